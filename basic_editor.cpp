@@ -1,5 +1,5 @@
 // Basic working editor with autocomplete - NO COLORS, JUST WORKS
-// Compile: g++ -std=c++17 basic_editor.cpp src/tst.cpp src/phrase_store.cpp src/freq_store.cpp src/ranker.cpp src/graph.cpp src/minheap.cpp src/lru.cpp src/stack.cpp src/kmp.cpp -lncurses -Iinclude -o basic_editor
+// Build: make basic_editor, or by hand: g++ -std=c++17 basic_editor.cpp src/tst.cpp src/phrase_store.cpp src/freq_store.cpp src/ranker.cpp src/graph.cpp src/minheap.cpp src/lru.cpp src/stack.cpp src/kmp.cpp src/text_buffer.cpp src/line_index.cpp src/edit_journal.cpp src/symbol_index.cpp src/syntax.cpp src/suggest_worker.cpp src/metrics.cpp src/doc_search.cpp src/fuzzy.cpp src/substring_session.cpp -lncurses -pthread -Iinclude -o basic_editor
 
 #include <ncurses.h>
 #include <string>
@@ -9,6 +9,9 @@
 #include <algorithm>
 #include <filesystem>
 #include <unordered_set>
+#include <chrono>
+#include <atomic>
+#include <unistd.h>
 
 #include "tst.h"
 #include "phrase_store.h"
@@ -19,10 +22,20 @@
 #include "minheap.h"
 #include "lru.h"
 #include "stack.h"
+#include "text_buffer.h"
+#include "syntax.h"
+#include "suggest_worker.h"
+#include "doc_search.h"
+#include "fuzzy.h"
+#include "substring_session.h"
+#include "edit_journal.h"
+#include "symbol_index.h"
 
 class BasicEditor {
 private:
-    std::vector<std::string> lines;
+    // Document storage: piece table with a line-start index
+    TextBuffer buffer;
+    SyntaxHighlighter syntax;
     std::vector<std::string> suggestions;
     std::vector<bool> isPhraseFlag;
     int cursorY, cursorX;
@@ -36,7 +49,10 @@ private:
     CooccurrenceGraph graph;
     Ranker ranker;
     std::vector<std::string> dictionaryWords;
+    FuzzyIndex fuzzyWords;      // dictionaryWords packed for typo-tolerant matching
+    SubstringSession substringMatches{&dictionaryWords};    // narrowed as the word grows
     std::string lastAcceptedWord;
+    SymbolIndex localSymbols;   // identifiers of the open document, fed edit by edit
 
     // A) MinHeap for Top-K ranking
     MinHeap suggestionHeap{10};
@@ -44,15 +60,42 @@ private:
     // B) LRU Cache for query caching
     lru_cache suggestionCache{100};
 
-    // C) Stack for undo/redo
-    UndoRedoStack undoRedoStack;
+    // C) Stack for undo/redo (delta history, bounded to a byte budget)
+    UndoRedoStack undoRedoStack{4 * UndoRedoStack::DEFAULT_MAX_BYTES};
 
     std::string currentFileName;
     bool fileModified;
 
-    std::string searchQuery;
+    // Match index for Ctrl+R, kept current across edits
+    DocumentSearch search;
     bool searchMode;
 
+    // Rendering state for damage tracking
+    std::vector<char> rowDirty;
+    std::vector<uint64_t> rowVersion;
+    bool fullRepaint;
+    int renderedScrollY;
+    std::vector<std::string> popupRows;
+    int popupY, popupX;
+    int lastRowsDrawn;
+    double lastFrameMs;
+    std::string statusMessage;      // shown on the message line for one frame
+    std::string pendingSearch;      // re-run on a file once its lines are indexed
+    EditJournal journal;            // unsaved edits, replayable after a crash
+    bool journalFailed;             // its writer hit a disk error; cleared when it is reopened
+
+    // Read by the status bar while the worker updates phraseStore
+    std::atomic<int> phraseCount;
+    // Cursor line of the newest request, for ranking local symbols by proximity
+    std::atomic<int> suggestLine;
+    // Larger documents are not tokenized up front, and their symbols are not tracked
+    static const size_t SYMBOL_INDEX_MAX_BYTES = 4 << 20;
+    bool symbolsTracked;
+
+    // Owns every access to the dictionary state above once run() starts;
+    // declared last so it is joined before anything it touches is destroyed
+    SuggestWorker suggestWorker;
+
 public:
     BasicEditor()
         : cursorY(0), cursorX(0), scrollY(0),
@@ -62,10 +105,15 @@ public:
         ranker(&freqStore, &graph),
         currentFileName(""),
         fileModified(false),
-        searchMode(false) {
+        searchMode(false),
+        fullRepaint(true), renderedScrollY(0),
+        popupY(0), popupX(0),
+        lastRowsDrawn(0), lastFrameMs(0.0), journalFailed(false),
+        phraseCount(0), suggestLine(0), symbolsTracked(true),
+        suggestWorker([this](const std::string& word) { return computeSuggestions(word); }) {
 
-        lines.push_back("");
-                loadDictionary();
+        loadDictionary();
+        phraseCount = phraseStore.getTotalPhrases();
 
                 std::error_code ec;
                 std::filesystem::create_directories("scratch", ec);
@@ -84,6 +132,7 @@ public:
             }
         }
         file.close();
+        fuzzyWords.build(dictionaryWords);
     }
 
     void run() {
@@ -103,168 +152,228 @@ public:
         init_pair(6, COLOR_RED, COLOR_BLACK);     // Operators
         init_pair(7, COLOR_WHITE, COLOR_BLUE);    // Selection/Highlight
 
+        recoverJournal();
+        indexSymbols();
+
         bool running = true;
         while (running) {
+            if (buffer.pollLoading()) fileLoaded();
+            // Write errors happen on the journal's own thread; pick them up here
+            if (!journalFailed && journal.hasFailed()) {
+                journalFailed = true;
+                statusMessage = "Warning: writing the edit journal failed; newer edits are not recoverable";
+            }
             draw();
+
+            // Poll for worker results while a query is in flight, and for the
+            // line index while a file is loading; otherwise block
+            timeout(suggestWorker.pending() || buffer.loading() ? 10 : -1);
             int ch = getch();
+            timeout(-1);
+
+            if (ch == ERR) {
+                pollSuggestions();
+                continue;
+            }
             running = handleInput(ch);
         }
 
+        // A clean exit leaves nothing to recover
+        journal.close(true);
+        suggestWorker.stop();
         phraseStore.save();
         freqStore.save();
         endwin();
     }
 
 private:
-    bool isKeyword(const std::string& word) {
-        static const std::vector<std::string> keywords = {
-            "auto", "break", "case", "char", "const", "continue", "default", "do",
-            "double", "else", "enum", "extern", "float", "for", "goto", "if",
-            "int", "long", "register", "return", "short", "signed", "sizeof", "static",
-            "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while",
-            "class", "namespace", "template", "public", "private", "protected", "virtual",
-            "bool", "true", "false", "nullptr", "new", "delete", "try", "catch", "throw",
-            "using", "std", "string", "vector", "map", "set", "include", "define", "ifdef"
-        };
-        return std::find(keywords.begin(), keywords.end(), word) != keywords.end();
+    static attr_t tokenAttr(TokenKind kind) {
+        switch (kind) {
+            case TOKEN_KEYWORD:      return COLOR_PAIR(1) | A_BOLD;
+            case TOKEN_STRING:       return COLOR_PAIR(2);
+            case TOKEN_COMMENT:      return COLOR_PAIR(3);
+            case TOKEN_NUMBER:       return COLOR_PAIR(4);
+            case TOKEN_PREPROCESSOR: return COLOR_PAIR(5);
+            case TOKEN_OPERATOR:     return COLOR_PAIR(6);
+            default:                 return A_NORMAL;
+        }
     }
 
-    void drawLineWithSyntax(int y, int lineNum, const std::string& line) {
-        mvprintw(y, 0, "%3d | ", lineNum);
-        int x = 6;
-
-        for (size_t i = 0; i < line.length(); i++) {
-            // Handle strings
-            if (line[i] == '"' || line[i] == '\'') {
-                char quote = line[i];
-                attron(COLOR_PAIR(2));
-                mvaddch(y, x++, line[i]);
-                i++;
-                while (i < line.length() && line[i] != quote) {
-                    mvaddch(y, x++, line[i]);
-                    if (line[i] == '\\' && i + 1 < line.length()) {
-                        i++;
-                        mvaddch(y, x++, line[i]);
-                    }
-                    i++;
-                }
-                if (i < line.length()) mvaddch(y, x++, line[i]);
-                attroff(COLOR_PAIR(2));
-                continue;
-            }
+    // Render one line from its cached tokens into a row of attributed cells
+    // and emit it with a single call
+    void drawLineWithSyntax(int y, int lineNum, const std::string& line,
+                            const std::vector<SyntaxToken>& tokens) {
+        std::vector<chtype> cells;
+        cells.reserve(line.length() + 8);
+
+        char gutter[16];
+        snprintf(gutter, sizeof(gutter), "%3d | ", lineNum);
+        for (const char* p = gutter; *p; p++) {
+            cells.push_back((unsigned char)*p);
+        }
 
-            // Handle comments
-            if (i + 1 < line.length() && line[i] == '/' && line[i+1] == '/') {
-                attron(COLOR_PAIR(3));
-                while (i < line.length()) {
-                    mvaddch(y, x++, line[i++]);
-                }
-                attroff(COLOR_PAIR(3));
-                break;
+        size_t base = cells.size();
+        for (char c : line) {
+            cells.push_back((unsigned char)c);
+        }
+        for (const auto& token : tokens) {
+            attr_t attr = tokenAttr(token.kind);
+            for (uint32_t i = token.start; i < token.start + token.length && i < line.length(); i++) {
+                cells[base + i] |= attr;
             }
+        }
+        highlightMatches(cells, base, lineNum - 1, line.length());
 
-            // Handle preprocessor
-            if (line[i] == '#') {
-                attron(COLOR_PAIR(5));
-                std::string word;
-                while (i < line.length() && (isalnum(line[i]) || line[i] == '#' || line[i] == '_')) {
-                    word += line[i];
-                    mvaddch(y, x++, line[i++]);
-                }
-                attroff(COLOR_PAIR(5));
-                i--;
-                continue;
-            }
+        int width = std::min((int)cells.size(), COLS);
+        mvaddchnstr(y, 0, cells.data(), width);
+        if (width < COLS) {
+            move(y, width);
+            clrtoeol();
+        }
+    }
 
-            // Handle numbers
-            if (isdigit(line[i])) {
-                attron(COLOR_PAIR(4));
-                while (i < line.length() && (isdigit(line[i]) || line[i] == '.')) {
-                    mvaddch(y, x++, line[i++]);
-                }
-                attroff(COLOR_PAIR(4));
-                i--;
-                continue;
+    // Paint every search match on this line, including the parts of matches
+    // that start on an earlier line; the match under the cursor is reversed
+    void highlightMatches(std::vector<chtype>& cells, size_t base, size_t lineIndex, size_t length) {
+        if (!search.active() || search.count() == 0) return;
+
+        size_t m = search.pattern().size();
+        size_t lineStart = buffer.lineStart(lineIndex);
+        size_t lineEnd = lineStart + length;
+        size_t i = search.lowerBound(lineStart >= m - 1 ? lineStart - (m - 1) : 0);
+
+        for (; i < search.count() && search.at(i) < lineEnd; i++) {
+            size_t from = std::max(search.at(i), lineStart) - lineStart;
+            size_t to = std::min(search.at(i) + m, lineEnd) - lineStart;
+            attr_t attr = COLOR_PAIR(7) | (i == search.currentIndex() ? A_REVERSE : 0);
+            for (size_t c = from; c < to; c++) {
+                cells[base + c] = (cells[base + c] & ~A_COLOR) | attr;
             }
+        }
+    }
 
-            // Handle operators
-            if (strchr("+-*/%=<>!&|^~?:;,(){}[]", line[i])) {
-                attron(COLOR_PAIR(6));
-                mvaddch(y, x++, line[i]);
-                attroff(COLOR_PAIR(6));
-                continue;
-            }
+    // Damage tracking: only rows marked here are re-rendered on the next frame
+    void markAllDirty() {
+        fullRepaint = true;
+    }
 
-            // Handle keywords and identifiers
-            if (isalnum(line[i]) || line[i] == '_') {
-                std::string word;
-                size_t start = i;
-                while (i < line.length() && (isalnum(line[i]) || line[i] == '_')) {
-                    word += line[i++];
-                }
-                i--;
+    void markRowsDirty(int firstRow, int count) {
+        for (int r = std::max(firstRow, 0); r < firstRow + count && r < (int)rowDirty.size(); r++) {
+            rowDirty[r] = 1;
+        }
+    }
 
-                if (isKeyword(word)) {
-                    attron(COLOR_PAIR(1) | A_BOLD);
-                    mvprintw(y, x, "%s", word.c_str());
-                    attroff(COLOR_PAIR(1) | A_BOLD);
-                } else {
-                    mvprintw(y, x, "%s", word.c_str());
-                }
-                x += word.length();
-                continue;
-            }
+    void markLineDirty(int line) {
+        markRowsDirty(line - scrollY, 1);
+    }
 
-            // Default: print character as-is
-            mvaddch(y, x++, line[i]);
-        }
+    // Lines shifted up or down: every row from this line to the bottom changes.
+    // A line above the viewport shifts every visible row.
+    void markDirtyFrom(int line) {
+        int firstRow = std::max(line - scrollY, 0);
+        markRowsDirty(firstRow, (int)rowDirty.size() - firstRow);
     }
 
     void draw() {
-        clear();
+        auto frameStart = std::chrono::steady_clock::now();
 
         // Calculate how many lines we can show
         int maxLines = LINES - 3;
 
-        // Draw lines with syntax highlighting
-        for (int i = 0; i < maxLines && (scrollY + i) < lines.size(); i++) {
-            int lineNum = scrollY + i + 1;
-            drawLineWithSyntax(i, lineNum, lines[scrollY + i]);
+        if ((int)rowDirty.size() != maxLines || scrollY != renderedScrollY) {
+            rowDirty.assign(std::max(maxLines, 0), 1);
+            rowVersion.assign(std::max(maxLines, 0), 0);
+            fullRepaint = true;
         }
+        if (fullRepaint) {
+            // erase() only blanks the virtual screen; refresh() still sends a diff
+            erase();
+            std::fill(rowDirty.begin(), rowDirty.end(), 1);
+            popupRows.clear();
+            fullRepaint = false;
+        }
+        renderedScrollY = scrollY;
 
-        // Draw suggestions popup
+        // Lay out the suggestions popup and damage the rows it covered or now covers
+        std::vector<std::string> newPopup;
+        int displayY = cursorY - scrollY;
+        int newPopupY = (displayY < maxLines - 1) ? displayY + 1 : displayY;
+        int newPopupX = cursorX + 6;
         if (showingSuggestions && !suggestions.empty()) {
-            int displayY = cursorY - scrollY;
-            int popupY = (displayY < maxLines - 1) ? displayY + 1 : displayY;
-            int popupX = cursorX + 6;
-
             for (size_t i = 0; i < suggestions.size() && i < 5; i++) {
-                int y = popupY + i;
-                if (y < maxLines && y >= 0) {
-                    if (i == selectedSuggestion) {
-                        mvprintw(y, popupX, " > %s", suggestions[i].c_str());
-                    } else {
-                        mvprintw(y, popupX, "   %s", suggestions[i].c_str());
-                    }
-                }
+                newPopup.push_back(((int)i == selectedSuggestion ? " > " : "   ") + suggestions[i]);
+            }
+        }
+        if (newPopup != popupRows || newPopupY != popupY || newPopupX != popupX) {
+            markRowsDirty(popupY, popupRows.size());
+            markRowsDirty(newPopupY, newPopup.size());
+            popupRows = newPopup;
+            popupY = newPopupY;
+            popupX = newPopupX;
+        }
+
+        // Draw only damaged lines, or lines whose highlighting changed because
+        // the lexer state flowing into them did (e.g. a comment was opened above)
+        auto getLine = [this](size_t line) { return buffer.line(line); };
+        int rowsDrawn = 0;
+        for (int i = 0; i < maxLines; i++) {
+            if ((scrollY + i) < (int)buffer.lineCount()) {
+                const LineTokens& lineTokens = syntax.lineTokens(scrollY + i, getLine);
+                if (!rowDirty[i] && rowVersion[i] == lineTokens.version) continue;
+
+                int lineNum = scrollY + i + 1;
+                drawLineWithSyntax(i, lineNum, buffer.line(scrollY + i), lineTokens.tokens);
+                rowVersion[i] = lineTokens.version;
+            } else {
+                if (!rowDirty[i]) continue;
+                move(i, 0);
+                clrtoeol();
+                rowVersion[i] = 0;
+            }
+            rowDirty[i] = 0;
+            rowsDrawn++;
+        }
+
+        // Draw suggestions popup over the text
+        for (size_t i = 0; i < popupRows.size(); i++) {
+            int y = popupY + i;
+            if (y < maxLines && y >= 0) {
+                mvprintw(y, popupX, "%s", popupRows[i].c_str());
             }
         }
 
         // Status bar with file info
         std::string fileName = currentFileName.empty() ? "[No Name]" : currentFileName;
         std::string modifiedMark = fileModified ? " [+]" : "";
+        if (journalFailed) modifiedMark += " [not journaled]";
+        std::string matchInfo;
+        if (search.active()) {
+            size_t current = search.currentIndex();
+            matchInfo = " | Match " + (current == DocumentSearch::npos ? std::string("-") : std::to_string(current + 1)) +
+                        "/" + std::to_string(search.count());
+        }
+        // Lines are still being counted after opening a large file
+        std::string lineTotal = std::to_string(buffer.lineCount());
+        if (buffer.loading()) {
+            lineTotal += "+ (indexing " + std::to_string((int)(buffer.loadProgress() * 100)) + "%)";
+        }
         attron(A_REVERSE);
-        mvprintw(LINES - 2, 0, " %s%s | Line %d/%zu Col %d | %d phrases | Ctrl+O: Open | Ctrl+W: Save | Ctrl+R: Search | Ctrl+N: Next | Ctrl+H: Help | Ctrl+Q: Quit ",
-                fileName.c_str(), modifiedMark.c_str(), cursorY + 1, lines.size(), cursorX + 1, phraseStore.getTotalPhrases());
+        mvprintw(LINES - 2, 0, " %s%s | Line %d/%s Col %d%s | %d phrases | %.2f ms/frame (%d rows) | Ctrl+O: Open | Ctrl+W: Save | Ctrl+R: Search | Ctrl+N: Next | Ctrl+H: Help | Ctrl+Q: Quit ",
+                fileName.c_str(), modifiedMark.c_str(), cursorY + 1, lineTotal.c_str(), cursorX + 1, matchInfo.c_str(), phraseCount.load(), lastFrameMs, lastRowsDrawn);
         attroff(A_REVERSE);
 
         // Clear rest of status line
-        for (int i = fileName.length() + 130; i < COLS; i++) {
-            mvaddch(LINES - 2, i, ' ');
+        clrtoeol();
+
+        // Messages from the previous key only last one frame
+        move(LINES - 1, 0);
+        clrtoeol();
+        if (!statusMessage.empty()) {
+            mvprintw(LINES - 1, 0, "%s", statusMessage.c_str());
+            statusMessage.clear();
         }
 
         // Position cursor - calculate display position relative to scroll
-        int displayY = cursorY - scrollY;
         int displayX = cursorX + 6;
 
         // Make sure cursor position is valid
@@ -273,6 +382,10 @@ private:
         }
 
         refresh();
+
+        lastRowsDrawn = rowsDrawn;
+        lastFrameMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - frameStart).count();
     }
 
     void updateScroll() {
@@ -289,6 +402,12 @@ private:
     }
 
     bool handleInput(int ch) {
+        // Anything other than typing or backspacing ends the current undo step
+        bool isEditKey = (ch >= 32 && ch <= 126) || ch == 127 || ch == KEY_BACKSPACE;
+        if (!isEditKey) {
+            undoRedoStack.seal();
+        }
+
         switch (ch) {
             case 17:  // Ctrl+Q
                 if (fileModified) {
@@ -320,6 +439,14 @@ private:
                 findNext();
                 break;
 
+            case 2:   // Ctrl+B - Find previous (Back)
+                findPrevious();
+                break;
+
+            case 5:   // Ctrl+E - Replace all matches (rEplace)
+                replaceAll();
+                break;
+
             case 16:  // Ctrl+P - Save phrase
             case 19:  // Ctrl+S - Save phrase (alternative)
                 saveCurrentLineAsPhrase();
@@ -342,8 +469,8 @@ private:
                     selectedSuggestion--;
                 } else if (cursorY > 0) {
                     cursorY--;
-                    if (cursorX > lines[cursorY].size()) {
-                        cursorX = lines[cursorY].size();
+                    if (cursorX > (int)buffer.lineLength(cursorY)) {
+                        cursorX = buffer.lineLength(cursorY);
                     }
                     updateScroll();
                 }
@@ -352,10 +479,10 @@ private:
             case KEY_DOWN:
                 if (showingSuggestions && selectedSuggestion < suggestions.size() - 1) {
                     selectedSuggestion++;
-                } else if (cursorY < lines.size() - 1) {
+                } else if (cursorY < (int)buffer.lineCount() - 1) {
                     cursorY++;
-                    if (cursorX > lines[cursorY].size()) {
-                        cursorX = lines[cursorY].size();
+                    if (cursorX > (int)buffer.lineLength(cursorY)) {
+                        cursorX = buffer.lineLength(cursorY);
                     }
                     updateScroll();
                 }
@@ -366,21 +493,21 @@ private:
                     cursorX--;
                 } else if (cursorY > 0) {
                     cursorY--;
-                    cursorX = lines[cursorY].size();
+                    cursorX = buffer.lineLength(cursorY);
                     updateScroll();
                 }
-                showingSuggestions = false;
+                hideSuggestions();
                 break;
 
             case KEY_RIGHT:
-                if (cursorX < lines[cursorY].size()) {
+                if (cursorX < (int)buffer.lineLength(cursorY)) {
                     cursorX++;
-                } else if (cursorY < lines.size() - 1) {
+                } else if (cursorY < (int)buffer.lineCount() - 1) {
                     cursorY++;
                     cursorX = 0;
                     updateScroll();
                 }
-                showingSuggestions = false;
+                hideSuggestions();
                 break;
 
             case '\t':  // Tab - Accept suggestion
@@ -392,116 +519,100 @@ private:
                 break;
 
             case '\n':  // Enter with smart indentation
-                // C) Save to undo stack before modification
-                saveToUndoStack();
-
-                showingSuggestions = false;
+                hideSuggestions();
                 {
-                    // Allow unlimited lines with scrolling
-                        // Calculate base indentation
-                        int baseIndent = 0;
-                        for (char c : lines[cursorY]) {
-                            if (c == ' ') baseIndent++;
-                            else break;
-                        }
+                    std::string current = buffer.line(cursorY);
 
-                        // Check if we need to add extra indent
-                        bool needExtraIndent = false;
-                        bool addClosingBrace = false;
-
-                        // Look at character before cursor
-                        if (cursorX > 0) {
-                            char prevChar = lines[cursorY][cursorX - 1];
-                            if (prevChar == '{') {
-                                needExtraIndent = true;
-                                // Check if next character is closing brace
-                                if (cursorX < lines[cursorY].size() && lines[cursorY][cursorX] == '}') {
-                                    addClosingBrace = true;
-                                }
-                            } else if (prevChar == '(') {
-                                needExtraIndent = true;
+                    // Calculate base indentation
+                    int baseIndent = 0;
+                    for (char c : current) {
+                        if (c == ' ') baseIndent++;
+                        else break;
+                    }
+
+                    // Check if we need to add extra indent
+                    bool needExtraIndent = false;
+                    bool addClosingBrace = false;
+
+                    // Look at character before cursor
+                    if (cursorX > 0) {
+                        char prevChar = current[cursorX - 1];
+                        if (prevChar == '{') {
+                            needExtraIndent = true;
+                            // Check if next character is closing brace
+                            if (cursorX < (int)current.size() && current[cursorX] == '}') {
+                                addClosingBrace = true;
                             }
+                        } else if (prevChar == '(') {
+                            needExtraIndent = true;
                         }
-
-                    std::string remainder = lines[cursorY].substr(cursorX);
-                    lines[cursorY] = lines[cursorY].substr(0, cursorX);
+                    }
 
                     int newIndent = baseIndent + (needExtraIndent ? 4 : 0);
+                    std::string text = "\n" + std::string(newIndent, ' ');
 
                     if (addClosingBrace) {
-                        // We have {|}, so remainder starts with }
-                        // Remove the } from remainder and add it on a separate line
-                        if (!remainder.empty() && remainder[0] == '}') {
-                            remainder = remainder.substr(1); // Remove the }
-                        }
-
-                        // Insert indented empty line for code
-                        lines.insert(lines.begin() + cursorY + 1, std::string(newIndent, ' ') + remainder);
-                        cursorY++;
-                        cursorX = newIndent;
-
-                        // Add closing brace on next line at original indent
-                        lines.insert(lines.begin() + cursorY + 1, std::string(baseIndent, ' ') + "}");
-                    } else {
-                        // Normal case - just indent
-                        lines.insert(lines.begin() + cursorY + 1, std::string(newIndent, ' ') + remainder);
-                        cursorY++;
-                        cursorX = newIndent;
+                        // We have {|}, so push the } onto its own line at the original indent
+                        text += "\n" + std::string(baseIndent, ' ');
                     }
 
+                    applyEdit(cursorY, cursorX, 0, text);
+                    cursorY++;
+                    cursorX = newIndent;
+
                     updateScroll();
                 }
                 break;
 
             case 127:  // Backspace
             case KEY_BACKSPACE:
-                // C) Save to undo stack before modification
-                saveToUndoStack();
-
-                showingSuggestions = false;
-                fileModified = true;
+                hideSuggestions();
                 if (cursorX > 0) {
-                    lines[cursorY].erase(cursorX - 1, 1);
+                    applyEdit(cursorY, cursorX - 1, 1, "");
                     cursorX--;
                 } else if (cursorY > 0) {
-                    cursorX = lines[cursorY - 1].size();
-                    lines[cursorY - 1] += lines[cursorY];
-                    lines.erase(lines.begin() + cursorY);
+                    // Join with the previous line by removing its newline
+                    int prevLen = buffer.lineLength(cursorY - 1);
+                    applyEdit(cursorY - 1, prevLen, 1, "");
                     cursorY--;
+                    cursorX = prevLen;
                     updateScroll();
                 }
                 break;
 
-            case 27:  // Escape
-                showingSuggestions = false;
+            case 27:  // Escape - close the popup, or else clear search highlights
+                if (showingSuggestions) {
+                    hideSuggestions();
+                } else if (search.active()) {
+                    search.clear();
+                    markAllDirty();
+                }
                 break;
 
             default:
                 if (ch >= 32 && ch <= 126) {
-                    // C) Save to undo stack before modification
-                    saveToUndoStack();
-
-                    lines[cursorY].insert(cursorX, 1, ch);
-                    cursorX++;
-                    fileModified = true;
+                    std::string text(1, (char)ch);
 
                     // Auto-close brackets
                     if (ch == '(') {
-                        lines[cursorY].insert(cursorX, ")");
+                        text += ")";
                     } else if (ch == '{') {
-                        lines[cursorY].insert(cursorX, "}");
+                        text += "}";
                     } else if (ch == '[') {
-                        lines[cursorY].insert(cursorX, "]");
+                        text += "]";
                     } else if (ch == '"') {
-                        lines[cursorY].insert(cursorX, "\"");
+                        text += "\"";
                     } else if (ch == '\'') {
-                        lines[cursorY].insert(cursorX, "'");
+                        text += "'";
                     }
 
+                    applyEdit(cursorY, cursorX, 0, text);
+                    cursorX++;
+
                     if (isalnum(ch) || ch == '#') {
                         triggerAutocomplete();
                     } else {
-                        showingSuggestions = false;
+                        hideSuggestions();
                     }
                 }
         }
@@ -510,11 +621,111 @@ private:
     }
 
     // C) Undo/Redo using Stack
-    void saveToUndoStack() {
-        // Store current line state (simple: just track line content changes)
-        if (cursorY < (int)lines.size()) {
-            undoRedoStack.pushInsert(cursorY, lines[cursorY]);
+    // Every buffer mutation goes through applyEdit so the history stores it as a delta
+    void applyEdit(int line, int col, size_t removeLen, const std::string& text) {
+        std::string removed = eraseText(line, col, removeLen);
+        insertText(line, col, text);
+        undoRedoStack.record(line, col, removed, text);
+        fileModified = true;
+    }
+
+    // Insert text (which may contain newlines) at (line, col)
+    void insertText(int line, int col, const std::string& text) {
+        ensureLoaded();
+        size_t offset = buffer.offsetOf(line, col);
+        buffer.insert(offset, text);
+        journal.insert(offset, text);
+        searchEdited(offset, 0, text.size());
+
+        size_t newLines = std::count(text.begin(), text.end(), '\n');
+        symbolsEdited(line, 0, newLines);
+        syntax.invalidate(line);
+        if (newLines > 0) {
+            syntax.linesInserted(line + 1, newLines);
+            markDirtyFrom(line);
+        } else {
+            markLineDirty(line);
+        }
+    }
+
+    // Erase len characters starting at (line, col), counting each line break as one.
+    // Returns the erased text so it can be restored.
+    std::string eraseText(int line, int col, size_t len) {
+        ensureLoaded();
+        size_t offset = buffer.offsetOf(line, col);
+        std::string removed = buffer.substring(offset, len);
+        buffer.erase(offset, removed.size());
+        journal.erase(offset, removed.size());
+        searchEdited(offset, removed.size(), 0);
+
+        size_t joined = std::count(removed.begin(), removed.end(), '\n');
+        symbolsEdited(line, joined, 0);
+        if (joined > 0) {
+            syntax.linesErased(line + 1, joined);
+            markDirtyFrom(line);
+        } else {
+            markLineDirty(line);
         }
+        syntax.invalidate(line);
+        return removed;
+    }
+
+    // Re-tokenize the lines an edit left behind, starting at `line`. The
+    // index belongs to the suggestion worker, so the new text is posted to it.
+    void symbolsEdited(int line, size_t erasedBreaks, size_t insertedBreaks) {
+        if (!symbolsTracked) return;
+        std::vector<std::string> texts;
+        for (size_t i = 0; i <= insertedBreaks; i++) {
+            texts.push_back(buffer.line(line + i));
+        }
+        suggestWorker.post([this, line, erasedBreaks, insertedBreaks, texts = std::move(texts)]() {
+            localSymbols.linesErased(line + 1, erasedBreaks);
+            localSymbols.linesInserted(line + 1, insertedBreaks);
+            for (size_t i = 0; i < texts.size(); i++) {
+                localSymbols.updateLine(line + i, texts[i]);
+            }
+        });
+    }
+
+    // Index every line of a newly opened (or recovered) document
+    void indexSymbols() {
+        std::vector<std::string> lines;
+        symbolsTracked = buffer.length() <= SYMBOL_INDEX_MAX_BYTES;
+        if (symbolsTracked) {
+            ensureLoaded();
+            lines.reserve(buffer.lineCount());
+            for (size_t i = 0; i < buffer.lineCount(); i++) {
+                lines.push_back(buffer.line(i));
+            }
+        }
+        suggestWorker.post([this, lines = std::move(lines)]() {
+            localSymbols.clear();
+            for (size_t i = 0; i < lines.size(); i++) {
+                localSymbols.updateLine(i, lines[i]);
+            }
+        });
+    }
+
+    void searchEdited(size_t offset, size_t removed, size_t inserted) {
+        if (!search.active()) return;
+        search.edited(offset, removed, inserted, buffer);
+        // A multi-line match can start or end on a line that was not edited
+        if (search.pattern().find('\n') != std::string::npos) {
+            markAllDirty();
+        }
+    }
+
+    // Move the cursor to just past `text` as if it had been typed at (line, col)
+    void placeCursorAfter(int line, int col, const std::string& text) {
+        size_t nl = text.rfind('\n');
+        if (nl == std::string::npos) {
+            cursorY = line;
+            cursorX = col + text.size();
+        } else {
+            cursorY = line + std::count(text.begin(), text.end(), '\n');
+            cursorX = text.size() - nl - 1;
+        }
+        updateScroll();
     }
 
     void undoLastChange() {
@@ -523,9 +734,13 @@ private:
             refresh();
             return;
         }
-        auto [lineIdx, content] = undoRedoStack.undo();
-        if (lineIdx >= 0 && lineIdx < (int)lines.size()) {
-            lines[lineIdx] = content;
+        EditDelta delta = undoRedoStack.undo();
+        if (delta.line >= 0 && delta.line < (int)buffer.lineCount()) {
+            eraseText(delta.line, delta.col, delta.inserted.size());
+            insertText(delta.line, delta.col, delta.removed);
+            placeCursorAfter(delta.line, delta.col, delta.removed);
+            fileModified = true;
+            hideSuggestions();
             mvprintw(LINES - 1, 0, "Undo performed                                                                                                                                                                    ");
             refresh();
             getch();
@@ -538,9 +753,13 @@ private:
             refresh();
             return;
         }
-        auto [lineIdx, content] = undoRedoStack.redo();
-        if (lineIdx >= 0 && lineIdx < (int)lines.size()) {
-            lines[lineIdx] = content;
+        EditDelta delta = undoRedoStack.redo();
+        if (delta.line >= 0 && delta.line < (int)buffer.lineCount()) {
+            eraseText(delta.line, delta.col, delta.removed.size());
+            insertText(delta.line, delta.col, delta.inserted);
+            placeCursorAfter(delta.line, delta.col, delta.inserted);
+            fileModified = true;
+            hideSuggestions();
             mvprintw(LINES - 1, 0, "Redo performed                                                                                                                                                                    ");
             refresh();
             getch();
@@ -551,35 +770,60 @@ private:
         // Not needed anymore with UndoRedoStack
     }
 
+    // Queue a query for the word at the cursor; the popup updates when the
+    // worker answers, so typing never waits on the dictionary
     void triggerAutocomplete() {
         std::string currentWord = getCurrentWord();
         if (currentWord.empty()) {
-            showingSuggestions = false;
+            hideSuggestions();
             return;
         }
+        suggestLine = cursorY;
+        suggestWorker.request(currentWord);
+    }
 
-        suggestions.clear();
+    void hideSuggestions() {
+        showingSuggestions = false;
+        suggestWorker.cancel();
+    }
+
+    // Apply the newest suggestions if they still match the word being typed
+    bool pollSuggestions() {
+        SuggestWorker::Result result;
+        if (!suggestWorker.poll(result)) return false;
+        if (result.prefix != getCurrentWord()) return false;
+
+        suggestions = std::move(result.suggestions);
         isPhraseFlag.clear();
+        for (const auto& suggestion : suggestions) {
+            isPhraseFlag.push_back(suggestion.find("[PHRASE]") == 0);
+        }
+        showingSuggestions = !suggestions.empty();
+        selectedSuggestion = 0;
+        return true;
+    }
+
+    // Runs on the suggestion worker thread only
+    std::vector<std::string> computeSuggestions(const std::string& currentWord) {
+        std::vector<std::string> results;
+        const int maxSuggestions = 10;
+
+        // Identifiers of this document change with every edit and cursor
+        // move, so queries that match any are not cached
+        auto local = localSymbols.complete(currentWord, suggestLine.load(), maxSuggestions / 2);
 
         // B) Check LRU cache first
-        if (suggestionCache.exists(currentWord)) {
+        if (local.empty() && suggestionCache.exists(currentWord)) {
             auto cached = suggestionCache.get(currentWord);
             // Use cached suggestions if available
             if (!cached.empty()) {
-                for (const auto& suggestion : cached) {
-                    suggestions.push_back(suggestion);
-                    isPhraseFlag.push_back(suggestion.find("[PHRASE]") == 0);
-                }
-                showingSuggestions = !suggestions.empty();
-                selectedSuggestion = 0;
-                return;
+                return cached;
             }
         }
 
         // A) Use MinHeap for ranking
         suggestionHeap.clear(); // reset heap for new query
 
-        const int maxSuggestions = 10;
         std::unordered_set<std::string> seen;
 
         // 1) Phrase suggestions
@@ -590,7 +834,14 @@ private:
             seen.insert(phrase.snippet);
         }
 
-        // 2) Prefix token suggestions from TST
+        // 2) Identifiers used in this document, boosted near the cursor
+        for (const auto& symbol : local) {
+            if (seen.find(symbol.word) != seen.end()) continue;
+            suggestionHeap.insert(freqStore.get(symbol.word) + symbol.score, symbol.word);
+            seen.insert(symbol.word);
+        }
+
+        // 3) Prefix token suggestions from TST
         int need = maxSuggestions - suggestionHeap.size();
         if (need > 0) {
             auto tokens = tst.prefixSearch(currentWord, need);
@@ -602,18 +853,28 @@ private:
             }
         }
 
-        // 3) Substring matches using KMP
+        // 4) Substring matches, narrowed from the previous keystroke's
         need = maxSuggestions - suggestionHeap.size();
         if (need > 0) {
-            for (const auto& word : dictionaryWords) {
+            for (const auto& candidate : substringMatches.update(currentWord)) {
                 if ((int)suggestionHeap.size() >= maxSuggestions) break;
+                if (candidate.offset == 0) continue; // skip prefix matches
+                const std::string& word = substringMatches.word(candidate);
                 if (seen.find(word) != seen.end()) continue;
-                if (word.rfind(currentWord, 0) == 0) continue; // skip prefix matches
-                if (KMP::contains(word, currentWord)) {
-                    double score = freqStore.get(word);
-                    suggestionHeap.insert(score, word);
-                    seen.insert(word);
-                }
+                double score = freqStore.get(word);
+                suggestionHeap.insert(score, word);
+                seen.insert(word);
+            }
+        }
+
+        // 5) Words containing the query with one typo, below exact matches
+        need = maxSuggestions - suggestionHeap.size();
+        if (need > 0 && currentWord.size() >= 4) {
+            for (const auto& match : fuzzyWords.search(currentWord, 1, maxSuggestions)) {
+                if ((int)suggestionHeap.size() >= maxSuggestions) break;
+                if (seen.find(match.word) != seen.end()) continue;
+                suggestionHeap.insert(freqStore.get(match.word) / (1 + match.distance), match.word);
+                seen.insert(match.word);
             }
         }
 
@@ -624,17 +885,15 @@ private:
                  [](const auto& a, const auto& b) { return a.first > b.first; });
 
         for (const auto& [score, suggestion] : heapResults) {
-            suggestions.push_back(suggestion);
-            isPhraseFlag.push_back(suggestion.find("[PHRASE]") == 0);
+            results.push_back(suggestion);
         }
 
         // B) Store in LRU cache for next time
-        if (!suggestions.empty()) {
-            suggestionCache.put(currentWord, suggestions);
+        if (!results.empty() && local.empty()) {
+            suggestionCache.put(currentWord, results);
         }
 
-        showingSuggestions = !suggestions.empty();
-        selectedSuggestion = 0;
+        return results;
     }
 
     void acceptSuggestion() {
@@ -658,22 +917,25 @@ private:
 
         // Replace current word
         int wordStart = cursorX - currentWord.length();
-        lines[cursorY].erase(wordStart, currentWord.length());
-        lines[cursorY].insert(wordStart, textToInsert);
+        applyEdit(cursorY, wordStart, currentWord.length(), textToInsert);
+        undoRedoStack.seal();
         cursorX = wordStart + textToInsert.length();
 
-        // Update frequency
-        freqStore.bump(textToInsert, 1);
-        if (!lastAcceptedWord.empty()) {
-            graph.addEdge(lastAcceptedWord, textToInsert);
-        }
+        // Update frequency on the worker, which owns the dictionary state
+        std::string previous = lastAcceptedWord;
+        suggestWorker.post([this, textToInsert, previous]() {
+            freqStore.bump(textToInsert, 1);
+            if (!previous.empty()) {
+                graph.addEdge(previous, textToInsert);
+            }
+        });
         lastAcceptedWord = textToInsert;
 
-        showingSuggestions = false;
+        hideSuggestions();
     }
 
     std::string getCurrentWord() {
-        std::string& line = lines[cursorY];
+        std::string line = buffer.line(cursorY);
         int end = cursorX;
         int start = end;
 
@@ -698,34 +960,133 @@ private:
 
         if (strlen(filename) == 0) return;
 
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            mvprintw(LINES - 1, 0, "Error: Could not open file '%s'", filename);
+        // The file is mapped, not read: the first screen is drawn right away
+        // while the rest of its lines are counted in the background
+        std::string error;
+        if (!buffer.open(filename, error)) {
+            mvprintw(LINES - 1, 0, "Error: Could not open file '%s'", error.c_str());
             refresh();
             getch();
             return;
         }
-
-        lines.clear();
-        std::string line;
-        while (std::getline(file, line)) {
-            lines.push_back(line);
-        }
-        file.close();
-
-        if (lines.empty()) {
-            lines.push_back("");
-        }
+        // Edits of the previous document are given up with it
+        journal.close(true);
+        syntax.reset();
+        // Searching the new file waits for its index, so the first paint does not
+        pendingSearch = search.pattern();
+        search.clear();
+        markAllDirty();
+        if (!buffer.loading()) fileLoaded();
 
         currentFileName = filename;
         fileModified = false;
+        undoRedoStack.clear();
         cursorY = 0;
         cursorX = 0;
         scrollY = 0;
 
-        mvprintw(LINES - 1, 0, "Loaded '%s' (%zu lines)", filename, lines.size());
-        refresh();
-        getch();
+        statusMessage = std::string("Loaded '") + filename + "'";
+        recoverJournal();
+        indexSymbols();
+    }
+
+    // Journal for an untitled buffer. Each editor gets its own name, but
+    // first takes over one a crashed editor left with edits in it; left
+    // behind with none, it is removed.
+    std::string untitledJournalPath() const {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("scratch", ec)) {
+            std::string name = entry.path().filename().string();
+            std::string path = entry.path().string();
+            if (name.rfind(".untitled", 0) != 0 || name.size() < 14 ||
+                name.compare(name.size() - 5, 5, ".scaj") != 0 || EditJournal::inUse(path)) {
+                continue;
+            }
+            JournalHeader header;
+            std::vector<JournalOp> ops;
+            if (!EditJournal::replay(path, header, ops)) continue;
+            if (!ops.empty()) return path;
+            std::filesystem::remove(path, ec);
+        }
+        return "scratch/.untitled." + std::to_string(getpid()) + ".scaj";
+    }
+
+    // Record edits from here on in the journal at path; keep appends to a
+    // journal just recovered from
+    void startJournal(const std::string& path, bool keep) {
+        if (currentFileName.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories("scratch", ec);
+        }
+        journalFailed = false;
+        std::string error;
+        if (!journal.open(path, EditJournal::describe(currentFileName), keep, error)) {
+            statusMessage = "Warning: edits are not journaled (" + error + ")";
+        }
+    }
+
+    // Offer to replay the edits a crash left in the current document's journal
+    void recoverJournal() {
+        JournalHeader header;
+        std::vector<JournalOp> ops;
+        std::string path = currentFileName.empty() ? untitledJournalPath() : EditJournal::pathFor(currentFileName);
+        bool recovered = false;
+        journalFailed = false;
+
+        // Another editor has this file open: its journal is live, not a crash's
+        if (EditJournal::inUse(path)) {
+            statusMessage = "Warning: edits are not journaled (" + path + ": in use by another editor)";
+            return;
+        }
+
+        if (EditJournal::replay(path, header, ops) && !ops.empty()) {
+            JournalHeader now = EditJournal::describe(currentFileName);
+            if (header.baseSize != now.baseSize || header.baseMtimeNs != now.baseMtimeNs) {
+                statusMessage = "Ignored '" + path + "': the file changed after it was written";
+            } else {
+                mvprintw(LINES - 1, 0, "Recover %zu unsaved edits from '%s'? (y/n): ", ops.size(), path.c_str());
+                clrtoeol();
+                refresh();
+                int answer = getch();
+                if (answer == 'y' || answer == 'Y') {
+                    ensureLoaded();
+                    for (const auto& op : ops) {
+                        if (op.kind == JournalOp::INSERT) {
+                            buffer.insert(op.offset, op.text);
+                        } else {
+                            buffer.erase(op.offset, op.count);
+                        }
+                    }
+                    syntax.reset();
+                    if (search.active()) {
+                        std::string pattern = search.pattern();
+                        search.setPattern(pattern, buffer);
+                    }
+                    markAllDirty();
+                    fileModified = true;
+                    recovered = true;
+                    statusMessage = "Recovered " + std::to_string(ops.size()) + " edits";
+                }
+            }
+        }
+
+        startJournal(path, recovered);
+    }
+
+    // The line index of an opened file is complete
+    void fileLoaded() {
+        if (!pendingSearch.empty()) {
+            search.setPattern(pendingSearch, buffer);
+            pendingSearch.clear();
+        }
+        markAllDirty();
+    }
+
+    // Edits need every line counted; wait for the rest of the index
+    void ensureLoaded() {
+        if (!buffer.loading()) return;
+        buffer.finishLoading();
+        fileLoaded();
     }
 
     void saveFile() {
@@ -767,117 +1128,158 @@ private:
             }
         }
 
-        std::ofstream file(finalPath);
-        if (!file.is_open()) {
-            mvprintw(LINES - 1, 0, "Error: Could not save file '%s'", finalPath.c_str());
+        // Written beside finalPath and renamed over it, so a crash never
+        // leaves a half-written file (and a mapped original is not truncated)
+        std::string error;
+        if (!buffer.save(finalPath, error)) {
+            mvprintw(LINES - 1, 0, "Error: Could not save file (%s)", error.c_str());
             refresh();
             getch();
             return;
         }
 
-        for (size_t i = 0; i < lines.size(); i++) {
-            file << lines[i];
-            if (i < lines.size() - 1) {
-                file << "\n";
-            }
-        }
-        file.close();
-
+        // The saved file is the new base; earlier edits need no recovery
+        journal.close(true);
         currentFileName = finalPath;
         fileModified = false;
+        startJournal(EditJournal::pathFor(currentFileName), false);
 
-        mvprintw(LINES - 1, 0, "Saved '%s' (%zu lines)", currentFileName.c_str(), lines.size());
+        mvprintw(LINES - 1, 0, "Saved '%s' (%zu lines)", currentFileName.c_str(), buffer.lineCount());
         refresh();
         getch();
     }
 
-    void searchFile() {
+    // Read a line from the prompt; returns false when it is left empty
+    bool promptLine(const char* prompt, std::string& out) {
         echo();
-        mvprintw(LINES - 1, 0, "Search: ");
+        mvprintw(LINES - 1, 0, "%s", prompt);
         clrtoeol();
         refresh();
 
-        char query[256];
-        getnstr(query, 255);
+        char input[256];
+        getnstr(input, 255);
         noecho();
 
-        if (strlen(query) == 0) return;
-
-        searchQuery = query;
+        out = input;
+        return !out.empty();
+    }
 
-        // Search from current position
-        for (size_t i = cursorY; i < lines.size(); i++) {
-            size_t pos = lines[i].find(searchQuery, (i == cursorY) ? cursorX + 1 : 0);
-            if (pos != std::string::npos) {
-                cursorY = i;
-                cursorX = pos;
-                updateScroll();
-                mvprintw(LINES - 1, 0, "Found at line %zu, column %zu (Ctrl+N for next)", i + 1, pos + 1);
-                refresh();
-                return;
+    // "\n", "\t" and "\\" in a typed pattern stand for newline, tab and backslash
+    static std::string unescape(const std::string& text) {
+        std::string out;
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '\\' && i + 1 < text.size()) {
+                char next = text[i + 1];
+                if (next == 'n' || next == 't' || next == '\\') {
+                    out += next == 'n' ? '\n' : next == 't' ? '\t' : '\\';
+                    i++;
+                    continue;
+                }
             }
+            out += text[i];
         }
+        return out;
+    }
 
-        // Wrap around
-        for (size_t i = 0; i < cursorY; i++) {
-            size_t pos = lines[i].find(searchQuery);
-            if (pos != std::string::npos) {
-                cursorY = i;
-                cursorX = pos;
-                updateScroll();
-                mvprintw(LINES - 1, 0, "Found at line %zu, column %zu (wrapped, Ctrl+N for next)", i + 1, pos + 1);
-                refresh();
-                return;
-            }
-        }
+    // Put the cursor on a match and report where it is
+    void goToMatch(size_t index, size_t from, bool forward) {
+        size_t offset = search.at(index);
+        cursorY = buffer.lineAt(offset);
+        cursorX = offset - buffer.lineStart(cursorY);
+        updateScroll();
+        hideSuggestions();
+        markAllDirty();
+
+        char message[160];
+        snprintf(message, sizeof(message), "Match %zu/%zu at line %d, column %d%s (Ctrl+N next, Ctrl+B previous, Ctrl+E replace all)",
+                 index + 1, search.count(), cursorY + 1, cursorX + 1,
+                 (forward ? offset <= from : offset >= from) ? ", wrapped" : "");
+        statusMessage = message;
+    }
 
-        mvprintw(LINES - 1, 0, "Not found: '%s'", searchQuery.c_str());
-        refresh();
-        getch();
+    void searchFile() {
+        std::string query;
+        if (!promptLine("Search (\\n matches a line break): ", query)) return;
+
+        search.setPattern(unescape(query), buffer);
+        markAllDirty();
+
+        size_t from = buffer.offsetOf(cursorY, cursorX);
+        size_t index = search.next(from);
+        if (index == DocumentSearch::npos) {
+            mvprintw(LINES - 1, 0, "Not found: '%s'", query.c_str());
+            refresh();
+            getch();
+            return;
+        }
+        goToMatch(index, from, true);
     }
 
     void findNext() {
-        if (searchQuery.empty()) {
+        if (!search.active()) {
             mvprintw(LINES - 1, 0, "No search query. Press Ctrl+R to search first.");
             refresh();
             getch();
             return;
         }
 
-        // Search from next position after current cursor
-        for (size_t i = cursorY; i < lines.size(); i++) {
-            size_t startPos = (i == cursorY) ? cursorX + 1 : 0;
-            size_t pos = lines[i].find(searchQuery, startPos);
-            if (pos != std::string::npos) {
-                cursorY = i;
-                cursorX = pos;
-                updateScroll();
-                mvprintw(LINES - 1, 0, "Found at line %zu, column %zu (Ctrl+N for next)", i + 1, pos + 1);
-                refresh();
-                return;
-            }
+        size_t from = buffer.offsetOf(cursorY, cursorX);
+        size_t index = search.next(from);
+        if (index == DocumentSearch::npos) {
+            mvprintw(LINES - 1, 0, "No matches left for the search");
+            refresh();
+            getch();
+            return;
         }
+        goToMatch(index, from, true);
+    }
 
-        // Wrap around to beginning
-        for (size_t i = 0; i <= cursorY; i++) {
-            size_t pos = lines[i].find(searchQuery);
-            if (pos != std::string::npos) {
-                // Skip the current match
-                if (i == cursorY && pos == cursorX) {
-                    continue;
-                }
-                cursorY = i;
-                cursorX = pos;
-                updateScroll();
-                mvprintw(LINES - 1, 0, "Found at line %zu, column %zu (wrapped, Ctrl+N for next)", i + 1, pos + 1);
-                refresh();
-                return;
-            }
+    void findPrevious() {
+        if (!search.active()) {
+            mvprintw(LINES - 1, 0, "No search query. Press Ctrl+R to search first.");
+            refresh();
+            getch();
+            return;
         }
 
-        mvprintw(LINES - 1, 0, "No more matches for '%s'", searchQuery.c_str());
-        refresh();
-        getch();
+        size_t from = buffer.offsetOf(cursorY, cursorX);
+        size_t index = search.prev(from);
+        if (index == DocumentSearch::npos) {
+            mvprintw(LINES - 1, 0, "No matches left for the search");
+            refresh();
+            getch();
+            return;
+        }
+        goToMatch(index, from, false);
+    }
+
+    // Replace every match in one pass and record it as a single undo step
+    void replaceAll() {
+        if (!search.active() || search.count() == 0) {
+            mvprintw(LINES - 1, 0, "No matches to replace. Press Ctrl+R to search first.");
+            refresh();
+            getch();
+            return;
+        }
+
+        std::string prompt = "Replace " + std::to_string(search.count()) + " matches with: ";
+        std::string replacement;
+        if (!promptLine(prompt.c_str(), replacement)) return;
+
+        DocumentSearch::Replacement r = search.replaceAll(buffer, unescape(replacement));
+        int line = buffer.lineAt(r.from);
+        int col = r.from - buffer.lineStart(line);
+
+        undoRedoStack.seal();
+        applyEdit(line, col, r.length, r.text);
+        undoRedoStack.seal();
+        cursorY = line;
+        cursorX = col;
+        updateScroll();
+        hideSuggestions();
+        markAllDirty();
+
+        statusMessage = "Replaced " + std::to_string(r.replaced) + " matches (Ctrl+Z to undo)";
     }
 
     void showHelp() {
@@ -899,6 +1301,9 @@ private:
         mvprintw(line++, 4, "Ctrl+W           - Save file (Write)");
         mvprintw(line++, 4, "Ctrl+R           - Find/Search text");
         mvprintw(line++, 4, "Ctrl+N           - Find next match (after Ctrl+R)");
+        mvprintw(line++, 4, "Ctrl+B           - Find previous match");
+        mvprintw(line++, 4, "Ctrl+E           - Replace all matches");
+        mvprintw(line++, 4, "Esc              - Clear search highlights (\\n in a search matches a line break)");
         mvprintw(line++, 4, "Ctrl+Z           - Undo last change");
         mvprintw(line++, 4, "Ctrl+Y           - Redo change");
         mvprintw(line++, 4, "[+] indicator    - Shows unsaved changes in status bar");
@@ -916,7 +1321,7 @@ private:
         mvprintw(line++, 4, "Strings          - Green (\"hello\", 'c')");
         attroff(COLOR_PAIR(2));
         attron(COLOR_PAIR(3));
-        mvprintw(line++, 4, "Comments         - Cyan (// comment)");
+        mvprintw(line++, 4, "Comments         - Cyan (// comment, /* block */)");
         attroff(COLOR_PAIR(3));
         attron(COLOR_PAIR(4));
         mvprintw(line++, 4, "Numbers          - Yellow (123, 45.67)");
@@ -984,7 +1389,7 @@ private:
         // Status
         mvprintw(line++, 2, "Current Status:");
         mvprintw(line++, 4, "Dictionary words: 10,000+");
-        mvprintw(line++, 4, "Learned phrases: %d", phraseStore.getTotalPhrases());
+        mvprintw(line++, 4, "Learned phrases: %d", phraseCount.load());
         line++;
 
         // Footer
@@ -994,10 +1399,11 @@ private:
 
         refresh();
         getch();
+        markAllDirty();
     }
 
     void saveCurrentLineAsPhrase() {
-        std::string line = lines[cursorY];
+        std::string line = buffer.line(cursorY);
 
         // Remove leading/trailing spaces
         size_t start = line.find_first_not_of(" \t");
@@ -1030,8 +1436,11 @@ private:
             return;
         }
 
-        phraseStore.addPhrase(trigger, line);
-        phraseStore.save();
+        suggestWorker.post([this, trigger, line]() {
+            phraseStore.addPhrase(trigger, line);
+            phraseStore.save();
+            phraseCount = phraseStore.getTotalPhrases();
+        });
 
         mvprintw(LINES - 1, 0, "[OK] Phrase saved: '%s' -> '%s' (Press any key)          ",
                 trigger.c_str(), line.c_str());
@@ -0,0 +1,201 @@
+// Load generator for smart_autocomplete --serve
+// Build: make loadgen
+// Usage: ./loadgen [-s socket] [-c connections] [-n requests_per_connection]
+//                  [-p pipeline_depth] [-a accept_percent] [-w words_file]
+//
+// Each connection runs on its own thread and keeps up to pipeline_depth
+// requests in flight. Latency is measured per request from send to reply.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string socketPath = "/tmp/smart_autocomplete.sock";
+    std::string wordsFile = "data/words.txt";
+    int connections = 4;
+    int requests = 10000;
+    int pipeline = 16;
+    int acceptPercent = 0;
+};
+
+struct ThreadResult {
+    std::vector<double> latenciesUs;
+    size_t errors = 0;
+    bool failed = false;
+};
+
+static int connectTo(const std::string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t len = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (len <= 0) return false;
+        sent += len;
+    }
+    return true;
+}
+
+static void runConnection(const Options& opt, const std::vector<std::string>& prefixes,
+                          unsigned seed, ThreadResult& result) {
+    int fd = connectTo(opt.socketPath);
+    if (fd < 0) {
+        result.failed = true;
+        return;
+    }
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, prefixes.size() - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    std::deque<Clock::time_point> inFlight;
+    std::string inbox;
+    char buffer[65536];
+    int sent = 0;
+    int received = 0;
+    result.latenciesUs.reserve(opt.requests);
+
+    while (received < opt.requests) {
+        // Top up the pipeline in one write
+        std::string batch;
+        while (sent < opt.requests && (int)inFlight.size() < opt.pipeline) {
+            const std::string& prefix = prefixes[pick(rng)];
+            if (percent(rng) < opt.acceptPercent) {
+                batch += "{\"op\":\"accept\",\"token\":\"" + prefix + "\"}\n";
+            } else {
+                batch += "{\"op\":\"complete\",\"prefix\":\"" + prefix + "\",\"k\":5}\n";
+            }
+            inFlight.push_back(Clock::now());
+            sent++;
+        }
+        if (!batch.empty() && !sendAll(fd, batch)) {
+            result.failed = true;
+            break;
+        }
+
+        ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
+        if (len <= 0) {
+            result.failed = true;
+            break;
+        }
+        auto now = Clock::now();
+        inbox.append(buffer, len);
+
+        size_t start = 0, nl;
+        while ((nl = inbox.find('\n', start)) != std::string::npos) {
+            if (inbox.compare(start, 10, "{\"ok\":true") != 0) {
+                result.errors++;
+            }
+            result.latenciesUs.push_back(
+                std::chrono::duration<double, std::micro>(now - inFlight.front()).count());
+            inFlight.pop_front();
+            received++;
+            start = nl + 1;
+        }
+        inbox.erase(0, start);
+    }
+
+    close(fd);
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t idx = std::min(sorted.size() - 1, (size_t)(p / 100.0 * sorted.size()));
+    return sorted[idx];
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "-s") opt.socketPath = value;
+        else if (flag == "-c") opt.connections = std::max(1, atoi(value.c_str()));
+        else if (flag == "-n") opt.requests = std::max(1, atoi(value.c_str()));
+        else if (flag == "-p") opt.pipeline = std::max(1, atoi(value.c_str()));
+        else if (flag == "-a") opt.acceptPercent = std::clamp(atoi(value.c_str()), 0, 100);
+        else if (flag == "-w") opt.wordsFile = value;
+        else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    // Every prefix of every seed word makes a realistic keystroke stream
+    std::vector<std::string> prefixes;
+    std::ifstream words(opt.wordsFile);
+    std::string word;
+    while (words >> word) {
+        for (size_t len = 1; len <= word.size(); len++) {
+            std::string prefix = word.substr(0, len);
+            if (prefix.find_first_of("\"\\") == std::string::npos) {
+                prefixes.push_back(prefix);
+            }
+        }
+    }
+    if (prefixes.empty()) {
+        std::cerr << "No words in " << opt.wordsFile << std::endl;
+        return 1;
+    }
+
+    std::vector<ThreadResult> results(opt.connections);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (int c = 0; c < opt.connections; c++) {
+        threads.emplace_back(runConnection, std::cref(opt), std::cref(prefixes), 1234u + c,
+                             std::ref(results[c]));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    size_t errors = 0;
+    for (const auto& r : results) {
+        if (r.failed) {
+            std::cerr << "A connection failed; is the server running on " << opt.socketPath << "?" << std::endl;
+        }
+        all.insert(all.end(), r.latenciesUs.begin(), r.latenciesUs.end());
+        errors += r.errors;
+    }
+    std::sort(all.begin(), all.end());
+
+    std::cout << "requests     " << all.size() << " (" << errors << " errors)" << std::endl;
+    std::cout << "connections  " << opt.connections << ", pipeline " << opt.pipeline
+              << ", accept " << opt.acceptPercent << "%" << std::endl;
+    std::cout << "elapsed      " << seconds << " s" << std::endl;
+    std::cout << "throughput   " << (seconds > 0 ? all.size() / seconds : 0) << " req/s" << std::endl;
+    std::cout << "latency us   p50 " << percentile(all, 50) << "  p90 " << percentile(all, 90)
+              << "  p99 " << percentile(all, 99) << "  p99.9 " << percentile(all, 99.9)
+              << "  max " << (all.empty() ? 0 : all.back()) << std::endl;
+
+    return all.empty() ? 1 : 0;
+}
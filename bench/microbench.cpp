@@ -0,0 +1,879 @@
+// Microbenchmarks for the core data structures
+// Build and run: make bench
+// Usage: ./microbench [--sizes 10k,1M] [--huge] [--filter substring]
+//                     [--csv file] [--json file] [--seed n] [--corpus dir]
+//
+// Every benchmark runs twice over the same inputs: an untimed-per-op pass for
+// ns/op and allocations/op, then a pass timing each operation for the
+// latency percentiles (clock overhead subtracted). The mem_* rows build
+// each structure once and compare the heap it really took (tracked in
+// operator new/delete) with what its memoryUsage() reports, per item. Vocabularies are
+// synthetic identifiers built from common name parts, so prefixes share
+// subtrees the way real code does. --huge adds the 10M token vocabulary,
+// which needs roughly 8 GB of memory for the TST alone. --corpus runs the
+// suite on the identifiers of a real source tree instead (only, unless
+// --sizes is given too), e.g. --corpus /usr/include/c++/12.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include <memory>
+#include <thread>
+#include <new>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <unistd.h>
+#include <malloc.h>
+
+#include "tst.h"
+#include "radix_tst.h"
+#include "art.h"
+#include "sorted_dictionary.h"
+#include "indexer.h"
+#include "ranker.h"
+#include "minheap.h"
+#include "lru.h"
+#include "kmp.h"
+#include "fuzzy.h"
+#include "substring_session.h"
+#include "edit_journal.h"
+#include "freq_store.h"
+#include "graph.h"
+#include "phrase_store.h"
+
+// ---------------------------------------------------------------------------
+// Allocation counting: every global operator new in the process goes here.
+// Some benchmarks allocate from worker threads (the threaded fuzzy search,
+// the journal writer), so the counters are atomic. They are plain tallies
+// with no ordering to enforce, so relaxed updates are enough.
+
+static std::atomic<size_t> allocCount{0};
+static std::atomic<size_t> allocBytes{0};
+// Heap blocks currently live, including each block's malloc header
+static std::atomic<size_t> liveBytes{0};
+
+static size_t blockBytes(void* p) {
+    return malloc_usable_size(p) + sizeof(size_t);
+}
+
+void* operator new(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        liveBytes.fetch_add(blockBytes(p), std::memory_order_relaxed);
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+// GCC cannot see that these frees match the mallocs above
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void operator delete(void* p) noexcept {
+    if (p) liveBytes.fetch_sub(blockBytes(p), std::memory_order_relaxed);
+    std::free(p);
+}
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+// ---------------------------------------------------------------------------
+
+using Clock = std::chrono::steady_clock;
+
+// Latency samples kept per benchmark; longer runs sample every n-th op
+const size_t MAX_SAMPLES = 1 << 20;
+
+// Mirrors AutocompleteEngine: 5 suggestions from 10 candidates, 50 cache entries
+const int K = 5;
+const int CANDIDATES = K * 2;
+const int CACHE_CAPACITY = 50;
+
+struct Options {
+    std::vector<size_t> sizes = {10000, 1000000};
+    std::string filter;
+    std::string csvPath;
+    std::string jsonPath;
+    std::string corpus;
+    unsigned seed = 42;
+};
+
+struct Result {
+    std::string name;
+    size_t vocab = 0;
+    size_t ops = 0;
+    double nsPerOp = 0;
+    double allocsPerOp = 0;
+    double bytesPerOp = 0;
+    bool hasLatency = false;
+    double p50 = 0, p90 = 0, p99 = 0, p999 = 0, max = 0;   // ns
+
+    // Memory rows: heap per item, measured and as reported by memoryUsage()
+    bool isMemory = false;
+    size_t items = 0;
+    double liveBytesPerItem = 0;
+    double reportedBytesPerItem = 0;
+    size_t structureNodes = 0;      // trie nodes, for the trie variants
+};
+
+static double clockOverheadNs = 0;
+
+static void calibrateClock() {
+    std::vector<double> samples(10000);
+    for (auto& s : samples) {
+        auto t0 = Clock::now();
+        auto t1 = Clock::now();
+        s = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    }
+    std::sort(samples.begin(), samples.end());
+    clockOverheadNs = samples[samples.size() / 2];
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t idx = std::min(sorted.size() - 1, (size_t)(p / 100.0 * sorted.size()));
+    return sorted[idx];
+}
+
+// Run op(i) for i in [0, ops) twice: once for throughput and allocations,
+// once for per-op latency. reset() restores the starting state before
+// each pass so both passes see the same work (e.g. an empty tree).
+template <typename Op, typename Reset>
+Result measure(const std::string& name, size_t vocab, size_t ops, Op&& op, Reset&& reset) {
+    Result r;
+    r.name = name;
+    r.vocab = vocab;
+    r.ops = ops;
+
+    reset();
+    size_t allocs0 = allocCount, bytes0 = allocBytes;
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < ops; i++) {
+        op(i);
+    }
+    auto t1 = Clock::now();
+    r.nsPerOp = std::chrono::duration<double, std::nano>(t1 - t0).count() / ops;
+    r.allocsPerOp = (double)(allocCount - allocs0) / ops;
+    r.bytesPerOp = (double)(allocBytes - bytes0) / ops;
+
+    reset();
+    size_t stride = std::max<size_t>(1, ops / MAX_SAMPLES);
+    std::vector<double> latencies;
+    latencies.reserve(ops / stride + 1);
+    for (size_t i = 0; i < ops; i++) {
+        if (i % stride != 0) {
+            op(i);
+            continue;
+        }
+        auto s = Clock::now();
+        op(i);
+        auto e = Clock::now();
+        latencies.push_back(std::max(0.0, std::chrono::duration<double, std::nano>(e - s).count() - clockOverheadNs));
+    }
+    std::sort(latencies.begin(), latencies.end());
+    r.hasLatency = true;
+    r.p50 = percentile(latencies, 50);
+    r.p90 = percentile(latencies, 90);
+    r.p99 = percentile(latencies, 99);
+    r.p999 = percentile(latencies, 99.9);
+    r.max = latencies.empty() ? 0 : latencies.back();
+    return r;
+}
+
+template <typename Op>
+Result measure(const std::string& name, size_t vocab, size_t ops, Op&& op) {
+    return measure(name, vocab, ops, op, [] {});
+}
+
+// ---------------------------------------------------------------------------
+// Synthetic vocabulary
+
+static const char* const PARTS[] = {
+    "get", "set", "is", "has", "to", "from", "make", "read", "write", "parse",
+    "load", "save", "init", "update", "find", "insert", "remove", "clear",
+    "buffer", "node", "tree", "list", "map", "index", "count", "size",
+    "key", "value", "token", "line", "file", "path", "name", "data",
+    "item", "cache", "heap", "graph", "edge", "text", "word", "query",
+    "result", "score", "rank", "prefix", "suffix", "state", "config", "stream",
+    "handle", "event", "socket", "thread", "lock", "queue", "stack", "string",
+    "vector", "array", "range", "offset", "cursor", "window"
+};
+static const size_t PART_COUNT = sizeof(PARTS) / sizeof(PARTS[0]);
+
+// Token i is three name parts in camelCase or snake_case plus, past the
+// first PART_COUNT^3 tokens, a base-36 suffix, so every index is unique
+static std::string makeToken(size_t i) {
+    size_t a = i % PART_COUNT;
+    size_t b = (i / PART_COUNT) % PART_COUNT;
+    size_t c = (i / PART_COUNT / PART_COUNT) % PART_COUNT;
+    size_t rest = i / (PART_COUNT * PART_COUNT * PART_COUNT);
+    bool snake = ((i * 2654435761u) >> 7) & 1;
+
+    std::string token = PARTS[a];
+    for (size_t part : {b, c}) {
+        std::string s = PARTS[part];
+        if (snake) {
+            token += '_';
+        } else {
+            s[0] = (char)toupper((unsigned char)s[0]);
+        }
+        token += s;
+    }
+    while (rest > 0) {
+        token += "0123456789abcdefghijklmnopqrstuvwxyz"[rest % 36];
+        rest /= 36;
+    }
+    return token;
+}
+
+static std::vector<std::string> makeVocabulary(size_t n, std::mt19937& rng) {
+    std::vector<std::string> vocab;
+    vocab.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        vocab.push_back(makeToken(i));
+    }
+    std::shuffle(vocab.begin(), vocab.end(), rng);
+    return vocab;
+}
+
+// Prefixes of 2..5 characters, the lengths at which suggestions are asked for
+static std::vector<std::string> makePrefixes(const std::vector<std::string>& vocab, size_t n, std::mt19937& rng) {
+    std::uniform_int_distribution<size_t> pick(0, vocab.size() - 1);
+    std::uniform_int_distribution<size_t> len(2, 5);
+    std::vector<std::string> prefixes;
+    prefixes.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        const std::string& word = vocab[pick(rng)];
+        prefixes.push_back(word.substr(0, std::min(word.size(), len(rng))));
+    }
+    return prefixes;
+}
+
+// ---------------------------------------------------------------------------
+
+static std::string formatSize(size_t n) {
+    if (n % 1000000 == 0) return std::to_string(n / 1000000) + "M";
+    if (n % 1000 == 0) return std::to_string(n / 1000) + "k";
+    return std::to_string(n);
+}
+
+static bool parseSize(const std::string& s, size_t& n) {
+    char* end = nullptr;
+    double value = strtod(s.c_str(), &end);
+    if (end == s.c_str() || value <= 0) return false;
+    std::string unit = end;
+    if (unit == "k" || unit == "K") value *= 1e3;
+    else if (unit == "m" || unit == "M") value *= 1e6;
+    else if (!unit.empty()) return false;
+    n = (size_t)value;
+    return n > 0;
+}
+
+static void printResult(const Result& r) {
+    char line[256];
+    if (r.isMemory) {
+        int length = snprintf(line, sizeof(line), "%-30s %6s %10zu   %.1f B/item measured, %.1f B/item reported",
+                              r.name.c_str(), formatSize(r.vocab).c_str(), r.items, r.liveBytesPerItem,
+                              r.reportedBytesPerItem);
+        if (r.structureNodes > 0 && length > 0 && (size_t)length < sizeof(line)) {
+            snprintf(line + length, sizeof(line) - length, ", %zu nodes", r.structureNodes);
+        }
+    } else if (r.hasLatency) {
+        snprintf(line, sizeof(line), "%-30s %6s %10zu %11.1f %9.2f %9.0f %9.0f %9.0f %9.0f %10.0f",
+                 r.name.c_str(), formatSize(r.vocab).c_str(), r.ops, r.nsPerOp, r.allocsPerOp,
+                 r.bytesPerOp, r.p50, r.p99, r.p999, r.max);
+    } else {
+        snprintf(line, sizeof(line), "%-30s %6s %10zu %11.1f %9.2f %9.0f %9s %9s %9s %10s",
+                 r.name.c_str(), formatSize(r.vocab).c_str(), r.ops, r.nsPerOp, r.allocsPerOp,
+                 r.bytesPerOp, "-", "-", "-", "-");
+    }
+    std::cout << line << std::endl;
+}
+
+static void writeCsv(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream out(path);
+    out << "benchmark,vocab,ops,ns_per_op,allocs_per_op,bytes_per_op,p50_ns,p90_ns,p99_ns,p999_ns,max_ns,"
+           "items,live_bytes_per_item,reported_bytes_per_item,nodes\n";
+    for (const auto& r : results) {
+        out << r.name << ',' << r.vocab << ',' << r.ops << ',' << r.nsPerOp << ','
+            << r.allocsPerOp << ',' << r.bytesPerOp;
+        if (r.hasLatency) {
+            out << ',' << r.p50 << ',' << r.p90 << ',' << r.p99 << ',' << r.p999 << ',' << r.max;
+        } else {
+            out << ",,,,,";
+        }
+        if (r.isMemory) {
+            out << ',' << r.items << ',' << r.liveBytesPerItem << ',' << r.reportedBytesPerItem << ','
+                << r.structureNodes;
+        } else {
+            out << ",,,,";
+        }
+        out << '\n';
+    }
+}
+
+static void writeJson(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream out(path);
+    out << "{\"compiler\":\"" << __VERSION__ << "\",\"clock_overhead_ns\":" << clockOverheadNs
+        << ",\"results\":[";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << (i ? ",\n" : "\n") << "{\"benchmark\":\"" << r.name << "\",\"vocab\":" << r.vocab
+            << ",\"ops\":" << r.ops << ",\"ns_per_op\":" << r.nsPerOp
+            << ",\"allocs_per_op\":" << r.allocsPerOp << ",\"bytes_per_op\":" << r.bytesPerOp;
+        if (r.isMemory) {
+            out << ",\"items\":" << r.items << ",\"live_bytes_per_item\":" << r.liveBytesPerItem
+                << ",\"reported_bytes_per_item\":" << r.reportedBytesPerItem;
+            if (r.structureNodes > 0) out << ",\"nodes\":" << r.structureNodes;
+        }
+        if (r.hasLatency) {
+            out << ",\"p50_ns\":" << r.p50 << ",\"p90_ns\":" << r.p90 << ",\"p99_ns\":" << r.p99
+                << ",\"p999_ns\":" << r.p999 << ",\"max_ns\":" << r.max;
+        }
+        out << '}';
+    }
+    out << "\n]}\n";
+}
+
+// ---------------------------------------------------------------------------
+
+class Suite {
+private:
+    const Options& opt;
+    std::vector<Result>& results;
+
+    bool enabled(const std::string& name) const {
+        return opt.filter.empty() || name.find(opt.filter) != std::string::npos;
+    }
+
+    void add(const Result& r) {
+        printResult(r);
+        results.push_back(r);
+    }
+
+    // Build a structure and record its heap per item, measured and reported
+    template <typename Build, typename Report>
+    void addMemory(const std::string& name, size_t vocab, Build&& build, Report&& report,
+                   std::function<size_t()> countNodes = nullptr) {
+        size_t live0 = liveBytes;
+        build();
+        size_t live = liveBytes - live0;
+        MemoryUsage usage = report();
+
+        Result r;
+        r.name = name;
+        r.vocab = vocab;
+        r.isMemory = true;
+        r.items = usage.items;
+        r.liveBytesPerItem = usage.items ? (double)live / usage.items : 0;
+        r.reportedBytesPerItem = usage.bytesPerItem();
+        if (countNodes) r.structureNodes = countNodes();
+        add(r);
+    }
+
+    // insert, prefixSearch and search rows for a structure with the TST's interface
+    template <typename Tree>
+    void compareTree(const std::string& name, const std::vector<std::string>& vocab,
+                     const std::vector<std::string>& prefixes, const std::vector<size_t>& lookups) {
+        size_t n = vocab.size();
+        Tree tree;
+        add(measure(name + "_insert", n, n,
+                    [&](size_t i) { tree.insert(vocab[i]); },
+                    [&] { tree.clear(); }));
+        // Fold in anything the inserts left pending, as after a bulk load
+        tree.compactIfFragmented(0.0);
+        std::vector<std::string> found;
+        add(measure(name + "_prefix_search", n, std::min<size_t>(prefixes.size(), 2000),
+                    [&](size_t i) { found = tree.prefixSearch(prefixes[i], CANDIDATES); }));
+        add(measure(name + "_search", n, lookups.size(), [&](size_t i) {
+            bool hit = tree.search(vocab[lookups[i]]);
+            (void)hit;
+        }));
+    }
+
+public:
+    Suite(const Options& opt, std::vector<Result>& results) : opt(opt), results(results) {}
+
+    void run(size_t n) {
+        std::mt19937 rng(opt.seed);
+        run(makeVocabulary(n, rng), rng);
+    }
+
+    // A real vocabulary, e.g. the identifiers of a source tree
+    void runCorpus(std::vector<std::string> vocab) {
+        std::mt19937 rng(opt.seed);
+        std::shuffle(vocab.begin(), vocab.end(), rng);
+        run(vocab, rng);
+    }
+
+    void run(const std::vector<std::string>& vocab, std::mt19937& rng) {
+        size_t n = vocab.size();
+        size_t queryCount = std::min<size_t>(n, 20000);
+        std::vector<std::string> prefixes = makePrefixes(vocab, queryCount, rng);
+        std::uniform_int_distribution<size_t> pickWord(0, n - 1);
+
+        // Every later benchmark reads the tree, so it is always built
+        TST tst;
+        if (enabled("tst_insert")) {
+            add(measure("tst_insert", n, n,
+                        [&](size_t i) { tst.insert(vocab[i]); },
+                        [&] { tst = TST(); }));
+        } else {
+            for (const auto& w : vocab) tst.insert(w);
+        }
+
+        if (enabled("tst_prefix_search")) {
+            // Collects the whole subtree under the prefix, so fewer ops
+            std::vector<std::string> found;
+            add(measure("tst_prefix_search", n, std::min<size_t>(queryCount, 2000),
+                        [&](size_t i) { found = tst.prefixSearch(prefixes[i], CANDIDATES); }));
+        }
+
+        // Exact lookups of words in the tree
+        std::vector<size_t> lookups(queryCount);
+        for (auto& l : lookups) l = pickWord(rng);
+        if (enabled("tst_search")) {
+            add(measure("tst_search", n, queryCount, [&](size_t i) {
+                bool hit = tst.search(vocab[lookups[i]]);
+                (void)hit;
+            }));
+        }
+
+        // The path-compressed and adaptive radix trees and the sorted array
+        // on the same words, prefixes and lookups. Their prefixSearch stops after k words
+        // instead of collecting the whole subtree and truncating, so they
+        // run the same op count.
+        if (enabled("radix")) {
+            compareTree<RadixTST>("radix", vocab, prefixes, lookups);
+        }
+        if (enabled("art")) {
+            compareTree<AdaptiveRadixTree>("art", vocab, prefixes, lookups);
+        }
+        if (enabled("sorted")) {
+            compareTree<SortedDictionary>("sorted", vocab, prefixes, lookups);
+
+            // The k heaviest words of each prefix range instead of the first k
+            std::unordered_map<std::string, int> freq;
+            std::uniform_int_distribution<int> pickFreq(0, 999);
+            for (const auto& w : vocab) freq[w] = pickFreq(rng);
+            SortedDictionary sorted;
+            for (const auto& w : vocab) sorted.insert(w);
+            sorted.compact();
+            sorted.setWeights([&](const std::string& w) {
+                auto it = freq.find(w);
+                return it == freq.end() ? 0 : it->second;
+            });
+            std::vector<std::string> found;
+            add(measure("sorted_top_k", n, std::min<size_t>(prefixes.size(), 2000),
+                        [&](size_t i) { found = sorted.prefixSearch(prefixes[i], CANDIDATES); }));
+        }
+
+        // The same candidates prefixSearch returns (the first words in
+        // sorted order), taken from a sorted copy so they are cheap to build
+        std::vector<std::vector<std::string>> candidates(queryCount);
+        {
+            std::vector<std::string> sorted = vocab;
+            std::sort(sorted.begin(), sorted.end());
+            for (size_t i = 0; i < queryCount; i++) {
+                auto it = std::lower_bound(sorted.begin(), sorted.end(), prefixes[i]);
+                for (; it != sorted.end() && (int)candidates[i].size() < CANDIDATES &&
+                       it->compare(0, prefixes[i].size(), prefixes[i]) == 0; ++it) {
+                    candidates[i].push_back(*it);
+                }
+            }
+        }
+
+        std::string freqPath = "/tmp/microbench_freq_" + std::to_string(getpid()) + ".txt";
+        std::string phrasePath = "/tmp/microbench_phrases_" + std::to_string(getpid()) + ".txt";
+        unlink(freqPath.c_str());
+        unlink(phrasePath.c_str());
+
+        FreqStore freq(freqPath);
+        freq.setAutoSave(false);
+        {
+            std::unordered_map<std::string, int> counts;
+            std::uniform_int_distribution<int> count(1, 1000);
+            for (const auto& w : vocab) counts[w] = count(rng);
+            freq.bumpBatch(counts);
+        }
+
+        if (enabled("ranker_rank")) {
+            CooccurrenceGraph graph;
+            for (size_t i = 0; i + 1 < std::min<size_t>(n, 200000); i++) {
+                graph.addEdge(vocab[i], vocab[pickWord(rng)]);
+            }
+            Ranker ranker(&freq, &graph);
+            add(measure("ranker_rank", n, queryCount, [&](size_t i) {
+                ranker.setLastToken(vocab[i]);
+                auto ranked = ranker.rankResults(candidates[i], K);
+                (void)ranked;
+            }));
+        }
+
+        if (enabled("lru_put")) {
+            lru_cache cache(CACHE_CAPACITY);
+            add(measure("lru_put", n, queryCount,
+                        [&](size_t i) { cache.put(prefixes[i], candidates[i]); },
+                        [&] { cache.clear(); }));
+        }
+
+        if (enabled("lru_get")) {
+            // Keys cycle through twice the capacity, so about half the gets hit
+            lru_cache cache(CACHE_CAPACITY);
+            size_t keys = std::min<size_t>(queryCount, CACHE_CAPACITY * 2);
+            for (size_t i = 0; i < keys; i++) cache.put(prefixes[i], candidates[i]);
+            std::uniform_int_distribution<size_t> pickKey(0, keys - 1);
+            std::vector<size_t> order(queryCount);
+            for (auto& o : order) o = pickKey(rng);
+            add(measure("lru_get", n, queryCount, [&](size_t i) {
+                auto hit = cache.get(prefixes[order[i]]);
+                (void)hit;
+            }));
+        }
+
+        if (enabled("minheap_insert")) {
+            std::vector<double> scores(n);
+            std::uniform_real_distribution<double> score(0, 1000);
+            for (auto& s : scores) s = score(rng);
+            MinHeap heap(K);
+            add(measure("minheap_insert", n, n,
+                        [&](size_t i) { heap.insert(scores[i], vocab[i]); },
+                        [&] { heap.clear(); }));
+        }
+
+        if (enabled("kmp_find_all")) {
+            // Search 64 KB of joined source-like text per op
+            std::string text;
+            for (size_t i = 0; text.size() < (1 << 16); i++) {
+                text += vocab[i % n];
+                text += (i % 8 == 7) ? ";\n" : " ";
+            }
+            size_t ops = std::min<size_t>(n, 2000);
+            add(measure("kmp_find_all_64k", n, ops, [&](size_t i) {
+                auto hits = KMP::findAll(text, vocab[(i * 7919) % n]);
+                (void)hits;
+            }));
+        }
+
+        if (enabled("kmp_compiled")) {
+            // The KMP class against a CompiledPattern per kernel, at several
+            // pattern lengths; patterns are cut from the text so they match
+            std::string text;
+            for (size_t i = 0; text.size() < (1 << 16); i++) {
+                text += vocab[i % n];
+                text += (i % 8 == 7) ? ";\n" : " ";
+            }
+            const size_t PATTERNS = 64;
+            std::uniform_int_distribution<size_t> pickStart(0, text.size() - 64);
+            std::vector<size_t> starts(PATTERNS);
+            for (auto& s : starts) s = pickStart(rng);
+
+            for (size_t m : {2, 4, 8, 16, 32}) {
+                std::vector<std::string> patterns;
+                for (size_t s : starts) patterns.push_back(text.substr(s, m));
+                std::string suffix = "_64k_m" + std::to_string(m);
+
+                add(measure("kmp_find_all" + suffix, n, 2000, [&](size_t i) {
+                    auto hits = KMP::findAll(text, patterns[i % PATTERNS]);
+                    (void)hits;
+                }));
+                for (auto kernel : {CompiledPattern::SCALAR, CompiledPattern::SSE2, CompiledPattern::AVX2}) {
+                    if (kernel > CompiledPattern::bestKernel()) continue;
+                    std::vector<CompiledPattern> compiled;
+                    for (const auto& p : patterns) compiled.emplace_back(p, kernel);
+                    add(measure(std::string("kmp_compiled_") + CompiledPattern::kernelName(kernel) + suffix, n, 2000,
+                                [&](size_t i) {
+                                    auto hits = compiled[i % PATTERNS].findAll(text);
+                                    (void)hits;
+                                }));
+                }
+            }
+
+            // Substring fallback: one pattern tested against every word
+            size_t words = std::min<size_t>(n, 100000);
+            size_t ops = std::max<size_t>(1, 20000000 / (words * 8));
+            add(measure("kmp_contains_vocab", n, ops, [&](size_t i) {
+                const std::string& pattern = prefixes[i % queryCount];
+                size_t hits = 0;
+                for (size_t w = 0; w < words; w++) hits += KMP::contains(vocab[w], pattern);
+                (void)hits;
+            }));
+            add(measure("kmp_compiled_contains_vocab", n, ops, [&](size_t i) {
+                CompiledPattern pattern(prefixes[i % queryCount]);
+                size_t hits = 0;
+                for (size_t w = 0; w < words; w++) hits += pattern.contains(vocab[w]);
+                (void)hits;
+            }));
+        }
+
+        if (enabled("substring_keystroke")) {
+            // Type 8 characters of a word's middle one at a time; each op is
+            // one keystroke's substring matches, rescanned or narrowed
+            std::vector<std::string> typed;
+            for (size_t i = 0; typed.size() < 200; i++) {
+                const std::string& word = vocab[(i * 7919) % n];
+                if (word.size() < 10) continue;
+                std::string query = word.substr(1, 8);
+                for (size_t len = 1; len <= query.size(); len++) typed.push_back(query.substr(0, len));
+            }
+            add(measure("substring_keystroke_rescan", n, typed.size(), [&](size_t i) {
+                CompiledPattern pattern(typed[i]);
+                size_t hits = 0;
+                for (const auto& word : vocab) hits += pattern.contains(word);
+                (void)hits;
+            }));
+            SubstringSession session(&vocab);
+            add(measure("substring_keystroke_narrow", n, typed.size(),
+                        [&](size_t i) { session.update(typed[i]); },
+                        [&] { session.reset(&vocab); }));
+        }
+
+        if (enabled("journal_record")) {
+            // One typed character per op; the writer thread writes and
+            // fdatasyncs in the background, so this is the keystroke's share
+            std::string journalPath = "/tmp/microbench_journal_" + std::to_string(getpid()) + ".scaj";
+            EditJournal journal;
+            std::string error;
+            JournalHeader header;
+            header.document = "microbench.cpp";
+            if (journal.open(journalPath, header, false, error)) {
+                add(measure("journal_record", n, 20000, [&](size_t i) { journal.insert(i, "x"); }));
+                journal.close(true);
+            }
+        }
+
+        if (enabled("fuzzy_search")) {
+            // Whole-vocabulary scans for a word with one substituted letter
+            FuzzyIndex fuzzy;
+            fuzzy.build(vocab);
+            std::vector<std::string> typos;
+            for (size_t i = 0; i < 64; i++) {
+                std::string word = vocab[(i * 7919) % n];
+                word[word.size() / 2] = word[word.size() / 2] == 'x' ? 'y' : 'x';
+                typos.push_back(word);
+            }
+            std::vector<unsigned> threadCounts = {1};
+            unsigned cores = std::thread::hardware_concurrency();
+            if (cores > 1) threadCounts.push_back(cores);
+            size_t ops = std::max<size_t>(4, 20000000 / (n * 8));
+            for (int errors : {1, 2}) {
+                for (unsigned threads : threadCounts) {
+                    std::string name = "fuzzy_search_k" + std::to_string(errors) + "_t" + std::to_string(threads);
+                    add(measure(name, n, ops, [&](size_t i) {
+                        auto matches = fuzzy.search(typos[i % typos.size()], errors, 10, threads);
+                        (void)matches;
+                    }));
+                }
+            }
+        }
+
+        if (enabled("freq_bump")) {
+            std::vector<size_t> order(std::min<size_t>(n, 1000000));
+            for (auto& o : order) o = pickWord(rng);
+            add(measure("freq_bump", n, order.size(), [&](size_t i) { freq.bump(vocab[order[i]]); }));
+        }
+
+        if (enabled("freq_load")) {
+            // One op is one token; the file is parsed line by line
+            freq.save();
+            auto t0 = Clock::now();
+            size_t allocs0 = allocCount, bytes0 = allocBytes;
+            {
+                FreqStore loaded(freqPath);
+                loaded.setAutoSave(false);
+            }
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            Result r;
+            r.name = "freq_load";
+            r.vocab = n;
+            r.ops = n;
+            r.nsPerOp = ns / n;
+            r.allocsPerOp = (double)(allocCount - allocs0) / n;
+            r.bytesPerOp = (double)(allocBytes - bytes0) / n;
+            add(r);
+        }
+
+        if (enabled("phrase_top")) {
+            // A tenth of the vocabulary triggers 1-8 learned snippets each
+            PhraseStore phrases(phrasePath);
+            size_t triggers = std::max<size_t>(1, std::min<size_t>(n / 10, 100000));
+            std::uniform_int_distribution<int> snippetCount(1, 8);
+            for (size_t i = 0; i < triggers; i++) {
+                int count = snippetCount(rng);
+                for (int s = 0; s < count; s++) {
+                    std::string snippet = vocab[i] + "(" + vocab[pickWord(rng)] + ");";
+                    for (int uses = s; uses >= 0; uses--) phrases.addPhrase(vocab[i], snippet);
+                }
+            }
+            std::uniform_int_distribution<size_t> pickTrigger(0, triggers - 1);
+            std::vector<size_t> order(queryCount);
+            for (auto& o : order) o = pickTrigger(rng);
+            add(measure("phrase_top", n, queryCount, [&](size_t i) {
+                auto top = phrases.getTopPhrases(vocab[order[i]], 3);
+                (void)top;
+            }));
+        }
+
+        if (enabled("mem")) {
+            {
+                TST built;
+                addMemory("mem_tst", n, [&] { for (const auto& w : vocab) built.insert(w); },
+                          [&] { return built.memoryUsage(); }, [&] { return built.nodeCount(); });
+            }
+            {
+                RadixTST built;
+                addMemory("mem_radix_tst", n, [&] { for (const auto& w : vocab) built.insert(w); },
+                          [&] { return built.memoryUsage(); }, [&] { return built.nodeCount(); });
+            }
+            {
+                AdaptiveRadixTree built;
+                addMemory("mem_art", n, [&] { for (const auto& w : vocab) built.insert(w); },
+                          [&] { return built.memoryUsage(); }, [&] { return built.nodeCount(); });
+            }
+            {
+                SortedDictionary built;
+                addMemory("mem_sorted", n,
+                          [&] {
+                              for (const auto& w : vocab) built.insert(w);
+                              built.compact();
+                          },
+                          [&] { return built.memoryUsage(); });
+            }
+            {
+                std::unordered_map<std::string, int> counts;
+                for (const auto& w : vocab) counts[w] = 1;
+                std::unique_ptr<FreqStore> built;
+                addMemory("mem_freq_store", n,
+                          [&] {
+                              built.reset(new FreqStore(freqPath));
+                              built->setAutoSave(false);
+                              built->bumpBatch(counts);
+                          },
+                          [&] { return built->memoryUsage(); });
+            }
+            {
+                CooccurrenceGraph built;
+                addMemory("mem_graph", n,
+                          [&] { for (size_t i = 0; i + 1 < n; i++) built.addEdge(vocab[i], vocab[i + 1]); },
+                          [&] { return built.memoryUsage(); });
+            }
+            {
+                std::unique_ptr<PhraseStore> built;
+                addMemory("mem_phrase_store", n,
+                          [&] {
+                              built.reset(new PhraseStore(phrasePath));
+                              for (size_t i = 0; i < std::min<size_t>(n, 100000); i++) {
+                                  built->addPhrase(vocab[i], vocab[i] + "(" + vocab[(i * 7) % n] + ");");
+                              }
+                          },
+                          [&] { return built->memoryUsage(); });
+            }
+            {
+                lru_cache built(CACHE_CAPACITY);
+                addMemory("mem_lru_cache", n,
+                          [&] { for (size_t i = 0; i < queryCount; i++) built.put(prefixes[i], candidates[i]); },
+                          [&] { return built.memoryUsage(); });
+            }
+        }
+
+        unlink(freqPath.c_str());
+        unlink(phrasePath.c_str());
+    }
+};
+
+int main(int argc, char** argv) {
+    Options opt;
+    bool huge = false;
+    bool sizesGiven = false;
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (flag == "--huge") {
+            huge = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (flag == "--sizes") {
+            sizesGiven = true;
+            opt.sizes.clear();
+            size_t start = 0;
+            while (start <= value.size()) {
+                size_t comma = value.find(',', start);
+                if (comma == std::string::npos) comma = value.size();
+                size_t n;
+                if (!parseSize(value.substr(start, comma - start), n)) {
+                    std::cerr << "Bad size in " << value << std::endl;
+                    return 1;
+                }
+                opt.sizes.push_back(n);
+                start = comma + 1;
+            }
+        } else if (flag == "--filter") opt.filter = value;
+        else if (flag == "--csv") opt.csvPath = value;
+        else if (flag == "--json") opt.jsonPath = value;
+        else if (flag == "--corpus") opt.corpus = value;
+        else if (flag == "--seed") opt.seed = (unsigned)atoi(value.c_str());
+        else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+    if (huge) {
+        opt.sizes.push_back(10000000);
+    }
+
+    std::vector<std::string> corpus;
+    if (!opt.corpus.empty()) {
+        TokenCounts counts;
+        IndexStats stats = ProjectIndexer().scanTree(opt.corpus, counts);
+        corpus = counts.names;
+        if (corpus.empty()) {
+            std::cerr << "No identifiers found under " << opt.corpus << std::endl;
+            return 1;
+        }
+        std::cout << "corpus " << opt.corpus << ": " << stats.files << " files, " << corpus.size()
+                  << " distinct identifiers" << std::endl;
+        if (!sizesGiven) opt.sizes.clear();
+    }
+
+    calibrateClock();
+    std::cout << "clock overhead " << clockOverheadNs << " ns (subtracted from latencies)" << std::endl;
+
+    char header[256];
+    snprintf(header, sizeof(header), "%-30s %6s %10s %11s %9s %9s %9s %9s %9s %10s",
+             "benchmark", "vocab", "ops", "ns/op", "allocs/op", "bytes/op", "p50 ns", "p99 ns",
+             "p99.9 ns", "max ns");
+    std::cout << header << std::endl;
+
+    std::vector<Result> results;
+    Suite suite(opt, results);
+    for (size_t n : opt.sizes) {
+        suite.run(n);
+    }
+    if (!corpus.empty()) {
+        suite.runCorpus(std::move(corpus));
+    }
+
+    if (!opt.csvPath.empty()) {
+        writeCsv(opt.csvPath, results);
+        std::cout << "wrote " << opt.csvPath << std::endl;
+    }
+    if (!opt.jsonPath.empty()) {
+        writeJson(opt.jsonPath, results);
+        std::cout << "wrote " << opt.jsonPath << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,377 @@
+// End-to-end keystroke replay against AutocompleteEngine
+// Build: make replay
+// Usage: ./replay [--trace file | --synth words] [--save-trace file] [--index dir]
+//                 [--dictionary tst|radix|art|sorted] [--substring] [--seed n]
+//                 [--csv file] [--json file] [--gate-p99-us us]
+//
+// Drives the engine the way the REPL does: every keystroke that leaves a
+// word being typed asks for getSuggestions(word, 5) and getPhraseSuggestions(word),
+// and accepting a token calls acceptSuggestion. Latency is recorded per
+// keystroke and per engine stage in HDR-style histograms. With
+// --gate-p99-us the exit status is 2 when keystroke p99 exceeds the limit,
+// so the replay can gate engine changes.
+//
+// Trace format, one event per line ('#' starts a comment):
+//   t <text>     type text one key at a time; letters, digits and '_' extend
+//                the current word, anything else ends it
+//   b <n>        press backspace n times
+//   a <token>    accept token in place of the word being typed
+//
+// Run from the repository root so the engine finds data/. Frequencies
+// learned from accepts are not saved.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "engine.h"
+#include "histogram.h"
+#include "indexer.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string tracePath;
+    std::string saveTracePath;
+    std::string indexRoot;
+    std::string dictionary = DICTIONARY_DEFAULT;
+    std::string csvPath;
+    std::string jsonPath;
+    size_t synthWords = 20000;
+    bool substring = false;
+    unsigned seed = 42;
+    double gateP99Us = 0;
+};
+
+struct Event {
+    char type;          // 't', 'b' or 'a'
+    std::string text;   // typed text or accepted token
+    int count = 0;      // backspaces
+};
+
+struct Stage {
+    const char* name;
+    LatencyHistogram histogram;
+};
+
+enum StageId { KEYSTROKE, SUGGEST, CACHE, PREFIX, SUBSTRING, RANK, FILL, PHRASES, ACCEPT, STAGE_COUNT };
+
+static bool isWordChar(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+static uint64_t elapsedNs(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+static bool loadTrace(const std::string& path, std::vector<Event>& events) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.size() < 3 || line[0] == '#' || line[1] != ' ') continue;
+
+        Event e;
+        e.type = line[0];
+        e.text = line.substr(2);
+        if (e.type == 'b') {
+            e.count = atoi(e.text.c_str());
+        } else if (e.type != 't' && e.type != 'a') {
+            continue;
+        }
+        events.push_back(e);
+    }
+    return true;
+}
+
+static void saveTrace(const std::string& path, const std::vector<Event>& events) {
+    std::ofstream out(path);
+    for (const auto& e : events) {
+        if (e.type == 'b') {
+            out << "b " << e.count << '\n';
+        } else {
+            out << e.type << ' ' << e.text << '\n';
+        }
+    }
+}
+
+// A typing session over vocab, with words drawn in proportion to weight:
+// most words are accepted after a few keys, the rest typed out in full,
+// and an occasional typo is fixed with backspace
+static std::vector<Event> synthesize(const std::vector<std::string>& vocab,
+                                     const std::vector<double>& weights, size_t words, unsigned seed) {
+    static const char* const SEPARATORS[] = {" ", " ", " ", "(", ")", ".", ", ", "; ", "->", "::"};
+    std::mt19937 rng(seed);
+    std::discrete_distribution<size_t> pickWord(weights.begin(), weights.end());
+    std::uniform_real_distribution<double> chance(0, 1);
+    std::uniform_int_distribution<size_t> pickSeparator(0, sizeof(SEPARATORS) / sizeof(SEPARATORS[0]) - 1);
+
+    std::vector<Event> events;
+    for (size_t w = 0; w < words; w++) {
+        const std::string& word = vocab[pickWord(rng)];
+        size_t typed = std::min(word.size(), std::uniform_int_distribution<size_t>(1, 6)(rng));
+
+        if (chance(rng) < 0.05 && typed > 1) {
+            events.push_back({'t', word.substr(0, typed - 1) + "q"});
+            events.push_back({'b', "", 1});
+            events.push_back({'t', word.substr(typed - 1, 1)});
+        } else {
+            events.push_back({'t', word.substr(0, typed)});
+        }
+
+        if (chance(rng) < 0.7) {
+            events.push_back({'a', word});
+        } else if (typed < word.size()) {
+            events.push_back({'t', word.substr(typed)});
+        }
+        events.push_back({'t', SEPARATORS[pickSeparator(rng)]});
+    }
+    return events;
+}
+
+static void writeCsv(const std::string& path, const std::vector<Stage>& stages) {
+    std::ofstream out(path);
+    out << "stage,count,mean_ns,p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n";
+    for (const auto& s : stages) {
+        const LatencyHistogram& h = s.histogram;
+        out << s.name << ',' << h.count() << ',' << h.mean() << ',' << h.percentile(50) << ','
+            << h.percentile(90) << ',' << h.percentile(99) << ',' << h.percentile(99.9) << ','
+            << h.max() << '\n';
+    }
+}
+
+static void writeJson(const std::string& path, const std::vector<Stage>& stages,
+                      size_t events, size_t hits, double seconds) {
+    std::ofstream out(path);
+    const LatencyHistogram& suggest = stages[SUGGEST].histogram;
+    out << "{\"events\":" << events << ",\"seconds\":" << seconds
+        << ",\"cache_hit_rate\":" << (suggest.count() ? (double)hits / suggest.count() : 0.0)
+        << ",\"stages\":[";
+    for (size_t i = 0; i < stages.size(); i++) {
+        const LatencyHistogram& h = stages[i].histogram;
+        out << (i ? ",\n" : "\n") << "{\"stage\":\"" << stages[i].name << "\",\"count\":" << h.count()
+            << ",\"mean_ns\":" << h.mean() << ",\"p50_ns\":" << h.percentile(50)
+            << ",\"p90_ns\":" << h.percentile(90) << ",\"p99_ns\":" << h.percentile(99)
+            << ",\"p999_ns\":" << h.percentile(99.9) << ",\"max_ns\":" << h.max() << '}';
+    }
+    out << "\n]}\n";
+}
+
+// Percentile distribution in the HdrHistogram layout
+static void printDistribution(const LatencyHistogram& h) {
+    static const double PERCENTILES[] = {0, 50, 75, 90, 95, 99, 99.5, 99.9, 99.95, 99.99, 100};
+    std::cout << "\n       Value(us)   Percentile   TotalCount   1/(1-Percentile)" << std::endl;
+    for (double p : PERCENTILES) {
+        uint64_t value = h.percentile(p);
+        uint64_t below = 0;
+        for (size_t i = 0; i < LatencyHistogram::BUCKETS && LatencyHistogram::bucketLow(i) <= value; i++) {
+            below += h.bucketCount(i);
+        }
+        char line[128];
+        if (p < 100) {
+            snprintf(line, sizeof(line), "%16.3f %12.6f %12llu %18.2f", value / 1000.0, p / 100.0,
+                     (unsigned long long)below, 1.0 / (1.0 - p / 100.0));
+        } else {
+            snprintf(line, sizeof(line), "%16.3f %12.6f %12llu %18s", value / 1000.0, 1.0,
+                     (unsigned long long)below, "inf");
+        }
+        std::cout << line << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (flag == "--substring") {
+            opt.substring = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (flag == "--trace") opt.tracePath = value;
+        else if (flag == "--synth") opt.synthWords = std::max(1L, atol(value.c_str()));
+        else if (flag == "--save-trace") opt.saveTracePath = value;
+        else if (flag == "--index") opt.indexRoot = value;
+        else if (flag == "--dictionary") opt.dictionary = value;
+        else if (flag == "--seed") opt.seed = (unsigned)atoi(value.c_str());
+        else if (flag == "--csv") opt.csvPath = value;
+        else if (flag == "--json") opt.jsonPath = value;
+        else if (flag == "--gate-p99-us") opt.gateP99Us = atof(value.c_str());
+        else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    if (!Dictionary::create(opt.dictionary)) {
+        std::cerr << "Unknown dictionary " << opt.dictionary << std::endl;
+        return 1;
+    }
+    AutocompleteEngine engine(opt.dictionary);
+    engine.setAutoSave(false);
+    if (opt.substring) {
+        engine.toggleSubstringSearch();
+    }
+
+    // The synthetic session types the seed words, plus a project's tokens
+    // weighted by how often they occur there
+    std::vector<std::string> vocab;
+    std::vector<double> weights;
+    {
+        std::ifstream seeds("data/words.txt");
+        std::string word;
+        while (seeds >> word) {
+            vocab.push_back(word);
+            weights.push_back(1.0 / vocab.size());
+        }
+    }
+    if (!opt.indexRoot.empty()) {
+        IndexStats stats = engine.indexProject(opt.indexRoot);
+        TokenCounts counts;
+        ProjectIndexer().scanTree(opt.indexRoot, counts);
+        for (size_t id = 0; id < counts.names.size(); id++) {
+            vocab.push_back(counts.names[id]);
+            weights.push_back(counts.counts[id]);
+        }
+        std::cout << "indexed " << stats.files << " files, " << stats.uniqueTokens << " tokens" << std::endl;
+    }
+
+    std::vector<Event> events;
+    if (!opt.tracePath.empty()) {
+        if (!loadTrace(opt.tracePath, events)) {
+            std::cerr << "Cannot read " << opt.tracePath << std::endl;
+            return 1;
+        }
+    } else {
+        if (vocab.empty()) {
+            std::cerr << "No vocabulary to synthesize a trace from" << std::endl;
+            return 1;
+        }
+        events = synthesize(vocab, weights, opt.synthWords, opt.seed);
+    }
+    if (!opt.saveTracePath.empty()) {
+        saveTrace(opt.saveTracePath, events);
+    }
+
+    std::vector<Stage> stages = {
+        {"keystroke", {}}, {"suggest", {}}, {"cache", {}}, {"prefix", {}}, {"substring", {}},
+        {"rank", {}}, {"fill", {}}, {"phrases", {}}, {"accept", {}}
+    };
+    QueryStages trace;
+    engine.setStageTrace(&trace);
+
+    std::string line;       // text typed so far; the current word is its tail
+    size_t wordStart = 0;
+    size_t hits = 0;
+
+    auto query = [&]() {
+        std::string word = line.substr(wordStart);
+        auto keyStart = Clock::now();
+        auto suggestions = engine.getSuggestions(word, 5);
+        uint64_t suggestNs = elapsedNs(keyStart);
+        auto phraseStart = Clock::now();
+        auto phrases = engine.getPhraseSuggestions(word);
+        uint64_t phraseNs = elapsedNs(phraseStart);
+
+        stages[KEYSTROKE].histogram.record(suggestNs + phraseNs);
+        stages[SUGGEST].histogram.record(suggestNs);
+        stages[PHRASES].histogram.record(phraseNs);
+        stages[CACHE].histogram.record(trace.cacheNs);
+        if (trace.cacheHit) {
+            hits++;
+            return;
+        }
+        stages[PREFIX].histogram.record(trace.prefixNs);
+        if (trace.substringNs > 0) stages[SUBSTRING].histogram.record(trace.substringNs);
+        stages[RANK].histogram.record(trace.rankNs);
+        stages[FILL].histogram.record(trace.fillNs);
+    };
+
+    auto findWordStart = [&]() {
+        wordStart = line.size();
+        while (wordStart > 0 && isWordChar(line[wordStart - 1])) wordStart--;
+    };
+
+    auto start = Clock::now();
+    for (const auto& e : events) {
+        if (e.type == 't') {
+            for (char c : e.text) {
+                line += c;
+                if (!isWordChar(c)) {
+                    wordStart = line.size();
+                    continue;
+                }
+                query();
+            }
+        } else if (e.type == 'b') {
+            for (int i = 0; i < e.count && !line.empty(); i++) {
+                line.pop_back();
+                findWordStart();
+                if (wordStart < line.size()) query();
+            }
+        } else {
+            line.erase(wordStart);
+            line += e.text;
+            wordStart = line.size();
+            auto acceptStart = Clock::now();
+            engine.acceptSuggestion(e.text);
+            stages[ACCEPT].histogram.record(elapsedNs(acceptStart));
+        }
+
+        // Keep the line short; only the current word matters
+        if (line.size() > 4096) {
+            line.erase(0, wordStart);
+            wordStart = 0;
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    engine.setStageTrace(nullptr);
+
+    const LatencyHistogram& keys = stages[KEYSTROKE].histogram;
+    std::cout << "dictionary   " << engine.dictionaryName() << std::endl;
+    std::cout << "events       " << events.size() << " (" << keys.count() << " keystroke queries, "
+              << stages[ACCEPT].histogram.count() << " accepts)" << std::endl;
+    std::cout << "elapsed      " << seconds << " s" << std::endl;
+    std::cout << "cache hits   "
+              << (keys.count() ? 100.0 * hits / keys.count() : 0.0) << "%" << std::endl;
+
+    std::cout << "\nstage            count    mean us     p50 us     p90 us     p99 us   p99.9 us     max us" << std::endl;
+    for (const auto& s : stages) {
+        const LatencyHistogram& h = s.histogram;
+        char row[160];
+        snprintf(row, sizeof(row), "%-10s %11llu %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f", s.name,
+                 (unsigned long long)h.count(), h.mean() / 1000.0, h.percentile(50) / 1000.0,
+                 h.percentile(90) / 1000.0, h.percentile(99) / 1000.0, h.percentile(99.9) / 1000.0,
+                 h.max() / 1000.0);
+        std::cout << row << std::endl;
+    }
+    printDistribution(keys);
+
+    if (!opt.csvPath.empty()) {
+        writeCsv(opt.csvPath, stages);
+    }
+    if (!opt.jsonPath.empty()) {
+        writeJson(opt.jsonPath, stages, events.size(), hits, seconds);
+    }
+
+    if (opt.gateP99Us > 0 && keys.percentile(99) / 1000.0 > opt.gateP99Us) {
+        std::cerr << "FAIL: keystroke p99 " << keys.percentile(99) / 1000.0 << " us exceeds "
+                  << opt.gateP99Us << " us" << std::endl;
+        return 2;
+    }
+    return 0;
+}
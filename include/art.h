@@ -0,0 +1,131 @@
+#ifndef ART_H
+#define ART_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "memory_usage.h"
+
+struct ArtLeaf {
+    std::string word;
+};
+
+// Header shared by the four inner node sizes
+struct ArtNode {
+    static const size_t MAX_PREFIX = 10;
+    enum Type : uint8_t { NODE4, NODE16, NODE48, NODE256 };
+
+    Type type;
+    uint16_t count;             // children in use
+    // Bytes every key below shares after the parent's branch byte. Only the
+    // first MAX_PREFIX are stored; the rest are read from any leaf below.
+    uint32_t prefixLength;
+    char prefix[MAX_PREFIX];
+    ArtLeaf* end;               // the word that ends right after the prefix
+
+    explicit ArtNode(Type type) : type(type), count(0), prefixLength(0), prefix(), end(nullptr) {}
+};
+
+// Children are tagged pointers: the low bit marks an ArtLeaf
+struct ArtNode4 : ArtNode {
+    unsigned char keys[4];      // sorted
+    void* children[4];
+    ArtNode4() : ArtNode(NODE4), keys(), children() {}
+};
+
+struct ArtNode16 : ArtNode {
+    alignas(16) unsigned char keys[16];     // sorted; searched with one SSE2 compare
+    void* children[16];
+    ArtNode16() : ArtNode(NODE16), keys(), children() {}
+};
+
+struct ArtNode48 : ArtNode {
+    uint8_t index[256];         // byte -> slot + 1, 0 when absent
+    void* children[48];
+    ArtNode48() : ArtNode(NODE48), index(), children() {}
+};
+
+struct ArtNode256 : ArtNode {
+    void* children[256];
+    ArtNode256() : ArtNode(NODE256), children() {}
+};
+
+/**
+ * AdaptiveRadixTree - Byte-indexed trie whose nodes grow and shrink with their fan-out
+ * Data Structure: Adaptive radix tree (Leis et al.) with 4/16/48/256-way
+ * inner nodes, path compression and one heap leaf per word
+ *
+ * Purpose: A TST compares a character against one sibling at a time and
+ * follows a left or right pointer after each miss. Here a node indexes its
+ * children by the next byte directly: Node4 scans four keys, Node16 finds
+ * its child with a single SSE2 byte compare over all sixteen keys, Node48
+ * maps the byte through a 256-entry index, and Node256 is a plain array. A
+ * node is replaced by the next size when it fills up and by the previous
+ * one when erases thin it out, so sparse levels stay small. Runs without a
+ * branch are compressed into the node's prefix. Same interface as TST, so
+ * it can take the TST's place in the engine (see dictionary.h).
+ *
+ * Time Complexity (m = word length):
+ * - insert / search / erase: O(m), one child lookup per branching byte
+ * - prefixSearch: O(prefix) + O(k * word length) to collect, in byte order
+ */
+class AdaptiveRadixTree {
+private:
+    void* root;
+    size_t words;
+    size_t innerNodes[4];       // by ArtNode::Type
+
+    static bool isLeaf(const void* ref) { return (reinterpret_cast<uintptr_t>(ref) & 1) != 0; }
+    static ArtLeaf* leafOf(const void* ref) {
+        return reinterpret_cast<ArtLeaf*>(reinterpret_cast<uintptr_t>(ref) & ~(uintptr_t)1);
+    }
+    static void* tagLeaf(ArtLeaf* leaf) { return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(leaf) | 1); }
+
+    static void** findChild(ArtNode* node, unsigned char byte);
+    static const ArtLeaf* minimumLeaf(const void* ref);
+    static size_t prefixMismatch(const ArtNode* node, const std::string& key, size_t depth);
+
+    ArtNode* allocate(ArtNode::Type type);
+    void release(ArtNode* node);
+    void addChild(void** slot, ArtNode* node, unsigned char byte, void* child);
+    void attach(void** slot, ArtNode* node, ArtLeaf* leaf, size_t depth);
+    void removeChild(ArtNode* node, unsigned char byte, void** child);
+    void shrink(void** slot);
+    void destroy(void* ref);
+
+    bool eraseAt(void** slot, const std::string& word, size_t depth);
+    void collect(const void* ref, std::vector<std::string>& results, size_t k) const;
+    void report(const void* ref, MemoryUsage& usage) const;
+
+public:
+    AdaptiveRadixTree();
+    ~AdaptiveRadixTree();
+    AdaptiveRadixTree(const AdaptiveRadixTree&) = delete;
+    AdaptiveRadixTree& operator=(const AdaptiveRadixTree&) = delete;
+    AdaptiveRadixTree(AdaptiveRadixTree&& other) noexcept;
+    AdaptiveRadixTree& operator=(AdaptiveRadixTree&& other) noexcept;
+
+    void insert(const std::string& word);
+    std::vector<std::string> prefixSearch(const std::string& prefix, int k = 10) const;
+    bool search(const std::string& word) const;
+    // Remove word, shrinking or collapsing the nodes it leaves underfull
+    bool erase(const std::string& word);
+    void clear();
+
+    // Erase keeps every node at its right size, so there is never anything
+    // to compact; these keep the TST's interface
+    void compact() {}
+    bool compactIfFragmented(double threshold = 0.25) { (void)threshold; return false; }
+
+    // Inner nodes plus leaves
+    size_t nodeCount() const;
+    size_t nodeCount(ArtNode::Type type) const { return innerNodes[type]; }
+    size_t wordCount() const { return words; }
+    void getAllWords(std::vector<std::string>& results) const;
+
+    MemoryUsage memoryUsage() const;
+};
+
+#endif
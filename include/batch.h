@@ -0,0 +1,57 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstdio>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+
+struct BatchOptions {
+    int k = 5;
+    bool json = false;          // JSON lines instead of TSV
+};
+
+struct BatchStats {
+    size_t queries = 0;
+    size_t accepts = 0;
+    size_t bytesIn = 0;
+    double seconds = 0;
+
+    double queriesPerSecond() const { return seconds > 0 ? queries / seconds : 0.0; }
+};
+
+/**
+ * BatchRunner - Non-interactive query mode for scripts and replays
+ * Data Structure: Block-buffered input and output
+ *
+ * Purpose: Answer a stream of queries without prompts. Every input line is
+ *
+ *   <prefix> [context tokens...]      rank completions of prefix, using the
+ *                                     last context token as the previous token
+ *   :accept <token> [previous]        accept a token, as a recorded session did
+ *
+ * and every query produces exactly one output line, either TSV
+ * (prefix, then token and score columns) or a JSON object. Input is read
+ * and output written in large blocks with no per-query flush. Accepts
+ * change rankings for the rest of the run but are not saved to disk.
+ *
+ * Time Complexity:
+ * - O(queries * engine query cost); I/O is amortized over 1 MB blocks
+ */
+class BatchRunner {
+private:
+    AutocompleteEngine& engine;
+    BatchOptions options;
+    std::vector<std::string> fields;
+
+    void processLine(const char* line, size_t length, std::string& out, BatchStats& stats);
+
+public:
+    BatchRunner(AutocompleteEngine& engine, const BatchOptions& options);
+
+    BatchStats run(FILE* in, FILE* out);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include "memory_usage.h"
+#include "tst.h"
+#include "radix_tst.h"
+#include "art.h"
+#include "sorted_dictionary.h"
+
+// Backend used when none is asked for; make DICTIONARY=<kind> changes it
+#ifndef DICTIONARY_DEFAULT
+#define DICTIONARY_DEFAULT "tst"
+#endif
+
+/**
+ * Dictionary - The word set AutocompleteEngine and the indexers complete from
+ * Data Structure: Interface over TST ("tst"), RadixTST ("radix"),
+ * AdaptiveRadixTree ("art") and SortedDictionary ("sorted")
+ *
+ * Purpose: Choose the prefix structure at startup. All four provide
+ * insert, search, erase, prefixSearch, getAllWords, compactIfFragmented and
+ * memoryUsage; DictionaryOf forwards to them, so the engine, the project
+ * indexers and their tests run unchanged against any of them, and the
+ * front ends can benchmark one against another with --dictionary.
+ *
+ * Time Complexity:
+ * - One virtual call on top of the backend's own cost
+ */
+class Dictionary {
+public:
+    using WeightFn = std::function<int(const std::string&)>;
+
+    virtual ~Dictionary() = default;
+
+    virtual const char* name() const = 0;
+    virtual void insert(const std::string& word) = 0;
+    virtual bool search(const std::string& word) const = 0;
+    virtual bool erase(const std::string& word) = 0;
+    // Up to k words starting with prefix: the first k in order, or the k
+    // heaviest for a backend that ranks by weight
+    virtual std::vector<std::string> prefixSearch(const std::string& prefix, int k = 10) const = 0;
+    virtual void getAllWords(std::vector<std::string>& results) const = 0;
+    virtual bool compactIfFragmented() = 0;
+    virtual size_t wordCount() const = 0;
+    virtual MemoryUsage memoryUsage() const = 0;
+    // Weight for backends that rank prefix matches; the others ignore it
+    virtual void setWeights(WeightFn weight) { (void)weight; }
+
+    // The backend called kind, or nullptr when there is none by that name
+    static std::unique_ptr<Dictionary> create(const std::string& kind);
+    static std::vector<std::string> kinds();
+};
+
+template <typename Tree>
+class DictionaryOf : public Dictionary {
+private:
+    const char* kind;
+    Tree tree;
+
+public:
+    explicit DictionaryOf(const char* kind) : kind(kind) {}
+
+    Tree& get() { return tree; }
+    const Tree& get() const { return tree; }
+
+    const char* name() const override { return kind; }
+    void insert(const std::string& word) override { tree.insert(word); }
+    bool search(const std::string& word) const override { return tree.search(word); }
+    bool erase(const std::string& word) override { return tree.erase(word); }
+    std::vector<std::string> prefixSearch(const std::string& prefix, int k = 10) const override {
+        return tree.prefixSearch(prefix, k);
+    }
+    void getAllWords(std::vector<std::string>& results) const override { tree.getAllWords(results); }
+    bool compactIfFragmented() override { return tree.compactIfFragmented(); }
+    size_t wordCount() const override { return tree.wordCount(); }
+    MemoryUsage memoryUsage() const override { return tree.memoryUsage(); }
+    void setWeights(WeightFn weight) override { (void)weight; }
+};
+
+template <>
+inline void DictionaryOf<SortedDictionary>::setWeights(WeightFn weight) {
+    tree.setWeights(std::move(weight));
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef DOC_SEARCH_H
+#define DOC_SEARCH_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "text_buffer.h"
+
+/**
+ * DocumentSearch - Whole-document find, match index and replace-all
+ * Data Structure: Sorted vector of match offsets with a lazily applied shift
+ *
+ * Purpose: Give the editor search that does not rescan the file on every
+ * Ctrl+N and finds matches spanning lines ("\n" in the pattern). One scan
+ * over the piece table's segments looks for the pattern's rarest byte with
+ * memchr (vectorized in glibc) and verifies each hit, so most of the file
+ * is never compared byte by byte. The sorted offsets are then kept in step
+ * with every edit: only matches touching the edited range are dropped and
+ * rescanned, and the offsets after it are moved by a pending shift that is
+ * applied the next time an edit lands elsewhere.
+ *
+ * Every occurrence is indexed, overlapping ones included; replace-all takes
+ * them left to right and skips any that overlap a replaced one.
+ *
+ * Time Complexity (N = document length, k = matches):
+ * - setPattern: O(N) (memchr skips, plus a verify per candidate)
+ * - edited: O(log k + pattern length + edit size), plus moving the pending
+ *   shift across the matches between this edit and the previous one
+ * - next / prev: O(1) from the current match, O(log k) from anywhere else
+ * - replaceAll: O(span of the matches + k * replacement length)
+ */
+class DocumentSearch {
+private:
+    std::string pat;
+    size_t rare;                    // index in pat of its rarest byte
+
+    std::vector<size_t> positions;
+    size_t shiftFrom;               // positions[i >= shiftFrom] still need shift added
+    size_t shift;                   // pending offset change (modular, may be "negative")
+    size_t current;                 // index of the match the cursor is on, or npos
+
+    void scanSegments(const TextBuffer& buffer);
+
+public:
+    static const size_t npos = (size_t)-1;
+
+    DocumentSearch();
+
+    // Index every occurrence of pattern in buffer; an empty pattern clears
+    void setPattern(const std::string& pattern, const TextBuffer& buffer);
+    void clear();
+    const std::string& pattern() const { return pat; }
+    bool active() const { return !pat.empty(); }
+
+    // buffer has just had `removed` bytes at offset replaced by `inserted` bytes
+    void edited(size_t offset, size_t removed, size_t inserted, const TextBuffer& buffer);
+
+    size_t count() const { return positions.size(); }
+    // Offset of the i-th match
+    size_t at(size_t i) const { return positions[i] + (i >= shiftFrom ? shift : 0); }
+    // First match starting at or after offset (count() if none)
+    size_t lowerBound(size_t offset) const;
+
+    // Index of the first match after / before offset, wrapping around the
+    // document; npos without matches. Stepping from the current match is O(1).
+    size_t next(size_t offset);
+    size_t prev(size_t offset);
+    size_t currentIndex() const { return current; }
+
+    // Replace non-overlapping matches, leftmost first. The document from
+    // `from` to `from + length` is to be replaced by the returned text.
+    struct Replacement {
+        size_t from = 0;
+        size_t length = 0;
+        size_t replaced = 0;
+        std::string text;
+    };
+    Replacement replaceAll(const TextBuffer& buffer, const std::string& replacement) const;
+
+    // Index of the byte of pattern least likely to occur in source code
+    static size_t rarestByte(const std::string& pattern);
+    // Append base + offset of every occurrence of pattern in data[0, length)
+    static void scan(const char* data, size_t length, size_t base, const std::string& pattern,
+                     size_t rare, std::vector<size_t>& out);
+};
+
+#endif
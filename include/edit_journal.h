@@ -0,0 +1,109 @@
+#ifndef EDIT_JOURNAL_H
+#define EDIT_JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// One recorded edit, in document offsets at the time it was made
+struct JournalOp {
+    enum Kind : uint8_t { INSERT = 'i', ERASE = 'e' };
+
+    Kind kind;
+    uint64_t offset;
+    uint64_t count;         // erased bytes; text.size() for inserts
+    std::string text;
+};
+
+// The file a journal's edits apply to, as it was when the journal started
+struct JournalHeader {
+    std::string document;
+    uint64_t baseSize = 0;
+    int64_t baseMtimeNs = 0;
+};
+
+/**
+ * EditJournal - Crash-safe, append-only log of unsaved edits
+ * Data Structure: Double-buffered byte log + writer thread with group commit
+ *
+ * Purpose: Make a crash lose at most the last SYNC_INTERVAL of typing
+ * without making typing wait on the disk. Recording an edit only encodes it
+ * into an in-memory batch under a lock; a writer thread swaps the batch out,
+ * appends it with one write() and calls fdatasync at most once per
+ * SYNC_INTERVAL, so a burst of keystrokes costs one sync. Every record
+ * carries a CRC32, so replay stops cleanly at a torn or corrupt tail and
+ * returns the edits before it. The header names the file and its size and
+ * mtime, so edits are never replayed onto a different version of it. An
+ * open journal holds an exclusive flock, so a second editor of the same
+ * file can neither truncate it nor replay it while it is being written.
+ *
+ * Time Complexity:
+ * - insert / erase: O(text length), no disk I/O on the caller's thread
+ * - sync: waits for at most one write and one fdatasync
+ * - replay: O(journal size)
+ */
+class EditJournal {
+public:
+    static constexpr std::chrono::milliseconds SYNC_INTERVAL{50};
+
+private:
+    int fd;
+    std::string journalPath;
+
+    std::mutex mutex;
+    std::condition_variable wake;           // writer: new records, sync request or stop
+    std::condition_variable synced;         // sync(): durable caught up
+    std::string pending;                    // records not yet handed to the writer
+    uint64_t recorded;                      // bytes ever appended to pending
+    uint64_t durable;                       // bytes written and fdatasync'd
+    uint64_t syncTarget;                    // sync() waits for durable >= this
+    bool failed;
+    bool stopping;
+    std::thread writer;
+
+    void append(JournalOp::Kind kind, uint64_t offset, uint64_t count, const char* text, size_t length);
+    void loop();
+    void stop();
+
+public:
+    EditJournal();
+    ~EditJournal();
+    EditJournal(const EditJournal&) = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+
+    // Start a journal at path for the given file; with keep, an existing
+    // journal for the same header is appended to instead of truncated.
+    // Fails, leaving the file alone, when another process holds its lock.
+    bool open(const std::string& path, const JournalHeader& header, bool keep, std::string& error);
+    // Stop recording; with discard the journal file is removed (clean exit or save)
+    void close(bool discard);
+
+    bool isOpen() const { return fd >= 0; }
+    const std::string& path() const { return journalPath; }
+    // True once a write or sync failed; edits since are not protected
+    bool hasFailed();
+
+    void insert(size_t offset, const std::string& text);
+    void erase(size_t offset, size_t count);
+
+    // Block until everything recorded so far is on disk
+    void sync();
+
+    // Header and the intact prefix of edits of a journal file; false when
+    // it is missing or is not a journal
+    static bool replay(const std::string& path, JournalHeader& header, std::vector<JournalOp>& ops);
+    // True while another open journal (in any process) holds path's lock
+    static bool inUse(const std::string& path);
+    // Header describing the file at path now (size 0 when it does not exist)
+    static JournalHeader describe(const std::string& document);
+    // Where the journal of a document lives: ".name.scaj" next to it (not
+    // ".name.swp", which is Vim's swap file)
+    static std::string pathFor(const std::string& document);
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <cstdint>
+
+#include "dictionary.h"
+#include "lru.h"
+#include "stack.h"
+#include "graph.h"
+#include "freq_store.h"
+#include "ranker.h"
+#include "phrase_store.h"
+#include "incremental_indexer.h"
+#include "fuzzy.h"
+#include "substring_session.h"
+
+// Where one getSuggestions call spent its time, in nanoseconds
+struct QueryStages {
+    uint64_t cacheNs = 0;       // building the key and probing the cache (and rescoring a hit)
+    uint64_t prefixNs = 0;      // dictionary prefix search
+    uint64_t substringNs = 0;   // substring fallback, when it ran
+    uint64_t rankNs = 0;        // scoring and top-k selection
+    uint64_t fillNs = 0;        // storing the ranking in the cache
+    bool cacheHit = false;
+};
+
+/**
+ * AutocompleteEngine - The dictionary and ranking pipeline behind every front end
+ * Data Structure: Dictionary (any backend) + LRU cache + FreqStore + CooccurrenceGraph + PhraseStore
+ *
+ * Purpose: One engine shared by the interactive REPL, the socket server and
+ * batch mode. It never writes to stdout; front ends report results
+ * themselves, so the same calls work behind a prompt or a protocol.
+ *
+ * Time Complexity:
+ * - getSuggestions: O(1) on a cache hit, otherwise prefix search + O(c log k)
+ * - acceptSuggestion: O(1) plus a FreqStore save when auto-save is on
+ */
+class AutocompleteEngine {
+private:
+    std::unique_ptr<Dictionary> dictionary;
+    LRUCache cache;
+    FreqStore freqStore;
+    CooccurrenceGraph graph;
+    Ranker ranker;
+    UndoRedoStack undoRedo;
+    PhraseStore phraseStore;
+    IncrementalIndexer projectIndex;
+    // Snapshot of the dictionary's words for the scans that have no index; the
+    // fuzzy index and the substring session refer to it by position
+    std::vector<std::string> vocabulary;
+    bool vocabularyStale;       // the dictionary changed since the snapshot was taken
+    FuzzyIndex fuzzyIndex;
+    SubstringSession substringSession;
+    std::string lastAccepted;
+    bool useSubstringSearch;
+    bool usePhraseCompletion;
+    int seedsLoaded;
+    QueryStages* stageTrace;
+
+    int loadSeeds(const std::string& filename);
+    void refreshVocabulary();
+    std::vector<std::string> substringSearch(const std::string& prefix);
+
+public:
+    // dictionaryKind is one of Dictionary::kinds(); throws
+    // std::invalid_argument for any other
+    explicit AutocompleteEngine(const std::string& dictionaryKind = DICTIONARY_DEFAULT);
+
+    const char* dictionaryName() const { return dictionary->name(); }
+
+    int seedCount() const { return seedsLoaded; }
+    int phraseCount() const { return phraseStore.getTotalPhrases(); }
+
+    // Rank completions of prefix; context is the preceding token (defaults
+    // to the last accepted one) and boosts tokens that usually follow it
+    std::vector<std::pair<std::string, double>> getSuggestions(const std::string& prefix, int k = 5);
+    std::vector<std::pair<std::string, double>> getSuggestions(const std::string& prefix, int k,
+                                                               const std::string& context);
+    std::vector<std::string> getPhraseSuggestions(const std::string& prefix);
+
+    // Vocabulary words containing query with at most maxErrors typos,
+    // closest first and then most frequent
+    std::vector<FuzzyMatch> fuzzySearch(const std::string& query, int maxErrors = 1, size_t limit = 10);
+
+    // While set, every getSuggestions call is timed and overwrites *stages
+    // with its per-stage timings; otherwise only the sampled metrics are kept
+    void setStageTrace(QueryStages* stages) { stageTrace = stages; }
+
+    // Accept after the last accepted token, or after an explicit previous token
+    void acceptSuggestion(const std::string& token);
+    void acceptSuggestion(const std::string& token, const std::string& previous);
+    void bumpToken(const std::string& token, int amount = 5);
+    void learnPhrase(const std::string& trigger, const std::string& fullText);
+
+    // Undo/redo of accepted tokens; false when there is nothing to undo/redo
+    bool performUndo(std::string& removed);
+    bool performRedo(std::string& restored);
+
+    bool toggleSubstringSearch();
+    bool togglePhraseCompletion();
+
+    IndexStats indexProject(const std::string& root, ProjectIndexer::ProgressFn progress = nullptr);
+    // Apply files changed on disk since the last call
+    UpdateStats refreshIndex();
+    size_t watchedDirectories() const { return projectIndex.watchCount(); }
+
+    void displayGraph();
+
+    // Heap held by each structure, by name (tst or art, lru_cache, freq_store, graph, phrase_store)
+    std::vector<std::pair<std::string, MemoryUsage>> memoryUsage() const;
+    int savePhrases();
+
+    // With auto-save off, frequency changes are kept in memory until flush()
+    void setAutoSave(bool enabled);
+    void flush();
+};
+
+#endif
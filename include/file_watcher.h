@@ -0,0 +1,61 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+/**
+ * FileWatcher - Reports file changes under a directory tree (Linux inotify)
+ * Data Structure: Hash map from watch descriptor to directory path
+ *
+ * Purpose: Tell the incremental indexer which files were written, moved or
+ * deleted since it last looked. inotify watches are per directory, so every
+ * subdirectory gets its own watch; directories created later are picked up
+ * as their creation event arrives. The descriptor is non-blocking, so
+ * readEvents() never waits.
+ *
+ * Time Complexity:
+ * - watchTree: O(directories)
+ * - readEvents: O(pending events)
+ */
+class FileWatcher {
+public:
+    // QUEUE_OVERFLOW: the kernel dropped events, so any file may have
+    // changed unseen; its path is empty
+    enum class Change { WRITTEN, REMOVED, DIRECTORY_ADDED, QUEUE_OVERFLOW };
+
+    struct Event {
+        Change change;
+        std::string path;
+    };
+
+private:
+    int fd;
+    std::unordered_map<int, std::string> directories;
+
+    bool addWatch(const std::string& dir);
+
+public:
+    FileWatcher();
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // False if inotify is unavailable (e.g. out of instances)
+    bool valid() const { return fd >= 0; }
+    int descriptor() const { return fd; }
+    size_t watchCount() const { return directories.size(); }
+
+    // Watch root and every non-hidden directory below it; returns watches added
+    size_t watchTree(const std::string& root);
+
+    // Drain pending notifications without blocking
+    std::vector<Event> readEvents();
+
+    // Remove every watch
+    void clear();
+};
+
+#endif
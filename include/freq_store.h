@@ -4,10 +4,18 @@
 #include <string>
 #include <unordered_map>
 
+#include "memory_usage.h"
+
 class FreqStore {
 private:
-    std::unordered_map<std::string, int> frequencies;
+    std::unordered_map<std::string, int> frequencies;      // learned from accepts; saved
+    std::unordered_map<std::string, int> projectCounts;    // from indexing; memory only
     std::string filePath;
+    bool autoSave;
+    bool dirty;
+
+    void changed();
+    int learned(const std::string& token) const;
 
 public:
     FreqStore(const std::string& path);
@@ -16,6 +24,22 @@ public:
     int get(const std::string& token);
     void bump(const std::string& token, int amount = 1);
     void set(const std::string& token, int freq);
+    // Apply many bumps and save once.
+    // Negative amounts subtract; tokens that reach zero are dropped.
+    void bumpBatch(const std::unordered_map<std::string, int>& amounts);
+
+    // Token counts of an indexed project. get() adds them to the learned
+    // frequency, but they are never saved: the next session indexes the
+    // project again instead of loading its counts a second time.
+    // Negative amounts subtract; tokens that reach zero are dropped.
+    void bumpProject(const std::unordered_map<std::string, int>& amounts);
+
+    // Every change saves the file by default; long-running servers turn this
+    // off and flush() periodically instead
+    void setAutoSave(bool enabled);
+    void flush();
+
+    MemoryUsage memoryUsage() const;
 };
 
 #endif
\ No newline at end of file
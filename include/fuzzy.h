@@ -0,0 +1,75 @@
+#ifndef FUZZY_H
+#define FUZZY_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// A word containing the query with at most `distance` edits
+struct FuzzyMatch {
+    std::string word;
+    uint32_t id;        // position of the word in the order it was added
+    int distance;
+};
+
+/**
+ * FuzzyIndex - Approximate "contains" search over a whole vocabulary
+ * Data Structure: Length-bucketed packed arena + Myers bit-parallel matcher
+ *
+ * Purpose: Find words that contain the query with up to k typos (insertions,
+ * deletions, substitutions) when neither the Trie nor an exact substring
+ * scan can. The query is turned into one 64-bit mask per byte value, and
+ * each word is then checked with Myers' algorithm: a handful of word-sized
+ * operations per character, whatever k is. Words are packed back to back in
+ * one buffer per length, so a scan streams through memory, and buckets of
+ * words shorter than (query length - k) are skipped without reading them.
+ * Large vocabularies are split across threads, each taking a slice of every
+ * bucket. Matching ignores ASCII case.
+ *
+ * Time Complexity (N = total characters scanned, m <= 64 = query length):
+ * - add: amortized O(word length)
+ * - search: O(N / threads) plus sorting the matches
+ */
+class FuzzyIndex {
+public:
+    static const size_t MAX_QUERY = 64;
+    static const size_t PARALLEL_THRESHOLD = 1 << 16;   // words before search() uses threads
+
+private:
+    // Words of one length: word i is bytes[i * length, (i + 1) * length).
+    // The last bucket holds longer words, found through offsets.
+    struct Bucket {
+        size_t length = 0;
+        std::string bytes;
+        std::vector<uint32_t> ids;
+        std::vector<uint32_t> offsets;      // long-word bucket only: start of each word, plus the end
+    };
+
+    std::vector<Bucket> buckets;            // buckets[L] for L in 1..MAX_QUERY, last for longer
+    size_t words;
+
+    Bucket& bucketFor(size_t length);
+    void searchSlice(const uint64_t* peq, size_t m, int maxErrors, size_t limit, unsigned slice,
+                     unsigned slices, std::vector<FuzzyMatch>& out) const;
+
+public:
+    FuzzyIndex();
+
+    void add(const std::string& word);
+    void build(const std::vector<std::string>& vocabulary);
+    void clear();
+    size_t size() const { return words; }
+
+    // Words containing query with at most maxErrors edits, closest first
+    // (then shorter, then earlier added), at most limit of them. threads = 0
+    // picks one per core for large vocabularies and 1 otherwise.
+    std::vector<FuzzyMatch> search(const std::string& query, int maxErrors, size_t limit,
+                                   unsigned threads = 0) const;
+
+    // Smallest edit distance between query and any substring of text;
+    // query must be 1..MAX_QUERY bytes
+    static int substringDistance(const std::string& query, const std::string& text);
+};
+
+#endif
@@ -5,15 +5,22 @@
 #include <unordered_map>
 #include <map>
 
+#include "memory_usage.h"
+
 class CooccurrenceGraph {
 private:
     std::unordered_map<std::string, std::map<std::string, int>> adjacencyList;
 
 public:
-    void addEdge(const std::string& from, const std::string& to);
+    void addEdge(const std::string& from, const std::string& to, int weight = 1);
+    // Lower an edge's weight, dropping it (and an emptied node) at zero
+    void removeEdge(const std::string& from, const std::string& to, int weight = 1);
     double getBoost(const std::string& from, const std::string& to);
     void display();
     int getEdgeWeight(const std::string& from, const std::string& to);
+
+    // Items are edges
+    MemoryUsage memoryUsage() const;
 };
 
 #endif
\ No newline at end of file
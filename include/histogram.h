@@ -0,0 +1,61 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "log_buckets.h"
+
+/**
+ * LatencyHistogram - HDR-style log-linear histogram of non-negative values
+ * Data Structure: Fixed array of counters, 32 linear sub-buckets per power of two
+ *
+ * Purpose: Record millions of latencies (in nanoseconds) in constant memory
+ * and report any percentile with at most ~3% relative error. Values below
+ * 32 are exact; above that every power-of-two range is split into 32 equal
+ * buckets, so precision tracks magnitude as in HdrHistogram.
+ *
+ * Time Complexity:
+ * - record: O(1)
+ * - percentile: O(buckets) = O(1920)
+ * - merge: O(buckets)
+ */
+class LatencyHistogram {
+public:
+    using Buckets = LogLinearBuckets<5>;
+    static const int SUB_BUCKET_BITS = Buckets::SUB_BUCKET_BITS;
+    static const size_t SUB_BUCKETS = Buckets::SUB_BUCKETS;
+    static const size_t BUCKETS = Buckets::COUNT;
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t total;
+    uint64_t sum;
+    uint64_t minValue;
+    uint64_t maxValue;
+
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+    void clear();
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? minValue : 0; }
+    uint64_t max() const { return maxValue; }
+    double mean() const { return total ? (double)sum / total : 0.0; }
+
+    // Smallest recorded bucket bound with at least p percent of values at or
+    // below it (p in [0, 100]); 0 when empty
+    uint64_t percentile(double p) const;
+
+    // Bucket layout, for printing distributions
+    static size_t bucketIndex(uint64_t value) { return Buckets::index(value); }
+    static uint64_t bucketLow(size_t index) { return Buckets::low(index); }
+    static uint64_t bucketHigh(size_t index) { return Buckets::high(index); }
+    uint64_t bucketCount(size_t index) const { return counts[index]; }
+};
+
+#endif
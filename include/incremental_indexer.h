@@ -0,0 +1,77 @@
+#ifndef INCREMENTAL_INDEXER_H
+#define INCREMENTAL_INDEXER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "indexer.h"
+#include "file_watcher.h"
+
+struct UpdateStats {
+    size_t filesRescanned = 0;
+    size_t filesRemoved = 0;
+    size_t tokensAdded = 0;     // newly inserted into the dictionary
+    size_t tokensRemoved = 0;   // erased from the dictionary
+    bool fullRescan = false;    // events were lost, so the whole tree was indexed again
+    double seconds = 0;
+};
+
+/**
+ * IncrementalIndexer - Keeps indexed vocabulary in step with the files on disk
+ * Data Structure: Per-file TokenCounts + global occurrence counts
+ *
+ * Purpose: After the initial ProjectIndexer pass, only re-scan the files a
+ * FileWatcher reports as changed. Every file's contribution is remembered,
+ * so an edit subtracts the file's old counts from FreqStore's project
+ * counts (never saved) and the graph and adds the new ones. A token whose occurrences across all indexed files
+ * fall to zero is erased from the dictionary, but only if indexing put it there:
+ * seed words and tokens learned interactively are never removed.
+ *
+ * Time Complexity:
+ * - update: O(bytes of changed files + their unique tokens and edges)
+ */
+class IncrementalIndexer {
+private:
+    Dictionary& dictionary;
+    FreqStore& freqStore;
+    CooccurrenceGraph& graph;
+    ProjectIndexer indexer;
+    FileWatcher watcher;
+
+    std::string root;
+    FileContributions files;                      // path -> that file's counts
+    std::unordered_map<std::string, int> occurrences; // token -> total across files
+    std::unordered_set<std::string> ownedTokens;  // tokens the indexer inserted
+
+    struct Delta {
+        std::unordered_map<std::string, int> tokens;
+        std::unordered_map<std::string, std::unordered_map<std::string, int>> edges;
+    };
+
+    static void accumulate(const TokenCounts& counts, int sign, Delta& delta);
+    void removeFile(const std::string& path, Delta& delta, UpdateStats& stats);
+    void rescanFile(const std::string& path, Delta& delta, UpdateStats& stats);
+    void applyDelta(const Delta& delta, UpdateStats& stats);
+
+public:
+    IncrementalIndexer(Dictionary& dictionary, FreqStore& freqStore, CooccurrenceGraph& graph);
+
+    // Full index of dir, then start watching it. Any previous project is unloaded first.
+    IndexStats start(const std::string& dir, ProjectIndexer::ProgressFn progress = nullptr);
+
+    // Apply every change reported since the last call; cheap when nothing changed.
+    // If the watcher's queue overflowed, unload and index the tree again.
+    UpdateStats update();
+
+    // Remove everything this indexer contributed and stop watching
+    void stop();
+
+    bool watching() const { return !root.empty(); }
+    const std::string& directory() const { return root; }
+    size_t fileCount() const { return files.size(); }
+    size_t watchCount() const { return watcher.watchCount(); }
+};
+
+#endif
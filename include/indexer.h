@@ -0,0 +1,94 @@
+#ifndef INDEXER_H
+#define INDEXER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <filesystem>
+#include <cstddef>
+#include <cstdint>
+
+#include "dictionary.h"
+#include "freq_store.h"
+#include "graph.h"
+
+// Token and co-occurrence counts gathered from one or more files.
+// Tokens are interned to dense ids so each edge is a single 64-bit key.
+struct TokenCounts {
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<std::string> names;     // id -> token
+    std::vector<int> counts;            // id -> occurrences
+    // (from id << 32 | to id) for each pair of adjacent tokens within a statement
+    std::unordered_map<uint64_t, int> edges;
+    size_t occurrences = 0;
+
+    uint32_t intern(const std::string& token);
+    void merge(const TokenCounts& other);
+    std::unordered_map<std::string, int> tokenMap() const;
+    // Drop the intern table of a finished per-file table; merge() still accepts it as input
+    void shrink();
+};
+
+using FileContributions = std::unordered_map<std::string, TokenCounts>;
+
+struct IndexStats {
+    size_t files = 0;
+    size_t bytes = 0;
+    size_t tokens = 0;          // token occurrences
+    size_t uniqueTokens = 0;
+    size_t edges = 0;
+    double scanSeconds = 0;     // mmap + tokenize, in parallel
+    double mergeSeconds = 0;    // combining per-thread tables
+    double loadSeconds = 0;     // populating the dictionary, FreqStore and graph
+
+    double totalSeconds() const { return scanSeconds + mergeSeconds + loadSeconds; }
+    double megabytesPerSecond() const;
+};
+
+/**
+ * ProjectIndexer - Builds the vocabulary from a source tree
+ * Data Structure: Work queue (atomic cursor) + per-thread hash maps
+ *
+ * Purpose: Learn identifiers, keywords and member names straight from the
+ * code being edited. Files are mmap'd and tokenized on a pool of threads,
+ * each filling its own frequency and co-occurrence tables, which are then
+ * merged and loaded into the Dictionary, FreqStore and CooccurrenceGraph in one pass.
+ *
+ * Time Complexity:
+ * - indexTree: O(total bytes / threads) scan + O(unique tokens) merge
+ */
+class ProjectIndexer {
+public:
+    using ProgressFn = std::function<void(size_t filesDone, size_t filesTotal, size_t bytesDone)>;
+
+private:
+    unsigned threadCount;
+
+public:
+    explicit ProjectIndexer(unsigned threads = 0);
+
+    IndexStats indexTree(const std::string& root, Dictionary& dictionary, FreqStore& freqStore,
+                         CooccurrenceGraph& graph, ProgressFn progress = nullptr);
+
+    // Scan and merge without loading anything. When perFile is given, each
+    // file's own counts are kept there as well, keyed by path.
+    IndexStats scanTree(const std::string& root, TokenCounts& merged,
+                        ProgressFn progress = nullptr, FileContributions* perFile = nullptr);
+
+    // Gather every C/C++ source file under root
+    static std::vector<std::filesystem::path> listSources(const std::string& root);
+    static bool isSourceFile(const std::filesystem::path& path);
+
+    // Tokenize a file through mmap; returns the bytes read (0 on failure)
+    static size_t scanFile(const std::filesystem::path& path, TokenCounts& counts);
+
+    // Identifiers outside comments, string and character literals
+    static void tokenize(const char* data, size_t size, TokenCounts& counts);
+
+    // Load merged counts into the engine's data structures
+    static void apply(const TokenCounts& counts, Dictionary& dictionary, FreqStore& freqStore,
+                      CooccurrenceGraph& graph);
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef JSON_LINES_H
+#define JSON_LINES_H
+
+#include <string>
+#include <unordered_map>
+
+/**
+ * JSON-lines helpers for the server and batch protocols
+ *
+ * Requests are single-line flat JSON objects whose values are strings,
+ * numbers or booleans, e.g. {"op":"complete","prefix":"pri","k":5}.
+ * Nested objects and arrays are rejected; that is all the protocol needs.
+ */
+namespace jsonl {
+
+using Object = std::unordered_map<std::string, std::string>;
+
+// Parse a flat object. String values are unescaped; numbers and booleans
+// are kept as their literal text. Returns false on malformed input.
+bool parseObject(const std::string& line, Object& out);
+
+// Append s as a quoted JSON string
+void appendString(std::string& out, const std::string& s);
+
+// Field lookups with defaults
+std::string getString(const Object& obj, const std::string& key, const std::string& fallback = "");
+long getInt(const Object& obj, const std::string& key, long fallback);
+
+}
+
+#endif
@@ -9,9 +9,54 @@ using namespace std;
 class KMP {
 private:
     static vector<int> computeLPS(const string& pattern);
+    friend class CompiledPattern;
 public:
     static bool contains(const string& text, const string& pattern);
     static vector<int> findAll(const string& text, const string& pattern);
 };
 
+/**
+ * CompiledPattern - A search pattern preprocessed once and reused
+ * Data Structure: KMP failure table + vector first/last-byte filter
+ *
+ * Purpose: KMP::contains rebuilds the failure table on every call, which
+ * dominates when one pattern is tested against every vocabulary word.
+ * A CompiledPattern builds it once. Texts long enough are scanned 32 or 16
+ * bytes at a time: positions whose first and last bytes both equal the
+ * pattern's are found with two vector compares, and only those are
+ * verified. The widest kernel the CPU supports (AVX2, then SSE2) is picked
+ * at runtime; short texts, tails and other CPUs use the KMP scan.
+ *
+ * Time Complexity (n = text length, m = pattern length):
+ * - construction: O(m)
+ * - find / contains: O(n + m) with KMP; the vector kernels cost O(n / width)
+ *   plus O(m) per first/last-byte candidate
+ */
+class CompiledPattern {
+public:
+    enum Kernel { SCALAR, SSE2, AVX2 };
+
+    // kernel is lowered to what the CPU supports
+    explicit CompiledPattern(const string& pattern, Kernel kernel = bestKernel());
+
+    bool contains(const string& text) const;
+    // Offset of the first match starting at or after from, or string::npos
+    size_t find(const char* text, size_t length, size_t from = 0) const;
+    // Every match, overlapping ones included (same as KMP::findAll)
+    vector<int> findAll(const string& text) const;
+
+    const string& pattern() const { return pat; }
+    Kernel kernel() const { return simd; }
+
+    static Kernel bestKernel();
+    static const char* kernelName(Kernel kernel);
+
+private:
+    string pat;
+    vector<int> lps;
+    Kernel simd;
+
+    size_t findScalar(const char* text, size_t length, size_t from) const;
+};
+
 #endif
@@ -0,0 +1,72 @@
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * LineIndex - Sparse newline index over a read-only byte range
+ * Data Structure: Prefix counts of '\n' per 4 KB block, filled in the background
+ *
+ * Purpose: Find lines in a file of any size without storing an offset per
+ * line. Only the number of newlines before each block is kept (8 bytes per
+ * 4 KB of text); the exact position is found by scanning at most one block
+ * with vector compares. The counts are built on a worker thread so a file
+ * can be shown as soon as it is mapped: queries past the indexed prefix
+ * scan from its end instead of waiting, which is cheap for the first screen.
+ *
+ * Time Complexity (B = BLOCK):
+ * - build: O(n / 16) per core, SSE2 or AVX2 newline counting
+ * - breaksBefore / findBreak: O(log(n / B) + B) once indexed
+ */
+class LineIndex {
+public:
+    static constexpr size_t BLOCK = 4096;
+    static const size_t npos = (size_t)-1;
+
+private:
+    const char* data;
+    size_t size;
+    std::vector<uint64_t> prefix;           // prefix[b] = newlines in blocks [0, b)
+    std::atomic<size_t> indexed;            // blocks whose prefix[b + 1] is published
+    std::atomic<bool> cancel;
+    std::thread worker;
+
+    size_t blocks() const { return (size + BLOCK - 1) / BLOCK; }
+    void indexBlocks(size_t from, size_t to);
+
+public:
+    LineIndex();
+    ~LineIndex();
+    LineIndex(const LineIndex&) = delete;
+    LineIndex& operator=(const LineIndex&) = delete;
+
+    // Index [data, data + size), which must stay valid until reset() or
+    // destruction. The first `eager` bytes are indexed before returning; with
+    // background the rest is done on a worker thread, otherwise right away.
+    void build(const char* data, size_t size, bool background, size_t eager = 1 << 16);
+    // Stop the worker and forget the range
+    void reset();
+    // Block until the whole range is indexed
+    void wait();
+
+    bool ready() const { return indexed.load(std::memory_order_acquire) == blocks(); }
+    double progress() const;
+
+    // Newlines in [0, offset)
+    size_t breaksBefore(size_t offset) const;
+    // Offset of the k-th newline (0-based), or npos when there are not that many
+    size_t findBreak(size_t k) const;
+    // Newlines in the part indexed so far; all of them once ready()
+    size_t knownBreaks() const;
+
+    size_t memoryUsage() const { return sizeof(*this) + prefix.capacity() * sizeof(uint64_t); }
+
+    // Number of '\n' bytes in [data, data + length), using the widest vectors the CPU has
+    static size_t countNewlines(const char* data, size_t length);
+};
+
+#endif
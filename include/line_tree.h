@@ -0,0 +1,183 @@
+#ifndef LINE_TREE_H
+#define LINE_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * LineTree - One value per document line, addressed by line number
+ * Data Structure: Implicit treap (the same split / merge scheme as the
+ * piece table), every node caching the size of its subtree
+ *
+ * Purpose: Per-line caches have to follow the document as lines are
+ * inserted and erased. In a vector, a line break typed near the top of a
+ * large file moves every entry below it. Here a node's line number is the
+ * number of nodes before it in order, so inserting or erasing a run of
+ * lines is a split and a merge wherever it happens, and the lines below
+ * renumber without being touched.
+ *
+ * Time Complexity (n = lines):
+ * - operator[]: O(log n) expected
+ * - insert(at, count): O(log n + count)
+ * - erase(at, count): O(log n + count)
+ */
+template <typename T>
+class LineTree {
+private:
+    struct Node {
+        T value;
+        size_t size;
+        uint32_t priority;
+        Node* left;
+        Node* right;
+
+        explicit Node(uint32_t prio) : value(), size(1), priority(prio), left(nullptr), right(nullptr) {}
+    };
+
+    Node* root;
+    uint32_t seed;
+
+    uint32_t nextPriority() {
+        // xorshift32 - treap priorities only need to be well spread
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    static size_t sizeOf(Node* node) { return node ? node->size : 0; }
+
+    static void update(Node* node) {
+        node->size = sizeOf(node->left) + 1 + sizeOf(node->right);
+    }
+
+    // left takes the first `count` nodes, right the rest
+    static void split(Node* node, size_t count, Node*& left, Node*& right) {
+        if (node == nullptr) {
+            left = right = nullptr;
+            return;
+        }
+        if (count <= sizeOf(node->left)) {
+            split(node->left, count, left, node->left);
+            right = node;
+        } else {
+            split(node->right, count - sizeOf(node->left) - 1, node->right, right);
+            left = node;
+        }
+        update(node);
+    }
+
+    static Node* merge(Node* left, Node* right) {
+        if (left == nullptr) return right;
+        if (right == nullptr) return left;
+
+        if (left->priority > right->priority) {
+            left->right = merge(left->right, right);
+            update(left);
+            return left;
+        }
+        right->left = merge(left, right->left);
+        update(right);
+        return right;
+    }
+
+    // A treap of count default values, built in one pass over the
+    // rightmost spine rather than by count merges
+    Node* build(size_t count) {
+        std::vector<Node*> spine;
+        for (size_t i = 0; i < count; i++) {
+            Node* node = new Node(nextPriority());
+            Node* last = nullptr;
+            while (!spine.empty() && spine.back()->priority < node->priority) {
+                last = spine.back();
+                spine.pop_back();
+                update(last);
+            }
+            node->left = last;
+            if (!spine.empty()) spine.back()->right = node;
+            spine.push_back(node);
+        }
+        while (spine.size() > 1) {
+            update(spine.back());
+            spine.pop_back();
+        }
+        if (spine.empty()) return nullptr;
+        update(spine.back());
+        return spine.back();
+    }
+
+    template <typename Fn>
+    static void destroy(Node* node, Fn& onErase) {
+        if (node == nullptr) return;
+        destroy(node->left, onErase);
+        onErase(node->value);
+        destroy(node->right, onErase);
+        delete node;
+    }
+
+    Node* find(size_t index) const {
+        Node* node = root;
+        while (node != nullptr) {
+            size_t leftSize = sizeOf(node->left);
+            if (index == leftSize) return node;
+            if (index < leftSize) {
+                node = node->left;
+            } else {
+                index -= leftSize + 1;
+                node = node->right;
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    LineTree() : root(nullptr), seed(2463534242u) {}
+    ~LineTree() { clear(); }
+    LineTree(const LineTree&) = delete;
+    LineTree& operator=(const LineTree&) = delete;
+
+    size_t size() const { return sizeOf(root); }
+
+    // index must be below size()
+    T& operator[](size_t index) { return find(index)->value; }
+    const T& operator[](size_t index) const { return find(index)->value; }
+
+    // count default values now start at `at`; values from `at` on move down
+    void insert(size_t at, size_t count) {
+        if (count == 0) return;
+        Node* left;
+        Node* right;
+        split(root, at, left, right);
+        root = merge(merge(left, build(count)), right);
+    }
+
+    // Values [at, at + count) are gone, each passed to onErase first in order
+    template <typename Fn>
+    void erase(size_t at, size_t count, Fn onErase) {
+        if (count == 0) return;
+        Node* left;
+        Node* middle;
+        Node* right;
+        split(root, at, left, middle);
+        split(middle, count, middle, right);
+        destroy(middle, onErase);
+        root = merge(left, right);
+    }
+
+    void erase(size_t at, size_t count) {
+        erase(at, count, [](T&) {});
+    }
+
+    // Append default values up to size n (never shrinks)
+    void grow(size_t n) {
+        if (n > size()) root = merge(root, build(n - size()));
+    }
+
+    void clear() {
+        erase(0, size());
+    }
+};
+
+#endif
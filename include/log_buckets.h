@@ -0,0 +1,76 @@
+#ifndef LOG_BUCKETS_H
+#define LOG_BUCKETS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * LogLinearBuckets - Bucket layout of the HDR-style latency histograms
+ * Data Structure: One bucket per value below 2^SubBits, then every power of
+ * two split into 2^SubBits equal-width buckets
+ *
+ * Purpose: The bucket math behind LatencyHistogram (5 bits, ~3% error) and
+ * the metrics stage histograms (2 bits, 25%), kept in one place so the two
+ * differ only in precision. Header-only, since metrics is linked into
+ * targets that do not build histogram.cpp.
+ *
+ * Time Complexity:
+ * - index / low / high: O(1)
+ * - percentile: O(COUNT)
+ */
+template <int SubBits>
+struct LogLinearBuckets {
+    static constexpr int SUB_BUCKET_BITS = SubBits;
+    static constexpr size_t SUB_BUCKETS = (size_t)1 << SubBits;
+    static constexpr size_t COUNT = (64 - SubBits + 1) * SUB_BUCKETS;
+
+    static size_t index(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return value;
+        }
+        int exponent = 63 - __builtin_clzll(value);
+        size_t sub = (value >> (exponent - SubBits)) & (SUB_BUCKETS - 1);
+        return (exponent - SubBits + 1) * SUB_BUCKETS + sub;
+    }
+
+    static uint64_t low(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        size_t block = index / SUB_BUCKETS;
+        size_t sub = index % SUB_BUCKETS;
+        return (uint64_t)(SUB_BUCKETS + sub) << (block - 1);
+    }
+
+    static uint64_t high(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        size_t block = index / SUB_BUCKETS;
+        return low(index) + ((uint64_t)1 << (block - 1)) - 1;
+    }
+
+    // Upper bound of the bucket holding the p-th percentile (p in [0, 100])
+    // of total values counted in counts, capped at maxValue; 0 when empty
+    template <typename Counts>
+    static uint64_t percentile(const Counts& counts, uint64_t total, uint64_t maxValue, double p) {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = (uint64_t)std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * total);
+        rank = std::max<uint64_t>(rank, 1);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < COUNT; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(high(i), maxValue);
+            }
+        }
+        return maxValue;
+    }
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include<string>
 #include<vector>
 #include<unordered_map>
+#include "memory_usage.h"
 using namespace std;
 
 struct Node{
@@ -38,6 +39,7 @@ public:
     void put(const string& key, const vector<string>& val);
     bool exists(const string& key);
     void clear();
+    MemoryUsage memoryUsage() const;
 };
 
 using LRUCache = lru_cache;
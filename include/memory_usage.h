@@ -0,0 +1,87 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * MemoryUsage - Heap bytes held by one data structure, by kind
+ * Data Structure: Plain counters filled by each structure's memoryUsage()
+ *
+ * Purpose: Let every structure (TST, lru_cache, FreqStore, PhraseStore,
+ * CooccurrenceGraph) report what it costs in one common shape, so layout
+ * changes can be compared on numbers. Sizes follow libstdc++ and glibc
+ * malloc: strings of up to 15 characters live inside the string object,
+ * hash nodes for string keys cache the hash, and every heap block has an
+ * 8-byte header and is rounded up to 16 bytes (32 at least).
+ *
+ * Time Complexity:
+ * - add*: O(1); a structure's report is O(its size)
+ */
+struct MemoryUsage {
+    size_t items = 0;       // words, entries or tokens held
+    size_t nodes = 0;       // node and entry objects, as requested from the allocator
+    size_t strings = 0;     // character buffers of strings too long for the inline buffer
+    size_t buckets = 0;     // hash table bucket arrays and vector buffers in use
+    size_t overhead = 0;    // malloc headers and rounding, control blocks, unused capacity
+
+    size_t total() const { return nodes + strings + buckets + overhead; }
+    double bytesPerItem() const { return items ? (double)total() / items : 0.0; }
+
+    // glibc malloc block size for a request of the given size
+    static size_t heapBlock(size_t request) {
+        size_t block = (request + sizeof(size_t) + 15) & ~(size_t)15;
+        return block < 32 ? 32 : block;
+    }
+
+    // count heap blocks of bytes each
+    void addNodes(size_t bytes, size_t count = 1) {
+        nodes += bytes * count;
+        overhead += (heapBlock(bytes) - bytes) * count;
+    }
+
+    void addString(const std::string& s) {
+        const size_t INLINE_CAPACITY = 15;
+        if (s.capacity() > INLINE_CAPACITY) {
+            strings += s.capacity() + 1;
+            overhead += heapBlock(s.capacity() + 1) - (s.capacity() + 1);
+        }
+    }
+
+    // A vector buffer or bucket array: used bytes, plus the rest of its capacity as overhead
+    void addArray(size_t usedBytes, size_t capacityBytes) {
+        if (capacityBytes == 0) return;
+        buckets += usedBytes;
+        overhead += heapBlock(capacityBytes) - usedBytes;
+    }
+
+    void addBuckets(size_t bucketCount) {
+        // libstdc++ keeps a single bucket inside the table object
+        if (bucketCount > 1) {
+            addArray(bucketCount * sizeof(void*), bucketCount * sizeof(void*));
+        }
+    }
+
+    // libstdc++ unordered_map node: next pointer, value, and the cached hash for string keys
+    template <typename Value>
+    static size_t hashNode(bool cachedHash) {
+        return sizeof(void*) + sizeof(Value) + (cachedHash ? sizeof(size_t) : 0);
+    }
+
+    // libstdc++ std::map node: color and three links, then the value
+    template <typename Value>
+    static size_t treeNode() {
+        return 4 * sizeof(void*) + sizeof(Value);
+    }
+
+    MemoryUsage& operator+=(const MemoryUsage& other) {
+        items += other.items;
+        nodes += other.nodes;
+        strings += other.strings;
+        buckets += other.buckets;
+        overhead += other.overhead;
+        return *this;
+    }
+};
+
+#endif
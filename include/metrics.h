@@ -0,0 +1,188 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "log_buckets.h"
+
+/**
+ * metrics - Always-on counters and latency histograms for the engine's stages
+ * Data Structure: Per-thread blocks of relaxed atomics + log-bucketed histograms
+ *
+ * Purpose: Show where query time goes in a running process (cache lookup,
+ * TST prefix search, substring fallback, ranking, cache fill, accepts,
+ * FreqStore saves) without a profiler. Each thread writes only its own
+ * block with plain loads and stores, so recording never takes a lock or a
+ * locked instruction; collect() sums every block for :stats and JSON.
+ *
+ * Call counts are exact. Stage latencies of hot paths are timed on one
+ * operation in SAMPLE_INTERVAL per thread, which keeps the clock reads
+ * under 1% of query time; slow operations (accepts, saves) are timed
+ * every time.
+ *
+ * Time Complexity:
+ * - count / lap: O(1)
+ * - collect: O(threads * stages * buckets)
+ */
+namespace metrics {
+
+enum Stage {
+    SUGGEST,            // a whole getSuggestions call
+    CACHE_LOOKUP,
+    PREFIX_SEARCH,
+    SUBSTRING_SEARCH,
+    RANK,
+    CACHE_FILL,
+    PHRASES,
+    ACCEPT,
+    FREQ_SAVE,
+    STAGE_COUNT
+};
+
+enum Counter {
+    CACHE_HITS,
+    CACHE_MISSES,
+    SUBSTRING_FALLBACKS,
+    COUNTER_COUNT
+};
+
+const char* stageName(Stage stage);
+const char* counterName(Counter counter);
+
+// 4 linear sub-buckets per power of two: at most 25% above the true value
+using Buckets = LogLinearBuckets<2>;
+const int SUB_BUCKET_BITS = Buckets::SUB_BUCKET_BITS;
+const size_t SUB_BUCKETS = Buckets::SUB_BUCKETS;
+const size_t BUCKETS = Buckets::COUNT;
+
+// One hot-path operation in this many has its stages timed
+const uint32_t SAMPLE_INTERVAL = 64;
+
+inline size_t bucketIndex(uint64_t ns) { return Buckets::index(ns); }
+inline uint64_t bucketHigh(size_t index) { return Buckets::high(index); }
+
+// Written only by its thread; read by collect() from any thread
+struct ThreadBlock {
+    std::atomic<uint64_t> counters[COUNTER_COUNT];
+    std::atomic<uint64_t> calls[STAGE_COUNT];
+    std::atomic<uint64_t> timed[STAGE_COUNT];
+    std::atomic<uint64_t> totalNs[STAGE_COUNT];
+    std::atomic<uint64_t> maxNs[STAGE_COUNT];
+    std::atomic<uint64_t> buckets[STAGE_COUNT][BUCKETS];
+    uint32_t sampleCountdown[STAGE_COUNT];
+
+    ThreadBlock();
+};
+
+extern thread_local ThreadBlock* localBlock;
+ThreadBlock& registerThread();
+
+inline ThreadBlock& threadBlock() {
+    return localBlock ? *localBlock : registerThread();
+}
+
+// Single-writer increment: no read-modify-write instruction needed
+inline void add(std::atomic<uint64_t>& cell, uint64_t amount = 1) {
+    cell.store(cell.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+inline void count(Counter counter, uint64_t amount = 1) {
+    add(threadBlock().counters[counter], amount);
+}
+
+// True for one operation in SAMPLE_INTERVAL that starts with stage,
+// counted separately per stage and per thread
+inline bool sample(Stage stage) {
+    uint32_t& countdown = threadBlock().sampleCountdown[stage];
+    if (countdown == 0) {
+        countdown = SAMPLE_INTERVAL - 1;
+        return true;
+    }
+    countdown--;
+    return false;
+}
+
+void record(ThreadBlock& block, Stage stage, uint64_t ns);
+
+/**
+ * StageTimer - Times consecutive stages of one operation
+ *
+ * Each lap() ends the running stage, counts a call to it and, when timing,
+ * records its latency and starts the next stage. total() records the time
+ * since construction. Without timing no clock is read.
+ */
+class StageTimer {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ThreadBlock& block;
+    bool timing;
+    Clock::time_point start;
+    Clock::time_point last;
+
+    uint64_t timedLap(Stage stage);
+    uint64_t timedTotal(Stage stage);
+
+public:
+    explicit StageTimer(bool timing) : block(threadBlock()), timing(timing) {
+        if (timing) {
+            start = last = Clock::now();
+        }
+    }
+
+    // Nanoseconds spent in stage (0 when not timing)
+    uint64_t lap(Stage stage) {
+        add(block.calls[stage]);
+        return timing ? timedLap(stage) : 0;
+    }
+    uint64_t total(Stage stage) {
+        add(block.calls[stage]);
+        return timing ? timedTotal(stage) : 0;
+    }
+    bool isTiming() const { return timing; }
+};
+
+// Times the enclosing scope as one stage
+class ScopedTimer {
+private:
+    Stage stage;
+    StageTimer timer;
+
+public:
+    explicit ScopedTimer(Stage stage, bool timing = true) : stage(stage), timer(timing) {}
+    ~ScopedTimer() { timer.total(stage); }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+struct StageStats {
+    uint64_t calls = 0;
+    uint64_t timed = 0;         // calls with a latency sample
+    uint64_t totalNs = 0;       // over the timed calls
+    uint64_t maxNs = 0;
+    std::vector<uint64_t> buckets = std::vector<uint64_t>(BUCKETS, 0);
+
+    double meanNs() const { return timed ? (double)totalNs / timed : 0.0; }
+    // Upper bound of the bucket holding the p-th percentile sample
+    uint64_t percentile(double p) const;
+};
+
+struct Snapshot {
+    StageStats stages[STAGE_COUNT];
+    uint64_t counters[COUNTER_COUNT] = {};
+    size_t threads = 0;         // threads that have recorded anything
+};
+
+// Sum of every thread's block, including threads that have exited
+Snapshot collect();
+
+std::string toJson(const Snapshot& snapshot);
+
+}
+
+#endif
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <fstream>
 
+#include "memory_usage.h"
+
 using namespace std;
 
 // Structure to store a learned phrase/snippet
@@ -61,6 +63,8 @@ public:
 
     // Get total number of learned phrases
     int getTotalPhrases() const;
+
+    MemoryUsage memoryUsage() const;
 };
 
 #endif
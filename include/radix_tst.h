@@ -0,0 +1,96 @@
+#ifndef RADIX_TST_H
+#define RADIX_TST_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "memory_usage.h"
+
+struct RadixNode {
+    static const size_t INLINE_LABEL = 12;
+
+    // Indices into the node pool; 0 is no node
+    uint32_t left;
+    uint32_t eq;
+    uint32_t right;
+    uint32_t length : 31;           // label characters, at least 1
+    uint32_t isEndOfString : 1;
+    // Labels of up to INLINE_LABEL characters are stored in the node,
+    // longer ones in the tree's label arena
+    union {
+        char text[INLINE_LABEL];
+        uint32_t offset;
+    } label;
+};
+
+/**
+ * RadixTST - Path-compressed ternary search tree
+ * Data Structure: TST whose unary eq chains are collapsed into one labelled
+ * node; nodes live in a pool addressed by 32-bit index, long labels in a
+ * shared character arena
+ *
+ * Purpose: In TST every character is a node, so "unordered_map" is a chain
+ * of thirteen single-child nodes that every lookup walks one pointer at a
+ * time. Here a node holds the whole run: its first character takes part in
+ * the sibling BST exactly as in TST, and the rest is checked with a single
+ * memcmp. Inserting a word that leaves a label midway splits the node at
+ * the first differing character; erasing a word merges a node back with a
+ * lone continuation. Results come back in the same order as TST's.
+ *
+ * Time Complexity (m = word length, s = sibling BST depth per node visited):
+ * - insert / search / erase: O(m + s * labelled nodes on the path)
+ * - prefixSearch: O(prefix) to locate + O(k * average word length) to collect
+ */
+class RadixTST {
+private:
+    static const uint32_t NIL = 0;
+
+    std::vector<RadixNode> pool;        // pool[0] is unused so 0 can mean no node
+    std::vector<uint32_t> freeNodes;
+    std::vector<char> labels;           // labels longer than INLINE_LABEL
+    size_t garbage;                     // arena bytes no node refers to any more
+    uint32_t root;
+    size_t nodes;
+    size_t words;
+
+    const char* labelOf(const RadixNode& node) const {
+        return node.length > RadixNode::INLINE_LABEL ? labels.data() + node.label.offset : node.label.text;
+    }
+
+    uint32_t allocate();
+    void release(uint32_t node);
+    void setLabel(uint32_t node, const char* text, size_t length);
+    void split(uint32_t node, size_t at);
+    void merge(uint32_t node);
+    uint32_t unlink(uint32_t node);
+
+    uint32_t eraseUtil(uint32_t node, const std::string& word, size_t index, bool& erased);
+    void insertBalanced(const std::vector<std::string>& sorted, size_t lo, size_t hi);
+    void collect(uint32_t node, std::string& path, std::vector<std::string>& results, size_t k) const;
+
+public:
+    RadixTST();
+    void insert(const std::string& word);
+    std::vector<std::string> prefixSearch(const std::string& prefix, int k = 10) const;
+    bool search(const std::string& word) const;
+    // Remove word, merging or unlinking the nodes it leaves unary or empty
+    bool erase(const std::string& word);
+    void clear();
+
+    // Rebuild from the live words, reclaiming arena bytes left by merges
+    void compact();
+    // Erase already compacts once half the arena is garbage; this keeps
+    // the TST's interface
+    bool compactIfFragmented(double threshold = 0.25) { (void)threshold; return false; }
+
+    size_t nodeCount() const { return nodes; }
+    size_t wordCount() const { return words; }
+    size_t labelBytes() const { return labels.size() - garbage; }
+    void getAllWords(std::vector<std::string>& results) const;
+
+    MemoryUsage memoryUsage() const;
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include <cmath>
 #include "freq_store.h"
 #include "graph.h"
 
@@ -18,6 +19,14 @@ class Ranker {
         void setLastToken(const std::string &token);
         double computeScore(const std::string &token);
         std::vector<std::pair<std::string,double>> rankResults(const std::vector<std::string> &candidates,int k);
+
+        // Frequency plus the co-occurrence boost for having followed the
+        // previous token edgeWeight times. The one scoring formula, shared
+        // with DictionarySnapshot and CooccurrenceGraph::getBoost.
+        static double score(double frequency, int edgeWeight) {
+            double graphBoost = edgeWeight > 0 ? std::log(1 + edgeWeight) * 0.5 : 0.0;
+            return frequency + graphBoost;
+        }
 };
 
 #endif
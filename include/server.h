@@ -0,0 +1,91 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+#include "engine.h"
+
+struct ServerStats {
+    size_t connections = 0;     // accepted since start
+    size_t requests = 0;
+    size_t errors = 0;          // malformed or failed requests
+};
+
+/**
+ * AutocompleteServer - Serves one shared engine over a UNIX domain socket
+ * Data Structure: epoll event loop + per-connection input/output buffers
+ *
+ * Purpose: Let every editor on the machine query a single loaded
+ * dictionary instead of each loading its own. Clients send JSON lines and
+ * get one JSON line back per request, in order, so requests can be
+ * pipelined:
+ *
+ *   {"op":"complete","prefix":"pri","k":5,"context":"std"}
+ *   {"op":"accept","token":"printf","context":"std"}
+ *   {"op":"learn","trigger":"for","text":"for (int i = 0; i < n; i++)"}
+ *   {"op":"bump","token":"printf","amount":5}
+ *   {"op":"stats"}                  (per-stage latency and counters)
+ *
+ * Replies carry "ok" and either results or "error"; an "id" field in a
+ * request is echoed back as a string. Frequency changes are flushed to
+ * disk once a second rather than on every accept.
+ *
+ * Time Complexity:
+ * - per request: the engine call plus O(request + reply) buffering
+ */
+class AutocompleteServer {
+private:
+    struct Connection {
+        std::string in;
+        std::string out;
+        size_t outPos = 0;
+        bool peerClosed = false;
+        uint32_t events = 0;        // epoll interest currently registered
+    };
+
+    AutocompleteEngine& engine;
+    std::string socketPath;
+    int listenFd;
+    int epollFd;
+    bool bound;                 // socketPath is the socket this process created
+    dev_t boundDev;
+    ino_t boundIno;
+    std::unordered_map<int, Connection> connections;
+    ServerStats stats;
+
+    void acceptClients();
+    void readClient(int fd);
+    void processInput(Connection& conn);
+    bool flushClient(int fd, Connection& conn);
+    void closeClient(int fd);
+
+public:
+    static const size_t MAX_LINE = 1 << 20;
+    // Stop reading a client's requests while this much output is unsent
+    static const size_t MAX_PENDING_OUTPUT = 4 << 20;
+
+    AutocompleteServer(AutocompleteEngine& engine, const std::string& socketPath);
+    ~AutocompleteServer();
+    AutocompleteServer(const AutocompleteServer&) = delete;
+    AutocompleteServer& operator=(const AutocompleteServer&) = delete;
+
+    // Bind and listen; on failure returns false with a message in error.
+    // An existing socketPath is replaced only when it is a stale socket;
+    // any other file, or a socket a server still accepts on, is left alone.
+    bool listen(std::string& error);
+
+    // Serve until SIGINT/SIGTERM or requestStop()
+    void run();
+    static void requestStop();
+
+    // Handle one request line and return its reply (without the newline)
+    std::string handle(const std::string& line);
+
+    const ServerStats& getStats() const { return stats; }
+};
+
+#endif
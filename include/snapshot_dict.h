@@ -0,0 +1,167 @@
+#ifndef SNAPSHOT_DICT_H
+#define SNAPSHOT_DICT_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+
+#include "tst.h"
+
+/**
+ * DictionarySnapshot - One immutable version of words, scores and graph
+ * Data Structure: Frozen TST + hash-sharded, copy-on-write maps
+ *
+ * Purpose: Everything a completion query reads, frozen at publish time.
+ * Versions share structure: the TST shares every node the writer did not
+ * touch, and each frequency or graph shard is shared until the writer
+ * modifies a key in it.
+ *
+ * Time Complexity:
+ * - frequency / edgeWeight: O(1) average
+ * - complete: O(prefix search + candidates * log k)
+ */
+struct DictionarySnapshot {
+    static constexpr size_t SHARDS = 64;
+
+    using FreqShard = std::unordered_map<std::string, int>;
+    using GraphShard = std::unordered_map<std::string, std::unordered_map<std::string, int>>;
+
+    uint64_t version = 0;
+    TST words;
+    std::array<std::shared_ptr<const FreqShard>, SHARDS> frequencies;
+    std::array<std::shared_ptr<const GraphShard>, SHARDS> graph;   // sharded by "from"
+
+    static size_t shardOf(const std::string& key);
+
+    int frequency(const std::string& token) const;
+    int edgeWeight(const std::string& from, const std::string& to) const;
+
+    // Ranker::score of the token's frequency and its edge from lastToken
+    double score(const std::string& token, const std::string& lastToken) const;
+    std::vector<std::pair<std::string, double>> complete(const std::string& prefix, int k,
+                                                         const std::string& lastToken = "") const;
+};
+
+/**
+ * SnapshotDictionary - Lock-free readers, one batching writer
+ * Data Structure: Atomic snapshot pointer + epoch-based reclamation
+ *
+ * Purpose: Let many threads query completions while another learns new
+ * tokens. The writer stages inserts, bumps and edges and publish() swaps
+ * in a new DictionarySnapshot with one atomic store. Readers announce the
+ * current epoch in a per-thread slot, load the pointer and read without
+ * taking any lock or touching a reference count. A replaced snapshot is
+ * retired with the epoch at which it was replaced and deleted once every
+ * active reader has announced a later epoch.
+ *
+ * Usage:
+ *   auto reader = dict.registerReader();     // once per thread
+ *   { auto snap = reader.read(); snap->complete("pri", 5); }
+ *
+ * Time Complexity:
+ * - read: O(1), two atomic stores and one load
+ * - publish: O(changed paths + touched shards + reader slots)
+ */
+class SnapshotDictionary {
+private:
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0};     // 0 while not reading
+        std::atomic<bool> claimed{false};
+    };
+
+public:
+    class ReadGuard;
+
+    // A thread's reader slot; not shareable between threads
+    class Reader {
+    private:
+        SnapshotDictionary* dict;
+        ReaderSlot* slot;
+        int depth;
+
+        friend class SnapshotDictionary;
+        friend class ReadGuard;
+        Reader(SnapshotDictionary* dict, ReaderSlot* slot);
+
+    public:
+        Reader(Reader&& other) noexcept;
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        Reader& operator=(Reader&&) = delete;
+        ~Reader();
+
+        // Pin the current snapshot for as long as the guard lives
+        ReadGuard read();
+    };
+
+    class ReadGuard {
+    private:
+        Reader* reader;
+        const DictionarySnapshot* snapshot;
+
+        friend class Reader;
+        ReadGuard(Reader* reader, const DictionarySnapshot* snapshot);
+
+    public:
+        ReadGuard(ReadGuard&& other) noexcept;
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        ~ReadGuard();
+
+        const DictionarySnapshot* operator->() const { return snapshot; }
+        const DictionarySnapshot& operator*() const { return *snapshot; }
+    };
+
+private:
+    std::atomic<const DictionarySnapshot*> current;
+    std::atomic<uint64_t> globalEpoch;
+    std::unique_ptr<ReaderSlot[]> slots;
+    size_t slotCount;
+
+    // Writer state, guarded by writerMutex
+    std::mutex writerMutex;
+    TST working;
+    std::array<std::shared_ptr<DictionarySnapshot::FreqShard>, DictionarySnapshot::SHARDS> frequencies;
+    std::array<std::shared_ptr<DictionarySnapshot::GraphShard>, DictionarySnapshot::SHARDS> graph;
+    std::array<bool, DictionarySnapshot::SHARDS> freqCopied;
+    std::array<bool, DictionarySnapshot::SHARDS> graphCopied;
+    size_t pendingChanges;
+    uint64_t version;
+    std::vector<std::pair<uint64_t, const DictionarySnapshot*>> retired;
+
+    DictionarySnapshot::FreqShard& writableFreqShard(size_t shard);
+    DictionarySnapshot::GraphShard& writableGraphShard(size_t shard);
+    size_t reclaimLocked();
+
+public:
+    explicit SnapshotDictionary(size_t maxReaders = 64);
+    ~SnapshotDictionary();
+    SnapshotDictionary(const SnapshotDictionary&) = delete;
+    SnapshotDictionary& operator=(const SnapshotDictionary&) = delete;
+
+    // Claim a reader slot; throws std::runtime_error when all are in use
+    Reader registerReader();
+
+    // Writer side: staged until publish()
+    void insert(const std::string& word);
+    void bump(const std::string& token, int amount = 1);
+    void addEdge(const std::string& from, const std::string& to, int weight = 1);
+
+    // Make staged changes visible to new reads; returns the new version
+    uint64_t publish();
+    size_t pendingCount();
+
+    // Delete retired snapshots no reader can still see; returns how many
+    size_t reclaim();
+    size_t retiredCount();
+    uint64_t currentVersion() const;
+};
+
+#endif
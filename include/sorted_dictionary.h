@@ -0,0 +1,133 @@
+#ifndef SORTED_DICTIONARY_H
+#define SORTED_DICTIONARY_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+#include "memory_usage.h"
+
+/**
+ * SortedDictionary - Read-mostly word set kept as one sorted, front-coded array
+ * Data Structure: Front-coded string blocks + Eytzinger-ordered index over
+ * the block heads + sparse table of range maxima over word weights, with
+ * the words added and erased since the last rebuild kept in side sets
+ *
+ * Purpose: All the words with a given prefix sit in one contiguous run of
+ * a sorted array, so a prefix query is two lower bounds: the prefix, and
+ * the first string past every word that starts with it. Words are stored
+ * in blocks of BLOCK, the first in full and the rest as the length shared
+ * with the word before plus the remaining bytes, so the array costs little
+ * more than the distinct suffixes. Lower bounds descend over the block
+ * heads laid out in Eytzinger (breadth-first) order: the next probe is
+ * always at 2k or 2k + 1, picked without a branch from a compare of the
+ * heads' first eight bytes, and the top of the tree shares a few cache
+ * lines. Only the one block the search lands in is decoded.
+ *
+ * With weights set (the engine uses token frequencies), prefixSearch
+ * returns the k heaviest words of the run instead of the first k, popping
+ * range maxima from a sparse table over per-block maxima. Weights are
+ * sampled when a word enters the array (at a rebuild) or the pending set
+ * (at insert), never during a query. Pending words are also kept heaviest
+ * first, so a query walks them in byte order and in weight order side by
+ * side and stops with whichever settles its k first. Changes go to the
+ * side sets, which queries merge in, and the array is rebuilt once they
+ * reach an eighth of it (MIN_REBUILD at least). Same interface as TST.
+ *
+ * Time Complexity (n = words, m = word length, B = BLOCK, d = pending changes):
+ * - search: O(m log n) over the block heads + O(B * m) to decode one block
+ * - prefixSearch: two searches + O(k log k) range-max pops, each O(B * m),
+ *   + O(min(pending matches, pending words walked by weight to find k))
+ * - insert / erase: a search + O(log d), and an O(n m) rebuild every n / 8 changes
+ */
+class SortedDictionary {
+public:
+    static constexpr size_t BLOCK = 16;
+    static constexpr size_t MIN_REBUILD = 1024;
+    using WeightFn = std::function<int(const std::string&)>;
+
+private:
+    // Entries of varint shared length, varint suffix length, suffix bytes.
+    // The shared length is 0 at every block head, so the array also
+    // decodes straight through from one block into the next.
+    std::vector<char> data;
+    std::vector<uint32_t> blockOffset;
+    size_t count;                               // words in the array
+    // Block heads in Eytzinger order from index 1: the first eight bytes
+    // big-endian, compared as one integer, and the block the head starts
+    std::vector<uint64_t> headKey;
+    std::vector<uint32_t> headBlock;
+    // weights[i] for the i-th word; sparse[j][b] is the heaviest word in
+    // blocks b .. b + 2^j - 1. Both empty while no weights are set.
+    std::vector<int> weights;
+    std::vector<std::vector<uint32_t>> sparse;
+    WeightFn weightOf;
+
+    // Present, not in the array: word -> weight sampled when it was added
+    using Pending = std::map<std::string, int>;
+    struct HeavierPending {
+        bool operator()(Pending::const_iterator a, Pending::const_iterator b) const {
+            return a->second != b->second ? a->second > b->second : a->first < b->first;
+        }
+    };
+    Pending added;
+    std::set<Pending::const_iterator, HeavierPending> addedByWeight;   // empty while no weights are set
+    std::unordered_set<std::string> removed;    // in the array, erased since
+
+    static uint64_t keyOf(const char* s, size_t length);
+    const char* headOf(size_t block, size_t& length) const;
+    bool headLess(size_t k, const std::string& key, uint64_t key8) const;
+    size_t firstBlockNotLess(const std::string& key) const;
+    size_t lowerBound(const std::string& key) const;
+    bool inArray(const std::string& word) const;
+
+    size_t decodeNext(size_t pos, std::string& word) const;
+    size_t seek(size_t index, std::string& word) const;
+    std::string wordAt(size_t index) const;
+
+    bool heavier(uint32_t a, uint32_t b) const {
+        return weights[a] > weights[b] || (weights[a] == weights[b] && a < b);
+    }
+    uint32_t heaviest(size_t lo, size_t hi) const;
+
+    void build(const std::vector<std::string>& sorted);
+    void sampleWeights();
+    void addPending(const std::string& word);
+    bool erasePending(const std::string& word);
+    void clearPending();
+    void rebuildIfBehind();
+
+public:
+    SortedDictionary();
+
+    void insert(const std::string& word);
+    // Up to k words starting with prefix: the heaviest first when weights
+    // are set (ties in order), otherwise the first k in byte order
+    std::vector<std::string> prefixSearch(const std::string& prefix, int k = 10) const;
+    bool search(const std::string& word) const;
+    bool erase(const std::string& word);
+    void clear();
+
+    // Fold the pending changes into a new array now
+    void compact();
+    // Compact when pending changes exceed threshold (a fraction of the array)
+    bool compactIfFragmented(double threshold = 0.25);
+
+    // Rank prefix matches by weight; takes effect now and is sampled again
+    // on every rebuild. An empty function goes back to byte order.
+    void setWeights(WeightFn weight);
+
+    size_t wordCount() const { return count + added.size() - removed.size(); }
+    size_t pendingCount() const { return added.size() + removed.size(); }
+    size_t blockCount() const { return blockOffset.size(); }
+    void getAllWords(std::vector<std::string>& results) const;
+
+    MemoryUsage memoryUsage() const;
+};
+
+#endif
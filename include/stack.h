@@ -1,22 +1,80 @@
 #ifndef STACK_H
 #define STACK_H
 
-#include <stack>
+#include <deque>
+#include <vector>
 #include <string>
-#include <utility>
+#include <cstddef>
 
+/**
+ * EditDelta - one reversible edit
+ *
+ * At (line, col) the text `removed` was replaced by `inserted`. Either side
+ * may be empty: a keystroke is a pure insert, a backspace a pure delete.
+ * Both strings may contain '\n' when the edit splits or joins lines.
+ */
+struct EditDelta {
+    int line;
+    int col;
+    std::string removed;
+    std::string inserted;
+    bool sealed;        // no further keystrokes are coalesced into this entry
+    bool reversed;      // `removed` is held back to front while a backspace run grows
+
+    EditDelta(int l, int c, const std::string& r, const std::string& i)
+        : line(l), col(c), removed(r), inserted(i), sealed(false), reversed(false) {}
+};
+
+/**
+ * UndoRedoStack - delta-based, memory-bounded edit history
+ * Data Structure: Deque (undo, oldest at front) + Vector (redo)
+ *
+ * Consecutive keystrokes on the same line coalesce into a single entry, and
+ * the oldest history is evicted once the byte budget is exceeded. A run of
+ * backspaces grows its text at the front, so it is kept reversed and
+ * appended to, then turned the right way round once when the entry is
+ * sealed or undone.
+ *
+ * Time Complexity:
+ * - record: O(delta size), amortized O(1) per coalesced keystroke
+ * - undo/redo: O(delta size)
+ */
 class UndoRedoStack {
 private:
-    std::stack<std::pair<int, std::string>> undoStack;
-    std::stack<std::pair<int, std::string>> redoStack;
+    std::deque<EditDelta> undoStack;
+    std::vector<EditDelta> redoStack;
+    size_t maxBytes;
+    size_t usedBytes;
+
+    static size_t deltaBytes(const EditDelta& delta);
+    static void settle(EditDelta& delta);
+    bool tryCoalesce(int line, int col, const std::string& removed, const std::string& inserted);
+    void enforceBudget();
 
 public:
+    static const size_t DEFAULT_MAX_BYTES = 1 << 20;
+
+    explicit UndoRedoStack(size_t maxBytes = DEFAULT_MAX_BYTES);
+
+    // Record that `removed` at (line, col) was replaced by `inserted`
+    void record(int line, int col, const std::string& removed, const std::string& inserted);
+
+    // Record a standalone insertion that never coalesces with its neighbours
     void pushInsert(int position, const std::string& text);
-    std::pair<int, std::string> undo();
-    std::pair<int, std::string> redo();
+
+    // Close the newest entry so the next edit starts a new undo step
+    void seal();
+
+    EditDelta undo();
+    EditDelta redo();
     bool canUndo() const { return !undoStack.empty(); }
     bool canRedo() const { return !redoStack.empty(); }
     void clearRedo();
+    void clear();
+
+    void setMaxBytes(size_t bytes);
+    size_t bytesUsed() const { return usedBytes; }
+    size_t undoDepth() const { return undoStack.size(); }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,64 @@
+#ifndef SUBSTRING_SESSION_H
+#define SUBSTRING_SESSION_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include <cstdint>
+
+// A vocabulary word containing the query, and where it first does
+struct SubstringCandidate {
+    uint32_t id;        // index into the session's vocabulary
+    uint32_t offset;    // first occurrence of the query in the word
+};
+
+/**
+ * SubstringSession - Substring matches narrowed keystroke by keystroke
+ * Data Structure: Stack of candidate sets, one per query the user typed
+ *
+ * Purpose: Every word containing "abc" also contains "ab", at or after the
+ * place "ab" first occurs, so typing a character only has to re-check the
+ * words that matched before - usually right at their stored offset. Each
+ * query's set is kept on a small stack, so backspace pops back to the
+ * previous set without scanning at all, and only a query that shares no
+ * retained prefix with the last ones scans the whole vocabulary.
+ *
+ * Time Complexity (V = vocabulary, C = candidates of the longest retained prefix):
+ * - update on append: O(C) (plus a short find for words whose match moved)
+ * - update on backspace: O(1) while the shorter query is retained
+ * - update otherwise: O(total vocabulary length)
+ */
+class SubstringSession {
+public:
+    static const size_t MAX_LEVELS = 16;
+
+private:
+    struct Level {
+        std::string query;
+        std::vector<SubstringCandidate> candidates;
+    };
+
+    const std::vector<std::string>* words;
+    std::deque<Level> levels;           // each query extends the one below it
+    size_t scanned;
+
+    void scanAll(const std::string& query, std::vector<SubstringCandidate>& out);
+    void narrow(const Level& from, const std::string& query, std::vector<SubstringCandidate>& out);
+
+public:
+    explicit SubstringSession(const std::vector<std::string>* vocabulary = nullptr);
+
+    // Start over on a new (or changed) vocabulary; it must outlive the session
+    void reset(const std::vector<std::string>* vocabulary);
+
+    // Words containing query, in vocabulary order; valid until the next call
+    const std::vector<SubstringCandidate>& update(const std::string& query);
+
+    const std::string& word(const SubstringCandidate& candidate) const { return (*words)[candidate.id]; }
+    // Words examined by the last update, to check that narrowing happened
+    size_t lastScanned() const { return scanned; }
+    size_t depth() const { return levels.size(); }
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef SUGGEST_WORKER_H
+#define SUGGEST_WORKER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+/**
+ * SuggestWorker - Computes autocomplete suggestions off the input thread
+ * Data Structure: Single-slot request mailbox + FIFO task queue
+ *
+ * Purpose: Keep keystroke handling constant-time regardless of how slow a
+ * query is. Requests coalesce: only the newest prefix is ever computed, and
+ * every request gets a sequence number so results for superseded prefixes
+ * are dropped. Mutations of the shared dictionary (accepts, learned phrases)
+ * are posted as tasks and run on the worker in order, so the data
+ * structures are only ever touched from one thread.
+ *
+ * Time Complexity (caller side):
+ * - request / post / poll: O(1) plus copying the prefix or result
+ */
+class SuggestWorker {
+public:
+    using ComputeFn = std::function<std::vector<std::string>(const std::string&)>;
+
+    struct Result {
+        uint64_t seq;
+        std::string prefix;
+        std::vector<std::string> suggestions;
+    };
+
+private:
+    ComputeFn compute;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> tasks;
+    bool hasRequest;
+    std::string requestPrefix;
+    uint64_t requestSeq;
+    bool hasResult;
+    Result result;
+    bool stopping;
+    bool busy;
+    uint64_t latestSeq;
+
+    std::thread thread;
+
+    void loop();
+
+public:
+    explicit SuggestWorker(ComputeFn fn);
+    ~SuggestWorker();
+    SuggestWorker(const SuggestWorker&) = delete;
+    SuggestWorker& operator=(const SuggestWorker&) = delete;
+
+    // Ask for suggestions for prefix, superseding any request not yet started
+    uint64_t request(const std::string& prefix);
+
+    // Drop the outstanding request; its result will be discarded on arrival
+    void cancel();
+
+    // Run task on the worker thread, after previously posted tasks
+    void post(std::function<void()> task);
+
+    // Fetch the result for the newest request, if it has arrived
+    bool poll(Result& out);
+
+    // True while a request is queued or being computed
+    bool pending() const;
+
+    // Finish queued tasks and join the thread; no further work is accepted
+    void stop();
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef SYMBOL_INDEX_H
+#define SYMBOL_INDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+#include "tst.h"
+#include "line_tree.h"
+
+// An identifier of the current document that completes a prefix
+struct LocalSymbol {
+    std::string word;
+    uint32_t count;         // occurrences in the document
+    size_t distance;        // lines to the nearest occurrence (RADIUS when farther)
+    double score;
+};
+
+/**
+ * SymbolIndex - Identifiers defined and used in the document being edited
+ * Data Structure: Per-line symbol id lists in a LineTree + counted local TST
+ *
+ * Purpose: Offer the locals, fields and helpers of the open file before
+ * anyone has learned them into the global dictionary. Each line keeps the
+ * ids of the identifiers on it; re-tokenizing an edited line adds its new
+ * identifiers and releases its old ones, so a name enters the local trie
+ * when its first occurrence appears and leaves it with its last. The lists
+ * live in a LineTree, so lines inserted or erased anywhere renumber the
+ * ones below without moving them, and an edit costs time for the lines it
+ * touched only. Completions are
+ * ranked by occurrences, boosted by how close the nearest one is to the
+ * cursor (found by scanning at most RADIUS lines either way).
+ *
+ * Time Complexity (n = document lines, L = identifiers on the edited line,
+ * C = prefix matches):
+ * - updateLine: O(log n + L * identifier length) expected
+ * - linesInserted / linesErased: O(log n + lines inserted or erased), plus releasing erased lines
+ * - complete: O(prefix search + RADIUS * (log n + identifiers per line) + C log limit)
+ */
+class SymbolIndex {
+public:
+    static const size_t MIN_LENGTH = 2;         // shorter identifiers are not worth completing
+    static const size_t RADIUS = 256;           // lines searched around the cursor for proximity
+    static constexpr double PROXIMITY_BOOST = 3.0;
+
+private:
+    struct Symbol {
+        std::string name;
+        uint32_t count;
+    };
+
+    TST trie;                                   // names with count > 0
+    std::vector<Symbol> symbols;                // by id
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<uint32_t> freeIds;
+    LineTree<std::vector<uint32_t>> lines;      // ids of the identifiers on each line, in order
+
+    uint32_t acquire(const std::string& name);
+    void release(uint32_t id);
+
+public:
+    void clear();
+
+    // Replace what a line contributes with the identifiers in text
+    void updateLine(size_t line, const std::string& text);
+    // count new (empty) lines now start at `at`; lines from `at` on move down
+    void linesInserted(size_t at, size_t count);
+    // Lines [at, at + count) are gone, with their identifiers
+    void linesErased(size_t at, size_t count);
+
+    // Identifiers starting with prefix (other than prefix itself), best
+    // first: occurrences, boosted when one is near cursorLine
+    std::vector<LocalSymbol> complete(const std::string& prefix, size_t cursorLine, size_t limit) const;
+
+    size_t symbolCount() const { return ids.size(); }
+    uint32_t occurrences(const std::string& name) const;
+
+    // Identifiers in text: [A-Za-z_][A-Za-z0-9_]*, at least MIN_LENGTH long
+    static void tokenize(const std::string& text, std::vector<std::string>& out);
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef SYNTAX_H
+#define SYNTAX_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+enum TokenKind : uint8_t {
+    TOKEN_PLAIN,
+    TOKEN_KEYWORD,
+    TOKEN_STRING,
+    TOKEN_COMMENT,
+    TOKEN_NUMBER,
+    TOKEN_PREPROCESSOR,
+    TOKEN_OPERATOR
+};
+
+struct SyntaxToken {
+    uint32_t start;
+    uint32_t length;
+    TokenKind kind;
+};
+
+// Lexer state carried from the end of one line into the next
+struct LexState {
+    enum Mode : uint8_t { NORMAL, BLOCK_COMMENT, RAW_STRING };
+
+    Mode mode;
+    std::string rawDelimiter;   // the d-char sequence of an open R"delim( string
+
+    LexState() : mode(NORMAL) {}
+    bool operator==(const LexState& other) const {
+        return mode == other.mode && rawDelimiter == other.rawDelimiter;
+    }
+    bool operator!=(const LexState& other) const { return !(*this == other); }
+};
+
+struct LineTokens {
+    bool valid;
+    uint64_t version;           // changes every time the line is re-lexed
+    LexState in;
+    LexState out;
+    std::vector<SyntaxToken> tokens;
+
+    LineTokens() : valid(false), version(0) {}
+};
+
+/**
+ * SyntaxHighlighter - Incremental C/C++ tokenizer with a windowed token cache
+ * Data Structure: Lexer state checkpoints every CHECKPOINT lines + a window
+ * of cached token lines around the viewport + perfect hash keyword table
+ *
+ * Purpose: Highlighting work is proportional to edited lines, not to
+ * visible lines times frames, and memory does not grow with the file.
+ * Tokens are cached only for the WINDOW lines around the last line asked
+ * for; the rest of the document keeps just the lexer state entering every
+ * CHECKPOINT-th line. A line outside the window is lexed from the nearest
+ * checkpoint above it, so scrolling anywhere below validUpTo costs at most
+ * CHECKPOINT lines of lexing. A cached line is re-lexed only when it was
+ * edited or the state flowing into it changed (e.g. a block comment opened
+ * above). Lines below validUpTo are known to be consistent with their
+ * predecessor, and there is a checkpoint for every multiple of CHECKPOINT
+ * up to it.
+ *
+ * An edit drops the checkpoints below it and, inside the window, shifts
+ * the cached lines; nothing outside the window moves.
+ *
+ * Time Complexity (W = WINDOW, K = CHECKPOINT):
+ * - isKeyword: O(word length), one probe into a constexpr perfect hash
+ * - lineTokens: O(1) for a cached line, O(K line lengths) for any other
+ *   line above validUpTo, plus the lines from validUpTo down to it
+ * - invalidate / linesInserted / linesErased: O(W), plus the checkpoints dropped
+ */
+class SyntaxHighlighter {
+public:
+    static constexpr size_t CHECKPOINT = 128;
+    static constexpr size_t WINDOW = 512;
+
+private:
+    std::vector<LexState> checkpoints;      // [c]: state entering line c * CHECKPOINT
+    std::vector<LineTokens> window;         // lines windowStart .. windowStart + WINDOW - 1
+    size_t windowStart;
+    size_t validUpTo;
+    uint64_t nextVersion;
+    std::vector<SyntaxToken> scratch;       // tokens of lines lexed outside the window
+
+    bool inWindow(size_t line) const {
+        return line >= windowStart && line - windowStart < window.size();
+    }
+    void moveWindow(size_t line);
+    void dropCheckpointsAfter(size_t line);
+
+public:
+    SyntaxHighlighter();
+
+    static bool isKeyword(const char* word, size_t length);
+
+    // Tokenize one line starting in state `in`; returns the state at its end
+    static LexState lexLine(const std::string& line, const LexState& in,
+                            std::vector<SyntaxToken>& tokens);
+
+    // Cached tokens for a line, re-lexing it (and any stale lines above) as
+    // needed. The reference stays valid until the next call.
+    const LineTokens& lineTokens(size_t line, const std::function<std::string(size_t)>& getLine);
+
+    // Edit notifications from the buffer owner. The cache only reaches as far
+    // as lines were asked for, so a new document starts it empty.
+    void reset();
+    void invalidate(size_t line);
+    void linesInserted(size_t at, size_t count);
+    void linesErased(size_t at, size_t count);
+};
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "line_index.h"
+
+// One contiguous run of text taken from either the original or the add buffer.
+// Pieces live in an implicit treap ordered by document position; every node
+// caches the total length and line-break count of its subtree.
+struct PieceNode {
+    int buffer;
+    size_t start;
+    size_t length;
+    size_t lineBreaks;
+
+    size_t subLength;
+    size_t subLineBreaks;
+    uint32_t priority;
+    PieceNode* left;
+    PieceNode* right;
+
+    PieceNode(int b, size_t s, size_t len, size_t breaks, uint32_t prio)
+        : buffer(b), start(s), length(len), lineBreaks(breaks),
+          subLength(len), subLineBreaks(breaks), priority(prio),
+          left(nullptr), right(nullptr) {}
+};
+
+/**
+ * TextBuffer - Piece table document storage for the editor
+ * Data Structure: Append-only buffers + Treap of pieces + newline index
+ *
+ * Purpose: Keep edits independent of file size. The loaded file is never
+ * copied or shifted; inserted text is appended to an add buffer and the
+ * document is described by a balanced sequence of pieces. The add buffer
+ * keeps the sorted offsets of its '\n' characters, so a piece's line-break
+ * count is two binary searches and line lookup is a single treap descent.
+ *
+ * open() maps the file read-only instead of reading it, and its newlines
+ * are counted per block by a LineIndex on a background thread. Until that
+ * finishes the document is one untouched piece: lineCount() covers the
+ * lines indexed so far and line lookups scan ahead of the index, so the
+ * first screen can be drawn at once. Memory grows with the edits and the
+ * line index (8 bytes per 4 KB), not with the file.
+ *
+ * Time Complexity (n = pieces, B = LineIndex::BLOCK):
+ * - lineStart / offsetOf / lineAt: O(log n), plus O(B) inside the original file
+ * - insert / erase: O(log n) plus the inserted text
+ * - line(i): O(log n + line length)
+ */
+class TextBuffer {
+private:
+    static const int ORIGINAL = 0;
+    static const int ADDED = 1;
+
+    std::string original;           // load(): the document is a copy
+    const char* originalData;       // original.data() or the mapped file
+    size_t originalSize;
+    void* mapping;
+    size_t mappingSize;
+    LineIndex originalBreaks;
+    bool indexing;                  // open() has not finished counting lines
+
+    std::string added;
+    std::vector<size_t> addedBreaks;
+
+    PieceNode* root;
+    uint32_t seed;
+    size_t pieces;
+
+    const char* bufferData(int buffer) const;
+    size_t countBreaks(int buffer, size_t start, size_t length) const;
+    size_t findBreak(int buffer, size_t start, size_t k) const;
+    void release();
+
+    uint32_t nextPriority();
+    PieceNode* makeNode(int buffer, size_t start, size_t length);
+    static size_t subLength(PieceNode* node);
+    static size_t subLineBreaks(PieceNode* node);
+    static void update(PieceNode* node);
+    void split(PieceNode* node, size_t offset, PieceNode*& left, PieceNode*& right);
+    static PieceNode* merge(PieceNode* left, PieceNode* right);
+    bool extendRightmost(PieceNode* node, size_t count);
+    void destroy(PieceNode* node);
+
+    void collect(PieceNode* node, size_t nodeOffset, size_t from, size_t to, std::string& out) const;
+    void visit(PieceNode* node, const std::function<void(const char*, size_t)>& fn) const;
+    static void indexBreaks(const std::string& text, size_t base, std::vector<size_t>& breaks);
+
+public:
+    TextBuffer();
+    ~TextBuffer();
+    TextBuffer(const TextBuffer&) = delete;
+    TextBuffer& operator=(const TextBuffer&) = delete;
+
+    // Replace the whole document with a copy of content
+    void load(const std::string& content);
+    // Replace the whole document with a read-only mapping of a file; lines
+    // are indexed in the background (see loading())
+    bool open(const std::string& path, std::string& error);
+
+    // True until open()'s line index is complete; lineCount() grows meanwhile
+    bool loading() const { return indexing; }
+    double loadProgress() const { return indexing ? originalBreaks.progress() : 1.0; }
+    // Finish loading if the index is complete; true on the call that does
+    bool pollLoading();
+    // Wait for the index; edits call this first
+    void finishLoading();
+
+    size_t length() const { return subLength(root); }
+    size_t lineCount() const;
+
+    // Offset of the first character of a line, and of (line, col)
+    size_t lineStart(size_t line) const;
+    size_t lineLength(size_t line) const;
+    size_t offsetOf(size_t line, size_t col) const { return lineStart(line) + col; }
+    // Line holding the character at offset (the last line for offset == length())
+    size_t lineAt(size_t offset) const;
+
+    std::string line(size_t line) const;
+    std::string substring(size_t offset, size_t count) const;
+    std::string text() const;
+
+    void insert(size_t offset, const std::string& text);
+    void erase(size_t offset, size_t count);
+
+    // Write the document to a new file beside path (mkstemp, path.XXXXXX),
+    // then fsync it and rename it over path: a crash leaves either the old
+    // file or the new one. The mode of the old file carries over.
+    bool save(const std::string& path, std::string& error) const;
+
+    // Visit the document as contiguous segments, in order
+    void forEachSegment(const std::function<void(const char*, size_t)>& fn) const;
+    size_t pieceCount() const;
+};
+
+#endif
@@ -4,36 +4,82 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
+
+#include "memory_usage.h"
 
 struct TSTNode {
     char data;
     bool isEndOfString;
+    // Generation of the tree allowed to modify this node in place (see freeze)
+    uint32_t owner;
     std::shared_ptr<TSTNode> left;
     std::shared_ptr<TSTNode> eq;
     std::shared_ptr<TSTNode> right;
     
-    TSTNode(char c) : data(c), isEndOfString(false), 
+    TSTNode(char c, uint32_t owner = 0) : data(c), isEndOfString(false), owner(owner),
                     left(nullptr), eq(nullptr), right(nullptr) {}
 };
 
 class TST {
 private:
     std::shared_ptr<TSTNode> root;
+    size_t nodes;
+    size_t words;
+    // Nodes that end no word and lead to none, kept only because both
+    // sibling links are in use; compact() drops them
+    size_t deadNodes;
+    // Nodes with another owner are shared with a frozen copy and are
+    // copied before being modified
+    uint32_t generation;
+
+    std::shared_ptr<TSTNode> own(const std::shared_ptr<TSTNode>& node);
     
     std::shared_ptr<TSTNode> insertUtil(std::shared_ptr<TSTNode> node, 
                                         const std::string& word, int index);
+
+    std::shared_ptr<TSTNode> eraseUtil(std::shared_ptr<TSTNode> node,
+                                       const std::string& word, size_t index, bool& erased);
+
+    std::shared_ptr<TSTNode> buildBalanced(const std::vector<std::string>& sorted,
+                                           size_t lo, size_t hi, size_t depth);
     
-    void collectWords(std::shared_ptr<TSTNode> node, 
+    // Read paths use raw pointers so concurrent readers of a frozen tree
+    // never touch the shared reference counts
+    void collectWords(const TSTNode* node, 
                     std::string prefix, 
-                    std::vector<std::string>& results);
+                    std::vector<std::string>& results) const;
     
-    std::shared_ptr<TSTNode> searchPrefix(const std::string& prefix);
+    const TSTNode* searchPrefix(const std::string& prefix) const;
 
 public:
     TST();
     void insert(const std::string& word);
-    std::vector<std::string> prefixSearch(const std::string& prefix, int k = 10);
-    bool search(const std::string& word);
-    void getAllWords(std::vector<std::string>& results);
+    std::vector<std::string> prefixSearch(const std::string& prefix, int k = 10) const;
+    bool search(const std::string& word) const;
+    // Remove word and prune the nodes only it used; false if it was not present
+    bool erase(const std::string& word);
+
+    // Rebuild a balanced tree from the live words, dropping dead nodes
+    void compact();
+    // Compact when dead nodes exceed threshold (a fraction of all nodes)
+    bool compactIfFragmented(double threshold = DEFAULT_COMPACT_THRESHOLD);
+
+    static constexpr double DEFAULT_COMPACT_THRESHOLD = 0.25;
+
+    size_t nodeCount() const { return nodes; }
+    size_t wordCount() const { return words; }
+    size_t deadNodeCount() const { return deadNodes; }
+    double fragmentation() const { return nodes ? (double)deadNodes / nodes : 0.0; }
+    void getAllWords(std::vector<std::string>& results) const;
+
+    // Heap held by the nodes; nodes shared with a frozen copy are counted in both
+    MemoryUsage memoryUsage() const;
+
+    // Return a copy sharing every node with this tree. Neither tree changes
+    // a node that existed at the time of the call: later inserts and erases
+    // copy the path they modify, so the returned copy is immutable in
+    // practice and safe to read from other threads while this one is written.
+    TST freeze();
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,684 @@
+#include "../include/art.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ART_SSE2 1
+#endif
+
+namespace {
+
+const size_t MAX_PREFIX = ArtNode::MAX_PREFIX;
+
+// A node grown or shrunk into another size keeps everything but its children
+void copyHeader(ArtNode* to, const ArtNode* from) {
+    to->count = from->count;
+    to->prefixLength = from->prefixLength;
+    std::memcpy(to->prefix, from->prefix, MAX_PREFIX);
+    to->end = from->end;
+}
+
+// Slot of the first key greater than byte in a sorted Node16
+size_t insertPosition(const ArtNode16* node, unsigned char byte) {
+#ifdef ART_SSE2
+    // SSE2 only compares signed bytes; flipping the top bit orders them as unsigned
+    const __m128i flip = _mm_set1_epi8((char)0x80);
+    __m128i keys = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(node->keys)), flip);
+    __m128i less = _mm_cmplt_epi8(keys, _mm_xor_si128(_mm_set1_epi8((char)byte), flip));
+    unsigned mask = (unsigned)_mm_movemask_epi8(less) & ((1u << node->count) - 1);
+    return (size_t)__builtin_popcount(mask);
+#else
+    size_t i = 0;
+    while (i < node->count && node->keys[i] < byte) i++;
+    return i;
+#endif
+}
+
+}
+
+AdaptiveRadixTree::AdaptiveRadixTree() : root(nullptr), words(0), innerNodes() {}
+
+AdaptiveRadixTree::~AdaptiveRadixTree() {
+    destroy(root);
+}
+
+AdaptiveRadixTree::AdaptiveRadixTree(AdaptiveRadixTree&& other) noexcept
+    : root(other.root), words(other.words) {
+    std::copy(other.innerNodes, other.innerNodes + 4, innerNodes);
+    other.root = nullptr;
+    other.words = 0;
+    std::fill(other.innerNodes, other.innerNodes + 4, 0);
+}
+
+AdaptiveRadixTree& AdaptiveRadixTree::operator=(AdaptiveRadixTree&& other) noexcept {
+    if (this != &other) {
+        destroy(root);
+        root = other.root;
+        words = other.words;
+        std::copy(other.innerNodes, other.innerNodes + 4, innerNodes);
+        other.root = nullptr;
+        other.words = 0;
+        std::fill(other.innerNodes, other.innerNodes + 4, 0);
+    }
+    return *this;
+}
+
+void AdaptiveRadixTree::clear() {
+    destroy(root);
+    root = nullptr;
+    words = 0;
+    std::fill(innerNodes, innerNodes + 4, 0);
+}
+
+ArtNode* AdaptiveRadixTree::allocate(ArtNode::Type type) {
+    innerNodes[type]++;
+    switch (type) {
+    case ArtNode::NODE4: return new ArtNode4();
+    case ArtNode::NODE16: return new ArtNode16();
+    case ArtNode::NODE48: return new ArtNode48();
+    default: return new ArtNode256();
+    }
+}
+
+void AdaptiveRadixTree::release(ArtNode* node) {
+    innerNodes[node->type]--;
+    switch (node->type) {
+    case ArtNode::NODE4: delete static_cast<ArtNode4*>(node); break;
+    case ArtNode::NODE16: delete static_cast<ArtNode16*>(node); break;
+    case ArtNode::NODE48: delete static_cast<ArtNode48*>(node); break;
+    default: delete static_cast<ArtNode256*>(node); break;
+    }
+}
+
+void AdaptiveRadixTree::destroy(void* ref) {
+    if (ref == nullptr) return;
+    if (isLeaf(ref)) {
+        delete leafOf(ref);
+        return;
+    }
+    ArtNode* node = static_cast<ArtNode*>(ref);
+    delete node->end;
+    switch (node->type) {
+    case ArtNode::NODE4: {
+        auto n = static_cast<ArtNode4*>(node);
+        for (size_t i = 0; i < n->count; i++) destroy(n->children[i]);
+        break;
+    }
+    case ArtNode::NODE16: {
+        auto n = static_cast<ArtNode16*>(node);
+        for (size_t i = 0; i < n->count; i++) destroy(n->children[i]);
+        break;
+    }
+    case ArtNode::NODE48: {
+        auto n = static_cast<ArtNode48*>(node);
+        for (void* child : n->children) destroy(child);
+        break;
+    }
+    default: {
+        auto n = static_cast<ArtNode256*>(node);
+        for (void* child : n->children) destroy(child);
+        break;
+    }
+    }
+    release(node);
+}
+
+void** AdaptiveRadixTree::findChild(ArtNode* node, unsigned char byte) {
+    switch (node->type) {
+    case ArtNode::NODE4: {
+        auto n = static_cast<ArtNode4*>(node);
+        for (size_t i = 0; i < n->count; i++) {
+            if (n->keys[i] == byte) return &n->children[i];
+        }
+        return nullptr;
+    }
+    case ArtNode::NODE16: {
+        auto n = static_cast<ArtNode16*>(node);
+#ifdef ART_SSE2
+        // All sixteen keys against the byte at once; unused slots are masked off
+        __m128i hits = _mm_cmpeq_epi8(_mm_set1_epi8((char)byte),
+                                      _mm_load_si128(reinterpret_cast<const __m128i*>(n->keys)));
+        unsigned mask = (unsigned)_mm_movemask_epi8(hits) & ((1u << n->count) - 1);
+        return mask ? &n->children[__builtin_ctz(mask)] : nullptr;
+#else
+        for (size_t i = 0; i < n->count; i++) {
+            if (n->keys[i] == byte) return &n->children[i];
+        }
+        return nullptr;
+#endif
+    }
+    case ArtNode::NODE48: {
+        auto n = static_cast<ArtNode48*>(node);
+        return n->index[byte] ? &n->children[n->index[byte] - 1] : nullptr;
+    }
+    default: {
+        auto n = static_cast<ArtNode256*>(node);
+        return n->children[byte] ? &n->children[byte] : nullptr;
+    }
+    }
+}
+
+const ArtLeaf* AdaptiveRadixTree::minimumLeaf(const void* ref) {
+    while (ref != nullptr && !isLeaf(ref)) {
+        const ArtNode* node = static_cast<const ArtNode*>(ref);
+        if (node->end) return node->end;
+        switch (node->type) {
+        case ArtNode::NODE4:
+            ref = static_cast<const ArtNode4*>(node)->children[0];
+            break;
+        case ArtNode::NODE16:
+            ref = static_cast<const ArtNode16*>(node)->children[0];
+            break;
+        case ArtNode::NODE48: {
+            auto n = static_cast<const ArtNode48*>(node);
+            size_t b = 0;
+            while (!n->index[b]) b++;
+            ref = n->children[n->index[b] - 1];
+            break;
+        }
+        default: {
+            auto n = static_cast<const ArtNode256*>(node);
+            size_t b = 0;
+            while (!n->children[b]) b++;
+            ref = n->children[b];
+            break;
+        }
+        }
+    }
+    return ref ? leafOf(ref) : nullptr;
+}
+
+// How many bytes of node's prefix match key from depth on; bytes past the
+// stored ones are compared against a leaf, which holds the whole key
+size_t AdaptiveRadixTree::prefixMismatch(const ArtNode* node, const std::string& key, size_t depth) {
+    size_t limit = std::min<size_t>(node->prefixLength, key.size() - depth);
+    size_t stored = std::min(limit, MAX_PREFIX);
+    size_t i = 0;
+    for (; i < stored; i++) {
+        if (node->prefix[i] != key[depth + i]) return i;
+    }
+    if (i < limit) {
+        const std::string& full = minimumLeaf(node)->word;
+        for (; i < limit; i++) {
+            if (full[depth + i] != key[depth + i]) return i;
+        }
+    }
+    return i;
+}
+
+void AdaptiveRadixTree::addChild(void** slot, ArtNode* node, unsigned char byte, void* child) {
+    switch (node->type) {
+    case ArtNode::NODE4: {
+        auto n = static_cast<ArtNode4*>(node);
+        if (n->count < 4) {
+            size_t i = 0;
+            while (i < n->count && n->keys[i] < byte) i++;
+            std::memmove(n->keys + i + 1, n->keys + i, n->count - i);
+            std::memmove(n->children + i + 1, n->children + i, (n->count - i) * sizeof(void*));
+            n->keys[i] = byte;
+            n->children[i] = child;
+            n->count++;
+            return;
+        }
+        auto grown = static_cast<ArtNode16*>(allocate(ArtNode::NODE16));
+        copyHeader(grown, n);
+        std::memcpy(grown->keys, n->keys, 4);
+        std::memcpy(grown->children, n->children, 4 * sizeof(void*));
+        release(n);
+        *slot = grown;
+        addChild(slot, grown, byte, child);
+        return;
+    }
+    case ArtNode::NODE16: {
+        auto n = static_cast<ArtNode16*>(node);
+        if (n->count < 16) {
+            size_t i = insertPosition(n, byte);
+            std::memmove(n->keys + i + 1, n->keys + i, n->count - i);
+            std::memmove(n->children + i + 1, n->children + i, (n->count - i) * sizeof(void*));
+            n->keys[i] = byte;
+            n->children[i] = child;
+            n->count++;
+            return;
+        }
+        auto grown = static_cast<ArtNode48*>(allocate(ArtNode::NODE48));
+        copyHeader(grown, n);
+        for (size_t i = 0; i < 16; i++) {
+            grown->index[n->keys[i]] = (uint8_t)(i + 1);
+            grown->children[i] = n->children[i];
+        }
+        release(n);
+        *slot = grown;
+        addChild(slot, grown, byte, child);
+        return;
+    }
+    case ArtNode::NODE48: {
+        auto n = static_cast<ArtNode48*>(node);
+        if (n->count < 48) {
+            size_t free = 0;
+            while (n->children[free]) free++;
+            n->children[free] = child;
+            n->index[byte] = (uint8_t)(free + 1);
+            n->count++;
+            return;
+        }
+        auto grown = static_cast<ArtNode256*>(allocate(ArtNode::NODE256));
+        copyHeader(grown, n);
+        for (size_t b = 0; b < 256; b++) {
+            if (n->index[b]) grown->children[b] = n->children[n->index[b] - 1];
+        }
+        release(n);
+        *slot = grown;
+        addChild(slot, grown, byte, child);
+        return;
+    }
+    default: {
+        auto n = static_cast<ArtNode256*>(node);
+        n->children[byte] = child;
+        n->count++;
+        return;
+    }
+    }
+}
+
+void AdaptiveRadixTree::removeChild(ArtNode* node, unsigned char byte, void** child) {
+    switch (node->type) {
+    case ArtNode::NODE4: {
+        auto n = static_cast<ArtNode4*>(node);
+        size_t i = child - n->children;
+        std::memmove(n->keys + i, n->keys + i + 1, n->count - i - 1);
+        std::memmove(n->children + i, n->children + i + 1, (n->count - i - 1) * sizeof(void*));
+        break;
+    }
+    case ArtNode::NODE16: {
+        auto n = static_cast<ArtNode16*>(node);
+        size_t i = child - n->children;
+        std::memmove(n->keys + i, n->keys + i + 1, n->count - i - 1);
+        std::memmove(n->children + i, n->children + i + 1, (n->count - i - 1) * sizeof(void*));
+        break;
+    }
+    case ArtNode::NODE48: {
+        auto n = static_cast<ArtNode48*>(node);
+        n->children[n->index[byte] - 1] = nullptr;
+        n->index[byte] = 0;
+        break;
+    }
+    default:
+        static_cast<ArtNode256*>(node)->children[byte] = nullptr;
+        break;
+    }
+    node->count--;
+}
+
+// Move an underfull node down a size, or fold a Node4 into what it leads to.
+// The thresholds sit below the next size's capacity so a node at the edge
+// does not flip back and forth.
+void AdaptiveRadixTree::shrink(void** slot) {
+    ArtNode* node = static_cast<ArtNode*>(*slot);
+    switch (node->type) {
+    case ArtNode::NODE4: {
+        auto n = static_cast<ArtNode4*>(node);
+        if (n->count == 0) {
+            *slot = n->end ? tagLeaf(n->end) : nullptr;
+            release(n);
+        } else if (n->count == 1 && n->end == nullptr) {
+            // One way on: the child takes over this node's prefix and branch byte
+            void* child = n->children[0];
+            if (!isLeaf(child)) {
+                ArtNode* next = static_cast<ArtNode*>(child);
+                char joined[MAX_PREFIX];
+                size_t length = std::min<size_t>(n->prefixLength, MAX_PREFIX);
+                std::memcpy(joined, n->prefix, length);
+                if (length < MAX_PREFIX) joined[length++] = (char)n->keys[0];
+                size_t rest = std::min<size_t>(next->prefixLength, MAX_PREFIX - length);
+                std::memcpy(joined + length, next->prefix, rest);
+                std::memcpy(next->prefix, joined, length + rest);
+                next->prefixLength += n->prefixLength + 1;
+            }
+            *slot = child;
+            release(n);
+        }
+        return;
+    }
+    case ArtNode::NODE16: {
+        auto n = static_cast<ArtNode16*>(node);
+        if (n->count > 3) return;
+        auto smaller = static_cast<ArtNode4*>(allocate(ArtNode::NODE4));
+        copyHeader(smaller, n);
+        std::memcpy(smaller->keys, n->keys, n->count);
+        std::memcpy(smaller->children, n->children, n->count * sizeof(void*));
+        release(n);
+        *slot = smaller;
+        return;
+    }
+    case ArtNode::NODE48: {
+        auto n = static_cast<ArtNode48*>(node);
+        if (n->count > 12) return;
+        auto smaller = static_cast<ArtNode16*>(allocate(ArtNode::NODE16));
+        copyHeader(smaller, n);
+        size_t i = 0;
+        for (size_t b = 0; b < 256; b++) {
+            if (!n->index[b]) continue;
+            smaller->keys[i] = (unsigned char)b;
+            smaller->children[i++] = n->children[n->index[b] - 1];
+        }
+        release(n);
+        *slot = smaller;
+        return;
+    }
+    default: {
+        auto n = static_cast<ArtNode256*>(node);
+        if (n->count > 37) return;
+        auto smaller = static_cast<ArtNode48*>(allocate(ArtNode::NODE48));
+        copyHeader(smaller, n);
+        size_t i = 0;
+        for (size_t b = 0; b < 256; b++) {
+            if (!n->children[b]) continue;
+            smaller->index[b] = (uint8_t)(i + 1);
+            smaller->children[i++] = n->children[b];
+        }
+        release(n);
+        *slot = smaller;
+        return;
+    }
+    }
+}
+
+// Hang leaf under node, whose prefix ends at depth
+void AdaptiveRadixTree::attach(void** slot, ArtNode* node, ArtLeaf* leaf, size_t depth) {
+    if (leaf->word.size() == depth) {
+        node->end = leaf;
+    } else {
+        addChild(slot, node, (unsigned char)leaf->word[depth], tagLeaf(leaf));
+    }
+}
+
+void AdaptiveRadixTree::insert(const std::string& word) {
+    if (word.empty()) return;
+
+    void** slot = &root;
+    size_t depth = 0;
+    while (true) {
+        void* ref = *slot;
+        if (ref == nullptr) {
+            *slot = tagLeaf(new ArtLeaf{word});
+            words++;
+            return;
+        }
+
+        if (isLeaf(ref)) {
+            ArtLeaf* leaf = leafOf(ref);
+            if (leaf->word == word) return;
+
+            // Both words continue below a new node holding what they share
+            size_t limit = std::min(leaf->word.size(), word.size()) - depth;
+            size_t common = 0;
+            while (common < limit && leaf->word[depth + common] == word[depth + common]) {
+                common++;
+            }
+            ArtNode* node = allocate(ArtNode::NODE4);
+            node->prefixLength = (uint32_t)common;
+            std::memcpy(node->prefix, word.data() + depth, std::min(common, MAX_PREFIX));
+            *slot = node;
+            attach(slot, node, leaf, depth + common);
+            attach(slot, node, new ArtLeaf{word}, depth + common);
+            words++;
+            return;
+        }
+
+        ArtNode* node = static_cast<ArtNode*>(ref);
+        if (node->prefixLength > 0) {
+            size_t matched = prefixMismatch(node, word, depth);
+            if (matched < node->prefixLength) {
+                // The word leaves the prefix midway: a new node takes the
+                // shared part and branches to the old node and the word
+                ArtNode* parent = allocate(ArtNode::NODE4);
+                parent->prefixLength = (uint32_t)matched;
+                std::memcpy(parent->prefix, node->prefix, std::min(matched, MAX_PREFIX));
+
+                unsigned char branch;
+                if (node->prefixLength <= MAX_PREFIX) {
+                    branch = (unsigned char)node->prefix[matched];
+                    node->prefixLength -= (uint32_t)(matched + 1);
+                    std::memmove(node->prefix, node->prefix + matched + 1, node->prefixLength);
+                } else {
+                    const std::string& full = minimumLeaf(node)->word;
+                    branch = (unsigned char)full[depth + matched];
+                    node->prefixLength -= (uint32_t)(matched + 1);
+                    std::memcpy(node->prefix, full.data() + depth + matched + 1,
+                                std::min<size_t>(node->prefixLength, MAX_PREFIX));
+                }
+
+                *slot = parent;
+                addChild(slot, parent, branch, node);
+                attach(slot, parent, new ArtLeaf{word}, depth + matched);
+                words++;
+                return;
+            }
+            depth += node->prefixLength;
+        }
+
+        if (depth == word.size()) {
+            if (node->end == nullptr) {
+                node->end = new ArtLeaf{word};
+                words++;
+            }
+            return;
+        }
+
+        void** child = findChild(node, (unsigned char)word[depth]);
+        if (child == nullptr) {
+            addChild(slot, node, (unsigned char)word[depth], tagLeaf(new ArtLeaf{word}));
+            words++;
+            return;
+        }
+        slot = child;
+        depth++;
+    }
+}
+
+bool AdaptiveRadixTree::search(const std::string& word) const {
+    if (word.empty()) return false;
+
+    const void* ref = root;
+    size_t depth = 0;
+    while (ref != nullptr) {
+        if (isLeaf(ref)) return leafOf(ref)->word == word;
+
+        const ArtNode* node = static_cast<const ArtNode*>(ref);
+        if (node->prefixLength > 0) {
+            // Only the stored bytes are checked on the way down; comparing
+            // the leaf at the end covers the rest
+            if (word.size() - depth < node->prefixLength) return false;
+            if (std::memcmp(node->prefix, word.data() + depth,
+                            std::min<size_t>(node->prefixLength, MAX_PREFIX)) != 0) {
+                return false;
+            }
+            depth += node->prefixLength;
+        }
+        if (depth == word.size()) {
+            return node->end != nullptr && node->end->word == word;
+        }
+        void** child = findChild(const_cast<ArtNode*>(node), (unsigned char)word[depth]);
+        if (child == nullptr) return false;
+        ref = *child;
+        depth++;
+    }
+    return false;
+}
+
+void AdaptiveRadixTree::collect(const void* ref, std::vector<std::string>& results, size_t k) const {
+    if (results.size() >= k) return;
+    if (isLeaf(ref)) {
+        results.push_back(leafOf(ref)->word);
+        return;
+    }
+
+    // The word ending at this node sorts before everything below it
+    const ArtNode* node = static_cast<const ArtNode*>(ref);
+    if (node->end) {
+        results.push_back(node->end->word);
+    }
+    switch (node->type) {
+    case ArtNode::NODE4: {
+        auto n = static_cast<const ArtNode4*>(node);
+        for (size_t i = 0; i < n->count && results.size() < k; i++) collect(n->children[i], results, k);
+        break;
+    }
+    case ArtNode::NODE16: {
+        auto n = static_cast<const ArtNode16*>(node);
+        for (size_t i = 0; i < n->count && results.size() < k; i++) collect(n->children[i], results, k);
+        break;
+    }
+    case ArtNode::NODE48: {
+        auto n = static_cast<const ArtNode48*>(node);
+        for (size_t b = 0; b < 256 && results.size() < k; b++) {
+            if (n->index[b]) collect(n->children[n->index[b] - 1], results, k);
+        }
+        break;
+    }
+    default: {
+        auto n = static_cast<const ArtNode256*>(node);
+        for (size_t b = 0; b < 256 && results.size() < k; b++) {
+            if (n->children[b]) collect(n->children[b], results, k);
+        }
+        break;
+    }
+    }
+}
+
+std::vector<std::string> AdaptiveRadixTree::prefixSearch(const std::string& prefix, int k) const {
+    std::vector<std::string> results;
+    if (k <= 0) return results;
+
+    const void* ref = root;
+    size_t depth = 0;
+    while (ref != nullptr) {
+        if (isLeaf(ref)) {
+            const std::string& word = leafOf(ref)->word;
+            if (word.compare(0, prefix.size(), prefix) == 0) {
+                results.push_back(word);
+            }
+            break;
+        }
+
+        // Unlike search, every prefix byte is checked: a subtree is only
+        // collected when all of its words really start with the prefix
+        const ArtNode* node = static_cast<const ArtNode*>(ref);
+        size_t matched = prefixMismatch(node, prefix, depth);
+        if (depth + matched == prefix.size()) {
+            collect(node, results, (size_t)k);
+            break;
+        }
+        if (matched < node->prefixLength) break;
+
+        depth += node->prefixLength;
+        void** child = findChild(const_cast<ArtNode*>(node), (unsigned char)prefix[depth]);
+        if (child == nullptr) break;
+        ref = *child;
+        depth++;
+    }
+    return results;
+}
+
+bool AdaptiveRadixTree::eraseAt(void** slot, const std::string& word, size_t depth) {
+    void* ref = *slot;
+    if (ref == nullptr) return false;
+
+    if (isLeaf(ref)) {
+        ArtLeaf* leaf = leafOf(ref);
+        if (leaf->word != word) return false;
+        delete leaf;
+        *slot = nullptr;
+        words--;
+        return true;
+    }
+
+    ArtNode* node = static_cast<ArtNode*>(ref);
+    if (prefixMismatch(node, word, depth) != node->prefixLength) return false;
+    depth += node->prefixLength;
+
+    if (depth == word.size()) {
+        if (node->end == nullptr) return false;
+        delete node->end;
+        node->end = nullptr;
+        words--;
+    } else {
+        unsigned char byte = (unsigned char)word[depth];
+        void** child = findChild(node, byte);
+        if (child == nullptr || !eraseAt(child, word, depth + 1)) return false;
+        if (*child == nullptr) {
+            removeChild(node, byte, child);
+        }
+    }
+    shrink(slot);
+    return true;
+}
+
+bool AdaptiveRadixTree::erase(const std::string& word) {
+    if (word.empty()) return false;
+    return eraseAt(&root, word, 0);
+}
+
+void AdaptiveRadixTree::getAllWords(std::vector<std::string>& results) const {
+    if (root != nullptr) {
+        collect(root, results, (size_t)-1);
+    }
+}
+
+size_t AdaptiveRadixTree::nodeCount() const {
+    size_t total = words;
+    for (size_t count : innerNodes) total += count;
+    return total;
+}
+
+void AdaptiveRadixTree::report(const void* ref, MemoryUsage& usage) const {
+    if (isLeaf(ref)) {
+        usage.addNodes(sizeof(ArtLeaf));
+        usage.addString(leafOf(ref)->word);
+        return;
+    }
+    const ArtNode* node = static_cast<const ArtNode*>(ref);
+    if (node->end) {
+        usage.addNodes(sizeof(ArtLeaf));
+        usage.addString(node->end->word);
+    }
+    switch (node->type) {
+    case ArtNode::NODE4: {
+        auto n = static_cast<const ArtNode4*>(node);
+        usage.addNodes(sizeof(ArtNode4));
+        for (size_t i = 0; i < n->count; i++) report(n->children[i], usage);
+        break;
+    }
+    case ArtNode::NODE16: {
+        auto n = static_cast<const ArtNode16*>(node);
+        usage.addNodes(sizeof(ArtNode16));
+        for (size_t i = 0; i < n->count; i++) report(n->children[i], usage);
+        break;
+    }
+    case ArtNode::NODE48: {
+        auto n = static_cast<const ArtNode48*>(node);
+        usage.addNodes(sizeof(ArtNode48));
+        for (const void* child : n->children) {
+            if (child) report(child, usage);
+        }
+        break;
+    }
+    default: {
+        auto n = static_cast<const ArtNode256*>(node);
+        usage.addNodes(sizeof(ArtNode256));
+        for (const void* child : n->children) {
+            if (child) report(child, usage);
+        }
+        break;
+    }
+    }
+}
+
+MemoryUsage AdaptiveRadixTree::memoryUsage() const {
+    MemoryUsage usage;
+    usage.items = words;
+    if (root != nullptr) {
+        report(root, usage);
+    }
+    return usage;
+}
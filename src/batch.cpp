@@ -0,0 +1,130 @@
+#include "../include/batch.h"
+#include "../include/json_lines.h"
+#include <chrono>
+#include <vector>
+#include <cstring>
+
+namespace {
+
+const size_t BLOCK_SIZE = 1 << 20;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Split a line into whitespace-separated fields
+void splitFields(const char* line, size_t length, std::vector<std::string>& fields) {
+    fields.clear();
+    size_t i = 0;
+    while (i < length) {
+        while (i < length && isSpace(line[i])) i++;
+        size_t start = i;
+        while (i < length && !isSpace(line[i])) i++;
+        if (i > start) {
+            fields.emplace_back(line + start, i - start);
+        }
+    }
+}
+
+void appendScore(std::string& out, double score) {
+    char buffer[32];
+    int len = snprintf(buffer, sizeof(buffer), "%.6g", score);
+    out.append(buffer, len);
+}
+
+}
+
+BatchRunner::BatchRunner(AutocompleteEngine& engine, const BatchOptions& options)
+    : engine(engine), options(options) {}
+
+void BatchRunner::processLine(const char* line, size_t length, std::string& out, BatchStats& stats) {
+    splitFields(line, length, fields);
+    if (fields.empty()) return;
+
+    if (fields[0] == ":accept") {
+        if (fields.size() >= 2) {
+            engine.acceptSuggestion(fields[1], fields.size() >= 3 ? fields[2] : "");
+            stats.accepts++;
+        }
+        return;
+    }
+
+    const std::string& prefix = fields[0];
+    const std::string& context = fields.size() > 1 ? fields.back() : std::string();
+    auto suggestions = engine.getSuggestions(prefix, options.k, context);
+    stats.queries++;
+
+    if (options.json) {
+        out += "{\"prefix\":";
+        jsonl::appendString(out, prefix);
+        out += ",\"suggestions\":[";
+        for (size_t i = 0; i < suggestions.size(); i++) {
+            if (i > 0) out += ',';
+            out += "{\"token\":";
+            jsonl::appendString(out, suggestions[i].first);
+            out += ",\"score\":";
+            appendScore(out, suggestions[i].second);
+            out += '}';
+        }
+        out += "]}\n";
+    } else {
+        out += prefix;
+        for (const auto& [token, score] : suggestions) {
+            out += '\t';
+            out += token;
+            out += '\t';
+            appendScore(out, score);
+        }
+        out += '\n';
+    }
+}
+
+BatchStats BatchRunner::run(FILE* in, FILE* out) {
+    BatchStats stats;
+    auto start = std::chrono::steady_clock::now();
+
+    // Replays must not rewrite the stored frequencies
+    engine.setAutoSave(false);
+
+    std::vector<char> block(BLOCK_SIZE);
+    std::string carry;          // partial line left at the end of a block
+    std::string output;
+    output.reserve(BLOCK_SIZE + 4096);
+
+    size_t len;
+    while ((len = fread(block.data(), 1, block.size(), in)) > 0) {
+        stats.bytesIn += len;
+        const char* data = block.data();
+        const char* end = data + len;
+
+        while (data < end) {
+            const char* nl = (const char*)memchr(data, '\n', end - data);
+            if (nl == nullptr) {
+                carry.append(data, end - data);
+                break;
+            }
+            if (!carry.empty()) {
+                carry.append(data, nl - data);
+                processLine(carry.data(), carry.size(), output, stats);
+                carry.clear();
+            } else {
+                processLine(data, nl - data, output, stats);
+            }
+            data = nl + 1;
+
+            if (output.size() >= BLOCK_SIZE) {
+                fwrite(output.data(), 1, output.size(), out);
+                output.clear();
+            }
+        }
+    }
+    if (!carry.empty()) {
+        processLine(carry.data(), carry.size(), output, stats);
+    }
+
+    fwrite(output.data(), 1, output.size(), out);
+    fflush(out);
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
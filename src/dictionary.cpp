@@ -0,0 +1,13 @@
+#include "../include/dictionary.h"
+
+std::unique_ptr<Dictionary> Dictionary::create(const std::string& kind) {
+    if (kind == "tst") return std::make_unique<DictionaryOf<TST>>("tst");
+    if (kind == "radix") return std::make_unique<DictionaryOf<RadixTST>>("radix");
+    if (kind == "art") return std::make_unique<DictionaryOf<AdaptiveRadixTree>>("art");
+    if (kind == "sorted") return std::make_unique<DictionaryOf<SortedDictionary>>("sorted");
+    return nullptr;
+}
+
+std::vector<std::string> Dictionary::kinds() {
+    return {"tst", "radix", "art", "sorted"};
+}
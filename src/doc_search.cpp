@@ -0,0 +1,210 @@
+#include "../include/doc_search.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Bytes of C/C++ source from most to least common; anything not listed is
+// rarer still. Only the order matters.
+const char COMMON_BYTES[] =
+    " etnirsaoclu\n_dpfm();h,=.gbt*v{}\"ykw<>0x1/-:&[]+ST2ECIANR\tLPDO#MF!3%'4B|8U5G6V79HWKzqj?X~QYJZ^@$\\`";
+
+struct ByteRanks {
+    unsigned char rank[256];
+
+    ByteRanks() {
+        std::memset(rank, 0, sizeof(rank));
+        size_t n = sizeof(COMMON_BYTES) - 1;
+        for (size_t i = 0; i < n; i++) {
+            unsigned char c = (unsigned char)COMMON_BYTES[i];
+            if (rank[c] == 0) rank[c] = (unsigned char)(n - i);
+        }
+    }
+};
+
+const ByteRanks RANKS;
+
+}
+
+DocumentSearch::DocumentSearch() : rare(0), shiftFrom(0), shift(0), current(npos) {}
+
+size_t DocumentSearch::rarestByte(const std::string& pattern) {
+    size_t best = 0;
+    for (size_t i = 1; i < pattern.size(); i++) {
+        if (RANKS.rank[(unsigned char)pattern[i]] < RANKS.rank[(unsigned char)pattern[best]]) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void DocumentSearch::scan(const char* data, size_t length, size_t base, const std::string& pattern,
+                          size_t rare, std::vector<size_t>& out) {
+    size_t m = pattern.size();
+    if (m == 0 || length < m) return;
+
+    // The rare byte of a match starting at s sits at s + rare, so only
+    // [rare, length - m + rare] can hold one
+    const char needle = pattern[rare];
+    const char* cursor = data + rare;
+    const char* limit = data + (length - m + rare) + 1;
+
+    while (cursor < limit) {
+        const char* hit = (const char*)std::memchr(cursor, needle, limit - cursor);
+        if (hit == nullptr) break;
+
+        const char* start = hit - rare;
+        if (std::memcmp(start, pattern.data(), m) == 0) {
+            out.push_back(base + (start - data));
+        }
+        cursor = hit + 1;
+    }
+}
+
+void DocumentSearch::scanSegments(const TextBuffer& buffer) {
+    // Matches inside one segment are found in place; matches across a
+    // segment boundary are found in the last m-1 bytes before it joined to
+    // the first m-1 bytes after it
+    size_t m = pat.size();
+    std::string tail;
+    size_t offset = 0;
+
+    buffer.forEachSegment([&](const char* data, size_t length) {
+        if (!tail.empty()) {
+            std::string window = tail + std::string(data, std::min(length, m - 1));
+            std::vector<size_t> found;
+            scan(window.data(), window.size(), offset - tail.size(), pat, rare, found);
+            for (size_t pos : found) {
+                if (pos < offset) positions.push_back(pos);
+            }
+        }
+
+        scan(data, length, offset, pat, rare, positions);
+        offset += length;
+
+        if (length >= m - 1) {
+            tail.assign(data + length - (m - 1), m - 1);
+        } else {
+            tail.append(data, length);
+            if (tail.size() > m - 1) tail.erase(0, tail.size() - (m - 1));
+        }
+    });
+}
+
+void DocumentSearch::setPattern(const std::string& pattern, const TextBuffer& buffer) {
+    clear();
+    pat = pattern;
+    if (pat.empty()) return;
+
+    rare = rarestByte(pat);
+    scanSegments(buffer);
+}
+
+void DocumentSearch::clear() {
+    pat.clear();
+    positions.clear();
+    shiftFrom = 0;
+    shift = 0;
+    current = npos;
+}
+
+size_t DocumentSearch::lowerBound(size_t offset) const {
+    size_t lo = 0, hi = positions.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (at(mid) < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void DocumentSearch::edited(size_t offset, size_t removed, size_t inserted, const TextBuffer& buffer) {
+    if (pat.empty()) return;
+    size_t m = pat.size();
+    current = npos;
+
+    // Old matches that overlapped the removed bytes or spanned the edit point
+    size_t reach = offset >= m - 1 ? offset - (m - 1) : 0;
+    size_t first = lowerBound(reach);
+    size_t last = lowerBound(offset + removed);
+
+    // Move the pending shift boundary to `last`, then everything from there
+    // on moves with this edit as well
+    for (; shiftFrom < last; shiftFrom++) positions[shiftFrom] += shift;
+    for (; shiftFrom > last; shiftFrom--) positions[shiftFrom - 1] -= shift;
+    shift += inserted - removed;
+
+    // New matches can only overlap the inserted bytes or span the edit point
+    std::vector<size_t> found;
+    size_t hi = std::min(buffer.length(), offset + inserted + m - 1);
+    if (hi > reach) {
+        std::string window = buffer.substring(reach, hi - reach);
+        scan(window.data(), window.size(), reach, pat, rare, found);
+    }
+
+    if (found.size() <= last - first) {
+        std::copy(found.begin(), found.end(), positions.begin() + first);
+        positions.erase(positions.begin() + first + found.size(), positions.begin() + last);
+    } else {
+        std::copy(found.begin(), found.begin() + (last - first), positions.begin() + first);
+        positions.insert(positions.begin() + last, found.begin() + (last - first), found.end());
+    }
+    shiftFrom = first + found.size();
+
+    if (shiftFrom == positions.size()) shift = 0;
+}
+
+size_t DocumentSearch::next(size_t offset) {
+    size_t n = positions.size();
+    if (n == 0) return current = npos;
+
+    if (current != npos && at(current) == offset) {
+        current = current + 1 == n ? 0 : current + 1;
+    } else {
+        current = lowerBound(offset + 1);
+        if (current == n) current = 0;
+    }
+    return current;
+}
+
+size_t DocumentSearch::prev(size_t offset) {
+    size_t n = positions.size();
+    if (n == 0) return current = npos;
+
+    if (current != npos && at(current) == offset) {
+        current = current == 0 ? n - 1 : current - 1;
+    } else {
+        size_t i = lowerBound(offset);
+        current = i == 0 ? n - 1 : i - 1;
+    }
+    return current;
+}
+
+DocumentSearch::Replacement DocumentSearch::replaceAll(const TextBuffer& buffer,
+                                                       const std::string& replacement) const {
+    Replacement result;
+    size_t n = positions.size();
+    if (n == 0) return result;
+
+    size_t m = pat.size();
+    result.from = at(0);
+    result.length = at(n - 1) + m - result.from;
+    std::string span = buffer.substring(result.from, result.length);
+
+    // Copy the text between kept matches and splice in the replacement
+    size_t copied = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t pos = at(i) - result.from;
+        if (pos < copied) continue;     // overlaps the previous replaced match
+        result.text.append(span, copied, pos - copied);
+        result.text += replacement;
+        copied = pos + m;
+        result.replaced++;
+    }
+    result.text.append(span, copied, std::string::npos);
+    result.length = span.size();
+    return result;
+}
@@ -0,0 +1,358 @@
+#include "../include/edit_journal.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+constexpr std::chrono::milliseconds EditJournal::SYNC_INTERVAL;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char MAGIC[4] = {'S', 'C', 'A', 'J'};
+const uint32_t VERSION = 1;
+
+struct Crc32Table {
+    uint32_t entry[256];
+
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entry[i] = c;
+        }
+    }
+};
+
+const Crc32Table CRC;
+
+uint32_t crc32(const char* data, size_t length) {
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        c = CRC.entry[(c ^ (unsigned char)data[i]) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+template <typename T>
+void put(std::string& out, T value) {
+    out.append((const char*)&value, sizeof(value));
+}
+
+template <typename T>
+bool get(const std::string& in, size_t& pos, T& value) {
+    if (in.size() - pos < sizeof(value)) return false;
+    std::memcpy(&value, in.data() + pos, sizeof(value));
+    pos += sizeof(value);
+    return true;
+}
+
+// Each record and the header end with the CRC32 of their bytes
+void seal(std::string& out, size_t from) {
+    put<uint32_t>(out, crc32(out.data() + from, out.size() - from));
+}
+
+bool sealed(const std::string& in, size_t from, size_t& pos) {
+    uint32_t stored;
+    size_t end = pos;
+    return get(in, pos, stored) && stored == crc32(in.data() + from, end - from);
+}
+
+std::string encodeHeader(const JournalHeader& header) {
+    std::string out(MAGIC, sizeof(MAGIC));
+    put<uint32_t>(out, VERSION);
+    put<uint64_t>(out, header.baseSize);
+    put<int64_t>(out, header.baseMtimeNs);
+    put<uint32_t>(out, (uint32_t)header.document.size());
+    out += header.document;
+    seal(out, 0);
+    return out;
+}
+
+bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+// True when path is missing or empty, or begins like a journal (a torn
+// header included), so creating a journal there destroys nothing else
+bool replaceable(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return true;
+    char head[sizeof(MAGIC)];
+    file.read(head, sizeof(head));
+    return std::memcmp(head, MAGIC, (size_t)file.gcount()) == 0;
+}
+
+// Open path for writing and take its lock without waiting. A journal can
+// be unlinked by its owner between our open() and flock(), so the lock only
+// counts if path still names the locked file afterwards.
+int openLocked(const std::string& path, bool& busy) {
+    busy = false;
+    for (int attempt = 0; attempt < 3; attempt++) {
+        int file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0600);
+        if (file < 0) return -1;
+        if (flock(file, LOCK_EX | LOCK_NB) != 0) {
+            busy = errno == EWOULDBLOCK;
+            ::close(file);
+            return -1;
+        }
+        struct stat opened, named;
+        if (fstat(file, &opened) == 0 && stat(path.c_str(), &named) == 0 &&
+            opened.st_dev == named.st_dev && opened.st_ino == named.st_ino) {
+            return file;
+        }
+        ::close(file);
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+// Parse a journal, returning how many leading bytes hold intact records
+bool scan(const std::string& path, JournalHeader& header, std::vector<JournalOp>& ops, size_t& valid) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    std::string in((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    size_t pos = 0;
+    uint32_t version, nameLength;
+    if (in.size() < sizeof(MAGIC) || std::memcmp(in.data(), MAGIC, sizeof(MAGIC)) != 0) return false;
+    pos = sizeof(MAGIC);
+    if (!get(in, pos, version) || version != VERSION) return false;
+    if (!get(in, pos, header.baseSize) || !get(in, pos, header.baseMtimeNs)) return false;
+    if (!get(in, pos, nameLength) || in.size() - pos < nameLength) return false;
+    header.document.assign(in, pos, nameLength);
+    pos += nameLength;
+    if (!sealed(in, 0, pos)) return false;
+
+    ops.clear();
+    valid = pos;
+    while (pos < in.size()) {
+        size_t start = pos;
+        uint8_t kind;
+        JournalOp op;
+        if (!get(in, pos, kind) || !get(in, pos, op.offset) || !get(in, pos, op.count)) break;
+        if (kind == JournalOp::INSERT) {
+            if (in.size() - pos < op.count) break;
+            op.text.assign(in, pos, op.count);
+            pos += op.count;
+        } else if (kind != JournalOp::ERASE) {
+            break;
+        }
+        // A torn or corrupt record ends the journal; later bytes cannot be trusted
+        if (!sealed(in, start, pos)) break;
+        op.kind = (JournalOp::Kind)kind;
+        ops.push_back(std::move(op));
+        valid = pos;
+    }
+    return true;
+}
+
+}
+
+EditJournal::EditJournal()
+    : fd(-1), recorded(0), durable(0), syncTarget(0), failed(false), stopping(false) {}
+
+EditJournal::~EditJournal() {
+    close(false);
+}
+
+bool EditJournal::open(const std::string& path, const JournalHeader& header, bool keep, std::string& error) {
+    close(false);
+
+    // Lock before reading it, so a journal another editor is writing is
+    // neither truncated nor appended to
+    bool busy;
+    int file = openLocked(path, busy);
+    if (file < 0) {
+        error = path + ": " + (busy ? "in use by another editor" : strerror(errno));
+        return false;
+    }
+
+    // Keep the intact part of a journal for the same file, minus any torn tail
+    JournalHeader existing;
+    std::vector<JournalOp> ops;
+    size_t valid = 0;
+    bool append = keep && scan(path, existing, ops, valid) && existing.document == header.document &&
+                  existing.baseSize == header.baseSize && existing.baseMtimeNs == header.baseMtimeNs;
+
+    // Never truncate someone else's file that happens to have the name
+    if (!append && !replaceable(path)) {
+        error = path + ": exists and is not an edit journal; left untouched";
+        ::close(file);
+        return false;
+    }
+
+    bool ok;
+    if (append) {
+        ok = ftruncate(file, valid) == 0 && lseek(file, 0, SEEK_END) >= 0;
+    } else {
+        std::string head = encodeHeader(header);
+        ok = ftruncate(file, 0) == 0 && writeAll(file, head.data(), head.size());
+    }
+    if (!ok || fdatasync(file) != 0) {
+        error = path + ": " + strerror(errno);
+        ::close(file);
+        return false;
+    }
+
+    fd = file;
+    journalPath = path;
+    pending.clear();
+    recorded = durable = syncTarget = 0;
+    failed = false;
+    stopping = false;
+    writer = std::thread(&EditJournal::loop, this);
+    return true;
+}
+
+void EditJournal::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (writer.joinable()) writer.join();
+}
+
+void EditJournal::close(bool discard) {
+    if (fd < 0) return;
+    stop();
+    // Unlink while still holding the lock, so the name is never removed
+    // from under an editor that has just locked it
+    if (discard) unlink(journalPath.c_str());
+    ::close(fd);
+    fd = -1;
+    journalPath.clear();
+}
+
+bool EditJournal::hasFailed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+void EditJournal::append(JournalOp::Kind kind, uint64_t offset, uint64_t count, const char* text,
+                         size_t length) {
+    if (fd < 0) return;
+
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        first = pending.empty();
+        size_t start = pending.size();
+        put<uint8_t>(pending, kind);
+        put<uint64_t>(pending, offset);
+        put<uint64_t>(pending, count);
+        if (length > 0) pending.append(text, length);
+        seal(pending, start);
+        recorded += pending.size() - start;
+    }
+    // Later records join the batch the writer was woken for
+    if (first) wake.notify_one();
+}
+
+void EditJournal::insert(size_t offset, const std::string& text) {
+    if (text.empty()) return;
+    append(JournalOp::INSERT, offset, text.size(), text.data(), text.size());
+}
+
+void EditJournal::erase(size_t offset, size_t count) {
+    if (count == 0) return;
+    append(JournalOp::ERASE, offset, count, nullptr, 0);
+}
+
+void EditJournal::sync() {
+    if (fd < 0) return;
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = recorded;
+    if (durable >= target) return;
+    syncTarget = std::max(syncTarget, target);
+    wake.notify_one();
+    synced.wait(lock, [&] { return durable >= target; });
+}
+
+void EditJournal::loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t written = 0;
+    Clock::time_point deadline = Clock::time_point::max();  // sync due for written bytes
+    std::string batch;
+
+    while (true) {
+        bool urgent = stopping || syncTarget > durable;
+        if (pending.empty() && written == durable) {
+            if (stopping) break;
+            wake.wait(lock);
+            continue;
+        }
+        if (pending.empty() && !urgent && Clock::now() < deadline) {
+            wake.wait_until(lock, deadline);
+            continue;
+        }
+
+        // Take the whole batch; the caller's thread keeps appending meanwhile
+        batch.swap(pending);
+        bool syncNow = urgent || Clock::now() >= deadline;
+        lock.unlock();
+
+        bool ok = batch.empty() || writeAll(fd, batch.data(), batch.size());
+        if (ok && syncNow) ok = fdatasync(fd) == 0;
+
+        lock.lock();
+        written += batch.size();
+        batch.clear();
+        if (!ok) failed = true;
+        if (syncNow) {
+            durable = written;
+            deadline = Clock::time_point::max();
+            synced.notify_all();
+        } else if (deadline == Clock::time_point::max()) {
+            deadline = Clock::now() + SYNC_INTERVAL;
+        }
+    }
+}
+
+bool EditJournal::replay(const std::string& path, JournalHeader& header, std::vector<JournalOp>& ops) {
+    size_t valid;
+    return scan(path, header, ops, valid);
+}
+
+bool EditJournal::inUse(const std::string& path) {
+    int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) return false;
+    bool held = flock(file, LOCK_SH | LOCK_NB) != 0 && errno == EWOULDBLOCK;
+    ::close(file);
+    return held;
+}
+
+JournalHeader EditJournal::describe(const std::string& document) {
+    JournalHeader header;
+    header.document = document;
+    struct stat info;
+    if (stat(document.c_str(), &info) == 0) {
+        header.baseSize = (uint64_t)info.st_size;
+        header.baseMtimeNs = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+    }
+    return header;
+}
+
+std::string EditJournal::pathFor(const std::string& document) {
+    std::filesystem::path p(document);
+    return (p.parent_path() / ("." + p.filename().string() + ".scaj")).string();
+}
@@ -0,0 +1,282 @@
+#include "../include/engine.h"
+#include "../include/metrics.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+static std::unique_ptr<Dictionary> makeDictionary(const std::string& kind) {
+    std::unique_ptr<Dictionary> dictionary = Dictionary::create(kind);
+    if (!dictionary) {
+        throw std::invalid_argument("Unknown dictionary " + kind);
+    }
+    return dictionary;
+}
+
+AutocompleteEngine::AutocompleteEngine(const std::string& dictionaryKind)
+    : dictionary(makeDictionary(dictionaryKind)),
+      cache(50),
+      freqStore("data/frequency.txt"),
+      ranker(&freqStore, &graph),
+      phraseStore("data/phrases.txt"),
+      projectIndex(*dictionary, freqStore, graph),
+      vocabularyStale(true),
+      useSubstringSearch(false),
+      usePhraseCompletion(true),
+      seedsLoaded(0),
+      stageTrace(nullptr) {
+    // Backends that rank inside a prefix take the learned frequencies
+    dictionary->setWeights([this](const std::string& token) { return freqStore.get(token); });
+    seedsLoaded = loadSeeds("data/words.txt");
+}
+
+int AutocompleteEngine::loadSeeds(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()){
+        std::cerr << "Warning: Could not open " << filename << std::endl;
+        return 0;
+    }
+
+    std::string word;
+    int count = 0;
+    while (file >> word) {
+        if (!word.empty()) {
+            dictionary->insert(word);
+            count++;
+        }
+    }
+    file.close();
+    // A backend that buffers inserts (SortedDictionary) takes the seeds
+    // into its compact form now rather than after MIN_REBUILD more changes
+    dictionary->compactIfFragmented();
+    return count;
+}
+
+void AutocompleteEngine::refreshVocabulary() {
+    if (!vocabularyStale) return;
+    vocabulary.clear();
+    dictionary->getAllWords(vocabulary);
+    fuzzyIndex.build(vocabulary);
+    substringSession.reset(&vocabulary);
+    vocabularyStale = false;
+}
+
+std::vector<std::string> AutocompleteEngine::substringSearch(const std::string& prefix){
+    // Consecutive keystrokes narrow the previous query's matches instead of
+    // rescanning the vocabulary
+    refreshVocabulary();
+    std::vector<std::string> results;
+    for (const auto& candidate : substringSession.update(prefix)) {
+        results.push_back(substringSession.word(candidate));
+    }
+
+    return results;
+}
+
+std::vector<std::pair<std::string, double>> AutocompleteEngine::getSuggestions(
+    const std::string& prefix, int k) {
+    return getSuggestions(prefix, k, lastAccepted);
+}
+
+std::vector<std::pair<std::string, double>> AutocompleteEngine::getSuggestions(
+    const std::string& prefix, int k, const std::string& context) {
+    if (prefix.empty()) {
+        return std::vector<std::pair<std::string, double>>();
+    }
+
+    // Stages are timed on a sample of calls, or on every call while traced
+    QueryStages* trace = stageTrace;
+    metrics::StageTimer timer(trace != nullptr || metrics::sample(metrics::SUGGEST));
+
+    // The ranking depends on the context token and on k, not just the prefix
+    std::string cacheKey = prefix + '\x1f' + context + '\x1f' + std::to_string(k);
+
+    if (cache.exists(cacheKey)) {
+        auto cached = cache.get(cacheKey);
+        std::vector<std::pair<std::string, double>> result;
+        for (const auto& token : cached) {
+            result.push_back(std::make_pair(token, freqStore.get(token)));
+        }
+        uint64_t cacheNs = timer.lap(metrics::CACHE_LOOKUP);
+        timer.total(metrics::SUGGEST);
+        metrics::count(metrics::CACHE_HITS);
+        if (trace) {
+            *trace = QueryStages();
+            trace->cacheNs = cacheNs;
+            trace->cacheHit = true;
+        }
+        return result;
+    }
+    uint64_t cacheNs = timer.lap(metrics::CACHE_LOOKUP);
+    metrics::count(metrics::CACHE_MISSES);
+
+    std::vector<std::string> candidates = dictionary->prefixSearch(prefix, k * 2);
+    uint64_t prefixNs = timer.lap(metrics::PREFIX_SEARCH);
+
+    uint64_t substringNs = 0;
+    if (candidates.size()<3 && useSubstringSearch) {
+        auto substringResults = substringSearch(prefix);
+        candidates.insert(candidates.end(), substringResults.begin(), substringResults.end());
+
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        substringNs = timer.lap(metrics::SUBSTRING_SEARCH);
+        metrics::count(metrics::SUBSTRING_FALLBACKS);
+    }
+
+    ranker.setLastToken(context);
+    auto ranked = ranker.rankResults(candidates, k);
+    uint64_t rankNs = timer.lap(metrics::RANK);
+
+    std::vector<std::string> toCache;
+    for (const auto& [token, score] : ranked){
+        toCache.push_back(token);
+    }
+    cache.put(cacheKey, toCache);
+    uint64_t fillNs = timer.lap(metrics::CACHE_FILL);
+    timer.total(metrics::SUGGEST);
+
+    if (trace) {
+        *trace = QueryStages();
+        trace->cacheNs = cacheNs;
+        trace->prefixNs = prefixNs;
+        trace->substringNs = substringNs;
+        trace->rankNs = rankNs;
+        trace->fillNs = fillNs;
+    }
+    return ranked;
+}
+
+std::vector<std::string> AutocompleteEngine::getPhraseSuggestions(const std::string& prefix) {
+    std::vector<std::string> suggestions;
+
+    if (!usePhraseCompletion) {
+        return suggestions;
+    }
+
+    // Get learned phrases for this prefix
+    metrics::StageTimer timer(metrics::sample(metrics::PHRASES));
+    auto phrases = phraseStore.getTopPhrases(prefix, 3);
+    timer.lap(metrics::PHRASES);
+
+    for (const auto& phrase : phrases) {
+        suggestions.push_back(phrase.snippet);
+    }
+
+    return suggestions;
+}
+
+std::vector<FuzzyMatch> AutocompleteEngine::fuzzySearch(const std::string& query, int maxErrors,
+                                                        size_t limit) {
+    refreshVocabulary();
+
+    // Rank a wider set of close words by frequency within each distance
+    auto matches = fuzzyIndex.search(query, maxErrors, limit * 4);
+    std::stable_sort(matches.begin(), matches.end(), [this](const FuzzyMatch& a, const FuzzyMatch& b) {
+        if (a.distance != b.distance) return a.distance < b.distance;
+        return freqStore.get(a.word) > freqStore.get(b.word);
+    });
+    if (matches.size() > limit) {
+        matches.resize(limit);
+    }
+    return matches;
+}
+
+void AutocompleteEngine::acceptSuggestion(const std::string& token) {
+    acceptSuggestion(token, lastAccepted);
+    lastAccepted = token;
+}
+
+void AutocompleteEngine::acceptSuggestion(const std::string& token, const std::string& previous) {
+    metrics::ScopedTimer timer(metrics::ACCEPT);
+    freqStore.bump(token, 1);
+
+    if (!previous.empty()){
+        graph.addEdge(previous, token);
+    }
+
+    undoRedo.pushInsert(0, token);
+}
+
+void AutocompleteEngine::bumpToken(const std::string& token, int amount) {
+    freqStore.bump(token, amount);
+}
+
+void AutocompleteEngine::learnPhrase(const std::string& trigger, const std::string& fullText) {
+    phraseStore.addPhrase(trigger, fullText);
+}
+
+bool AutocompleteEngine::performUndo(std::string& removed) {
+    if (!undoRedo.canUndo()) {
+        return false;
+    }
+    EditDelta action = undoRedo.undo();
+    removed = action.inserted;
+    return true;
+}
+
+bool AutocompleteEngine::performRedo(std::string& restored) {
+    if (!undoRedo.canRedo()) {
+        return false;
+    }
+    EditDelta action = undoRedo.redo();
+    restored = action.inserted;
+    return true;
+}
+
+bool AutocompleteEngine::toggleSubstringSearch() {
+    useSubstringSearch = !useSubstringSearch;
+    cache.clear();
+    return useSubstringSearch;
+}
+
+bool AutocompleteEngine::togglePhraseCompletion() {
+    usePhraseCompletion = !usePhraseCompletion;
+    return usePhraseCompletion;
+}
+
+IndexStats AutocompleteEngine::indexProject(const std::string& root,
+                                            ProjectIndexer::ProgressFn progress) {
+    IndexStats stats = projectIndex.start(root, progress);
+
+    // Frequencies changed underneath any cached rankings
+    cache.clear();
+    vocabularyStale = true;
+    return stats;
+}
+
+UpdateStats AutocompleteEngine::refreshIndex() {
+    UpdateStats stats = projectIndex.update();
+    if (stats.filesRescanned > 0 || stats.filesRemoved > 0 || stats.fullRescan) {
+        cache.clear();
+        vocabularyStale = true;
+    }
+    return stats;
+}
+
+void AutocompleteEngine::displayGraph() {
+    graph.display();
+}
+
+std::vector<std::pair<std::string, MemoryUsage>> AutocompleteEngine::memoryUsage() const {
+    return {
+        {dictionary->name(), dictionary->memoryUsage()},
+        {"lru_cache", cache.memoryUsage()},
+        {"freq_store", freqStore.memoryUsage()},
+        {"graph", graph.memoryUsage()},
+        {"phrase_store", phraseStore.memoryUsage()},
+    };
+}
+
+int AutocompleteEngine::savePhrases() {
+    phraseStore.save();
+    return phraseStore.getTotalPhrases();
+}
+
+void AutocompleteEngine::setAutoSave(bool enabled) {
+    freqStore.setAutoSave(enabled);
+}
+
+void AutocompleteEngine::flush() {
+    freqStore.flush();
+}
@@ -0,0 +1,115 @@
+#include "../include/file_watcher.h"
+#include <filesystem>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+namespace {
+
+const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                            IN_DELETE | IN_CREATE | IN_ONLYDIR;
+
+bool isHidden(const std::filesystem::path& path) {
+    return path.filename().string().rfind(".", 0) == 0;
+}
+
+}
+
+FileWatcher::FileWatcher() : fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {}
+
+FileWatcher::~FileWatcher() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool FileWatcher::addWatch(const std::string& dir) {
+    int wd = inotify_add_watch(fd, dir.c_str(), WATCH_MASK);
+    if (wd < 0) return false;
+
+    // Watching the same directory twice hands back the same descriptor
+    return directories.insert_or_assign(wd, dir).second;
+}
+
+size_t FileWatcher::watchTree(const std::string& root) {
+    if (fd < 0) return 0;
+
+    size_t added = addWatch(root) ? 1 : 0;
+    std::error_code ec;
+
+    auto it = std::filesystem::recursive_directory_iterator(
+        root, std::filesystem::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_directory(ec) || it->is_symlink(ec)) continue;
+
+        if (isHidden(it->path())) {
+            it.disable_recursion_pending();
+            continue;
+        }
+        if (addWatch(it->path().string())) {
+            added++;
+        }
+    }
+
+    return added;
+}
+
+std::vector<FileWatcher::Event> FileWatcher::readEvents() {
+    std::vector<Event> events;
+    if (fd < 0) return events;
+
+    alignas(struct inotify_event) char buffer[4096];
+
+    while (true) {
+        ssize_t len = read(fd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            if (len < 0 && errno == EINTR) continue;
+            break;
+        }
+
+        for (char* p = buffer; p < buffer + len; ) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + ev->len;
+
+            // Sent with wd == -1 once the kernel's event queue is full
+            if (ev->mask & IN_Q_OVERFLOW) {
+                events.push_back({Change::QUEUE_OVERFLOW, ""});
+                continue;
+            }
+
+            if (ev->mask & IN_IGNORED) {
+                directories.erase(ev->wd);
+                continue;
+            }
+
+            auto dir = directories.find(ev->wd);
+            if (dir == directories.end() || ev->len == 0) continue;
+
+            std::string path = dir->second + "/" + ev->name;
+
+            if (ev->mask & IN_ISDIR) {
+                // New subdirectories need watches of their own; removed ones
+                // drop theirs through IN_IGNORED
+                if ((ev->mask & (IN_CREATE | IN_MOVED_TO)) && ev->name[0] != '.') {
+                    watchTree(path);
+                    events.push_back({Change::DIRECTORY_ADDED, path});
+                } else if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    events.push_back({Change::REMOVED, path});
+                }
+            } else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                events.push_back({Change::WRITTEN, path});
+            } else if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                events.push_back({Change::REMOVED, path});
+            }
+        }
+    }
+
+    return events;
+}
+
+void FileWatcher::clear() {
+    for (const auto& [wd, dir] : directories) {
+        inotify_rm_watch(fd, wd);
+    }
+    directories.clear();
+}
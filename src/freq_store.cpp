@@ -1,8 +1,9 @@
 #include "../include/freq_store.h"
+#include "../include/metrics.h"
 #include <fstream>
 #include <sstream>
 
-FreqStore::FreqStore(const std::string& path) : filePath(path) {
+FreqStore::FreqStore(const std::string& path) : filePath(path), autoSave(true), dirty(false) {
     load();
 }
 
@@ -28,6 +29,7 @@ void FreqStore::load() {
 }
 
 void FreqStore::save() {
+    metrics::ScopedTimer timer(metrics::FREQ_SAVE);
     std::ofstream file(filePath);
     
     if (!file.is_open()) {
@@ -39,19 +41,84 @@ void FreqStore::save() {
     }
     
     file.close();
+    dirty = false;
+}
+
+void FreqStore::changed() {
+    if (autoSave) {
+        save();
+    } else {
+        dirty = true;
+    }
+}
+
+void FreqStore::setAutoSave(bool enabled) {
+    autoSave = enabled;
+    if (enabled) {
+        flush();
+    }
+}
+
+void FreqStore::flush() {
+    if (dirty) {
+        save();
+    }
 }
 
 int FreqStore::get(const std::string& token) {
+    int freq = learned(token);
+    if (!projectCounts.empty()) {
+        auto it = projectCounts.find(token);
+        if (it != projectCounts.end()) freq += it->second;
+    }
+    return freq;
+}
+
+int FreqStore::learned(const std::string& token) const {
     auto it = frequencies.find(token);
     return (it != frequencies.end()) ? it->second : 0;
 }
 
 void FreqStore::bump(const std::string& token, int amount) {
     frequencies[token] += amount;
-    save();
+    changed();
 }
 
 void FreqStore::set(const std::string& token, int freq) {
     frequencies[token] = freq;
-    save();
-}
\ No newline at end of file
+    changed();
+}
+
+void FreqStore::bumpBatch(const std::unordered_map<std::string, int>& amounts) {
+    for (const auto& [token, amount] : amounts) {
+        int& freq = frequencies[token];
+        freq += amount;
+        if (freq <= 0) {
+            frequencies.erase(token);
+        }
+    }
+    changed();
+}
+
+void FreqStore::bumpProject(const std::unordered_map<std::string, int>& amounts) {
+    for (const auto& [token, amount] : amounts) {
+        int& count = projectCounts[token];
+        count += amount;
+        if (count <= 0) {
+            projectCounts.erase(token);
+        }
+    }
+}
+
+MemoryUsage FreqStore::memoryUsage() const {
+    MemoryUsage usage;
+    usage.items = frequencies.size() + projectCounts.size();
+    for (const auto* map : {&frequencies, &projectCounts}) {
+        usage.addNodes(MemoryUsage::hashNode<std::pair<const std::string, int>>(true), map->size());
+        usage.addBuckets(map->bucket_count());
+        for (const auto& [token, freq] : *map) {
+            usage.addString(token);
+        }
+    }
+    return usage;
+}
@@ -0,0 +1,200 @@
+#include "../include/fuzzy.h"
+#include <algorithm>
+#include <thread>
+#include <cctype>
+
+namespace {
+
+bool closer(const FuzzyMatch& a, const FuzzyMatch& b) {
+    if (a.distance != b.distance) return a.distance < b.distance;
+    if (a.word.size() != b.word.size()) return a.word.size() < b.word.size();
+    return a.id < b.id;
+}
+
+// Keep only the limit closest matches
+void prune(std::vector<FuzzyMatch>& matches, size_t limit) {
+    if (matches.size() <= limit) return;
+    std::nth_element(matches.begin(), matches.begin() + limit, matches.end(), closer);
+    matches.resize(limit);
+}
+
+// One mask per byte value: bit i is set when query[i] equals the byte, either case
+void buildPeq(const std::string& query, uint64_t* peq) {
+    std::fill(peq, peq + 256, 0);
+    for (size_t i = 0; i < query.size(); i++) {
+        unsigned char c = (unsigned char)query[i];
+        uint64_t bit = (uint64_t)1 << i;
+        peq[c] |= bit;
+        peq[(unsigned char)std::tolower(c)] |= bit;
+        peq[(unsigned char)std::toupper(c)] |= bit;
+    }
+}
+
+// Myers' bit-vector algorithm, search variant: the pattern may start
+// anywhere in the text, so no edit is charged at the top row. Returns the
+// smallest distance seen, or stops early once it cannot get to maxErrors.
+inline int myersDistance(const uint64_t* peq, size_t m, const char* text, size_t n, int maxErrors) {
+    const uint64_t high = (uint64_t)1 << (m - 1);
+    uint64_t pv = ~(uint64_t)0;
+    uint64_t mv = 0;
+    int score = (int)m;
+    int best = score;
+
+    for (size_t j = 0; j < n; j++) {
+        uint64_t eq = peq[(unsigned char)text[j]];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+
+        if (ph & high) {
+            score++;
+        } else if (mh & high) {
+            score--;
+        }
+
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        if (score < best) {
+            best = score;
+            if (best == 0) break;
+        }
+        // The score drops by at most one per remaining character
+        if (score - (int)(n - j - 1) > maxErrors && best > maxErrors) break;
+    }
+    return best;
+}
+
+}
+
+FuzzyIndex::FuzzyIndex() : buckets(MAX_QUERY + 2), words(0) {
+    for (size_t length = 0; length < buckets.size(); length++) {
+        buckets[length].length = length;
+    }
+}
+
+FuzzyIndex::Bucket& FuzzyIndex::bucketFor(size_t length) {
+    return length <= MAX_QUERY ? buckets[length] : buckets.back();
+}
+
+void FuzzyIndex::add(const std::string& word) {
+    if (word.empty()) return;
+
+    Bucket& bucket = bucketFor(word.size());
+    if (&bucket == &buckets.back()) {
+        if (bucket.offsets.empty()) bucket.offsets.push_back(0);
+        bucket.bytes += word;
+        bucket.offsets.push_back(bucket.bytes.size());
+    } else {
+        bucket.bytes += word;
+    }
+    bucket.ids.push_back(words++);
+}
+
+void FuzzyIndex::build(const std::vector<std::string>& vocabulary) {
+    clear();
+
+    // Size every bucket first so each is one allocation
+    std::vector<size_t> bytes(buckets.size(), 0);
+    for (const auto& word : vocabulary) {
+        bytes[std::min(word.size(), buckets.size() - 1)] += word.size();
+    }
+    for (size_t b = 0; b < buckets.size(); b++) {
+        buckets[b].bytes.reserve(bytes[b]);
+    }
+
+    for (const auto& word : vocabulary) {
+        add(word);
+    }
+}
+
+void FuzzyIndex::clear() {
+    for (auto& bucket : buckets) {
+        bucket.bytes.clear();
+        bucket.ids.clear();
+        bucket.offsets.clear();
+    }
+    words = 0;
+}
+
+void FuzzyIndex::searchSlice(const uint64_t* peq, size_t m, int maxErrors, size_t limit, unsigned slice,
+                             unsigned slices, std::vector<FuzzyMatch>& out) const {
+    // Fewer than m - maxErrors characters cannot hold the query
+    size_t minLength = m - (size_t)maxErrors;
+
+    for (size_t b = std::max<size_t>(minLength, 1); b < buckets.size(); b++) {
+        const Bucket& bucket = buckets[b];
+        size_t count = bucket.ids.size();
+        size_t begin = count * slice / slices;
+        size_t end = count * (slice + 1) / slices;
+
+        bool fixed = b + 1 < buckets.size();
+        for (size_t i = begin; i < end; i++) {
+            const char* text;
+            size_t length;
+            if (fixed) {
+                text = bucket.bytes.data() + i * b;
+                length = b;
+            } else {
+                text = bucket.bytes.data() + bucket.offsets[i];
+                length = bucket.offsets[i + 1] - bucket.offsets[i];
+            }
+
+            int distance = myersDistance(peq, m, text, length, maxErrors);
+            if (distance <= maxErrors) {
+                out.push_back(FuzzyMatch{std::string(text, length), bucket.ids[i], distance});
+                // Loose queries can match most of the vocabulary
+                if (out.size() >= 2 * limit + 1024) prune(out, limit);
+            }
+        }
+    }
+}
+
+std::vector<FuzzyMatch> FuzzyIndex::search(const std::string& query, int maxErrors, size_t limit,
+                                           unsigned threads) const {
+    std::vector<FuzzyMatch> matches;
+    size_t m = query.size();
+    if (m == 0 || m > MAX_QUERY || maxErrors < 0 || limit == 0) return matches;
+    // With m edits every word matches; keep at least one character of the query
+    maxErrors = std::min(maxErrors, (int)m - 1);
+
+    uint64_t peq[256];
+    buildPeq(query, peq);
+
+    if (threads == 0) {
+        threads = words >= PARALLEL_THRESHOLD ? std::max(1u, std::thread::hardware_concurrency()) : 1;
+    }
+
+    if (threads == 1) {
+        searchSlice(peq, m, maxErrors, limit, 0, 1, matches);
+    } else {
+        std::vector<std::vector<FuzzyMatch>> parts(threads);
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; t++) {
+            pool.emplace_back([&, t] {
+                searchSlice(peq, m, maxErrors, limit, t, threads, parts[t]);
+                prune(parts[t], limit);
+            });
+        }
+        for (auto& thread : pool) {
+            thread.join();
+        }
+        for (auto& part : parts) {
+            matches.insert(matches.end(), std::make_move_iterator(part.begin()),
+                           std::make_move_iterator(part.end()));
+        }
+    }
+
+    prune(matches, limit);
+    std::sort(matches.begin(), matches.end(), closer);
+    return matches;
+}
+
+int FuzzyIndex::substringDistance(const std::string& query, const std::string& text) {
+    uint64_t peq[256];
+    buildPeq(query, peq);
+    return myersDistance(peq, query.size(), text.data(), text.size(), (int)query.size());
+}
@@ -1,24 +1,33 @@
 #include "../include/graph.h"
+#include "../include/ranker.h"
 #include <iostream>
-#include <cmath>
 
-void CooccurrenceGraph::addEdge(const std::string& from, const std::string& to) {
-    adjacencyList[from][to]++;
+void CooccurrenceGraph::addEdge(const std::string& from, const std::string& to, int weight) {
+    adjacencyList[from][to] += weight;
 }
 
-double CooccurrenceGraph::getBoost(const std::string& from, const std::string& to) {
-    if (adjacencyList.find(from) == adjacencyList.end()) {
-        return 0.0;
+void CooccurrenceGraph::removeEdge(const std::string& from, const std::string& to, int weight) {
+    auto node = adjacencyList.find(from);
+    if (node == adjacencyList.end()) {
+        return;
     }
-    
-    auto& neighbors = adjacencyList[from];
-    
-    if (neighbors.find(to) == neighbors.end()) {
-        return 0.0;
+
+    auto edge = node->second.find(to);
+    if (edge == node->second.end()) {
+        return;
+    }
+
+    edge->second -= weight;
+    if (edge->second <= 0) {
+        node->second.erase(edge);
+        if (node->second.empty()) {
+            adjacencyList.erase(node);
+        }
     }
-    
-    int weight = neighbors[to];
-    return std::log(1 + weight) * 0.5;
+}
+
+double CooccurrenceGraph::getBoost(const std::string& from, const std::string& to) {
+    return Ranker::score(0, getEdgeWeight(from, to));
 }
 
 int CooccurrenceGraph::getEdgeWeight(const std::string& from, const std::string& to) {
@@ -45,4 +54,21 @@ void CooccurrenceGraph::display() {
         }
         std::cout << std::endl;
     }
-}
\ No newline at end of file
+}
+
+MemoryUsage CooccurrenceGraph::memoryUsage() const {
+    using Neighbors = std::map<std::string, int>;
+
+    MemoryUsage usage;
+    usage.addNodes(MemoryUsage::hashNode<std::pair<const std::string, Neighbors>>(true), adjacencyList.size());
+    usage.addBuckets(adjacencyList.bucket_count());
+    for (const auto& [from, neighbors] : adjacencyList) {
+        usage.addString(from);
+        usage.items += neighbors.size();
+        usage.addNodes(MemoryUsage::treeNode<std::pair<const std::string, int>>(), neighbors.size());
+        for (const auto& [to, weight] : neighbors) {
+            usage.addString(to);
+        }
+    }
+    return usage;
+}
@@ -0,0 +1,35 @@
+#include "../include/histogram.h"
+#include <algorithm>
+
+LatencyHistogram::LatencyHistogram()
+    : counts(BUCKETS, 0), total(0), sum(0), minValue(UINT64_MAX), maxValue(0) {}
+
+void LatencyHistogram::record(uint64_t value) {
+    counts[bucketIndex(value)]++;
+    total++;
+    sum += value;
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKETS; i++) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    minValue = std::min(minValue, other.minValue);
+    maxValue = std::max(maxValue, other.maxValue);
+}
+
+void LatencyHistogram::clear() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    sum = 0;
+    minValue = UINT64_MAX;
+    maxValue = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    return Buckets::percentile(counts, total, maxValue, p);
+}
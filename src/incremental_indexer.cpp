@@ -0,0 +1,204 @@
+#include "../include/incremental_indexer.h"
+#include <chrono>
+#include <set>
+
+IncrementalIndexer::IncrementalIndexer(Dictionary& dictionary, FreqStore& freqStore, CooccurrenceGraph& graph)
+    : dictionary(dictionary), freqStore(freqStore), graph(graph) {}
+
+IndexStats IncrementalIndexer::start(const std::string& dir, ProjectIndexer::ProgressFn progress) {
+    if (watching()) {
+        stop();
+    }
+
+    root = dir;
+    while (root.size() > 1 && root.back() == '/') {
+        root.pop_back();
+    }
+
+    // Watch before scanning so edits made during the scan are not missed
+    watcher.watchTree(root);
+
+    TokenCounts merged;
+    IndexStats stats = indexer.scanTree(root, merged, progress, &files);
+
+    auto loadStart = std::chrono::steady_clock::now();
+    for (size_t id = 0; id < merged.names.size(); id++) {
+        const std::string& token = merged.names[id];
+        occurrences[token] = merged.counts[id];
+        if (!dictionary.search(token)) {
+            dictionary.insert(token);
+            ownedTokens.insert(token);
+        }
+    }
+    freqStore.bumpProject(merged.tokenMap());
+    for (const auto& [edge, count] : merged.edges) {
+        graph.addEdge(merged.names[edge >> 32], merged.names[edge & 0xffffffffu], count);
+    }
+    stats.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+
+    return stats;
+}
+
+void IncrementalIndexer::accumulate(const TokenCounts& counts, int sign, Delta& delta) {
+    for (size_t id = 0; id < counts.names.size(); id++) {
+        delta.tokens[counts.names[id]] += sign * counts.counts[id];
+    }
+    for (const auto& [edge, count] : counts.edges) {
+        delta.edges[counts.names[edge >> 32]][counts.names[edge & 0xffffffffu]] += sign * count;
+    }
+}
+
+void IncrementalIndexer::removeFile(const std::string& path, Delta& delta, UpdateStats& stats) {
+    // path may be a directory that was deleted or moved away as a whole
+    std::string dirPrefix = path + "/";
+
+    for (auto it = files.begin(); it != files.end(); ) {
+        if (it->first == path || it->first.compare(0, dirPrefix.size(), dirPrefix) == 0) {
+            accumulate(it->second, -1, delta);
+            it = files.erase(it);
+            stats.filesRemoved++;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void IncrementalIndexer::rescanFile(const std::string& path, Delta& delta, UpdateStats& stats) {
+    if (!ProjectIndexer::isSourceFile(path)) return;
+
+    TokenCounts fresh;
+    size_t bytes = ProjectIndexer::scanFile(path, fresh);
+
+    auto old = files.find(path);
+    bool existed = old != files.end();
+    if (existed) {
+        accumulate(old->second, -1, delta);
+        files.erase(old);
+    }
+
+    // Missing and empty files contribute nothing
+    if (bytes > 0) {
+        accumulate(fresh, +1, delta);
+        fresh.shrink();
+        files[path] = std::move(fresh);
+        stats.filesRescanned++;
+    } else if (existed) {
+        stats.filesRemoved++;
+    }
+}
+
+void IncrementalIndexer::applyDelta(const Delta& delta, UpdateStats& stats) {
+    std::unordered_map<std::string, int> bumps;
+
+    for (const auto& [token, change] : delta.tokens) {
+        if (change == 0) continue;
+        bumps[token] = change;
+
+        int before = occurrences[token];
+        int after = before + change;
+
+        if (after <= 0) {
+            occurrences.erase(token);
+            if (ownedTokens.erase(token) > 0 && dictionary.erase(token)) {
+                stats.tokensRemoved++;
+            }
+        } else {
+            occurrences[token] = after;
+            if (before == 0 && !dictionary.search(token)) {
+                dictionary.insert(token);
+                ownedTokens.insert(token);
+                stats.tokensAdded++;
+            }
+        }
+    }
+
+    // Erasing from a TST leaves dead junction nodes behind; rebuild once they pile up
+    if (stats.tokensRemoved > 0) {
+        dictionary.compactIfFragmented();
+    }
+
+    if (!bumps.empty()) {
+        freqStore.bumpProject(bumps);
+    }
+
+    for (const auto& [from, neighbors] : delta.edges) {
+        for (const auto& [to, change] : neighbors) {
+            if (change > 0) {
+                graph.addEdge(from, to, change);
+            } else if (change < 0) {
+                graph.removeEdge(from, to, -change);
+            }
+        }
+    }
+}
+
+UpdateStats IncrementalIndexer::update() {
+    UpdateStats stats;
+    if (!watching()) return stats;
+
+    std::vector<FileWatcher::Event> events = watcher.readEvents();
+    if (events.empty()) return stats;
+
+    auto began = std::chrono::steady_clock::now();
+
+    // Lost events could hide any change, so nothing short of a full rescan is safe
+    for (const auto& ev : events) {
+        if (ev.change != FileWatcher::Change::QUEUE_OVERFLOW) continue;
+
+        std::string dir = root;
+        stats.filesRemoved = files.size();
+        stop();
+        start(dir);
+        stats.filesRescanned = files.size();
+        stats.fullRescan = true;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+        return stats;
+    }
+
+    Delta delta;
+
+    // Removals apply at once; writes are deduplicated and rescanned after,
+    // so a file that was saved and then deleted simply turns up missing
+    std::set<std::string> written;
+    for (const auto& ev : events) {
+        switch (ev.change) {
+            case FileWatcher::Change::WRITTEN:
+                written.insert(ev.path);
+                break;
+            case FileWatcher::Change::REMOVED:
+                removeFile(ev.path, delta, stats);
+                break;
+            case FileWatcher::Change::DIRECTORY_ADDED:
+                for (const auto& file : ProjectIndexer::listSources(ev.path)) {
+                    written.insert(file.string());
+                }
+                break;
+            case FileWatcher::Change::QUEUE_OVERFLOW:
+                break;
+        }
+    }
+    for (const auto& path : written) {
+        rescanFile(path, delta, stats);
+    }
+
+    applyDelta(delta, stats);
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+
+    return stats;
+}
+
+void IncrementalIndexer::stop() {
+    UpdateStats stats;
+    Delta delta;
+
+    for (const auto& [path, counts] : files) {
+        accumulate(counts, -1, delta);
+    }
+    files.clear();
+    applyDelta(delta, stats);
+
+    watcher.clear();
+    occurrences.clear();
+    ownedTokens.clear();
+    root.clear();
+}
@@ -0,0 +1,311 @@
+#include "../include/indexer.h"
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+struct CharClass {
+    bool identStart[256];
+    bool identBody[256];
+
+    CharClass() {
+        for (int c = 0; c < 256; c++) {
+            identStart[c] = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+            identBody[c] = identStart[c] || (c >= '0' && c <= '9');
+        }
+    }
+};
+
+const CharClass CHARS;
+
+bool isRawPrefix(const char* word, size_t length) {
+    return (length == 1 && word[0] == 'R') ||
+           (length == 2 && word[1] == 'R' && (word[0] == 'L' || word[0] == 'u' || word[0] == 'U')) ||
+           (length == 3 && word[0] == 'u' && word[1] == '8' && word[2] == 'R');
+}
+
+}
+
+uint32_t TokenCounts::intern(const std::string& token) {
+    auto it = ids.find(token);
+    if (it != ids.end()) return it->second;
+
+    uint32_t id = names.size();
+    ids.emplace(token, id);
+    names.push_back(token);
+    counts.push_back(0);
+    return id;
+}
+
+void TokenCounts::merge(const TokenCounts& other) {
+    // Translate the other table's ids into ours
+    std::vector<uint32_t> remap(other.names.size());
+    for (size_t id = 0; id < other.names.size(); id++) {
+        remap[id] = intern(other.names[id]);
+        counts[remap[id]] += other.counts[id];
+    }
+    for (const auto& [edge, count] : other.edges) {
+        uint64_t from = remap[edge >> 32];
+        uint64_t to = remap[edge & 0xffffffffu];
+        edges[(from << 32) | to] += count;
+    }
+    occurrences += other.occurrences;
+}
+
+std::unordered_map<std::string, int> TokenCounts::tokenMap() const {
+    std::unordered_map<std::string, int> result;
+    result.reserve(names.size());
+    for (size_t id = 0; id < names.size(); id++) {
+        result.emplace(names[id], counts[id]);
+    }
+    return result;
+}
+
+void TokenCounts::shrink() {
+    std::unordered_map<std::string, uint32_t>().swap(ids);
+}
+
+double IndexStats::megabytesPerSecond() const {
+    return scanSeconds > 0 ? (bytes / (1024.0 * 1024.0)) / scanSeconds : 0.0;
+}
+
+ProjectIndexer::ProjectIndexer(unsigned threads) : threadCount(threads) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+bool ProjectIndexer::isSourceFile(const std::filesystem::path& path) {
+    static const char* const extensions[] = {
+        ".c", ".h", ".cc", ".cpp", ".cxx", ".hh", ".hpp", ".hxx", ".inl", ".ipp"
+    };
+    std::string ext = path.extension().string();
+    for (const char* e : extensions) {
+        if (ext == e) return true;
+    }
+    return false;
+}
+
+std::vector<std::filesystem::path> ProjectIndexer::listSources(const std::string& root) {
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+
+    auto it = std::filesystem::recursive_directory_iterator(
+        root, std::filesystem::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        // Skip VCS metadata and other hidden directories
+        if (it->is_directory(ec) && it->path().filename().string().rfind(".", 0) == 0) {
+            it.disable_recursion_pending();
+            continue;
+        }
+        if (it->is_regular_file(ec) && isSourceFile(it->path())) {
+            files.push_back(it->path());
+        }
+    }
+
+    return files;
+}
+
+void ProjectIndexer::tokenize(const char* data, size_t size, TokenCounts& counts) {
+    std::string token;
+    int64_t previous = -1;
+    size_t i = 0;
+
+    while (i < size) {
+        unsigned char c = data[i];
+
+        // Comments
+        if (c == '/' && i + 1 < size && data[i + 1] == '/') {
+            const char* nl = (const char*)memchr(data + i, '\n', size - i);
+            i = nl ? (nl - data) + 1 : size;
+            continue;
+        }
+        if (c == '/' && i + 1 < size && data[i + 1] == '*') {
+            i += 2;
+            while (i + 1 < size && !(data[i] == '*' && data[i + 1] == '/')) i++;
+            i = std::min(size, i + 2);
+            continue;
+        }
+
+        // String and character literals
+        if (c == '"' || c == '\'') {
+            i++;
+            while (i < size && data[i] != (char)c && data[i] != '\n') {
+                if (data[i] == '\\') i++;
+                i++;
+            }
+            i++;
+            continue;
+        }
+
+        // Numbers, including hex, exponents and digit separators
+        if (c >= '0' && c <= '9') {
+            while (i < size && (CHARS.identBody[(unsigned char)data[i]] || data[i] == '.' || data[i] == '\'')) i++;
+            continue;
+        }
+
+        if (CHARS.identStart[c]) {
+            size_t start = i;
+            while (i < size && CHARS.identBody[(unsigned char)data[i]]) i++;
+            size_t length = i - start;
+
+            // Raw string literal: skip to )delim"
+            if (i < size && data[i] == '"' && isRawPrefix(data + start, length)) {
+                const char* paren = (const char*)memchr(data + i, '(', std::min<size_t>(size - i, 20));
+                if (paren != nullptr) {
+                    std::string closing = ")" + std::string(data + i + 1, paren) + "\"";
+                    const char* end = std::search(paren, data + size, closing.begin(), closing.end());
+                    i = std::min(size, (size_t)(end - data) + closing.size());
+                    continue;
+                }
+            }
+
+            // Single letters (loop counters and the like) are not worth suggesting
+            if (length < 2) continue;
+
+            token.assign(data + start, length);
+            uint32_t id = counts.intern(token);
+            counts.counts[id]++;
+            counts.occurrences++;
+
+            if (previous >= 0) {
+                counts.edges[((uint64_t)previous << 32) | id]++;
+            }
+            previous = id;
+            continue;
+        }
+
+        // Statement boundaries end a co-occurrence chain
+        if (c == ';' || c == '{' || c == '}') {
+            previous = -1;
+        }
+        i++;
+    }
+}
+
+size_t ProjectIndexer::scanFile(const std::filesystem::path& path, TokenCounts& counts) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    size_t size = st.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return 0;
+
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    tokenize((const char*)mapped, size, counts);
+    munmap(mapped, size);
+
+    return size;
+}
+
+void ProjectIndexer::apply(const TokenCounts& counts, Dictionary& dictionary, FreqStore& freqStore,
+                           CooccurrenceGraph& graph) {
+    for (const auto& token : counts.names) {
+        dictionary.insert(token);
+    }
+    // Project counts are rebuilt by every index, so they never reach the file
+    freqStore.bumpProject(counts.tokenMap());
+
+    for (const auto& [edge, count] : counts.edges) {
+        graph.addEdge(counts.names[edge >> 32], counts.names[edge & 0xffffffffu], count);
+    }
+}
+
+IndexStats ProjectIndexer::indexTree(const std::string& root, Dictionary& dictionary, FreqStore& freqStore,
+                                     CooccurrenceGraph& graph, ProgressFn progress) {
+    TokenCounts merged;
+    IndexStats stats = scanTree(root, merged, progress);
+
+    auto loadStart = std::chrono::steady_clock::now();
+    apply(merged, dictionary, freqStore, graph);
+    stats.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+
+    return stats;
+}
+
+IndexStats ProjectIndexer::scanTree(const std::string& root, TokenCounts& merged,
+                                    ProgressFn progress, FileContributions* perFile) {
+    using Clock = std::chrono::steady_clock;
+    IndexStats stats;
+
+    auto scanStart = Clock::now();
+    std::vector<std::filesystem::path> files = listSources(root);
+    stats.files = files.size();
+
+    unsigned workers = std::max(1u, std::min<unsigned>(threadCount, files.size()));
+    std::vector<TokenCounts> perThread(workers);
+    std::vector<TokenCounts> fileTables(perFile ? files.size() : 0);
+    std::atomic<size_t> nextFile(0);
+    std::atomic<size_t> filesDone(0);
+    std::atomic<size_t> bytesDone(0);
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < workers; t++) {
+        pool.emplace_back([&, t]() {
+            size_t idx;
+            while ((idx = nextFile.fetch_add(1)) < files.size()) {
+                if (perFile) {
+                    // Each file gets its own table, folded into the thread's
+                    bytesDone += scanFile(files[idx], fileTables[idx]);
+                    perThread[t].merge(fileTables[idx]);
+                    fileTables[idx].shrink();
+                } else {
+                    bytesDone += scanFile(files[idx], perThread[t]);
+                }
+                filesDone++;
+            }
+        });
+    }
+
+    // Report progress from the calling thread so callbacks need no locking
+    while (progress && filesDone < files.size()) {
+        progress(filesDone, files.size(), bytesDone);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+    if (progress) {
+        progress(filesDone, files.size(), bytesDone);
+    }
+    stats.bytes = bytesDone;
+    stats.scanSeconds = std::chrono::duration<double>(Clock::now() - scanStart).count();
+
+    if (perFile) {
+        for (size_t i = 0; i < files.size(); i++) {
+            (*perFile)[files[i].string()] = std::move(fileTables[i]);
+        }
+    }
+
+    // Merge smaller tables into the largest to move the fewest entries
+    auto mergeStart = Clock::now();
+    std::sort(perThread.begin(), perThread.end(), [](const TokenCounts& a, const TokenCounts& b) {
+        return a.names.size() > b.names.size();
+    });
+    merged = std::move(perThread[0]);
+    for (size_t t = 1; t < perThread.size(); t++) {
+        merged.merge(perThread[t]);
+        perThread[t] = TokenCounts();
+    }
+    stats.mergeSeconds = std::chrono::duration<double>(Clock::now() - mergeStart).count();
+
+    stats.tokens = merged.occurrences;
+    stats.uniqueTokens = merged.names.size();
+    stats.edges = merged.edges.size();
+
+    return stats;
+}
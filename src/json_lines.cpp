@@ -0,0 +1,169 @@
+#include "../include/json_lines.h"
+#include <cstdlib>
+
+namespace jsonl {
+
+namespace {
+
+void skipSpace(const std::string& s, size_t& i) {
+    while (i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) i++;
+}
+
+void appendUtf8(std::string& out, unsigned long cp) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+bool parseString(const std::string& s, size_t& i, std::string& out) {
+    if (i >= s.size() || s[i] != '"') return false;
+    i++;
+
+    while (i < s.size()) {
+        char c = s[i++];
+        if (c == '"') return true;
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (i >= s.size()) return false;
+
+        char e = s[i++];
+        switch (e) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                if (i + 4 > s.size()) return false;
+                char* end = nullptr;
+                std::string hex = s.substr(i, 4);
+                unsigned long cp = std::strtoul(hex.c_str(), &end, 16);
+                if (end != hex.c_str() + 4) return false;
+                i += 4;
+                // Surrogate pair
+                if (cp >= 0xD800 && cp < 0xDC00 && i + 6 <= s.size() && s[i] == '\\' && s[i + 1] == 'u') {
+                    std::string low = s.substr(i + 2, 4);
+                    unsigned long lo = std::strtoul(low.c_str(), &end, 16);
+                    if (end == low.c_str() + 4 && lo >= 0xDC00 && lo < 0xE000) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                        i += 6;
+                    }
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+}
+
+bool parseObject(const std::string& line, Object& out) {
+    size_t i = 0;
+    skipSpace(line, i);
+    if (i >= line.size() || line[i] != '{') return false;
+    i++;
+    skipSpace(line, i);
+
+    if (i < line.size() && line[i] == '}') {
+        i++;
+    } else {
+        while (true) {
+            std::string key, value;
+            skipSpace(line, i);
+            if (!parseString(line, i, key)) return false;
+            skipSpace(line, i);
+            if (i >= line.size() || line[i] != ':') return false;
+            i++;
+            skipSpace(line, i);
+
+            if (i < line.size() && line[i] == '"') {
+                if (!parseString(line, i, value)) return false;
+            } else {
+                // Number, true, false or null: keep the literal
+                size_t start = i;
+                while (i < line.size() && line[i] != ',' && line[i] != '}' &&
+                       line[i] != ' ' && line[i] != '\t') {
+                    if (line[i] == '{' || line[i] == '[' || line[i] == '"') return false;
+                    i++;
+                }
+                if (i == start) return false;
+                value = line.substr(start, i - start);
+            }
+            out[key] = std::move(value);
+
+            skipSpace(line, i);
+            if (i < line.size() && line[i] == ',') {
+                i++;
+                continue;
+            }
+            if (i < line.size() && line[i] == '}') {
+                i++;
+                break;
+            }
+            return false;
+        }
+    }
+
+    skipSpace(line, i);
+    return i == line.size();
+}
+
+void appendString(std::string& out, const std::string& s) {
+    static const char* const HEX = "0123456789abcdef";
+    out += '"';
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out += "\\u00";
+                    out += HEX[c >> 4];
+                    out += HEX[c & 0xF];
+                } else {
+                    out += (char)c;
+                }
+        }
+    }
+    out += '"';
+}
+
+std::string getString(const Object& obj, const std::string& key, const std::string& fallback) {
+    auto it = obj.find(key);
+    return (it != obj.end()) ? it->second : fallback;
+}
+
+long getInt(const Object& obj, const std::string& key, long fallback) {
+    auto it = obj.find(key);
+    if (it == obj.end()) return fallback;
+
+    char* end = nullptr;
+    long value = std::strtol(it->second.c_str(), &end, 10);
+    return (end != it->second.c_str() && *end == '\0') ? value : fallback;
+}
+
+}
@@ -1,4 +1,9 @@
 #include "../include/kmp.h"
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KMP_X86 1
+#endif
 using namespace std;
 
 vector<int> KMP::computeLPS (const string& pattern){
@@ -82,3 +87,144 @@ vector<int> KMP::findAll (const string& text, const string& pattern){
 //test
 
 
+// ---------------------------------------------------------------------------
+// CompiledPattern
+
+namespace {
+
+#ifdef KMP_X86
+// Each kernel scans the block starts [from, ...) that leave room for a full
+// vector at both the first and the last byte of the pattern (m >= 2), and
+// returns the first verified match, or npos with *resume set to the first
+// start it did not look at.
+
+size_t findSSE2(const char* text, size_t length, size_t from, const string& pat, size_t* resume) {
+    size_t m = pat.size();
+    const __m128i first = _mm_set1_epi8(pat[0]);
+    const __m128i last = _mm_set1_epi8(pat[m - 1]);
+
+    size_t i = from;
+    for (; i + m - 1 + 16 <= length; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(text + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(text + i + m - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+        while (mask != 0) {
+            unsigned bit = __builtin_ctz(mask);
+            if (memcmp(text + i + bit + 1, pat.data() + 1, m - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    *resume = i;
+    return string::npos;
+}
+
+__attribute__((target("avx2")))
+size_t findAVX2(const char* text, size_t length, size_t from, const string& pat, size_t* resume) {
+    size_t m = pat.size();
+    const __m256i first = _mm256_set1_epi8(pat[0]);
+    const __m256i last = _mm256_set1_epi8(pat[m - 1]);
+
+    size_t i = from;
+    for (; i + m - 1 + 32 <= length; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(text + i + m - 1));
+        unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first),
+                                                              _mm256_cmpeq_epi8(b, last)));
+        while (mask != 0) {
+            unsigned bit = __builtin_ctz(mask);
+            if (memcmp(text + i + bit + 1, pat.data() + 1, m - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    *resume = i;
+    return string::npos;
+}
+#endif
+
+}
+
+CompiledPattern::Kernel CompiledPattern::bestKernel() {
+#ifdef KMP_X86
+    static const Kernel best = __builtin_cpu_supports("avx2") ? AVX2
+                             : __builtin_cpu_supports("sse2") ? SSE2 : SCALAR;
+    return best;
+#else
+    return SCALAR;
+#endif
+}
+
+const char* CompiledPattern::kernelName(Kernel kernel) {
+    switch (kernel) {
+        case AVX2: return "avx2";
+        case SSE2: return "sse2";
+        default:   return "scalar";
+    }
+}
+
+CompiledPattern::CompiledPattern(const string& pattern, Kernel kernel)
+    : pat(pattern), lps(KMP::computeLPS(pattern)), simd(min(kernel, bestKernel())) {}
+
+size_t CompiledPattern::findScalar(const char* text, size_t length, size_t from) const {
+    size_t m = pat.size();
+    size_t j = 0;
+    for (size_t i = from; i < length; i++) {
+        while (j > 0 && text[i] != pat[j]) j = lps[j - 1];
+        if (text[i] == pat[j]) j++;
+        if (j == m) return i + 1 - m;
+    }
+    return string::npos;
+}
+
+size_t CompiledPattern::find(const char* text, size_t length, size_t from) const {
+    size_t m = pat.size();
+    if (m == 0) return from <= length ? from : string::npos;
+    if (from >= length || length - from < m) return string::npos;
+
+    if (m == 1) {
+        const void* hit = memchr(text + from, pat[0], length - from);
+        return hit ? (const char*)hit - text : string::npos;
+    }
+
+#ifdef KMP_X86
+    if (simd != SCALAR) {
+        size_t resume = from;
+        size_t found = simd == AVX2 ? findAVX2(text, length, from, pat, &resume)
+                                    : findSSE2(text, length, from, pat, &resume);
+        if (found != string::npos) return found;
+        from = resume;
+    }
+#endif
+    return findScalar(text, length, from);
+}
+
+bool CompiledPattern::contains(const string& text) const {
+    return pat.empty() || find(text.data(), text.size()) != string::npos;
+}
+
+vector<int> CompiledPattern::findAll(const string& text) const {
+    vector<int> pos;
+    size_t m = pat.size();
+    if (m == 0) return pos;
+
+    if (simd == SCALAR && m > 1) {
+        // One pass that keeps the matched length across matches, as
+        // KMP::findAll does; restarting find() after each match would cost
+        // O(n * m) on periodic patterns
+        size_t j = 0;
+        for (size_t i = 0; i < text.size(); i++) {
+            while (j > 0 && text[i] != pat[j]) j = lps[j - 1];
+            if (text[i] == pat[j]) j++;
+            if (j == m) {
+                pos.push_back((int)(i + 1 - m));
+                j = lps[m - 1];
+            }
+        }
+        return pos;
+    }
+
+    for (size_t at = find(text.data(), text.size()); at != string::npos;
+         at = find(text.data(), text.size(), at + 1)) {
+        pos.push_back((int)at);
+    }
+    return pos;
+}
@@ -0,0 +1,168 @@
+#include "../include/line_index.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LINE_INDEX_X86 1
+#endif
+
+namespace {
+
+#ifdef LINE_INDEX_X86
+// Each kernel counts whole vectors and returns how many bytes it covered.
+// A compare yields 0xFF (-1) per matching byte, so subtracting it adds one
+// to that byte lane; lanes are summed with SAD every 255 vectors, before
+// they can overflow.
+
+size_t countSSE2(const char* data, size_t length, size_t* done) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i zero = _mm_setzero_si128();
+    size_t total = 0;
+    size_t i = 0;
+
+    while (i + 16 <= length) {
+        size_t end = i + std::min<size_t>(255, (length - i) / 16) * 16;
+        __m128i lanes = zero;
+        for (; i < end; i += 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+            lanes = _mm_sub_epi8(lanes, _mm_cmpeq_epi8(chunk, newline));
+        }
+        __m128i sums = _mm_sad_epu8(lanes, zero);
+        total += (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_extract_epi16(sums, 4);
+    }
+    *done = i;
+    return total;
+}
+
+__attribute__((target("avx2")))
+size_t countAVX2(const char* data, size_t length, size_t* done) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i zero = _mm256_setzero_si256();
+    size_t total = 0;
+    size_t i = 0;
+
+    while (i + 32 <= length) {
+        size_t end = i + std::min<size_t>(255, (length - i) / 32) * 32;
+        __m256i lanes = zero;
+        for (; i < end; i += 32) {
+            __m256i chunk = _mm256_loadu_si256((const __m256i*)(data + i));
+            lanes = _mm256_sub_epi8(lanes, _mm256_cmpeq_epi8(chunk, newline));
+        }
+        uint64_t sums[4];
+        _mm256_storeu_si256((__m256i*)sums, _mm256_sad_epu8(lanes, zero));
+        total += sums[0] + sums[1] + sums[2] + sums[3];
+    }
+    *done = i;
+    return total;
+}
+#endif
+
+}
+
+size_t LineIndex::countNewlines(const char* data, size_t length) {
+    size_t total = 0;
+    size_t done = 0;
+#ifdef LINE_INDEX_X86
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    total = avx2 ? countAVX2(data, length, &done) : countSSE2(data, length, &done);
+#endif
+    for (size_t i = done; i < length; i++) {
+        total += data[i] == '\n';
+    }
+    return total;
+}
+
+LineIndex::LineIndex() : data(nullptr), size(0), indexed(0), cancel(false) {}
+
+LineIndex::~LineIndex() {
+    reset();
+}
+
+void LineIndex::indexBlocks(size_t from, size_t to) {
+    for (size_t b = from; b < to; b++) {
+        if (cancel.load(std::memory_order_relaxed)) return;
+        size_t begin = b * BLOCK;
+        size_t length = std::min(BLOCK, size - begin);
+        prefix[b + 1] = prefix[b] + countNewlines(data + begin, length);
+        indexed.store(b + 1, std::memory_order_release);
+    }
+}
+
+void LineIndex::build(const char* text, size_t length, bool background, size_t eager) {
+    reset();
+    data = text;
+    size = length;
+
+    // Sized up front: readers use prefix[0, indexed] while the worker fills the rest
+    size_t total = blocks();
+    prefix.assign(total + 1, 0);
+
+    size_t first = std::min(total, (eager + BLOCK - 1) / BLOCK);
+    indexBlocks(0, first);
+    if (background && first < total) {
+        worker = std::thread(&LineIndex::indexBlocks, this, first, total);
+    } else {
+        indexBlocks(first, total);
+    }
+}
+
+void LineIndex::reset() {
+    cancel.store(true);
+    if (worker.joinable()) worker.join();
+    cancel.store(false);
+
+    data = nullptr;
+    size = 0;
+    prefix.clear();
+    indexed.store(0);
+}
+
+void LineIndex::wait() {
+    if (worker.joinable()) worker.join();
+}
+
+double LineIndex::progress() const {
+    size_t total = blocks();
+    return total == 0 ? 1.0 : (double)indexed.load(std::memory_order_acquire) / total;
+}
+
+size_t LineIndex::knownBreaks() const {
+    if (prefix.empty()) return 0;
+    return prefix[indexed.load(std::memory_order_acquire)];
+}
+
+size_t LineIndex::breaksBefore(size_t offset) const {
+    if (prefix.empty()) return 0;
+    offset = std::min(offset, size);
+
+    // Count from the start of offset's block, or from the end of the indexed
+    // prefix when the worker has not got that far
+    size_t block = std::min(offset / BLOCK, indexed.load(std::memory_order_acquire));
+    size_t begin = block * BLOCK;
+    return prefix[block] + countNewlines(data + begin, offset - begin);
+}
+
+size_t LineIndex::findBreak(size_t k) const {
+    if (prefix.empty()) return npos;
+
+    size_t done = indexed.load(std::memory_order_acquire);
+    size_t block = done;
+    size_t end = size;
+    if (k < prefix[done]) {
+        // The block holding it is the last one with fewer than k + 1 before it
+        block = std::upper_bound(prefix.begin(), prefix.begin() + done + 1, (uint64_t)k) - prefix.begin() - 1;
+        end = std::min(size, (block + 1) * BLOCK);
+    }
+
+    size_t remaining = k - prefix[block];
+    const char* cursor = data + block * BLOCK;
+    const char* limit = data + end;
+    while (cursor < limit) {
+        const char* hit = (const char*)std::memchr(cursor, '\n', limit - cursor);
+        if (hit == nullptr) break;
+        if (remaining == 0) return hit - data;
+        remaining--;
+        cursor = hit + 1;
+    }
+    return npos;
+}
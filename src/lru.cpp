@@ -88,3 +88,21 @@ void lru_cache::clear() {
     tail = nullptr;
     cacheMap.clear();
 }
+
+MemoryUsage lru_cache::memoryUsage() const{
+    MemoryUsage usage;
+    usage.items = cacheMap.size();
+    usage.addNodes(MemoryUsage::hashNode<pair<const string, Node*>>(true), cacheMap.size());
+    usage.addBuckets(cacheMap.bucket_count());
+
+    for(Node* node = head; node != nullptr; node = node->next){
+        usage.addNodes(sizeof(Node));
+        usage.addString(node->key);     // the map holds a second copy
+        usage.addString(node->key);
+        usage.addArray(node->val.size() * sizeof(string), node->val.capacity() * sizeof(string));
+        for(const auto& s : node->val){
+            usage.addString(s);
+        }
+    }
+    return usage;
+}
@@ -1,216 +1,273 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
-#include <vector>
 #include <string>
+#include <cctype>
 #include <algorithm>
-#include "../include/tst.h"
-#include "../include/minheap.h"
-#include "../include/lru.h"
-#include "../include/kmp.h"
-#include "../include/stack.h"
-#include "../include/graph.h"
-#include "../include/freq_store.h"
-#include "../include/ranker.h"
-#include "../include/phrase_store.h"
-
-class AutocompleteEngine {
-private:
-    TST tst;
-    LRUCache cache;
-    FreqStore freqStore;
-    CooccurrenceGraph graph;
-    Ranker ranker;
-    UndoRedoStack undoRedo;
-    PhraseStore phraseStore;
-    std::string lastAccepted;
-    bool useSubstringSearch;
-    bool usePhraseCompletion;
-
-    void loadSeeds(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()){
-            std::cerr << "Warning: Could not open " << filename << std::endl;
-            return;
-        }
-
-        std::string word;
-        int count = 0;
-        while (file >> word) {
-            if (!word.empty()) {
-                tst.insert(word);
-                count++;
-            }
-        }
-        file.close();
-        std::cout << "Loaded " << count << " tokens from seed file." << std::endl;
-    }
-
-    std::vector<std::string> substringSearch(const std::string& prefix){
-        std::vector<std::string> allWords;
-        tst.getAllWords(allWords);
+#include "../include/engine.h"
+#include "../include/server.h"
+#include "../include/batch.h"
+#include "../include/metrics.h"
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sstream>
+#include <chrono>
 
-        std::vector<std::string> results;
-        for (const auto& word : allWords) {
-            if (KMP::contains(word, prefix)) {
-                results.push_back(word);
-            }
-        }
+static const char* const DEFAULT_SOCKET = "/tmp/smart_autocomplete.sock";
 
-        return results;
+void showHelp() {
+    std::cout << "\n=== Smart Autocomplete Engine ===" << std::endl;
+    std::cout << "\nCommands:" << std::endl;
+    std::cout << ":help - Show this help message" << std::endl;
+    std::cout << ":exit or :q - Exit the program" << std::endl;
+    std::cout << ":bump <token> - Increase frequency of a token" << std::endl;
+    std::cout << ":undo - Undo last accepted token" << std::endl;
+    std::cout << ":redo - Redo last undone token" << std::endl;
+    std::cout << ":toggle_contains - Toggle substring search" << std::endl;
+    std::cout << ":toggle_phrases - Toggle phrase completion" << std::endl;
+    std::cout << ":learn <trigger> <full_text> - Manually teach a phrase" << std::endl;
+    std::cout << ":graph - Display co-occurrence graph" << std::endl;
+    std::cout << ":save - Save learned phrases to disk" << std::endl;
+    std::cout << ":index <dir> - Learn identifiers from C/C++ sources under dir and keep them in sync as files change" << std::endl;
+    std::cout << ":stats [json [file]] - Show per-stage latency and cache counters" << std::endl;
+    std::cout << ":mem - Show memory used by each data structure" << std::endl;
+    std::cout << ":fuzzy <query> [max_errors] - Find words containing query with typos (default 1)" << std::endl;
+    std::cout << "\nUsage:" << std::endl;
+    std::cout << " - Type a prefix to get suggestions" << std::endl;
+    std::cout << " - Select by number or type the full token" << std::endl;
+    std::cout << " - After accepting, type full code (e.g., for(i=0;i<n;i++))" << std::endl;
+    std::cout << " - Press Enter to learn the phrase, or skip" << std::endl;
+    std::cout << "\nServer mode: smart_autocomplete --serve [socket_path]" << std::endl;
+    std::cout << "Batch mode:  smart_autocomplete --batch [file] [-k N] [--json]" << std::endl;
+    std::cout << "Any mode takes --dictionary tst|radix|art|sorted first to pick the word store" << std::endl;
+    std::cout << std::endl;
+}
+
+void indexProject(AutocompleteEngine& engine, const std::string& root) {
+    auto stats = engine.indexProject(root,
+        [](size_t done, size_t total, size_t bytes) {
+            std::cout << "\rIndexing: " << done << "/" << total << " files, "
+                      << bytes / (1024 * 1024) << " MB" << std::flush;
+        });
+    std::cout << std::endl;
+
+    std::cout << "Indexed " << stats.files << " files (" << stats.bytes / 1024 << " KB): "
+              << stats.tokens << " tokens, " << stats.uniqueTokens << " unique, "
+              << stats.edges << " co-occurrence edges" << std::endl;
+    std::cout << "Scan " << stats.scanSeconds * 1000 << " ms ("
+              << stats.megabytesPerSecond() << " MB/s), merge "
+              << stats.mergeSeconds * 1000 << " ms, load "
+              << stats.loadSeconds * 1000 << " ms" << std::endl;
+    std::cout << "Watching " << engine.watchedDirectories()
+              << " directories for changes" << std::endl;
+}
+
+// Pick up files changed on disk since the last command
+void refreshIndex(AutocompleteEngine& engine) {
+    auto stats = engine.refreshIndex();
+    if (stats.fullRescan) {
+        std::cout << "File events were lost; re-indexed all " << stats.filesRescanned
+                  << " files in " << stats.seconds * 1000 << " ms" << std::endl;
+        return;
     }
-
-
-public:
-    AutocompleteEngine()
-        : cache(50),
-        freqStore("data/frequency.txt"),
-        phraseStore("data/phrases.txt"),
-        ranker(&freqStore, &graph),
-        useSubstringSearch(false),
-        usePhraseCompletion(true){
-
-        loadSeeds("data/words.txt");
-        std::cout << "Loaded " << phraseStore.getTotalPhrases() << " learned phrases." << std::endl;
+    if (stats.filesRescanned == 0 && stats.filesRemoved == 0) {
+        return;
     }
 
-    std::vector<std::pair<std::string, double>> getSuggestions(const std::string& prefix, int k = 5){
-        if (prefix.empty()) {
-            return std::vector<std::pair<std::string, double>>();
-        }
+    std::cout << "Re-indexed " << stats.filesRescanned << " changed and "
+              << stats.filesRemoved << " removed files (+" << stats.tokensAdded
+              << "/-" << stats.tokensRemoved << " tokens) in "
+              << stats.seconds * 1000 << " ms" << std::endl;
+}
 
-        if (cache.exists(prefix)) {
-            auto cached = cache.get(prefix);
-            std::vector<std::pair<std::string, double>> result;
-            for (const auto& token : cached) {
-                result.push_back(std::make_pair(token, freqStore.get(token)));
-            }
-            return result;
-        }
+void showStats(const std::string& args) {
+    metrics::Snapshot snapshot = metrics::collect();
 
-        std::vector<std::string> candidates = tst.prefixSearch(prefix, k * 2);
-
-        if (candidates.size()<3 && useSubstringSearch) {
-            auto substringResults = substringSearch(prefix);
-            candidates.insert(candidates.end(), substringResults.begin(), substringResults.end());
-            
-            std::sort(candidates.begin(), candidates.end());
-            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
-        }
-
-        ranker.setLastToken(lastAccepted);
-        auto ranked = ranker.rankResults(candidates, k);
-
-        std::vector<std::string> toCache;
-        for (const auto& [token, score] : ranked){
-            toCache.push_back(token);
+    if (args.substr(0, 4) == "json") {
+        std::string json = metrics::toJson(snapshot);
+        std::string path = args.size() > 5 ? args.substr(5) : "";
+        if (path.empty()) {
+            std::cout << json << std::endl;
+            return;
         }
-        cache.put(prefix, toCache);
-
-        return ranked;
+        std::ofstream out(path);
+        out << json << std::endl;
+        std::cout << (out ? "Wrote stats to " : "Could not write ") << path << std::endl;
+        return;
     }
 
-    void acceptSuggestion(const std::string& token){
-        freqStore.bump(token, 1);
-        
-        if (!lastAccepted.empty()){
-            graph.addEdge(lastAccepted, token);
-        }
-        
-        undoRedo.pushInsert(0, token);
-        lastAccepted = token;
-        
-        std::cout << "Accepted: "<< token << std::endl;
+    uint64_t hits = snapshot.counters[metrics::CACHE_HITS];
+    uint64_t misses = snapshot.counters[metrics::CACHE_MISSES];
+    std::cout << "Cache: " << hits << " hits, " << misses << " misses";
+    if (hits + misses > 0) {
+        std::cout << " (" << 100.0 * hits / (hits + misses) << "% hit rate)";
     }
-
-    void bumpToken(const std::string& token) {
-        freqStore.bump(token, 5);
-        std::cout << "Bumped frequency of '" << token << "' by 5" << std::endl;
+    std::cout << ", " << snapshot.counters[metrics::SUBSTRING_FALLBACKS] << " substring fallbacks" << std::endl;
+
+    char row[160];
+    snprintf(row, sizeof(row), "%-17s %9s %8s %9s %9s %9s %9s %9s", "stage", "calls", "timed",
+             "mean us", "p50 us", "p99 us", "p99.9 us", "max us");
+    std::cout << row << std::endl;
+    for (int s = 0; s < metrics::STAGE_COUNT; s++) {
+        const metrics::StageStats& stats = snapshot.stages[s];
+        snprintf(row, sizeof(row), "%-17s %9llu %8llu %9.2f %9.2f %9.2f %9.2f %9.2f",
+                 metrics::stageName((metrics::Stage)s), (unsigned long long)stats.calls,
+                 (unsigned long long)stats.timed, stats.meanNs() / 1000.0,
+                 stats.percentile(50) / 1000.0, stats.percentile(99) / 1000.0,
+                 stats.percentile(99.9) / 1000.0, stats.maxNs / 1000.0);
+        std::cout << row << std::endl;
     }
-
-    void performUndo() {
-        if (undoRedo.canUndo()) {
-            auto [pos, token] = undoRedo.undo();
-            std::cout << "Undo: Removed '" << token << "'" << std::endl;
-        } else {
-            std::cout << "Nothing to undo" << std::endl;
-        }
+}
+
+void showMemory(const AutocompleteEngine& engine) {
+    char row[160];
+    snprintf(row, sizeof(row), "%-13s %9s %11s %11s %11s %11s %11s %9s", "structure", "items",
+             "nodes", "strings", "buckets", "overhead", "total", "B/item");
+    std::cout << row << std::endl;
+
+    MemoryUsage sum;
+    for (const auto& [name, usage] : engine.memoryUsage()) {
+        snprintf(row, sizeof(row), "%-13s %9zu %11zu %11zu %11zu %11zu %11zu %9.1f", name.c_str(),
+                 usage.items, usage.nodes, usage.strings, usage.buckets, usage.overhead,
+                 usage.total(), usage.bytesPerItem());
+        std::cout << row << std::endl;
+        sum += usage;
     }
-
-    void performRedo() {
-        if (undoRedo.canRedo()) {
-            auto [pos, token] = undoRedo.redo();
-            std::cout << "Redo: Restored '" << token << "'" << std::endl;
-        } else {
-            std::cout << "Nothing to redo" << std::endl;
-        }
+    // Items differ in kind between structures, so they are not summed
+    snprintf(row, sizeof(row), "%-13s %9s %11zu %11zu %11zu %11zu %11zu", "total", "",
+             sum.nodes, sum.strings, sum.buckets, sum.overhead, sum.total());
+    std::cout << row << std::endl;
+
+    // Resident set size from /proc, for comparison with the accounted total
+    std::ifstream statm("/proc/self/statm");
+    size_t pages, resident;
+    if (statm >> pages >> resident) {
+        std::cout << "Process resident: " << resident * sysconf(_SC_PAGESIZE) / 1024 << " KB" << std::endl;
     }
-
-    void toggleSubstringSearch() {
-        useSubstringSearch = !useSubstringSearch;
-        std::cout << "Substring search: " << (useSubstringSearch ? "ON" : "OFF") << std::endl;
+}
+
+void showFuzzy(AutocompleteEngine& engine, const std::string& args) {
+    std::istringstream in(args);
+    std::string query;
+    int maxErrors = 1;
+    if (!(in >> query)) {
+        std::cout << "Usage: :fuzzy <query> [max_errors]" << std::endl;
+        return;
     }
+    in >> maxErrors;
 
-    void togglePhraseCompletion() {
-        usePhraseCompletion = !usePhraseCompletion;
-        std::cout << "Phrase completion: " << (usePhraseCompletion ? "ON" : "OFF") << std::endl;
-    }
+    auto start = std::chrono::steady_clock::now();
+    auto matches = engine.fuzzySearch(query, maxErrors, 10);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 
-    void learnPhrase(const std::string& trigger, const std::string& fullText) {
-        phraseStore.addPhrase(trigger, fullText);
-        std::cout << "Learned phrase: \"" << fullText << "\" for trigger \"" << trigger << "\"" << std::endl;
+    if (matches.empty()) {
+        std::cout << "No words within " << maxErrors << " edits of '" << query << "'" << std::endl;
+        return;
+    }
+    for (size_t i = 0; i < matches.size(); i++) {
+        std::cout << "  " << (i + 1) << ". " << matches[i].word << " (" << matches[i].distance
+                  << (matches[i].distance == 1 ? " edit)" : " edits)") << std::endl;
+    }
+    std::cout << "(" << ms << " ms)" << std::endl;
+}
+
+void acceptSuggestion(AutocompleteEngine& engine, const std::string& token) {
+    engine.acceptSuggestion(token);
+    std::cout << "Accepted: "<< token << std::endl;
+}
+
+void learnPhrase(AutocompleteEngine& engine, const std::string& trigger, const std::string& fullText) {
+    engine.learnPhrase(trigger, fullText);
+    std::cout << "Learned phrase: \"" << fullText << "\" for trigger \"" << trigger << "\"" << std::endl;
+}
+
+int serve(AutocompleteEngine& engine, const std::string& socketPath) {
+    AutocompleteServer server(engine, socketPath);
+    std::string error;
+    if (!server.listen(error)) {
+        std::cerr << "Cannot listen: " << error << std::endl;
+        return 1;
     }
 
-    std::vector<std::string> getPhraseSuggestions(const std::string& prefix) {
-        std::vector<std::string> suggestions;
+    std::cout << "Listening on " << socketPath << " (Ctrl+C to stop)" << std::endl;
+    server.run();
 
-        if (!usePhraseCompletion) {
-            return suggestions;
+    int phrases = engine.savePhrases();
+    const ServerStats& stats = server.getStats();
+    std::cout << "Served " << stats.requests << " requests (" << stats.errors << " errors) over "
+              << stats.connections << " connections; saved " << phrases << " learned phrases." << std::endl;
+    return 0;
+}
+
+// smart_autocomplete --batch [file] [-k N] [--json]
+int batch(AutocompleteEngine& engine, int argc, char** argv) {
+    BatchOptions options;
+    const char* inputPath = nullptr;
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-k" && i + 1 < argc) {
+            options.k = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--json") {
+            options.json = true;
+        } else if (inputPath == nullptr && arg != "-") {
+            inputPath = argv[i];
+        } else if (arg != "-") {
+            std::cerr << "Unexpected argument " << arg << std::endl;
+            return 1;
         }
+    }
 
-        // Get learned phrases for this prefix
-        auto phrases = phraseStore.getTopPhrases(prefix, 3);
-
-        for (const auto& phrase : phrases) {
-            suggestions.push_back(phrase.snippet);
+    FILE* in = stdin;
+    if (inputPath != nullptr) {
+        in = fopen(inputPath, "rb");
+        if (in == nullptr) {
+            std::cerr << "Cannot open " << inputPath << std::endl;
+            return 1;
         }
-
-        return suggestions;
     }
 
-    void displayGraph() {
-        graph.display();
+    BatchRunner runner(engine, options);
+    BatchStats stats = runner.run(in, stdout);
+    if (in != stdin) {
+        fclose(in);
     }
 
-    void savePhrases() {
-        phraseStore.save();
-        std::cout << "Saved " << phraseStore.getTotalPhrases() << " learned phrases." << std::endl;
+    // Summary goes to stderr so stdout stays machine-readable
+    std::cerr << "Answered " << stats.queries << " queries (" << stats.accepts << " accepts) in "
+              << stats.seconds * 1000 << " ms: " << stats.queriesPerSecond() << " queries/s" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // smart_autocomplete [--dictionary kind] [mode ...]; the rest of the
+    // arguments are parsed as if the option were not there
+    std::string dictionary = DICTIONARY_DEFAULT;
+    if (argc > 2 && std::string(argv[1]) == "--dictionary") {
+        dictionary = argv[2];
+        argv += 2;
+        argc -= 2;
     }
-
-    void showHelp() {
-        std::cout << "\n=== Smart Autocomplete Engine ===" << std::endl;
-        std::cout << "\nCommands:" << std::endl;
-        std::cout << ":help - Show this help message" << std::endl;
-        std::cout << ":exit or :q - Exit the program" << std::endl;
-        std::cout << ":bump <token> - Increase frequency of a token" << std::endl;
-        std::cout << ":undo - Undo last accepted token" << std::endl;
-        std::cout << ":redo - Redo last undone token" << std::endl;
-        std::cout << ":toggle_contains - Toggle substring search" << std::endl;
-        std::cout << ":toggle_phrases - Toggle phrase completion" << std::endl;
-        std::cout << ":learn <trigger> <full_text> - Manually teach a phrase" << std::endl;
-        std::cout << ":graph - Display co-occurrence graph" << std::endl;
-        std::cout << ":save - Save learned phrases to disk" << std::endl;
-        std::cout << "\nUsage:" << std::endl;
-        std::cout << " - Type a prefix to get suggestions" << std::endl;
-        std::cout << " - Select by number or type the full token" << std::endl;
-        std::cout << " - After accepting, type full code (e.g., for(i=0;i<n;i++))" << std::endl;
-        std::cout << " - Press Enter to learn the phrase, or skip" << std::endl;
-        std::cout << std::endl;
+    if (!Dictionary::create(dictionary)) {
+        std::cerr << "Unknown dictionary " << dictionary << "; choose one of:";
+        for (const auto& kind : Dictionary::kinds()) std::cerr << ' ' << kind;
+        std::cerr << std::endl;
+        return 1;
     }
-};
 
-int main() {
-    AutocompleteEngine engine;
+    std::string mode = argc > 1 ? argv[1] : "";
+    AutocompleteEngine engine(dictionary);
+
+    std::ostream& log = (mode == "--batch") ? std::cerr : std::cout;
+    log << "Loaded " << engine.seedCount() << " tokens from seed file." << std::endl;
+    log << "Loaded " << engine.phraseCount() << " learned phrases." << std::endl;
+
+    if (mode == "--serve") {
+        return serve(engine, argc > 2 ? argv[2] : DEFAULT_SOCKET);
+    }
+    if (mode == "--batch") {
+        return batch(engine, argc, argv);
+    }
     
     std::cout << "\n=== Smart Autocomplete Engine ===" << std::endl;
     std::cout << "Type ':help' for commands" << std::endl;
@@ -220,7 +277,10 @@ int main() {
     
     while (true) {
         std::cout << "> ";
-        std::getline(std::cin, input);
+        if (!std::getline(std::cin, input)) {
+            break;
+        }
+        refreshIndex(engine);
 
         if (input.empty()) {
             continue;
@@ -233,27 +293,39 @@ int main() {
 
         
         if (input == ":help") {
-            engine.showHelp();
+            showHelp();
             continue;
         }
 
         if (input == ":undo") {
-            engine.performUndo();
+            std::string removed;
+            if (engine.performUndo(removed)) {
+                std::cout << "Undo: Removed '" << removed << "'" << std::endl;
+            } else {
+                std::cout << "Nothing to undo" << std::endl;
+            }
             continue;
         }
 
         if (input == ":redo") {
-            engine.performRedo();
+            std::string restored;
+            if (engine.performRedo(restored)) {
+                std::cout << "Redo: Restored '" << restored << "'" << std::endl;
+            } else {
+                std::cout << "Nothing to redo" << std::endl;
+            }
             continue;
         }
 
         if (input == ":toggle_contains") {
-            engine.toggleSubstringSearch();
+            bool on = engine.toggleSubstringSearch();
+            std::cout << "Substring search: " << (on ? "ON" : "OFF") << std::endl;
             continue;
         }
 
         if (input == ":toggle_phrases") {
-            engine.togglePhraseCompletion();
+            bool on = engine.togglePhraseCompletion();
+            std::cout << "Phrase completion: " << (on ? "ON" : "OFF") << std::endl;
             continue;
         }
 
@@ -263,7 +335,8 @@ int main() {
         }
 
         if (input == ":save") {
-            engine.savePhrases();
+            int saved = engine.savePhrases();
+            std::cout << "Saved " << saved << " learned phrases." << std::endl;
             continue;
         }
 
@@ -273,16 +346,37 @@ int main() {
             if (spacePos != std::string::npos) {
                 std::string trigger = rest.substr(0, spacePos);
                 std::string fullText = rest.substr(spacePos + 1);
-                engine.learnPhrase(trigger, fullText);
+                learnPhrase(engine, trigger, fullText);
             } else {
                 std::cout << "Usage: :learn <trigger> <full_text>" << std::endl;
             }
             continue;
         }
 
+        if (input == ":stats" || input.substr(0, 7) == ":stats ") {
+            showStats(input.size() > 7 ? input.substr(7) : "");
+            continue;
+        }
+
+        if (input.substr(0, 7) == ":fuzzy ") {
+            showFuzzy(engine, input.substr(7));
+            continue;
+        }
+
+        if (input == ":mem") {
+            showMemory(engine);
+            continue;
+        }
+
+        if (input.substr(0, 7) == ":index ") {
+            indexProject(engine, input.substr(7));
+            continue;
+        }
+
         if (input.substr(0, 6) == ":bump ") {
             std::string token = input.substr(6);
             engine.bumpToken(token);
+            std::cout << "Bumped frequency of '" << token << "' by 5" << std::endl;
             continue;
         }
 
@@ -333,7 +427,7 @@ int main() {
                     // Selected a regular token
                     int tokenIndex = num - phraseSuggestions.size() - 1;
                     acceptedToken = suggestions[tokenIndex].first;
-                    engine.acceptSuggestion(acceptedToken);
+                    acceptSuggestion(engine, acceptedToken);
 
                     // Prompt for phrase learning
                     std::cout << "\nType complete code for '" << acceptedToken
@@ -342,7 +436,7 @@ int main() {
                     std::getline(std::cin, fullCode);
 
                     if (!fullCode.empty() && fullCode != acceptedToken) {
-                        engine.learnPhrase(acceptedToken, fullCode);
+                        learnPhrase(engine, acceptedToken, fullCode);
                     }
                 }
             } else {
@@ -354,7 +448,7 @@ int main() {
             bool found = false;
             for (const auto& [token, score] : suggestions) {
                 if (token == choice) {
-                    engine.acceptSuggestion(token);
+                    acceptSuggestion(engine, token);
                     acceptedToken = token;
                     found = true;
 
@@ -365,7 +459,7 @@ int main() {
                     std::getline(std::cin, fullCode);
 
                     if (!fullCode.empty() && fullCode != acceptedToken) {
-                        engine.learnPhrase(acceptedToken, fullCode);
+                        learnPhrase(engine, acceptedToken, fullCode);
                     }
                     break;
                 }
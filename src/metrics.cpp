@@ -0,0 +1,187 @@
+#include "../include/metrics.h"
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace metrics {
+
+namespace {
+
+const char* const STAGE_NAMES[STAGE_COUNT] = {
+    "suggest", "cache_lookup", "prefix_search", "substring_search", "rank",
+    "cache_fill", "phrases", "accept", "freq_save"
+};
+
+const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+    "cache_hits", "cache_misses", "substring_fallbacks"
+};
+
+// Blocks of live threads, plus the totals of threads that have exited
+struct Registry {
+    std::mutex lock;
+    std::vector<ThreadBlock*> blocks;
+    ThreadBlock retired;
+    size_t retiredThreads = 0;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();     // outlives thread_local destructors
+    return *instance;
+}
+
+void addBlock(ThreadBlock& into, const ThreadBlock& from) {
+    auto sum = [](std::atomic<uint64_t>& a, const std::atomic<uint64_t>& b) {
+        add(a, b.load(std::memory_order_relaxed));
+    };
+    for (size_t c = 0; c < COUNTER_COUNT; c++) {
+        sum(into.counters[c], from.counters[c]);
+    }
+    for (size_t s = 0; s < STAGE_COUNT; s++) {
+        sum(into.calls[s], from.calls[s]);
+        sum(into.timed[s], from.timed[s]);
+        sum(into.totalNs[s], from.totalNs[s]);
+        into.maxNs[s].store(std::max(into.maxNs[s].load(std::memory_order_relaxed),
+                                     from.maxNs[s].load(std::memory_order_relaxed)),
+                            std::memory_order_relaxed);
+        for (size_t b = 0; b < BUCKETS; b++) {
+            sum(into.buckets[s][b], from.buckets[s][b]);
+        }
+    }
+}
+
+// Owns a thread's block and folds it into the retired totals on exit
+struct BlockOwner {
+    std::unique_ptr<ThreadBlock> block;
+
+    ~BlockOwner() {
+        if (!block) return;
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        addBlock(reg.retired, *block);
+        reg.retiredThreads++;
+        reg.blocks.erase(std::remove(reg.blocks.begin(), reg.blocks.end(), block.get()), reg.blocks.end());
+        localBlock = nullptr;
+    }
+};
+
+}
+
+thread_local ThreadBlock* localBlock = nullptr;
+
+ThreadBlock::ThreadBlock() {
+    for (auto& c : counters) c.store(0, std::memory_order_relaxed);
+    for (size_t s = 0; s < STAGE_COUNT; s++) {
+        sampleCountdown[s] = 0;
+        calls[s].store(0, std::memory_order_relaxed);
+        timed[s].store(0, std::memory_order_relaxed);
+        totalNs[s].store(0, std::memory_order_relaxed);
+        maxNs[s].store(0, std::memory_order_relaxed);
+        for (auto& b : buckets[s]) b.store(0, std::memory_order_relaxed);
+    }
+}
+
+ThreadBlock& registerThread() {
+    static thread_local BlockOwner owner;
+    owner.block.reset(new ThreadBlock());
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    reg.blocks.push_back(owner.block.get());
+    localBlock = owner.block.get();
+    return *localBlock;
+}
+
+const char* stageName(Stage stage) {
+    return STAGE_NAMES[stage];
+}
+
+const char* counterName(Counter counter) {
+    return COUNTER_NAMES[counter];
+}
+
+void record(ThreadBlock& block, Stage stage, uint64_t ns) {
+    add(block.timed[stage]);
+    add(block.totalNs[stage], ns);
+    if (ns > block.maxNs[stage].load(std::memory_order_relaxed)) {
+        block.maxNs[stage].store(ns, std::memory_order_relaxed);
+    }
+    add(block.buckets[stage][bucketIndex(ns)]);
+}
+
+uint64_t StageTimer::timedLap(Stage stage) {
+    auto now = Clock::now();
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count();
+    last = now;
+    record(block, stage, ns);
+    return ns;
+}
+
+uint64_t StageTimer::timedTotal(Stage stage) {
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    record(block, stage, ns);
+    return ns;
+}
+
+uint64_t StageStats::percentile(double p) const {
+    return Buckets::percentile(buckets, timed, maxNs, p);
+}
+
+Snapshot collect() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+
+    Snapshot snap;
+    snap.threads = reg.blocks.size() + reg.retiredThreads;
+
+    auto gather = [&snap](const ThreadBlock& block) {
+        for (size_t c = 0; c < COUNTER_COUNT; c++) {
+            snap.counters[c] += block.counters[c].load(std::memory_order_relaxed);
+        }
+        for (size_t s = 0; s < STAGE_COUNT; s++) {
+            StageStats& stats = snap.stages[s];
+            stats.calls += block.calls[s].load(std::memory_order_relaxed);
+            stats.timed += block.timed[s].load(std::memory_order_relaxed);
+            stats.totalNs += block.totalNs[s].load(std::memory_order_relaxed);
+            stats.maxNs = std::max(stats.maxNs, block.maxNs[s].load(std::memory_order_relaxed));
+            for (size_t b = 0; b < BUCKETS; b++) {
+                stats.buckets[b] += block.buckets[s][b].load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    gather(reg.retired);
+    for (const ThreadBlock* block : reg.blocks) {
+        gather(*block);
+    }
+    return snap;
+}
+
+std::string toJson(const Snapshot& snapshot) {
+    std::string out = "{\"threads\":" + std::to_string(snapshot.threads) + ",\"counters\":{";
+    for (size_t c = 0; c < COUNTER_COUNT; c++) {
+        if (c > 0) out += ',';
+        out += '"';
+        out += COUNTER_NAMES[c];
+        out += "\":" + std::to_string(snapshot.counters[c]);
+    }
+    out += "},\"stages\":{";
+    for (size_t s = 0; s < STAGE_COUNT; s++) {
+        const StageStats& stats = snapshot.stages[s];
+        char buffer[320];
+        snprintf(buffer, sizeof(buffer),
+                 "%s\"%s\":{\"calls\":%llu,\"timed\":%llu,\"mean_ns\":%.0f,\"p50_ns\":%llu,"
+                 "\"p90_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,\"max_ns\":%llu}",
+                 s > 0 ? "," : "", STAGE_NAMES[s], (unsigned long long)stats.calls,
+                 (unsigned long long)stats.timed, stats.meanNs(),
+                 (unsigned long long)stats.percentile(50), (unsigned long long)stats.percentile(90),
+                 (unsigned long long)stats.percentile(99), (unsigned long long)stats.percentile(99.9),
+                 (unsigned long long)stats.maxNs);
+        out += buffer;
+    }
+    out += "}}";
+    return out;
+}
+
+}
@@ -119,3 +119,20 @@ int PhraseStore::getTotalPhrases() const {
     }
     return total;
 }
+
+MemoryUsage PhraseStore::memoryUsage() const {
+    MemoryUsage usage;
+    usage.addNodes(MemoryUsage::hashNode<pair<const string, vector<Phrase>>>(true), phrases.size());
+    usage.addBuckets(phrases.bucket_count());
+
+    for (const auto& [trigger, phraseList] : phrases) {
+        usage.addString(trigger);
+        usage.items += phraseList.size();
+        usage.addArray(phraseList.size() * sizeof(Phrase), phraseList.capacity() * sizeof(Phrase));
+        for (const auto& phrase : phraseList) {
+            usage.addString(phrase.trigger);
+            usage.addString(phrase.snippet);
+        }
+    }
+    return usage;
+}
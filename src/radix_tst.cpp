@@ -0,0 +1,382 @@
+#include "../include/radix_tst.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Arena bytes orphaned by merges are reclaimed by compact() once they are
+// the larger part of the arena
+const size_t COMPACT_MIN_GARBAGE = 4096;
+
+}
+
+RadixTST::RadixTST() : pool(1, RadixNode{}), garbage(0), root(NIL), nodes(0), words(0) {}
+
+void RadixTST::clear() {
+    pool.assign(1, RadixNode{});
+    freeNodes.clear();
+    labels.clear();
+    garbage = 0;
+    root = NIL;
+    nodes = 0;
+    words = 0;
+}
+
+uint32_t RadixTST::allocate() {
+    uint32_t node;
+    if (!freeNodes.empty()) {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+        pool[node] = RadixNode{};
+    } else {
+        node = (uint32_t)pool.size();
+        pool.push_back(RadixNode{});
+    }
+    nodes++;
+    return node;
+}
+
+void RadixTST::release(uint32_t node) {
+    if (pool[node].length > RadixNode::INLINE_LABEL) {
+        garbage += pool[node].length;
+    }
+    freeNodes.push_back(node);
+    nodes--;
+}
+
+// text must not point into the arena
+void RadixTST::setLabel(uint32_t node, const char* text, size_t length) {
+    RadixNode& n = pool[node];
+    n.length = (uint32_t)length;
+    if (length <= RadixNode::INLINE_LABEL) {
+        std::memcpy(n.label.text, text, length);
+    } else {
+        n.label.offset = (uint32_t)labels.size();
+        labels.insert(labels.end(), text, text + length);
+    }
+}
+
+// Cut node's label after `at` characters; the rest moves to a new eq child
+// that takes over the node's end marker and eq link
+void RadixTST::split(uint32_t node, size_t at) {
+    uint32_t tail = allocate();
+    RadixNode& head = pool[node];
+    RadixNode& rest = pool[tail];
+
+    size_t length = head.length;
+    rest.length = (uint32_t)(length - at);
+    rest.eq = head.eq;
+    rest.isEndOfString = head.isEndOfString;
+
+    if (length > RadixNode::INLINE_LABEL) {
+        // Both halves can keep pointing into the arena; short ones move inline
+        uint32_t offset = head.label.offset;
+        if (rest.length > RadixNode::INLINE_LABEL) {
+            rest.label.offset = offset + (uint32_t)at;
+        } else {
+            std::memcpy(rest.label.text, labels.data() + offset + at, rest.length);
+            garbage += rest.length;
+        }
+        if (at <= RadixNode::INLINE_LABEL) {
+            std::memcpy(head.label.text, labels.data() + offset, at);
+            garbage += at;
+        }
+    } else {
+        std::memcpy(rest.label.text, head.label.text + at, rest.length);
+    }
+
+    head.length = (uint32_t)at;
+    head.eq = tail;
+    head.isEndOfString = 0;
+}
+
+// Absorb node's only continuation (an eq child without siblings) into its label
+void RadixTST::merge(uint32_t node) {
+    RadixNode& head = pool[node];
+    uint32_t child = head.eq;
+    const RadixNode& tail = pool[child];
+
+    size_t a = head.length;
+    size_t b = tail.length;
+    const size_t INLINE = RadixNode::INLINE_LABEL;
+
+    if (a + b <= INLINE) {
+        std::memcpy(head.label.text + a, tail.label.text, b);
+    } else if (a > INLINE && b > INLINE && head.label.offset + a == tail.label.offset) {
+        // Still side by side in the arena, as a split left them
+    } else {
+        std::string joined(labelOf(head), a);
+        joined.append(labelOf(tail), b);
+        garbage += (a > INLINE ? a : 0) + (b > INLINE ? b : 0);
+        head.label.offset = (uint32_t)labels.size();
+        labels.insert(labels.end(), joined.begin(), joined.end());
+    }
+
+    head.length = (uint32_t)(a + b);
+    head.eq = tail.eq;
+    head.isEndOfString = tail.isEndOfString;
+    freeNodes.push_back(child);
+    nodes--;
+}
+
+// Take node out of its sibling BST; returns the node that replaces it
+uint32_t RadixTST::unlink(uint32_t node) {
+    uint32_t left = pool[node].left;
+    uint32_t right = pool[node].right;
+    release(node);
+
+    if (left == NIL) return right;
+    if (right == NIL) return left;
+
+    // Two siblings: the leftmost node of the right subtree takes its place
+    uint32_t parent = NIL;
+    uint32_t successor = right;
+    while (pool[successor].left != NIL) {
+        parent = successor;
+        successor = pool[successor].left;
+    }
+    if (parent != NIL) {
+        pool[parent].left = pool[successor].right;
+        pool[successor].right = right;
+    }
+    pool[successor].left = left;
+    return successor;
+}
+
+void RadixTST::insert(const std::string& word) {
+    if (word.empty()) return;
+
+    const char* key = word.data();
+    size_t length = word.size();
+    size_t i = 0;
+
+    uint32_t parent = NIL;
+    int side = 0;               // link of parent to follow: -1 left, 0 eq, 1 right
+    uint32_t node = root;
+
+    while (node != NIL) {
+        const RadixNode& n = pool[node];
+        const char* text = labelOf(n);
+        if (key[i] != text[0]) {
+            parent = node;
+            side = key[i] < text[0] ? -1 : 1;
+            node = side < 0 ? n.left : n.right;
+            continue;
+        }
+
+        size_t limit = std::min<size_t>(n.length, length - i);
+        size_t common = 1;
+        while (common < limit && key[i + common] == text[common]) {
+            common++;
+        }
+        if (common < n.length) {
+            split(node, common);
+        }
+
+        i += common;
+        if (i == length) {
+            if (!pool[node].isEndOfString) {
+                pool[node].isEndOfString = 1;
+                words++;
+            }
+            return;
+        }
+        parent = node;
+        side = 0;
+        node = pool[node].eq;
+    }
+
+    // The rest of the word becomes one node
+    uint32_t created = allocate();
+    setLabel(created, key + i, length - i);
+    pool[created].isEndOfString = 1;
+    words++;
+
+    if (parent == NIL) {
+        root = created;
+    } else if (side < 0) {
+        pool[parent].left = created;
+    } else if (side > 0) {
+        pool[parent].right = created;
+    } else {
+        pool[parent].eq = created;
+    }
+}
+
+bool RadixTST::search(const std::string& word) const {
+    if (word.empty()) return false;
+
+    size_t i = 0;
+    uint32_t node = root;
+    while (node != NIL) {
+        const RadixNode& n = pool[node];
+        const char* text = labelOf(n);
+        if (word[i] < text[0]) {
+            node = n.left;
+        } else if (word[i] > text[0]) {
+            node = n.right;
+        } else {
+            if (word.size() - i < n.length || std::memcmp(word.data() + i, text, n.length) != 0) {
+                return false;
+            }
+            i += n.length;
+            if (i == word.size()) return n.isEndOfString;
+            node = n.eq;
+        }
+    }
+    return false;
+}
+
+void RadixTST::collect(uint32_t node, std::string& path,
+                       std::vector<std::string>& results, size_t k) const {
+    // Right siblings are walked in the loop, so recursion goes only as deep
+    // as the left and eq links
+    while (node != NIL && results.size() < k) {
+        const RadixNode& n = pool[node];
+        collect(n.left, path, results, k);
+        if (results.size() >= k) return;
+
+        size_t base = path.size();
+        path.append(labelOf(n), n.length);
+        if (n.isEndOfString) {
+            results.push_back(path);
+        }
+        collect(n.eq, path, results, k);
+        path.resize(base);
+        node = n.right;
+    }
+}
+
+std::vector<std::string> RadixTST::prefixSearch(const std::string& prefix, int k) const {
+    std::vector<std::string> results;
+    if (k <= 0) return results;
+
+    std::string path;
+    if (prefix.empty()) {
+        collect(root, path, results, (size_t)k);
+        return results;
+    }
+
+    size_t i = 0;
+    uint32_t node = root;
+    while (node != NIL) {
+        const RadixNode& n = pool[node];
+        const char* text = labelOf(n);
+        if (prefix[i] < text[0]) {
+            node = n.left;
+            continue;
+        }
+        if (prefix[i] > text[0]) {
+            node = n.right;
+            continue;
+        }
+
+        size_t rest = prefix.size() - i;
+        if (rest <= n.length) {
+            // The prefix ends inside this label: everything below matches
+            if (std::memcmp(prefix.data() + i, text, rest) != 0) break;
+            path.assign(prefix, 0, i);
+            path.append(text, n.length);
+            if (n.isEndOfString) {
+                results.push_back(path);
+            }
+            collect(n.eq, path, results, (size_t)k);
+            break;
+        }
+        if (std::memcmp(prefix.data() + i, text, n.length) != 0) break;
+        i += n.length;
+        node = n.eq;
+    }
+    return results;
+}
+
+uint32_t RadixTST::eraseUtil(uint32_t node, const std::string& word, size_t index, bool& erased) {
+    if (node == NIL) return NIL;
+
+    // Erasing never grows the pool, so this reference stays valid
+    RadixNode& n = pool[node];
+    const char* text = labelOf(n);
+
+    if (word[index] < text[0]) {
+        n.left = eraseUtil(n.left, word, index, erased);
+        return node;
+    }
+    if (word[index] > text[0]) {
+        n.right = eraseUtil(n.right, word, index, erased);
+        return node;
+    }
+    if (word.size() - index < n.length || std::memcmp(word.data() + index, text, n.length) != 0) {
+        return node;
+    }
+
+    index += n.length;
+    if (index < word.size()) {
+        n.eq = eraseUtil(n.eq, word, index, erased);
+    } else if (n.isEndOfString) {
+        n.isEndOfString = 0;
+        erased = true;
+        words--;
+    }
+
+    if (!erased || n.isEndOfString) {
+        return node;
+    }
+    if (n.eq == NIL) {
+        return unlink(node);
+    }
+    if (pool[n.eq].left == NIL && pool[n.eq].right == NIL) {
+        merge(node);
+    }
+    return node;
+}
+
+bool RadixTST::erase(const std::string& word) {
+    if (word.empty()) return false;
+
+    bool erased = false;
+    root = eraseUtil(root, word, 0, erased);
+    if (garbage > COMPACT_MIN_GARBAGE && garbage * 2 > labels.size()) {
+        compact();
+    }
+    return erased;
+}
+
+// Median first, so each level's sibling BST comes out balanced
+void RadixTST::insertBalanced(const std::vector<std::string>& sorted, size_t lo, size_t hi) {
+    if (lo >= hi) return;
+    size_t mid = lo + (hi - lo) / 2;
+    insert(sorted[mid]);
+    insertBalanced(sorted, lo, mid);
+    insertBalanced(sorted, mid + 1, hi);
+}
+
+void RadixTST::compact() {
+    std::vector<std::string> live;
+    live.reserve(words);
+    getAllWords(live);
+    clear();
+    insertBalanced(live, 0, live.size());
+}
+
+void RadixTST::getAllWords(std::vector<std::string>& results) const {
+    std::string path;
+    collect(root, path, results, (size_t)-1);
+}
+
+MemoryUsage RadixTST::memoryUsage() const {
+    MemoryUsage usage;
+    usage.items = words;
+    usage.nodes = sizeof(RadixNode) * nodes;
+    usage.strings = labelBytes();
+
+    // Free and unused pool slots, orphaned label bytes and spare capacity
+    size_t poolBytes = pool.capacity() * sizeof(RadixNode);
+    usage.overhead = MemoryUsage::heapBlock(poolBytes) - usage.nodes;
+    if (labels.capacity() > 0) {
+        usage.overhead += MemoryUsage::heapBlock(labels.capacity()) - usage.strings;
+    }
+    if (freeNodes.capacity() > 0) {
+        usage.overhead += MemoryUsage::heapBlock(freeNodes.capacity() * sizeof(uint32_t));
+    }
+    return usage;
+}
@@ -10,14 +10,8 @@ void Ranker::setLastToken(const std::string& token) {
 }
 
 double Ranker::computeScore(const std::string& token){
-    double freqScore = freqStore->get(token);
-    double graphBoost = 0.0;
-    
-    if (!lastToken.empty()){
-        graphBoost = graph->getBoost(lastToken, token);
-    }
-    
-    return freqScore + graphBoost;
+    int edgeWeight = lastToken.empty() ? 0 : graph->getEdgeWeight(lastToken, token);
+    return score(freqStore->get(token), edgeWeight);
 }
 
 std::vector<std::pair<std::string, double>> Ranker::rankResults(
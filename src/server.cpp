@@ -0,0 +1,395 @@
+#include "../include/server.h"
+#include "../include/json_lines.h"
+#include "../include/metrics.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+
+namespace {
+
+volatile sig_atomic_t stopRequested = 0;
+
+void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+const int MAX_EVENTS = 64;
+const int FLUSH_INTERVAL_MS = 1000;
+
+void appendScore(std::string& out, double score) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.6g", score);
+    out += buffer;
+}
+
+std::string errorReply(const std::string& message, const std::string& id) {
+    std::string reply = "{\"ok\":false";
+    if (!id.empty()) {
+        reply += ",\"id\":";
+        jsonl::appendString(reply, id);
+    }
+    reply += ",\"error\":";
+    jsonl::appendString(reply, message);
+    reply += "}";
+    return reply;
+}
+
+}
+
+AutocompleteServer::AutocompleteServer(AutocompleteEngine& engine, const std::string& socketPath)
+    : engine(engine), socketPath(socketPath), listenFd(-1), epollFd(-1),
+      bound(false), boundDev(0), boundIno(0) {}
+
+AutocompleteServer::~AutocompleteServer() {
+    for (const auto& [fd, conn] : connections) {
+        close(fd);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+    }
+    // Only the socket this process bound, and only if nobody replaced it since
+    struct stat info;
+    if (bound && lstat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode) &&
+        info.st_dev == boundDev && info.st_ino == boundIno) {
+        unlink(socketPath.c_str());
+    }
+}
+
+bool AutocompleteServer::listen(std::string& error) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        error = "socket path too long";
+        return false;
+    }
+    strcpy(addr.sun_path, socketPath.c_str());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        error = std::string("socket: ") + strerror(errno);
+        return false;
+    }
+
+    // A socket file left by a previous run would make bind fail. Remove it
+    // only when it is a socket that refuses connections: never a regular
+    // file given by mistake (--serve data/words.txt), nor a live server's.
+    struct stat info;
+    if (lstat(socketPath.c_str(), &info) == 0) {
+        bool stale = false;
+        if (S_ISSOCK(info.st_mode)) {
+            int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            stale = probe >= 0 && connect(probe, (struct sockaddr*)&addr, sizeof(addr)) != 0 &&
+                    errno == ECONNREFUSED;
+            if (probe >= 0) close(probe);
+        }
+        if (!stale) {
+            error = socketPath + ": address in use" + (S_ISSOCK(info.st_mode) ? "" : " (not a socket)");
+            close(listenFd);
+            listenFd = -1;
+            return false;
+        }
+        unlink(socketPath.c_str());
+    }
+    if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0) {
+        error = socketPath + ": " + strerror(errno);
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    if (lstat(socketPath.c_str(), &info) == 0) {
+        bound = true;
+        boundDev = info.st_dev;
+        boundIno = info.st_ino;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        error = std::string("epoll_create1: ") + strerror(errno);
+        return false;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+
+    return true;
+}
+
+void AutocompleteServer::requestStop() {
+    stopRequested = 1;
+}
+
+void AutocompleteServer::run() {
+    // No SA_RESTART: the signal must interrupt epoll_wait
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onStopSignal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Accepts bump frequencies; write them out periodically, not per request
+    engine.setAutoSave(false);
+    auto lastFlush = std::chrono::steady_clock::now();
+
+    struct epoll_event events[MAX_EVENTS];
+    stopRequested = 0;
+
+    while (!stopRequested) {
+        int n = epoll_wait(epollFd, events, MAX_EVENTS, FLUSH_INTERVAL_MS);
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "epoll_wait: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            uint32_t mask = events[i].events;
+
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+
+            if (mask & EPOLLERR) {
+                closeClient(fd);
+                continue;
+            }
+            if (mask & EPOLLOUT) {
+                if (!flushClient(fd, it->second)) continue;
+                // Output drained: resume requests held back by backpressure
+                processInput(it->second);
+                if (!flushClient(fd, it->second)) continue;
+            }
+            if (mask & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+                readClient(fd);
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastFlush >= std::chrono::milliseconds(FLUSH_INTERVAL_MS)) {
+            engine.flush();
+            engine.refreshIndex();
+            lastFlush = now;
+        }
+    }
+
+    engine.setAutoSave(true);
+}
+
+void AutocompleteServer::acceptClients() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            // EAGAIN: backlog drained; anything else: try again next wakeup
+            return;
+        }
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            continue;
+        }
+        connections[fd].events = ev.events;
+        stats.connections++;
+    }
+}
+
+void AutocompleteServer::readClient(int fd) {
+    Connection& conn = connections[fd];
+    char buffer[16384];
+    bool eof = false;
+
+    while (true) {
+        ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
+        if (len > 0) {
+            conn.in.append(buffer, len);
+            if (conn.in.size() > MAX_LINE + sizeof(buffer) && conn.in.find('\n') == std::string::npos) {
+                closeClient(fd);
+                return;
+            }
+            continue;
+        }
+        if (len == 0) {
+            eof = true;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            eof = true;
+        }
+        break;
+    }
+
+    // A half-closed client still gets its replies; flushClient closes the
+    // connection once they are out
+    conn.peerClosed = eof;
+    processInput(conn);
+    flushClient(fd, conn);
+}
+
+void AutocompleteServer::processInput(Connection& conn) {
+    size_t start = 0;
+
+    while (conn.out.size() - conn.outPos < MAX_PENDING_OUTPUT) {
+        size_t nl = conn.in.find('\n', start);
+        if (nl == std::string::npos) break;
+
+        std::string line = conn.in.substr(start, nl - start);
+        start = nl + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+
+        conn.out += handle(line);
+        conn.out += '\n';
+    }
+
+    conn.in.erase(0, start);
+}
+
+bool AutocompleteServer::flushClient(int fd, Connection& conn) {
+    while (conn.outPos < conn.out.size()) {
+        ssize_t len = send(fd, conn.out.data() + conn.outPos, conn.out.size() - conn.outPos, MSG_NOSIGNAL);
+        if (len > 0) {
+            conn.outPos += len;
+            continue;
+        }
+        if (len < 0 && errno == EINTR) continue;
+        if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+
+        closeClient(fd);
+        return false;
+    }
+
+    if (conn.outPos >= conn.out.size()) {
+        conn.out.clear();
+        conn.outPos = 0;
+    } else if (conn.outPos > (1 << 16)) {
+        conn.out.erase(0, conn.outPos);
+        conn.outPos = 0;
+    }
+
+    if (conn.peerClosed && conn.out.empty()) {
+        closeClient(fd);
+        return false;
+    }
+
+    // Ask for writability only while output is pending, and stop reading
+    // from a client that is not reading its replies
+    uint32_t events = conn.out.empty() ? 0 : EPOLLOUT;
+    if (!conn.peerClosed && conn.out.size() - conn.outPos < MAX_PENDING_OUTPUT) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (events != conn.events) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = events;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+        conn.events = events;
+    }
+    return true;
+}
+
+void AutocompleteServer::closeClient(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
+
+std::string AutocompleteServer::handle(const std::string& line) {
+    stats.requests++;
+
+    jsonl::Object request;
+    if (!jsonl::parseObject(line, request)) {
+        stats.errors++;
+        return errorReply("malformed request", "");
+    }
+
+    std::string id = jsonl::getString(request, "id");
+    std::string op = jsonl::getString(request, "op");
+
+    std::string reply = "{\"ok\":true";
+    if (!id.empty()) {
+        reply += ",\"id\":";
+        jsonl::appendString(reply, id);
+    }
+
+    if (op == "complete") {
+        std::string prefix = jsonl::getString(request, "prefix");
+        int k = (int)std::max(1L, std::min(50L, jsonl::getInt(request, "k", 5)));
+        std::string context = jsonl::getString(request, "context");
+
+        auto suggestions = engine.getSuggestions(prefix, k, context);
+        reply += ",\"suggestions\":[";
+        for (size_t i = 0; i < suggestions.size(); i++) {
+            if (i > 0) reply += ',';
+            reply += "{\"token\":";
+            jsonl::appendString(reply, suggestions[i].first);
+            reply += ",\"score\":";
+            appendScore(reply, suggestions[i].second);
+            reply += '}';
+        }
+        reply += "],\"phrases\":[";
+        auto phrases = engine.getPhraseSuggestions(prefix);
+        for (size_t i = 0; i < phrases.size(); i++) {
+            if (i > 0) reply += ',';
+            jsonl::appendString(reply, phrases[i]);
+        }
+        reply += ']';
+    } else if (op == "accept") {
+        std::string token = jsonl::getString(request, "token");
+        if (token.empty()) {
+            stats.errors++;
+            return errorReply("accept needs a token", id);
+        }
+        engine.acceptSuggestion(token, jsonl::getString(request, "context"));
+    } else if (op == "learn") {
+        std::string trigger = jsonl::getString(request, "trigger");
+        std::string text = jsonl::getString(request, "text");
+        if (trigger.empty() || text.empty()) {
+            stats.errors++;
+            return errorReply("learn needs a trigger and text", id);
+        }
+        engine.learnPhrase(trigger, text);
+    } else if (op == "bump") {
+        std::string token = jsonl::getString(request, "token");
+        if (token.empty()) {
+            stats.errors++;
+            return errorReply("bump needs a token", id);
+        }
+        engine.bumpToken(token, (int)jsonl::getInt(request, "amount", 5));
+    } else if (op == "stats") {
+        reply += ",\"stats\":";
+        reply += metrics::toJson(metrics::collect());
+    } else {
+        stats.errors++;
+        return errorReply("unknown op '" + op + "'", id);
+    }
+
+    reply += '}';
+    return reply;
+}
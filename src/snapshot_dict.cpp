@@ -0,0 +1,227 @@
+#include "../include/snapshot_dict.h"
+#include "../include/minheap.h"
+#include "../include/ranker.h"
+#include <limits>
+#include <stdexcept>
+#include <functional>
+
+size_t DictionarySnapshot::shardOf(const std::string& key) {
+    return std::hash<std::string>{}(key) % SHARDS;
+}
+
+int DictionarySnapshot::frequency(const std::string& token) const {
+    const FreqShard& shard = *frequencies[shardOf(token)];
+    auto it = shard.find(token);
+    return (it != shard.end()) ? it->second : 0;
+}
+
+int DictionarySnapshot::edgeWeight(const std::string& from, const std::string& to) const {
+    const GraphShard& shard = *graph[shardOf(from)];
+    auto node = shard.find(from);
+    if (node == shard.end()) {
+        return 0;
+    }
+    auto edge = node->second.find(to);
+    return (edge != node->second.end()) ? edge->second : 0;
+}
+
+double DictionarySnapshot::score(const std::string& token, const std::string& lastToken) const {
+    int weight = lastToken.empty() ? 0 : edgeWeight(lastToken, token);
+    return Ranker::score(frequency(token), weight);
+}
+
+std::vector<std::pair<std::string, double>> DictionarySnapshot::complete(
+    const std::string& prefix, int k, const std::string& lastToken) const {
+    std::vector<std::pair<std::string, double>> result;
+    if (prefix.empty()) {
+        return result;
+    }
+
+    std::vector<std::string> candidates = words.prefixSearch(prefix, k * 2);
+
+    MinHeap heap(k);
+    for (const auto& token : candidates) {
+        heap.insert(score(token, lastToken), token);
+    }
+    for (const auto& [score, token] : heap.getAll()) {
+        result.push_back({token, score});
+    }
+
+    return result;
+}
+
+SnapshotDictionary::Reader::Reader(SnapshotDictionary* dict, ReaderSlot* slot)
+    : dict(dict), slot(slot), depth(0) {}
+
+SnapshotDictionary::Reader::Reader(Reader&& other) noexcept
+    : dict(other.dict), slot(other.slot), depth(other.depth) {
+    other.slot = nullptr;
+}
+
+SnapshotDictionary::Reader::~Reader() {
+    if (slot != nullptr) {
+        slot->epoch.store(0);
+        slot->claimed.store(false);
+    }
+}
+
+SnapshotDictionary::ReadGuard SnapshotDictionary::Reader::read() {
+    // Announce the epoch before loading the pointer: a writer that retires
+    // this snapshot afterwards either sees the announcement or published
+    // before it, in which case the load below returns the newer snapshot
+    if (depth++ == 0) {
+        slot->epoch.store(dict->globalEpoch.load());
+    }
+    return ReadGuard(this, dict->current.load());
+}
+
+SnapshotDictionary::ReadGuard::ReadGuard(Reader* reader, const DictionarySnapshot* snapshot)
+    : reader(reader), snapshot(snapshot) {}
+
+SnapshotDictionary::ReadGuard::ReadGuard(ReadGuard&& other) noexcept
+    : reader(other.reader), snapshot(other.snapshot) {
+    other.reader = nullptr;
+}
+
+SnapshotDictionary::ReadGuard::~ReadGuard() {
+    if (reader != nullptr && --reader->depth == 0) {
+        reader->slot->epoch.store(0, std::memory_order_release);
+    }
+}
+
+SnapshotDictionary::SnapshotDictionary(size_t maxReaders)
+    : globalEpoch(1),
+      slots(new ReaderSlot[maxReaders]),
+      slotCount(maxReaders),
+      pendingChanges(0),
+      version(0) {
+    auto* initial = new DictionarySnapshot();
+    for (size_t s = 0; s < DictionarySnapshot::SHARDS; s++) {
+        frequencies[s] = std::make_shared<DictionarySnapshot::FreqShard>();
+        graph[s] = std::make_shared<DictionarySnapshot::GraphShard>();
+        initial->frequencies[s] = frequencies[s];
+        initial->graph[s] = graph[s];
+    }
+    // The initial empty shards are shared with the first snapshot
+    freqCopied.fill(false);
+    graphCopied.fill(false);
+    initial->words = working.freeze();
+    current.store(initial);
+}
+
+SnapshotDictionary::~SnapshotDictionary() {
+    delete current.load();
+    for (const auto& [epoch, snapshot] : retired) {
+        delete snapshot;
+    }
+}
+
+SnapshotDictionary::Reader SnapshotDictionary::registerReader() {
+    for (size_t i = 0; i < slotCount; i++) {
+        bool expected = false;
+        if (slots[i].claimed.compare_exchange_strong(expected, true)) {
+            return Reader(this, &slots[i]);
+        }
+    }
+    throw std::runtime_error("SnapshotDictionary: no free reader slot");
+}
+
+DictionarySnapshot::FreqShard& SnapshotDictionary::writableFreqShard(size_t shard) {
+    // First write since the last publish: the shard is shared, copy it
+    if (!freqCopied[shard]) {
+        frequencies[shard] = std::make_shared<DictionarySnapshot::FreqShard>(*frequencies[shard]);
+        freqCopied[shard] = true;
+    }
+    return *frequencies[shard];
+}
+
+DictionarySnapshot::GraphShard& SnapshotDictionary::writableGraphShard(size_t shard) {
+    if (!graphCopied[shard]) {
+        graph[shard] = std::make_shared<DictionarySnapshot::GraphShard>(*graph[shard]);
+        graphCopied[shard] = true;
+    }
+    return *graph[shard];
+}
+
+void SnapshotDictionary::insert(const std::string& word) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    working.insert(word);
+    pendingChanges++;
+}
+
+void SnapshotDictionary::bump(const std::string& token, int amount) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    writableFreqShard(DictionarySnapshot::shardOf(token))[token] += amount;
+    pendingChanges++;
+}
+
+void SnapshotDictionary::addEdge(const std::string& from, const std::string& to, int weight) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    writableGraphShard(DictionarySnapshot::shardOf(from))[from][to] += weight;
+    pendingChanges++;
+}
+
+uint64_t SnapshotDictionary::publish() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    auto* next = new DictionarySnapshot();
+    next->version = ++version;
+    next->words = working.freeze();
+    for (size_t s = 0; s < DictionarySnapshot::SHARDS; s++) {
+        next->frequencies[s] = frequencies[s];
+        next->graph[s] = graph[s];
+    }
+    freqCopied.fill(false);
+    graphCopied.fill(false);
+    pendingChanges = 0;
+
+    const DictionarySnapshot* old = current.exchange(next);
+    // Readers that announced this epoch or earlier may still hold old
+    uint64_t epoch = globalEpoch.fetch_add(1);
+    retired.emplace_back(epoch, old);
+
+    reclaimLocked();
+    return version;
+}
+
+size_t SnapshotDictionary::pendingCount() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    return pendingChanges;
+}
+
+size_t SnapshotDictionary::reclaimLocked() {
+    uint64_t oldestActive = std::numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < slotCount; i++) {
+        uint64_t epoch = slots[i].epoch.load();
+        if (epoch != 0 && epoch < oldestActive) {
+            oldestActive = epoch;
+        }
+    }
+
+    size_t freed = 0;
+    for (size_t i = 0; i < retired.size(); ) {
+        if (retired[i].first < oldestActive) {
+            delete retired[i].second;
+            retired[i] = retired.back();
+            retired.pop_back();
+            freed++;
+        } else {
+            i++;
+        }
+    }
+    return freed;
+}
+
+size_t SnapshotDictionary::reclaim() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    return reclaimLocked();
+}
+
+size_t SnapshotDictionary::retiredCount() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    return retired.size();
+}
+
+uint64_t SnapshotDictionary::currentVersion() const {
+    return current.load()->version;
+}
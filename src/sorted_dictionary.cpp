@@ -0,0 +1,453 @@
+#include "../include/sorted_dictionary.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+namespace {
+
+void writeVarint(std::vector<char>& out, size_t value) {
+    while (value >= 0x80) {
+        out.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((char)value);
+}
+
+size_t readVarint(const char* data, size_t& pos) {
+    size_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        unsigned char byte = (unsigned char)data[pos++];
+        value |= (size_t)(byte & 0x7f) << shift;
+        if (byte < 0x80) return value;
+    }
+}
+
+}
+
+SortedDictionary::SortedDictionary() : count(0) {}
+
+uint64_t SortedDictionary::keyOf(const char* s, size_t length) {
+    // Big-endian and zero-padded, so integer order is byte order; strings
+    // that only differ past the eighth byte tie and are compared in full
+    uint64_t key = 0;
+    size_t n = std::min(length, (size_t)8);
+    for (size_t i = 0; i < n; i++) {
+        key |= (uint64_t)(unsigned char)s[i] << (56 - 8 * i);
+    }
+    return key;
+}
+
+const char* SortedDictionary::headOf(size_t block, size_t& length) const {
+    size_t pos = blockOffset[block];
+    readVarint(data.data(), pos);       // shared length, always 0 here
+    length = readVarint(data.data(), pos);
+    return data.data() + pos;
+}
+
+bool SortedDictionary::headLess(size_t k, const std::string& key, uint64_t key8) const {
+    if (headKey[k] != key8) return headKey[k] < key8;
+    size_t length;
+    const char* head = headOf(headBlock[k], length);
+    int c = std::memcmp(head, key.data(), std::min(length, key.size()));
+    return c < 0 || (c == 0 && length < key.size());
+}
+
+size_t SortedDictionary::firstBlockNotLess(const std::string& key) const {
+    size_t n = headKey.size() - 1;
+    uint64_t key8 = keyOf(key.data(), key.size());
+    size_t k = 1;
+    while (k <= n) {
+        // The node four levels down, whose cache line is needed soonest
+        __builtin_prefetch(headKey.data() + std::min(16 * k, n));
+        k = 2 * k + headLess(k, key, key8);
+    }
+    // k went right after every head below key; dropping those right turns
+    // and the left turn before them lands on the first head that is not
+    k >>= __builtin_ffsll(~(long long)k);
+    return k ? headBlock[k] : n;
+}
+
+size_t SortedDictionary::decodeNext(size_t pos, std::string& word) const {
+    size_t shared = readVarint(data.data(), pos);
+    size_t length = readVarint(data.data(), pos);
+    word.resize(shared);
+    word.append(data.data() + pos, length);
+    return pos + length;
+}
+
+size_t SortedDictionary::seek(size_t index, std::string& word) const {
+    size_t block = index / BLOCK;
+    size_t pos = blockOffset[block];
+    for (size_t i = block * BLOCK; i <= index; i++) {
+        pos = decodeNext(pos, word);
+    }
+    return pos;
+}
+
+std::string SortedDictionary::wordAt(size_t index) const {
+    std::string word;
+    seek(index, word);
+    return word;
+}
+
+size_t SortedDictionary::lowerBound(const std::string& key) const {
+    if (count == 0) return 0;
+    size_t block = firstBlockNotLess(key);
+    if (block == 0) return 0;
+
+    // The head of the block before is below key, so the bound is inside
+    // that block or at the next head
+    size_t index = (block - 1) * BLOCK;
+    size_t end = std::min(block * BLOCK, count);
+    std::string word;
+    size_t pos = decodeNext(blockOffset[block - 1], word);
+    while (++index < end) {
+        pos = decodeNext(pos, word);
+        if (word.compare(key) >= 0) return index;
+    }
+    return end;
+}
+
+bool SortedDictionary::inArray(const std::string& word) const {
+    if (count == 0) return false;
+    size_t block = firstBlockNotLess(word);
+    if (block < blockOffset.size()) {
+        size_t length;
+        const char* head = headOf(block, length);
+        if (length == word.size() && std::memcmp(head, word.data(), length) == 0) return true;
+    }
+    if (block == 0) return false;
+
+    size_t index = (block - 1) * BLOCK;
+    size_t end = std::min(block * BLOCK, count);
+    std::string current;
+    size_t pos = blockOffset[block - 1];
+    for (; index < end; index++) {
+        pos = decodeNext(pos, current);
+        int c = current.compare(word);
+        if (c >= 0) return c == 0;
+    }
+    return false;
+}
+
+uint32_t SortedDictionary::heaviest(size_t lo, size_t hi) const {
+    uint32_t best = (uint32_t)lo;
+    auto scan = [&](size_t from, size_t to) {
+        for (size_t i = from; i < to; i++) {
+            if (heavier((uint32_t)i, best)) best = (uint32_t)i;
+        }
+    };
+
+    size_t first = lo / BLOCK;
+    size_t last = (hi - 1) / BLOCK;
+    if (first == last) {
+        scan(lo + 1, hi);
+        return best;
+    }
+    // Ragged ends word by word, whole blocks between them from the table
+    scan(lo + 1, (first + 1) * BLOCK);
+    scan(last * BLOCK, hi);
+    if (first + 1 < last) {
+        size_t a = first + 1;
+        size_t b = last - 1;
+        int level = 63 - __builtin_clzll((unsigned long long)(b - a + 1));
+        uint32_t left = sparse[level][a];
+        uint32_t right = sparse[level][b + 1 - ((size_t)1 << level)];
+        if (heavier(left, best)) best = left;
+        if (heavier(right, best)) best = right;
+    }
+    return best;
+}
+
+void SortedDictionary::build(const std::vector<std::string>& sorted) {
+    std::vector<char> bytes;
+    std::vector<uint32_t> offsets;
+    offsets.reserve((sorted.size() + BLOCK - 1) / BLOCK);
+    for (size_t i = 0; i < sorted.size(); i++) {
+        const std::string& word = sorted[i];
+        size_t shared = 0;
+        if (i % BLOCK == 0) {
+            offsets.push_back((uint32_t)bytes.size());
+        } else {
+            const std::string& previous = sorted[i - 1];
+            size_t limit = std::min(word.size(), previous.size());
+            while (shared < limit && word[shared] == previous[shared]) shared++;
+        }
+        writeVarint(bytes, shared);
+        writeVarint(bytes, word.size() - shared);
+        bytes.insert(bytes.end(), word.begin() + shared, word.end());
+    }
+    bytes.shrink_to_fit();
+    data.swap(bytes);
+    blockOffset.swap(offsets);
+    count = sorted.size();
+
+    // Visit the Eytzinger positions in order (leftmost first, then each
+    // one's successor) and hand them the blocks in sorted order
+    size_t blocks = blockOffset.size();
+    headKey.assign(blocks + 1, 0);
+    headBlock.assign(blocks + 1, 0);
+    size_t k = 1;
+    while (2 * k <= blocks) k *= 2;
+    for (size_t block = 0; block < blocks; block++) {
+        size_t length;
+        const char* head = headOf(block, length);
+        headKey[k] = keyOf(head, length);
+        headBlock[k] = (uint32_t)block;
+        if (2 * k + 1 <= blocks) {
+            k = 2 * k + 1;
+            while (2 * k <= blocks) k *= 2;
+        } else {
+            k >>= __builtin_ffsll(~(long long)k);
+        }
+    }
+
+    sampleWeights();
+}
+
+void SortedDictionary::sampleWeights() {
+    std::vector<int>().swap(weights);
+    std::vector<std::vector<uint32_t>>().swap(sparse);
+    if (!weightOf || count == 0) return;
+
+    weights.resize(count);
+    std::string word;
+    size_t pos = 0;
+    for (size_t i = 0; i < count; i++) {
+        pos = decodeNext(pos, word);
+        weights[i] = weightOf(word);
+    }
+
+    size_t blocks = blockOffset.size();
+    sparse.emplace_back(blocks);
+    for (size_t b = 0; b < blocks; b++) {
+        uint32_t best = (uint32_t)(b * BLOCK);
+        for (size_t i = b * BLOCK + 1; i < std::min((b + 1) * BLOCK, count); i++) {
+            if (heavier((uint32_t)i, best)) best = (uint32_t)i;
+        }
+        sparse[0][b] = best;
+    }
+    for (size_t span = 2; span <= blocks; span *= 2) {
+        const std::vector<uint32_t>& below = sparse.back();
+        std::vector<uint32_t> level(blocks - span + 1);
+        for (size_t b = 0; b < level.size(); b++) {
+            uint32_t left = below[b];
+            uint32_t right = below[b + span / 2];
+            level[b] = heavier(left, right) ? left : right;
+        }
+        sparse.push_back(std::move(level));
+    }
+}
+
+void SortedDictionary::addPending(const std::string& word) {
+    auto it = added.emplace(word, weightOf ? weightOf(word) : 0).first;
+    if (weightOf) addedByWeight.insert(it);
+}
+
+bool SortedDictionary::erasePending(const std::string& word) {
+    auto it = added.find(word);
+    if (it == added.end()) return false;
+    addedByWeight.erase(it);
+    added.erase(it);
+    return true;
+}
+
+void SortedDictionary::clearPending() {
+    addedByWeight.clear();
+    added.clear();
+}
+
+void SortedDictionary::rebuildIfBehind() {
+    if (pendingCount() >= std::max(MIN_REBUILD, count / 8)) {
+        compact();
+    }
+}
+
+void SortedDictionary::insert(const std::string& word) {
+    if (word.empty()) return;
+    if (removed.erase(word) > 0) return;    // still in the array
+    if (added.count(word) > 0 || inArray(word)) return;
+    addPending(word);
+    rebuildIfBehind();
+}
+
+bool SortedDictionary::search(const std::string& word) const {
+    if (!added.empty() && added.count(word) > 0) return true;
+    if (!removed.empty() && removed.count(word) > 0) return false;
+    return inArray(word);
+}
+
+bool SortedDictionary::erase(const std::string& word) {
+    if (erasePending(word)) return true;
+    if (removed.count(word) > 0 || !inArray(word)) return false;
+    removed.insert(word);
+    rebuildIfBehind();
+    return true;
+}
+
+std::vector<std::string> SortedDictionary::prefixSearch(const std::string& prefix, int k) const {
+    std::vector<std::string> results;
+    if (k <= 0) return results;
+    size_t want = (size_t)k;
+
+    // Every word starting with prefix is below the prefix with its last
+    // byte under 0xff incremented and the rest dropped; with no such byte
+    // they run to the end
+    std::string past = prefix;
+    while (!past.empty() && (unsigned char)past.back() == 0xff) past.pop_back();
+    if (!past.empty()) past.back() = (char)((unsigned char)past.back() + 1);
+
+    size_t lo = lowerBound(prefix);
+    size_t hi = past.empty() ? count : lowerBound(past);
+    auto first = added.lower_bound(prefix);
+    auto last = past.empty() ? added.end() : added.lower_bound(past);
+    auto live = [this](const std::string& word) { return removed.empty() || removed.count(word) == 0; };
+
+    if (!weightOf) {
+        // Walk the run and the pending words side by side, in order
+        std::string word;
+        size_t pos = lo < hi ? seek(lo, word) : 0;
+        size_t i = lo;
+        while (results.size() < want && (i < hi || first != last)) {
+            if (i < hi && (first == last || word < first->first)) {
+                if (live(word)) results.push_back(word);
+                if (++i < hi) pos = decodeNext(pos, word);
+            } else {
+                results.push_back((first++)->first);
+            }
+        }
+        return results;
+    }
+
+    // Pop the heaviest word of a range and split the range around it; the
+    // queue holds at most one range per word popped
+    struct Range {
+        uint32_t best;
+        size_t lo, hi;
+    };
+    auto lighter = [this](const Range& a, const Range& b) { return heavier(b.best, a.best); };
+    std::priority_queue<Range, std::vector<Range>, decltype(lighter)> ranges(lighter);
+    if (lo < hi) ranges.push({heaviest(lo, hi), lo, hi});
+
+    std::vector<std::pair<int, std::string>> found;
+    while (!ranges.empty() && found.size() < want) {
+        Range range = ranges.top();
+        ranges.pop();
+        std::string word = wordAt(range.best);
+        if (live(word)) found.push_back({weights[range.best], std::move(word)});
+        if (range.lo < range.best) {
+            ranges.push({heaviest(range.lo, range.best), range.lo, range.best});
+        }
+        if (range.best + 1 < range.hi) {
+            ranges.push({heaviest(range.best + 1, range.hi), range.best + 1, range.hi});
+        }
+    }
+
+    // The pending matches that can place: step through them in byte order
+    // and through all pending words heaviest first at the same pace. The
+    // byte-order walk ending means every match has been seen; the weight-
+    // order walk is done after k matches, or at a word lighter than the
+    // k-th found in the array, since every word after it is lighter still.
+    std::vector<Pending::const_iterator> pending;
+    auto next = first;
+    auto heavy = addedByWeight.begin();
+    while (true) {
+        if (next == last) {
+            pending.clear();
+            for (auto it = first; it != last; ++it) pending.push_back(it);
+            break;
+        }
+        ++next;
+        if (heavy == addedByWeight.end()) break;
+        Pending::const_iterator it = *heavy++;
+        if (found.size() >= want && it->second < found.back().first) break;
+        if (it->first.compare(0, prefix.size(), prefix) != 0) continue;
+        pending.push_back(it);
+        if (pending.size() == want) break;
+    }
+    for (auto it : pending) {
+        found.push_back({it->second, it->first});
+    }
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    for (size_t i = 0; i < found.size() && i < want; i++) {
+        results.push_back(std::move(found[i].second));
+    }
+    return results;
+}
+
+void SortedDictionary::clear() {
+    std::vector<char>().swap(data);
+    std::vector<uint32_t>().swap(blockOffset);
+    std::vector<uint64_t>().swap(headKey);
+    std::vector<uint32_t>().swap(headBlock);
+    std::vector<int>().swap(weights);
+    std::vector<std::vector<uint32_t>>().swap(sparse);
+    count = 0;
+    clearPending();
+    removed.clear();
+}
+
+void SortedDictionary::compact() {
+    std::vector<std::string> all;
+    all.reserve(wordCount());
+    getAllWords(all);
+    clearPending();
+    removed.clear();
+    build(all);
+}
+
+bool SortedDictionary::compactIfFragmented(double threshold) {
+    if (pendingCount() == 0 || pendingCount() <= threshold * count) return false;
+    compact();
+    return true;
+}
+
+void SortedDictionary::setWeights(WeightFn weight) {
+    weightOf = std::move(weight);
+    sampleWeights();
+    addedByWeight.clear();
+    for (auto it = added.begin(); it != added.end(); ++it) {
+        it->second = weightOf ? weightOf(it->first) : 0;
+        if (weightOf) addedByWeight.insert(it);
+    }
+}
+
+void SortedDictionary::getAllWords(std::vector<std::string>& results) const {
+    std::string word;
+    size_t pos = 0;
+    auto pending = added.begin();
+    for (size_t i = 0; i < count; i++) {
+        pos = decodeNext(pos, word);
+        while (pending != added.end() && pending->first < word) results.push_back((pending++)->first);
+        if (removed.empty() || removed.count(word) == 0) results.push_back(word);
+    }
+    for (; pending != added.end(); ++pending) results.push_back(pending->first);
+}
+
+MemoryUsage SortedDictionary::memoryUsage() const {
+    MemoryUsage usage;
+    usage.items = wordCount();
+    usage.strings = data.size();
+    if (data.capacity() > 0) {
+        usage.overhead += MemoryUsage::heapBlock(data.capacity()) - data.size();
+    }
+    usage.addArray(blockOffset.size() * sizeof(uint32_t), blockOffset.capacity() * sizeof(uint32_t));
+    usage.addArray(headKey.size() * sizeof(uint64_t), headKey.capacity() * sizeof(uint64_t));
+    usage.addArray(headBlock.size() * sizeof(uint32_t), headBlock.capacity() * sizeof(uint32_t));
+    usage.addArray(weights.size() * sizeof(int), weights.capacity() * sizeof(int));
+    using Level = std::vector<uint32_t>;
+    usage.addArray(sparse.size() * sizeof(Level), sparse.capacity() * sizeof(Level));
+    for (const auto& level : sparse) {
+        usage.addArray(level.size() * sizeof(uint32_t), level.capacity() * sizeof(uint32_t));
+    }
+
+    usage.addNodes(MemoryUsage::treeNode<Pending::value_type>(), added.size());
+    for (const auto& entry : added) usage.addString(entry.first);
+    usage.addNodes(MemoryUsage::treeNode<Pending::const_iterator>(), addedByWeight.size());
+    usage.addNodes(MemoryUsage::hashNode<std::string>(true), removed.size());
+    usage.addBuckets(removed.bucket_count());
+    for (const auto& word : removed) usage.addString(word);
+    return usage;
+}
@@ -1,39 +1,137 @@
 #include "../include/stack.h"
 #include <stdexcept>
+#include <algorithm>
+#include <cctype>
+
+UndoRedoStack::UndoRedoStack(size_t maxBytes) : maxBytes(maxBytes), usedBytes(0) {}
+
+size_t UndoRedoStack::deltaBytes(const EditDelta& delta) {
+    return sizeof(EditDelta) + delta.removed.size() + delta.inserted.size();
+}
+
+void UndoRedoStack::settle(EditDelta& delta) {
+    if (!delta.reversed) return;
+    std::reverse(delta.removed.begin(), delta.removed.end());
+    delta.reversed = false;
+}
+
+bool UndoRedoStack::tryCoalesce(int line, int col, const std::string& removed,
+                                const std::string& inserted) {
+    if (undoStack.empty()) return false;
+
+    EditDelta& last = undoStack.back();
+    if (last.sealed || last.line != line) return false;
+    if (removed.find('\n') != std::string::npos || inserted.find('\n') != std::string::npos) {
+        return false;
+    }
+
+    // Typing: a pure insert that continues right where the last one ended.
+    // A space after a word starts a new step so undo removes one word at a time.
+    if (removed.empty() && last.removed.empty() && !inserted.empty() && !last.inserted.empty()) {
+        if (col != last.col + (int)last.inserted.size()) return false;
+        if (last.inserted.find('\n') != std::string::npos) return false;
+        if (isspace((unsigned char)inserted[0]) && !isspace((unsigned char)last.inserted.back())) {
+            return false;
+        }
+        last.inserted += inserted;
+        usedBytes += inserted.size();
+        return true;
+    }
+
+    // Backspacing: a pure delete that ends where the last one started.
+    if (inserted.empty() && last.inserted.empty() && !removed.empty() && !last.removed.empty()) {
+        if (col + (int)removed.size() != last.col) return false;
+        if (last.removed.find('\n') != std::string::npos) return false;
+        if (!last.reversed) {
+            std::reverse(last.removed.begin(), last.removed.end());
+            last.reversed = true;
+        }
+        last.removed.append(removed.rbegin(), removed.rend());
+        last.col = col;
+        usedBytes += removed.size();
+        return true;
+    }
+
+    return false;
+}
+
+void UndoRedoStack::enforceBudget() {
+    // Always keep the newest entry so the last edit can be undone
+    while (usedBytes > maxBytes && undoStack.size() > 1) {
+        usedBytes -= deltaBytes(undoStack.front());
+        undoStack.pop_front();
+    }
+}
+
+void UndoRedoStack::record(int line, int col, const std::string& removed,
+                           const std::string& inserted) {
+    if (removed.empty() && inserted.empty()) return;
+
+    clearRedo();
+
+    if (tryCoalesce(line, col, removed, inserted)) {
+        enforceBudget();
+        return;
+    }
+
+    if (!undoStack.empty()) settle(undoStack.back());
+    undoStack.emplace_back(line, col, removed, inserted);
+    usedBytes += deltaBytes(undoStack.back());
+    enforceBudget();
+}
 
 void UndoRedoStack::pushInsert(int position, const std::string& text) {
-    undoStack.push({position, text});
-    while (!redoStack.empty()) {
-        redoStack.pop();
+    record(0, position, "", text);
+    seal();
+}
+
+void UndoRedoStack::seal() {
+    if (!undoStack.empty()) {
+        undoStack.back().sealed = true;
+        settle(undoStack.back());
     }
 }
 
-std::pair<int, std::string> UndoRedoStack::undo() {
+EditDelta UndoRedoStack::undo() {
     if (undoStack.empty()) {
         throw std::runtime_error("Nothing to undo");
     }
-    
-    auto action = undoStack.top();
-    undoStack.pop();
-    redoStack.push(action);
-    
+
+    EditDelta action = std::move(undoStack.back());
+    undoStack.pop_back();
+    action.sealed = true;
+    settle(action);
+    redoStack.push_back(action);
+
     return action;
 }
 
-std::pair<int, std::string> UndoRedoStack::redo() {
+EditDelta UndoRedoStack::redo() {
     if (redoStack.empty()) {
         throw std::runtime_error("Nothing to redo");
     }
-    
-    auto action = redoStack.top();
-    redoStack.pop();
-    undoStack.push(action);
-    
+
+    EditDelta action = std::move(redoStack.back());
+    redoStack.pop_back();
+    undoStack.push_back(action);
+
     return action;
 }
 
 void UndoRedoStack::clearRedo() {
-    while (!redoStack.empty()) {
-        redoStack.pop();
+    for (const auto& delta : redoStack) {
+        usedBytes -= deltaBytes(delta);
     }
-}
\ No newline at end of file
+    redoStack.clear();
+}
+
+void UndoRedoStack::clear() {
+    undoStack.clear();
+    redoStack.clear();
+    usedBytes = 0;
+}
+
+void UndoRedoStack::setMaxBytes(size_t bytes) {
+    maxBytes = bytes;
+    enforceBudget();
+}
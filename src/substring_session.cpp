@@ -0,0 +1,73 @@
+#include "../include/substring_session.h"
+#include "../include/kmp.h"
+
+SubstringSession::SubstringSession(const std::vector<std::string>* vocabulary)
+    : words(vocabulary), scanned(0) {}
+
+void SubstringSession::reset(const std::vector<std::string>* vocabulary) {
+    words = vocabulary;
+    levels.clear();
+    scanned = 0;
+}
+
+void SubstringSession::scanAll(const std::string& query, std::vector<SubstringCandidate>& out) {
+    CompiledPattern pattern(query);
+    for (size_t id = 0; id < words->size(); id++) {
+        const std::string& word = (*words)[id];
+        size_t offset = pattern.find(word.data(), word.size());
+        if (offset != std::string::npos) {
+            out.push_back(SubstringCandidate{(uint32_t)id, (uint32_t)offset});
+        }
+    }
+    scanned = words->size();
+}
+
+void SubstringSession::narrow(const Level& from, const std::string& query,
+                              std::vector<SubstringCandidate>& out) {
+    for (const auto& candidate : from.candidates) {
+        const std::string& word = (*words)[candidate.id];
+        // The longer query can only start where the shorter one occurs
+        size_t offset = candidate.offset;
+        if (word.compare(offset, query.size(), query) != 0) {
+            offset = word.find(query, offset + 1);
+            if (offset == std::string::npos) continue;
+        }
+        out.push_back(SubstringCandidate{candidate.id, (uint32_t)offset});
+    }
+    scanned = from.candidates.size();
+}
+
+const std::vector<SubstringCandidate>& SubstringSession::update(const std::string& query) {
+    static const std::vector<SubstringCandidate> NONE;
+    if (words == nullptr || query.empty()) {
+        scanned = 0;
+        return NONE;
+    }
+
+    // Drop the sets of queries that are not a prefix of this one
+    while (!levels.empty()) {
+        const std::string& top = levels.back().query;
+        if (top.size() <= query.size() && query.compare(0, top.size(), top) == 0) break;
+        levels.pop_back();
+    }
+
+    if (!levels.empty() && levels.back().query == query) {
+        scanned = 0;
+        return levels.back().candidates;
+    }
+
+    Level next;
+    next.query = query;
+    if (levels.empty()) {
+        scanAll(query, next.candidates);
+    } else {
+        narrow(levels.back(), query, next.candidates);
+    }
+    levels.push_back(std::move(next));
+
+    // The shortest queries hold the most candidates; forget them first
+    if (levels.size() > MAX_LEVELS) {
+        levels.pop_front();
+    }
+    return levels.back().candidates;
+}
@@ -0,0 +1,108 @@
+#include "../include/suggest_worker.h"
+
+SuggestWorker::SuggestWorker(ComputeFn fn)
+    : compute(std::move(fn)),
+      hasRequest(false), requestSeq(0),
+      hasResult(false), stopping(false),
+      busy(false), latestSeq(0) {
+    thread = std::thread(&SuggestWorker::loop, this);
+}
+
+SuggestWorker::~SuggestWorker() {
+    stop();
+}
+
+void SuggestWorker::loop() {
+    while (true) {
+        std::function<void()> task;
+        std::string prefix;
+        uint64_t seq = 0;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !tasks.empty() || hasRequest; });
+
+            if (!tasks.empty()) {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            } else if (stopping) {
+                return;
+            } else {
+                prefix = requestPrefix;
+                seq = requestSeq;
+                hasRequest = false;
+                busy = true;
+            }
+        }
+
+        // Tasks run before any request queued behind them, so a query always
+        // sees the effect of earlier accepts
+        if (task) {
+            task();
+            continue;
+        }
+
+        std::vector<std::string> suggestions = compute(prefix);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        busy = false;
+        if (seq == latestSeq) {
+            result.seq = seq;
+            result.prefix = prefix;
+            result.suggestions = std::move(suggestions);
+            hasResult = true;
+        }
+    }
+}
+
+uint64_t SuggestWorker::request(const std::string& prefix) {
+    std::lock_guard<std::mutex> lock(mutex);
+    requestSeq = ++latestSeq;
+    requestPrefix = prefix;
+    hasRequest = true;
+    hasResult = false;
+    wake.notify_one();
+    return requestSeq;
+}
+
+void SuggestWorker::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++latestSeq;
+    hasRequest = false;
+    hasResult = false;
+}
+
+void SuggestWorker::post(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) return;
+    tasks.push_back(std::move(task));
+    wake.notify_one();
+}
+
+bool SuggestWorker::poll(Result& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hasResult || result.seq != latestSeq) {
+        return false;
+    }
+    out = std::move(result);
+    hasResult = false;
+    return true;
+}
+
+bool SuggestWorker::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return busy || hasRequest || hasResult;
+}
+
+void SuggestWorker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping && !thread.joinable()) return;
+        stopping = true;
+        hasRequest = false;
+    }
+    wake.notify_one();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
@@ -0,0 +1,150 @@
+#include "../include/symbol_index.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+
+void SymbolIndex::tokenize(const std::string& text, std::vector<std::string>& out) {
+    out.clear();
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char c = (unsigned char)text[i];
+        if (std::isalpha(c) || c == '_') {
+            size_t start = i;
+            while (i < text.size() && (std::isalnum((unsigned char)text[i]) || text[i] == '_')) i++;
+            if (i - start >= MIN_LENGTH) out.push_back(text.substr(start, i - start));
+        } else if (std::isdigit(c)) {
+            // Skip the rest of a number so "0x1f" or "10ul" yield nothing
+            while (i < text.size() && (std::isalnum((unsigned char)text[i]) || text[i] == '_')) i++;
+        } else {
+            i++;
+        }
+    }
+}
+
+uint32_t SymbolIndex::acquire(const std::string& name) {
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        symbols[it->second].count++;
+        return it->second;
+    }
+
+    uint32_t id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+        symbols[id] = Symbol{name, 1};
+    } else {
+        id = (uint32_t)symbols.size();
+        symbols.push_back(Symbol{name, 1});
+    }
+    ids.emplace(name, id);
+    trie.insert(name);
+    return id;
+}
+
+void SymbolIndex::release(uint32_t id) {
+    Symbol& symbol = symbols[id];
+    if (--symbol.count > 0) return;
+
+    // Last occurrence gone: the name leaves the trie and its id is reused
+    trie.erase(symbol.name);
+    trie.compactIfFragmented();
+    ids.erase(symbol.name);
+    symbol.name.clear();
+    freeIds.push_back(id);
+}
+
+void SymbolIndex::clear() {
+    trie = TST();
+    symbols.clear();
+    ids.clear();
+    freeIds.clear();
+    lines.clear();
+}
+
+void SymbolIndex::updateLine(size_t line, const std::string& text) {
+    lines.grow(line + 1);
+
+    std::vector<std::string> names;
+    tokenize(text, names);
+
+    // Acquire the new identifiers before releasing the old ones, so a name
+    // on the line before and after the edit never leaves the trie
+    std::vector<uint32_t> next;
+    next.reserve(names.size());
+    for (const auto& name : names) {
+        next.push_back(acquire(name));
+    }
+    std::vector<uint32_t>& previous = lines[line];
+    for (uint32_t id : previous) {
+        release(id);
+    }
+    previous = std::move(next);
+}
+
+void SymbolIndex::linesInserted(size_t at, size_t count) {
+    if (at >= lines.size()) return;
+    lines.insert(at, count);
+}
+
+void SymbolIndex::linesErased(size_t at, size_t count) {
+    if (at >= lines.size()) return;
+    count = std::min(count, lines.size() - at);
+    lines.erase(at, count, [&](std::vector<uint32_t>& erased) {
+        for (uint32_t id : erased) {
+            release(id);
+        }
+    });
+}
+
+uint32_t SymbolIndex::occurrences(const std::string& name) const {
+    auto it = ids.find(name);
+    return it == ids.end() ? 0 : symbols[it->second].count;
+}
+
+std::vector<LocalSymbol> SymbolIndex::complete(const std::string& prefix, size_t cursorLine,
+                                               size_t limit) const {
+    std::vector<LocalSymbol> out;
+    if (prefix.empty() || limit == 0) return out;
+
+    // Every match is ranked: a rare name next to the cursor can outscore
+    // any number of frequent ones, so no fixed cut of the matches is safe
+    std::unordered_map<uint32_t, size_t> slot;     // symbol id -> index in out
+    for (const auto& word : trie.prefixSearch(prefix, INT_MAX)) {
+        if (word == prefix) continue;   // the word being typed is in the document too
+        uint32_t id = ids.at(word);
+        slot.emplace(id, out.size());
+        out.push_back(LocalSymbol{word, symbols[id].count, RADIUS, 0.0});
+    }
+    if (out.empty()) return out;
+
+    // Walk outwards from the cursor; the first sighting is the nearest
+    size_t unseen = out.size();
+    auto sight = [&](size_t line, size_t distance) {
+        if (line >= lines.size()) return;
+        for (uint32_t id : lines[line]) {
+            auto it = slot.find(id);
+            if (it == slot.end() || out[it->second].distance < RADIUS) continue;
+            out[it->second].distance = distance;
+            unseen--;
+        }
+    };
+    sight(cursorLine, 0);
+    for (size_t d = 1; d < RADIUS && unseen > 0; d++) {
+        sight(cursorLine + d, d);
+        if (d <= cursorLine) sight(cursorLine - d, d);
+    }
+
+    for (auto& symbol : out) {
+        double proximity = (double)(RADIUS - symbol.distance) / RADIUS;
+        symbol.score = symbol.count * (1.0 + PROXIMITY_BOOST * proximity);
+    }
+    size_t kept = std::min(limit, out.size());
+    std::partial_sort(out.begin(), out.begin() + kept, out.end(),
+                      [](const LocalSymbol& a, const LocalSymbol& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.word < b.word;
+    });
+    out.resize(kept);
+    return out;
+}
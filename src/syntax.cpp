@@ -0,0 +1,337 @@
+#include "../include/syntax.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+constexpr const char* KEYWORDS[] = {
+    "auto", "break", "case", "char", "const", "continue", "default", "do",
+    "double", "else", "enum", "extern", "float", "for", "goto", "if",
+    "int", "long", "register", "return", "short", "signed", "sizeof", "static",
+    "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while",
+    "class", "namespace", "template", "public", "private", "protected", "virtual",
+    "bool", "true", "false", "nullptr", "new", "delete", "try", "catch", "throw",
+    "using", "std", "string", "vector", "map", "set", "include", "define", "ifdef"
+};
+constexpr size_t KEYWORD_COUNT = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+constexpr size_t TABLE_SIZE = 256;
+
+constexpr size_t constLength(const char* s) {
+    size_t n = 0;
+    while (s[n] != '\0') n++;
+    return n;
+}
+
+constexpr uint32_t hashWord(const char* s, size_t n, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (size_t i = 0; i < n; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    h ^= h >> 15;
+    return h;
+}
+
+struct KeywordTable {
+    uint32_t seed;
+    uint8_t slot[TABLE_SIZE];   // keyword index + 1, or 0 for an empty slot
+};
+
+// Search for a seed under which every keyword lands in its own slot.
+// Runs entirely at compile time; the result is baked into the binary.
+constexpr KeywordTable buildKeywordTable() {
+    for (uint32_t seed = 1; seed < 100000; seed++) {
+        KeywordTable table{seed, {}};
+        bool collision = false;
+        for (size_t k = 0; k < KEYWORD_COUNT && !collision; k++) {
+            uint32_t h = hashWord(KEYWORDS[k], constLength(KEYWORDS[k]), seed) % TABLE_SIZE;
+            if (table.slot[h] != 0) {
+                collision = true;
+            } else {
+                table.slot[h] = (uint8_t)(k + 1);
+            }
+        }
+        if (!collision) return table;
+    }
+    return KeywordTable{0, {}};
+}
+
+constexpr KeywordTable KEYWORD_TABLE = buildKeywordTable();
+static_assert(KEYWORD_TABLE.seed != 0, "no perfect hash seed found for the keyword table");
+
+bool isIdentChar(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+// R, LR, uR, UR and u8R introduce a raw string when followed by a quote
+bool isRawPrefix(const char* word, size_t length) {
+    static const char* const prefixes[] = {"R", "LR", "uR", "UR", "u8R"};
+    for (const char* prefix : prefixes) {
+        if (strlen(prefix) == length && strncmp(prefix, word, length) == 0) return true;
+    }
+    return false;
+}
+
+void emit(std::vector<SyntaxToken>& tokens, size_t start, size_t length, TokenKind kind) {
+    if (length == 0) return;
+
+    // Merge with the previous token when it is adjacent and of the same kind
+    if (!tokens.empty()) {
+        SyntaxToken& last = tokens.back();
+        if (last.kind == kind && last.start + last.length == start) {
+            last.length += length;
+            return;
+        }
+    }
+    tokens.push_back({(uint32_t)start, (uint32_t)length, kind});
+}
+
+}
+
+SyntaxHighlighter::SyntaxHighlighter()
+    : checkpoints(1), window(WINDOW), windowStart(0), validUpTo(0), nextVersion(0) {}
+
+bool SyntaxHighlighter::isKeyword(const char* word, size_t length) {
+    uint8_t idx = KEYWORD_TABLE.slot[hashWord(word, length, KEYWORD_TABLE.seed) % TABLE_SIZE];
+    if (idx == 0) return false;
+
+    const char* keyword = KEYWORDS[idx - 1];
+    return strncmp(keyword, word, length) == 0 && keyword[length] == '\0';
+}
+
+LexState SyntaxHighlighter::lexLine(const std::string& line, const LexState& in,
+                                    std::vector<SyntaxToken>& tokens) {
+    LexState state = in;
+    size_t n = line.length();
+    size_t i = 0;
+
+    // Finish a block comment or raw string left open by a previous line
+    if (state.mode == LexState::BLOCK_COMMENT) {
+        size_t end = line.find("*/");
+        if (end == std::string::npos) {
+            emit(tokens, 0, n, TOKEN_COMMENT);
+            return state;
+        }
+        emit(tokens, 0, end + 2, TOKEN_COMMENT);
+        state.mode = LexState::NORMAL;
+        i = end + 2;
+    } else if (state.mode == LexState::RAW_STRING) {
+        std::string closing = ")" + state.rawDelimiter + "\"";
+        size_t end = line.find(closing);
+        if (end == std::string::npos) {
+            emit(tokens, 0, n, TOKEN_STRING);
+            return state;
+        }
+        emit(tokens, 0, end + closing.length(), TOKEN_STRING);
+        state = LexState();
+        i = end + closing.length();
+    }
+
+    while (i < n) {
+        char c = line[i];
+
+        // Strings and character literals
+        if (c == '"' || c == '\'') {
+            size_t start = i++;
+            while (i < n && line[i] != c) {
+                if (line[i] == '\\' && i + 1 < n) i++;
+                i++;
+            }
+            if (i < n) i++;
+            emit(tokens, start, i - start, TOKEN_STRING);
+            continue;
+        }
+
+        // Line comments
+        if (c == '/' && i + 1 < n && line[i + 1] == '/') {
+            emit(tokens, i, n - i, TOKEN_COMMENT);
+            break;
+        }
+
+        // Block comments, possibly running past the end of the line
+        if (c == '/' && i + 1 < n && line[i + 1] == '*') {
+            size_t end = line.find("*/", i + 2);
+            if (end == std::string::npos) {
+                emit(tokens, i, n - i, TOKEN_COMMENT);
+                state.mode = LexState::BLOCK_COMMENT;
+                break;
+            }
+            emit(tokens, i, end + 2 - i, TOKEN_COMMENT);
+            i = end + 2;
+            continue;
+        }
+
+        // Preprocessor
+        if (c == '#') {
+            size_t start = i;
+            while (i < n && (isIdentChar(line[i]) || line[i] == '#')) i++;
+            emit(tokens, start, i - start, TOKEN_PREPROCESSOR);
+            continue;
+        }
+
+        // Numbers
+        if (isdigit((unsigned char)c)) {
+            size_t start = i;
+            while (i < n && (isdigit((unsigned char)line[i]) || line[i] == '.')) i++;
+            emit(tokens, start, i - start, TOKEN_NUMBER);
+            continue;
+        }
+
+        // Operators
+        if (strchr("+-*/%=<>!&|^~?:;,(){}[]", c)) {
+            emit(tokens, i, 1, TOKEN_OPERATOR);
+            i++;
+            continue;
+        }
+
+        // Keywords, identifiers and raw string prefixes
+        if (isIdentChar(c)) {
+            size_t start = i;
+            while (i < n && isIdentChar(line[i])) i++;
+            size_t len = i - start;
+
+            if (i < n && line[i] == '"' && isRawPrefix(line.data() + start, len)) {
+                size_t paren = line.find('(', i + 1);
+                if (paren != std::string::npos) {
+                    std::string delimiter = line.substr(i + 1, paren - i - 1);
+                    std::string closing = ")" + delimiter + "\"";
+                    size_t end = line.find(closing, paren + 1);
+                    if (end == std::string::npos) {
+                        emit(tokens, start, n - start, TOKEN_STRING);
+                        state.mode = LexState::RAW_STRING;
+                        state.rawDelimiter = delimiter;
+                        break;
+                    }
+                    i = end + closing.length();
+                    emit(tokens, start, i - start, TOKEN_STRING);
+                    continue;
+                }
+            }
+
+            if (isKeyword(line.data() + start, len)) {
+                emit(tokens, start, len, TOKEN_KEYWORD);
+            }
+            continue;
+        }
+
+        // Everything else is drawn as-is
+        i++;
+    }
+
+    return state;
+}
+
+void SyntaxHighlighter::moveWindow(size_t line) {
+    // Keep a quarter of the window above the line, since drawing goes down
+    // the screen from it; lines in both the old and new window stay cached
+    size_t start = line - std::min(line, WINDOW / 4);
+    std::vector<LineTokens> moved(WINDOW);
+    for (size_t i = 0; i < WINDOW; i++) {
+        if (inWindow(start + i)) moved[i] = std::move(window[start + i - windowStart]);
+    }
+    window.swap(moved);
+    windowStart = start;
+}
+
+void SyntaxHighlighter::dropCheckpointsAfter(size_t line) {
+    // The state entering a line depends only on the lines above it, so the
+    // checkpoint at `line` itself survives an edit of that line
+    checkpoints.resize(std::min(checkpoints.size(), line / CHECKPOINT + 1));
+}
+
+const LineTokens& SyntaxHighlighter::lineTokens(size_t line,
+                                                const std::function<std::string(size_t)>& getLine) {
+    if (!inWindow(line)) {
+        moveWindow(line);
+    }
+    LineTokens& wanted = window[line - windowStart];
+    if (line < validUpTo && wanted.valid) {
+        return wanted;
+    }
+
+    // Start from the nearest known state: a cached line above, or failing
+    // that the checkpoint (there is one for every multiple up to validUpTo)
+    size_t target = std::min(line, validUpTo);
+    size_t start = target / CHECKPOINT * CHECKPOINT;
+    LexState in = checkpoints[target / CHECKPOINT];
+    for (size_t i = target; i > start; i--) {
+        if (i - 1 < validUpTo && inWindow(i - 1) && window[i - 1 - windowStart].valid) {
+            start = i;
+            in = window[i - 1 - windowStart].out;
+            break;
+        }
+    }
+
+    // Walk forward; cached lines whose incoming state still matches keep
+    // their tokens, and lines outside the window are lexed and dropped
+    for (size_t i = start; i <= line; i++) {
+        if (i % CHECKPOINT == 0 && i / CHECKPOINT == checkpoints.size()) {
+            checkpoints.push_back(in);
+        }
+        if (!inWindow(i)) {
+            scratch.clear();
+            in = lexLine(getLine(i), in, scratch);
+            continue;
+        }
+        LineTokens& entry = window[i - windowStart];
+        if (!entry.valid || entry.in != in) {
+            entry.tokens.clear();
+            entry.in = in;
+            entry.out = lexLine(getLine(i), in, entry.tokens);
+            entry.valid = true;
+            entry.version = ++nextVersion;
+        }
+        in = entry.out;
+    }
+    if ((line + 1) % CHECKPOINT == 0 && (line + 1) / CHECKPOINT == checkpoints.size()) {
+        checkpoints.push_back(in);
+    }
+    validUpTo = std::max(validUpTo, line + 1);
+
+    return wanted;
+}
+
+void SyntaxHighlighter::reset() {
+    checkpoints.assign(1, LexState());
+    window.assign(WINDOW, LineTokens());
+    windowStart = 0;
+    validUpTo = 0;
+}
+
+void SyntaxHighlighter::invalidate(size_t line) {
+    if (inWindow(line)) {
+        window[line - windowStart].valid = false;
+    }
+    validUpTo = std::min(validUpTo, line);
+    dropCheckpointsAfter(line);
+}
+
+void SyntaxHighlighter::linesInserted(size_t at, size_t count) {
+    if (count == 0) return;
+    if (at <= windowStart) {
+        windowStart += count;
+    } else if (inWindow(at)) {
+        size_t pos = at - windowStart;
+        window.insert(window.begin() + pos, std::min(count, WINDOW - pos), LineTokens());
+        window.resize(WINDOW);
+    }
+    validUpTo = std::min(validUpTo, at);
+    dropCheckpointsAfter(at);
+}
+
+void SyntaxHighlighter::linesErased(size_t at, size_t count) {
+    if (count == 0) return;
+    size_t end = at + count;
+    if (end <= windowStart) {
+        windowStart -= count;
+    } else if (at < windowStart + WINDOW) {
+        size_t from = std::max(at, windowStart) - windowStart;
+        size_t to = std::min(end, windowStart + WINDOW) - windowStart;
+        window.erase(window.begin() + from, window.begin() + to);
+        window.resize(WINDOW);
+        windowStart = std::min(windowStart, at);
+    }
+    validUpTo = std::min(validUpTo, at);
+    dropCheckpointsAfter(at);
+}
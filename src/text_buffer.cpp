@@ -0,0 +1,507 @@
+#include "../include/text_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+namespace {
+
+// umask() can only be read by setting it, which would briefly change the
+// mode of files other threads create. Read it once during static
+// initialization, before main starts any threads.
+const mode_t PROCESS_UMASK = [] {
+    mode_t mask = umask(0);
+    umask(mask);
+    return mask;
+}();
+
+// writev until every byte of the batch is written, resuming after short writes
+bool writeSegments(int fd, std::vector<iovec>& batch) {
+    size_t first = 0;
+    while (first < batch.size()) {
+        ssize_t n = writev(fd, batch.data() + first, (int)(batch.size() - first));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        size_t done = (size_t)n;
+        while (first < batch.size() && done >= batch[first].iov_len) {
+            done -= batch[first].iov_len;
+            first++;
+        }
+        if (done > 0) {
+            batch[first].iov_base = (char*)batch[first].iov_base + done;
+            batch[first].iov_len -= done;
+        }
+    }
+    batch.clear();
+    return true;
+}
+
+}
+
+TextBuffer::TextBuffer()
+    : originalData(nullptr), originalSize(0), mapping(nullptr), mappingSize(0), indexing(false),
+      root(nullptr), seed(2463534242u), pieces(0) {}
+
+TextBuffer::~TextBuffer() {
+    destroy(root);
+    release();
+}
+
+const char* TextBuffer::bufferData(int buffer) const {
+    return buffer == ORIGINAL ? originalData : added.data();
+}
+
+size_t TextBuffer::countBreaks(int buffer, size_t start, size_t length) const {
+    if (buffer == ORIGINAL) {
+        return originalBreaks.breaksBefore(start + length) - originalBreaks.breaksBefore(start);
+    }
+    auto lo = std::lower_bound(addedBreaks.begin(), addedBreaks.end(), start);
+    auto hi = std::lower_bound(lo, addedBreaks.end(), start + length);
+    return hi - lo;
+}
+
+size_t TextBuffer::findBreak(int buffer, size_t start, size_t k) const {
+    // Offset of the k-th (0-based) '\n' at or after start in the buffer
+    if (buffer == ORIGINAL) {
+        return originalBreaks.findBreak(originalBreaks.breaksBefore(start) + k);
+    }
+    return *(std::lower_bound(addedBreaks.begin(), addedBreaks.end(), start) + k);
+}
+
+void TextBuffer::indexBreaks(const std::string& text, size_t base, std::vector<size_t>& breaks) {
+    size_t pos = text.find('\n');
+    while (pos != std::string::npos) {
+        breaks.push_back(base + pos);
+        pos = text.find('\n', pos + 1);
+    }
+}
+
+uint32_t TextBuffer::nextPriority() {
+    // xorshift32 - treap priorities only need to be well spread
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+PieceNode* TextBuffer::makeNode(int buffer, size_t start, size_t length) {
+    pieces++;
+    return new PieceNode(buffer, start, length, countBreaks(buffer, start, length), nextPriority());
+}
+
+size_t TextBuffer::subLength(PieceNode* node) {
+    return node ? node->subLength : 0;
+}
+
+size_t TextBuffer::subLineBreaks(PieceNode* node) {
+    return node ? node->subLineBreaks : 0;
+}
+
+void TextBuffer::update(PieceNode* node) {
+    if (node == nullptr) return;
+    node->subLength = subLength(node->left) + node->length + subLength(node->right);
+    node->subLineBreaks = subLineBreaks(node->left) + node->lineBreaks + subLineBreaks(node->right);
+}
+
+void TextBuffer::split(PieceNode* node, size_t offset, PieceNode*& left, PieceNode*& right) {
+    if (node == nullptr) {
+        left = right = nullptr;
+        return;
+    }
+
+    size_t leftLen = subLength(node->left);
+
+    if (offset <= leftLen) {
+        split(node->left, offset, left, node->left);
+        right = node;
+    } else if (offset >= leftLen + node->length) {
+        split(node->right, offset - leftLen - node->length, node->right, right);
+        left = node;
+    } else {
+        // The cut falls inside this piece: break it in two. The tail inherits
+        // the node's priority so it can take over the right subtree.
+        size_t cut = offset - leftLen;
+        PieceNode* tail = makeNode(node->buffer, node->start + cut, node->length - cut);
+        tail->priority = node->priority;
+        tail->right = node->right;
+        node->right = nullptr;
+        node->length = cut;
+        node->lineBreaks -= tail->lineBreaks;
+        update(tail);
+        left = node;
+        right = tail;
+    }
+
+    update(node);
+}
+
+PieceNode* TextBuffer::merge(PieceNode* left, PieceNode* right) {
+    if (left == nullptr) return right;
+    if (right == nullptr) return left;
+
+    if (left->priority > right->priority) {
+        left->right = merge(left->right, right);
+        update(left);
+        return left;
+    }
+    right->left = merge(left, right->left);
+    update(right);
+    return right;
+}
+
+bool TextBuffer::extendRightmost(PieceNode* node, size_t count) {
+    if (node == nullptr) return false;
+
+    bool extended;
+    if (node->right != nullptr) {
+        extended = extendRightmost(node->right, count);
+    } else {
+        // Typing appends to the add buffer, so the piece ending at the cursor
+        // usually ends at the add buffer's tail and can simply grow
+        extended = node->buffer == ADDED && node->start + node->length + count == added.size();
+        if (extended) {
+            node->lineBreaks += countBreaks(ADDED, node->start + node->length, count);
+            node->length += count;
+        }
+    }
+
+    if (extended) update(node);
+    return extended;
+}
+
+void TextBuffer::destroy(PieceNode* node) {
+    if (node == nullptr) return;
+    destroy(node->left);
+    destroy(node->right);
+    pieces--;
+    delete node;
+}
+
+void TextBuffer::release() {
+    // The index worker reads the mapping, so it goes first
+    originalBreaks.reset();
+    indexing = false;
+    if (mapping != nullptr) {
+        munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+    original.clear();
+    originalData = nullptr;
+    originalSize = 0;
+}
+
+void TextBuffer::load(const std::string& content) {
+    destroy(root);
+    root = nullptr;
+    release();
+
+    original = content;
+    originalData = original.data();
+    originalSize = original.size();
+    added.clear();
+    addedBreaks.clear();
+    originalBreaks.build(originalData, originalSize, false);
+
+    if (originalSize > 0) {
+        root = makeNode(ORIGINAL, 0, originalSize);
+    }
+}
+
+bool TextBuffer::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        error = path + ": not a regular file";
+        close(fd);
+        return false;
+    }
+
+    void* mapped = nullptr;
+    size_t size = (size_t)info.st_size;
+    if (size > 0) {
+        mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            error = path + ": " + strerror(errno);
+            close(fd);
+            return false;
+        }
+    }
+    close(fd);
+
+    destroy(root);
+    root = nullptr;
+    release();
+
+    mapping = mapped;
+    mappingSize = size;
+    originalData = (const char*)mapped;
+    originalSize = size;
+    added.clear();
+    addedBreaks.clear();
+    if (size == 0) return true;
+
+    // Count the first screen or so now and the rest in the background. The
+    // piece's break count is filled in by finishLoading(), so building it
+    // does not have to wait for the whole file.
+    originalBreaks.build(originalData, originalSize, true);
+    root = new PieceNode(ORIGINAL, 0, size, 0, nextPriority());
+    pieces++;
+    indexing = true;
+    pollLoading();
+    return true;
+}
+
+bool TextBuffer::pollLoading() {
+    if (!indexing || !originalBreaks.ready()) return false;
+    finishLoading();
+    return true;
+}
+
+void TextBuffer::finishLoading() {
+    if (!indexing) return;
+    originalBreaks.wait();
+    root->lineBreaks = originalBreaks.knownBreaks();
+    update(root);
+    indexing = false;
+}
+
+size_t TextBuffer::lineCount() const {
+    if (indexing) return originalBreaks.knownBreaks() + 1;
+    return subLineBreaks(root) + 1;
+}
+
+size_t TextBuffer::lineStart(size_t line) const {
+    if (line == 0) return 0;
+    if (indexing) {
+        // One piece over the whole file; look past the index if needed
+        size_t pos = originalBreaks.findBreak(line - 1);
+        return pos == LineIndex::npos ? length() : pos + 1;
+    }
+    if (line > subLineBreaks(root)) return length();
+
+    // Find the line-th '\n' (1-based) and return the offset just past it
+    size_t k = line;
+    size_t offset = 0;
+    PieceNode* node = root;
+
+    while (node != nullptr) {
+        size_t leftBreaks = subLineBreaks(node->left);
+        if (k <= leftBreaks) {
+            node = node->left;
+            continue;
+        }
+
+        k -= leftBreaks;
+        offset += subLength(node->left);
+
+        if (k <= node->lineBreaks) {
+            return offset + (findBreak(node->buffer, node->start, k - 1) - node->start) + 1;
+        }
+
+        k -= node->lineBreaks;
+        offset += node->length;
+        node = node->right;
+    }
+
+    return length();
+}
+
+size_t TextBuffer::lineAt(size_t offset) const {
+    if (indexing) return originalBreaks.breaksBefore(offset);
+
+    // Count the line breaks before offset on the way down
+    size_t line = 0;
+    PieceNode* node = root;
+
+    while (node != nullptr) {
+        size_t leftLen = subLength(node->left);
+        if (offset < leftLen) {
+            node = node->left;
+            continue;
+        }
+
+        line += subLineBreaks(node->left);
+        offset -= leftLen;
+
+        if (offset < node->length) {
+            return line + countBreaks(node->buffer, node->start, offset);
+        }
+
+        line += node->lineBreaks;
+        offset -= node->length;
+        node = node->right;
+    }
+
+    return line;
+}
+
+size_t TextBuffer::lineLength(size_t line) const {
+    size_t start = lineStart(line);
+    if (indexing) {
+        // The next break may not be indexed yet; find it directly
+        const char* data = originalData + start;
+        const char* end = (const char*)std::memchr(data, '\n', originalSize - start);
+        return end == nullptr ? originalSize - start : end - data;
+    }
+    if (line + 1 >= lineCount()) {
+        return length() - start;
+    }
+    return lineStart(line + 1) - 1 - start;
+}
+
+void TextBuffer::collect(PieceNode* node, size_t nodeOffset, size_t from, size_t to,
+                         std::string& out) const {
+    if (node == nullptr || from >= to) return;
+
+    size_t pieceBegin = nodeOffset + subLength(node->left);
+    size_t pieceEnd = pieceBegin + node->length;
+
+    if (from < pieceBegin) {
+        collect(node->left, nodeOffset, from, to, out);
+    }
+
+    size_t lo = std::max(from, pieceBegin);
+    size_t hi = std::min(to, pieceEnd);
+    if (lo < hi) {
+        out.append(bufferData(node->buffer) + node->start + (lo - pieceBegin), hi - lo);
+    }
+
+    if (to > pieceEnd) {
+        collect(node->right, pieceEnd, from, to, out);
+    }
+}
+
+std::string TextBuffer::substring(size_t offset, size_t count) const {
+    std::string out;
+    size_t end = std::min(length(), offset + count);
+    if (offset >= end) return out;
+
+    out.reserve(end - offset);
+    collect(root, 0, offset, end, out);
+    return out;
+}
+
+std::string TextBuffer::line(size_t line) const {
+    if (line >= lineCount()) return "";
+    return substring(lineStart(line), lineLength(line));
+}
+
+std::string TextBuffer::text() const {
+    return substring(0, length());
+}
+
+void TextBuffer::insert(size_t offset, const std::string& text) {
+    if (text.empty()) return;
+    finishLoading();
+    offset = std::min(offset, length());
+
+    size_t base = added.size();
+    added += text;
+    indexBreaks(text, base, addedBreaks);
+
+    PieceNode* left;
+    PieceNode* right;
+    split(root, offset, left, right);
+
+    if (!extendRightmost(left, text.size())) {
+        left = merge(left, makeNode(ADDED, base, text.size()));
+    }
+    root = merge(left, right);
+}
+
+void TextBuffer::erase(size_t offset, size_t count) {
+    if (count == 0 || offset >= length()) return;
+    finishLoading();
+
+    PieceNode* left;
+    PieceNode* middle;
+    PieceNode* right;
+    split(root, offset, left, middle);
+    split(middle, count, middle, right);
+    destroy(middle);
+    root = merge(left, right);
+}
+
+void TextBuffer::visit(PieceNode* node, const std::function<void(const char*, size_t)>& fn) const {
+    if (node == nullptr) return;
+    visit(node->left, fn);
+    if (node->length > 0) {
+        fn(bufferData(node->buffer) + node->start, node->length);
+    }
+    visit(node->right, fn);
+}
+
+void TextBuffer::forEachSegment(const std::function<void(const char*, size_t)>& fn) const {
+    visit(root, fn);
+}
+
+bool TextBuffer::save(const std::string& path, std::string& error) const {
+    // A fresh name from mkstemp, so neither another save of the same file
+    // nor a file that happens to be called path.tmp is ever truncated
+    std::string temp = path + ".XXXXXX";
+    int fd = mkstemp(&temp[0]);
+    if (fd < 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+
+    // mkstemp creates 0600: keep the mode of the file being replaced, or
+    // give a new one the usual 0666 less the umask
+    struct stat info;
+    mode_t mode;
+    if (stat(path.c_str(), &info) == 0) {
+        mode = info.st_mode & 07777;
+    } else {
+        mode = 0666 & ~PROCESS_UMASK;
+    }
+    fchmod(fd, mode);
+
+    // Pieces go straight from the mapping and the add buffer to the kernel,
+    // IOV_MAX of them per system call
+    std::vector<iovec> batch;
+    bool ok = true;
+    visit(root, [&](const char* data, size_t length) {
+        if (!ok) return;
+        batch.push_back(iovec{(void*)data, length});
+        if (batch.size() == IOV_MAX) ok = writeSegments(fd, batch);
+    });
+    ok = ok && writeSegments(fd, batch) && fsync(fd) == 0;
+    if (!ok) error = temp + ": " + strerror(errno);
+    ::close(fd);
+
+    if (ok && rename(temp.c_str(), path.c_str()) != 0) {
+        error = path + ": " + strerror(errno);
+        ok = false;
+    }
+    if (!ok) {
+        unlink(temp.c_str());
+        return false;
+    }
+
+    // Make the rename itself durable
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    int dirFd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+}
+
+size_t TextBuffer::pieceCount() const {
+    return pieces;
+}
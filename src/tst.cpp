@@ -1,12 +1,43 @@
 #include "../include/tst.h"
 #include <algorithm>
+#include <functional>
+#include <atomic>
 
-TST::TST() : root(nullptr) {}
+namespace {
+
+// Generations are unique across all trees; 0 is the default for trees that
+// were never frozen
+std::atomic<uint32_t> nextGeneration(1);
+
+}
+
+TST::TST() : root(nullptr), nodes(0), words(0), deadNodes(0), generation(0) {}
+
+std::shared_ptr<TSTNode> TST::own(const std::shared_ptr<TSTNode>& node) {
+    if (node->owner == generation) {
+        return node;
+    }
+    auto copy = std::make_shared<TSTNode>(*node);
+    copy->owner = generation;
+    return copy;
+}
+
+TST TST::freeze() {
+    TST frozen = *this;
+    frozen.generation = nextGeneration++;
+    generation = nextGeneration++;
+    return frozen;
+}
 
 std::shared_ptr<TSTNode> TST::insertUtil(std::shared_ptr<TSTNode> node, 
     const std::string& word, int index) {
+    bool created = false;
     if (node == nullptr) {
-        node = std::make_shared<TSTNode>(word[index]);
+        node = std::make_shared<TSTNode>(word[index], generation);
+        nodes++;
+        created = true;
+    } else {
+        node = own(node);
     }
     
     if (word[index] < node->data) {
@@ -14,10 +45,15 @@ std::shared_ptr<TSTNode> TST::insertUtil(std::shared_ptr<TSTNode> node,
         } else if (word[index] > node->data) {
         node->right = insertUtil(node->right, word, index);
     } else {
+        // A dead node left behind by erase comes back to life
+        if (!created && !node->isEndOfString && node->eq == nullptr) {
+            deadNodes--;
+        }
         if (index < word.length() - 1) {
             node->eq = insertUtil(node->eq, word, index + 1);
-        } else {
+        } else if (!node->isEndOfString) {
             node->isEndOfString = true;
+            words++;
         }
     }
     
@@ -29,21 +65,21 @@ void TST::insert(const std::string& word) {
     root = insertUtil(root, word, 0);
 }
 
-std::shared_ptr<TSTNode> TST::searchPrefix(const std::string& prefix) {
-    if (prefix.empty()) return root;
+const TSTNode* TST::searchPrefix(const std::string& prefix) const {
+    if (prefix.empty()) return root.get();
     
-    auto node = root;
+    const TSTNode* node = root.get();
     int i = 0;
     
     while (node != nullptr && i < prefix.length()) {
         if (prefix[i] < node->data) {
-            node = node->left;
+            node = node->left.get();
         } else if (prefix[i] > node->data) {
-            node = node->right;
+            node = node->right.get();
         } else {
             i++;
             if (i < prefix.length()) {
-                node = node->eq;
+                node = node->eq.get();
             }
         }
     }
@@ -51,12 +87,12 @@ std::shared_ptr<TSTNode> TST::searchPrefix(const std::string& prefix) {
     return (i == prefix.length()) ? node : nullptr;
 }
 
-void TST::collectWords(std::shared_ptr<TSTNode> node, 
+void TST::collectWords(const TSTNode* node, 
         std::string prefix, 
-        std::vector<std::string>& results) {
+        std::vector<std::string>& results) const {
     if (node == nullptr) return;
     
-    collectWords(node->left, prefix, results);
+    collectWords(node->left.get(), prefix, results);
     
     std::string current = prefix + node->data;
     
@@ -64,11 +100,11 @@ void TST::collectWords(std::shared_ptr<TSTNode> node,
         results.push_back(current);
     }
     
-    collectWords(node->eq, current, results);
-    collectWords(node->right, prefix, results);
+    collectWords(node->eq.get(), current, results);
+    collectWords(node->right.get(), prefix, results);
 }
 
-std::vector<std::string> TST::prefixSearch(const std::string& prefix, int k) {
+std::vector<std::string> TST::prefixSearch(const std::string& prefix, int k) const {
     std::vector<std::string> results;
     
     if (prefix.empty()) {
@@ -79,7 +115,7 @@ std::vector<std::string> TST::prefixSearch(const std::string& prefix, int k) {
         return results;
     }
     
-    auto node = searchPrefix(prefix);
+    const TSTNode* node = searchPrefix(prefix);
     
     if (node == nullptr) {
         return results;
@@ -91,7 +127,7 @@ std::vector<std::string> TST::prefixSearch(const std::string& prefix, int k) {
         results.push_back(prefix);
     }
     
-    collectWords(node->eq, prefix, results);
+    collectWords(node->eq.get(), prefix, results);
     
     if (results.size() > k) {
         results.resize(k);
@@ -100,21 +136,21 @@ std::vector<std::string> TST::prefixSearch(const std::string& prefix, int k) {
     return results;
 }
 
-bool TST::search(const std::string& word) {
+bool TST::search(const std::string& word) const {
     if (word.empty()) return false;
     
-    auto node = root;
+    const TSTNode* node = root.get();
     int i = 0;
     
     while (node != nullptr && i < word.length()) {
         if (word[i] < node->data) {
-            node = node->left;
+            node = node->left.get();
         } else if (word[i] > node->data) {
-            node = node->right;
+            node = node->right.get();
         } else {
             i++;
             if (i < word.length()) {
-                node = node->eq;
+                node = node->eq.get();
             }
         }
     }
@@ -122,7 +158,125 @@ bool TST::search(const std::string& word) {
     return (node != nullptr && i == word.length() && node->isEndOfString);
 }
 
-void TST::getAllWords(std::vector<std::string>& results) {
-    collectWords(root, "", results);
+std::shared_ptr<TSTNode> TST::eraseUtil(std::shared_ptr<TSTNode> node,
+    const std::string& word, size_t index, bool& erased) {
+    if (node == nullptr) return nullptr;
+    node = own(node);
+
+    // Whether this node's own eq link or end marker is on the erased path
+    bool onPath = true;
+
+    if (word[index] < node->data) {
+        node->left = eraseUtil(node->left, word, index, erased);
+        onPath = false;
+    } else if (word[index] > node->data) {
+        node->right = eraseUtil(node->right, word, index, erased);
+        onPath = false;
+    } else if (index + 1 < word.length()) {
+        node->eq = eraseUtil(node->eq, word, index + 1, erased);
+    } else if (node->isEndOfString) {
+        node->isEndOfString = false;
+        erased = true;
+        words--;
+    }
+
+    if (!erased || node->isEndOfString || node->eq != nullptr) {
+        return node;
+    }
+
+    // The node is dead. With at most one sibling link it can be spliced out;
+    // otherwise it stays as a BST junction until the next compact().
+    if (node->left == nullptr || node->right == nullptr) {
+        nodes--;
+        if (!onPath) deadNodes--;
+        return node->left != nullptr ? node->left : node->right;
+    }
+    if (onPath) deadNodes++;
+    return node;
 }
 
+bool TST::erase(const std::string& word) {
+    if (word.empty()) return false;
+
+    // Checking first keeps a miss from copying the path of a frozen tree
+    if (!search(word)) return false;
+
+    bool erased = false;
+    root = eraseUtil(root, word, 0, erased);
+    return erased;
+}
+
+std::shared_ptr<TSTNode> TST::buildBalanced(const std::vector<std::string>& sorted,
+    size_t lo, size_t hi, size_t depth) {
+    // sorted[lo, hi) share their first depth characters and are longer than
+    // depth; split them into runs by the character at depth
+    std::vector<size_t> runs;
+    for (size_t i = lo; i < hi; i++) {
+        if (i == lo || sorted[i][depth] != sorted[i - 1][depth]) {
+            runs.push_back(i);
+        }
+    }
+    runs.push_back(hi);
+
+    // Each run becomes one node; the median run roots this level's BST
+    std::function<std::shared_ptr<TSTNode>(size_t, size_t)> build =
+        [&](size_t first, size_t last) -> std::shared_ptr<TSTNode> {
+        if (first >= last) return nullptr;
+
+        size_t mid = first + (last - first) / 2;
+        size_t start = runs[mid];
+        size_t end = runs[mid + 1];
+
+        auto node = std::make_shared<TSTNode>(sorted[start][depth], generation);
+        nodes++;
+
+        // The word ending here, if any, sorts first in its run
+        if (sorted[start].length() == depth + 1) {
+            node->isEndOfString = true;
+            start++;
+        }
+        node->eq = buildBalanced(sorted, start, end, depth + 1);
+        node->left = build(first, mid);
+        node->right = build(mid + 1, last);
+        return node;
+    };
+
+    return build(0, runs.size() - 1);
+}
+
+void TST::compact() {
+    std::vector<std::string> live;
+    live.reserve(words);
+    getAllWords(live);
+
+    // getAllWords returns words in the tree's own order, so runs sharing a
+    // prefix are contiguous and their first characters already ascend
+    nodes = 0;
+    deadNodes = 0;
+    words = live.size();
+    root = buildBalanced(live, 0, live.size(), 0);
+}
+
+bool TST::compactIfFragmented(double threshold) {
+    if (fragmentation() <= threshold) {
+        return false;
+    }
+    compact();
+    return true;
+}
+
+void TST::getAllWords(std::vector<std::string>& results) const {
+    collectWords(root.get(), "", results);
+}
+
+MemoryUsage TST::memoryUsage() const {
+    // make_shared puts each node and its reference counts (a vtable
+    // pointer plus use and weak counts) in one heap block
+    const size_t CONTROL_BLOCK = sizeof(void*) + 2 * sizeof(int);
+
+    MemoryUsage usage;
+    usage.items = words;
+    usage.nodes = sizeof(TSTNode) * nodes;
+    usage.overhead = (MemoryUsage::heapBlock(sizeof(TSTNode) + CONTROL_BLOCK) - sizeof(TSTNode)) * nodes;
+    return usage;
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include "../include/art.h"
+
+// "x" followed by each of the first n byte values from `from` on
+static void insertFanOut(AdaptiveRadixTree& tree, int n, int from = 'A') {
+    for (int i = 0; i < n; i++) {
+        tree.insert(std::string("x") + (char)(from + i));
+    }
+}
+
+void testNodesGrow() {
+    AdaptiveRadixTree tree;
+    tree.insert("x");
+    assert(tree.nodeCount() == 1);      // a lone leaf
+
+    insertFanOut(tree, 4);
+    assert(tree.nodeCount(ArtNode::NODE4) == 1);
+    insertFanOut(tree, 5);
+    assert(tree.nodeCount(ArtNode::NODE4) == 0 && tree.nodeCount(ArtNode::NODE16) == 1);
+    insertFanOut(tree, 17);
+    assert(tree.nodeCount(ArtNode::NODE16) == 0 && tree.nodeCount(ArtNode::NODE48) == 1);
+    insertFanOut(tree, 49);
+    assert(tree.nodeCount(ArtNode::NODE48) == 0 && tree.nodeCount(ArtNode::NODE256) == 1);
+    assert(tree.wordCount() == 50);
+
+    for (int i = 0; i < 49; i++) {
+        assert(tree.search(std::string("x") + (char)('A' + i)));
+    }
+    assert(tree.search("x"));
+    assert(!tree.search(std::string("x") + (char)('A' + 49)));
+
+    // Children come back in byte order, the word ending at the node first
+    auto results = tree.prefixSearch("x", 3);
+    assert((results == std::vector<std::string>{"x", "xA", "xB"}));
+
+    std::cout << "ART node growth tests passed" << std::endl;
+}
+
+void testNode16Lookup() {
+    // Bytes above 0x7f must order and match like the rest
+    AdaptiveRadixTree tree;
+    std::vector<int> bytes = {0x01, 0x30, 0x7f, 0x80, 0x81, 0xc3, 0xfe, 0xff, 'a', 'z'};
+    for (int b : bytes) tree.insert(std::string("k") + (char)b);
+    assert(tree.nodeCount(ArtNode::NODE16) == 1);
+
+    for (int b : bytes) assert(tree.search(std::string("k") + (char)b));
+    for (int b : {0x00, 0x02, 0x7e, 0x82, 0xfd, (int)'b'}) {
+        assert(!tree.search(std::string("k") + (char)b));
+    }
+
+    std::vector<std::string> all;
+    tree.getAllWords(all);
+    for (size_t i = 1; i < all.size(); i++) {
+        assert((unsigned char)all[i - 1][1] < (unsigned char)all[i][1]);
+    }
+
+    std::cout << "ART Node16 lookup tests passed" << std::endl;
+}
+
+void testLongPrefixes() {
+    // Shared runs longer than the stored prefix, split inside and past it
+    AdaptiveRadixTree tree;
+    std::string a = "std::__detail::_Hashtable_traits_cache";
+    std::string b = "std::__detail::_Hashtable_traits_unique";
+    std::string c = "std::__detail::_Hash_code_base";
+    std::string d = "std::__det";
+    tree.insert(a);
+    tree.insert(b);
+    tree.insert(c);
+    tree.insert(d);
+    for (const auto& word : {a, b, c, d}) assert(tree.search(word));
+    assert(!tree.search("std::__detail::_Hashtable_traits_"));
+    assert(!tree.search("std::__detail::_Hashtable_traitX_cache"));
+    assert(!tree.search("std::__de"));
+
+    assert((tree.prefixSearch("std::__detail::_Hasht", 10) == std::vector<std::string>{a, b}));
+    assert((tree.prefixSearch("std::__d", 10) == std::vector<std::string>{d, c, a, b}));
+    assert(tree.prefixSearch("std::__detail::_HashtableX", 10).empty());
+    assert(tree.prefixSearch("std::__detail::_Hashtable_traits_cachex", 10).empty());
+
+    // Erasing folds the Node4 chain back into one long prefix
+    assert(tree.erase(c));
+    assert(tree.erase(d));
+    assert(tree.search(a) && tree.search(b) && !tree.search(c) && !tree.search(d));
+    assert(tree.nodeCount(ArtNode::NODE4) == 1);
+    assert((tree.prefixSearch("std", 10) == std::vector<std::string>{a, b}));
+
+    std::cout << "ART long prefix tests passed" << std::endl;
+}
+
+void testEraseShrinks() {
+    AdaptiveRadixTree tree;
+    insertFanOut(tree, 60);
+    assert(tree.nodeCount(ArtNode::NODE256) == 1);
+
+    for (int i = 59; i >= 2; i--) {
+        assert(tree.erase(std::string("x") + (char)('A' + i)));
+    }
+    assert(tree.nodeCount(ArtNode::NODE256) == 0 && tree.nodeCount(ArtNode::NODE4) == 1);
+    assert(tree.wordCount() == 2);
+
+    // The last Node4 goes away with its second-to-last word
+    assert(tree.erase("xA"));
+    assert(tree.nodeCount() == 1);
+    assert((tree.prefixSearch("", 10) == std::vector<std::string>{"xB"}));
+
+    assert(!tree.erase("xA"));
+    assert(!tree.erase("x"));
+    assert(!tree.erase(""));
+    assert(tree.erase("xB"));
+    assert(tree.nodeCount() == 0 && tree.wordCount() == 0);
+    assert(tree.prefixSearch("x", 5).empty());
+
+    // A word ending at a node survives the removal of everything below it
+    tree.insert("hell");
+    tree.insert("hello");
+    tree.insert("help");
+    assert(tree.erase("hello") && tree.erase("help"));
+    assert(tree.search("hell") && tree.nodeCount() == 1);
+
+    std::cout << "ART erase tests passed" << std::endl;
+}
+
+void testMove() {
+    AdaptiveRadixTree tree;
+    for (int i = 0; i < 300; i++) tree.insert("node_" + std::to_string(i));
+
+    // Moving hands the whole tree over
+    AdaptiveRadixTree moved(std::move(tree));
+    assert(moved.wordCount() == 300 && tree.wordCount() == 0);
+    assert(!tree.search("node_7") && tree.prefixSearch("", 5).empty());
+    tree = std::move(moved);
+    assert(tree.search("node_7") && tree.wordCount() == 300);
+
+    std::cout << "ART move tests passed" << std::endl;
+}
+
+void testMemoryUsage() {
+    AdaptiveRadixTree tree;
+    tree.insert("print");
+    tree.insert("printf");
+    tree.insert("a_word_too_long_for_the_inline_string_buffer");
+    MemoryUsage usage = tree.memoryUsage();
+    assert(usage.nodes == 3 * sizeof(ArtLeaf) + 2 * sizeof(ArtNode4));
+    assert(usage.strings > 0 && usage.total() > usage.nodes);
+
+    std::cout << "ART memory usage tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning ART Tests...\n" << std::endl;
+
+    testNodesGrow();
+    testNode16Lookup();
+    testLongPrefixes();
+    testEraseShrinks();
+    testMove();
+    testMemoryUsage();
+
+    std::cout << "\n All ART tests passed!\n" << std::endl;
+
+    return 0;
+}
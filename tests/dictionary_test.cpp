@@ -0,0 +1,131 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "../include/dictionary.h"
+#include "../include/tst.h"
+
+// Identifier-like words with long shared runs, so labels split and merge,
+// and now and then a last byte from a wide range, so nodes branch wide
+static std::string randomWord() {
+    static const char* const PARTS[] = {"get", "set", "_", "Buffer", "node", "std::", "vector", "x", "count", "ab"};
+    std::string word;
+    int parts = 1 + rand() % 4;
+    for (int i = 0; i < parts; i++) word += PARTS[rand() % 10];
+    if (rand() % 4 == 0) word += (char)('0' + rand() % 64);
+    return word;
+}
+
+void testDictionaryKinds() {
+    for (const auto& kind : Dictionary::kinds()) {
+        std::unique_ptr<Dictionary> dict = Dictionary::create(kind);
+        assert(dict && kind == dict->name());
+        for (const char* word : {"printf", "print", "private"}) dict->insert(word);
+        assert(dict->search("print") && !dict->search("pri"));
+        assert((dict->prefixSearch("pri", 2) == std::vector<std::string>{"print", "printf"}));
+        assert(dict->erase("print") && dict->wordCount() == 2);
+    }
+    assert(!Dictionary::create("btree"));
+
+    std::cout << "Dictionary backend selection tests passed" << std::endl;
+}
+
+// Every backend against a TST and a std::set under the same churn
+void testMatchesTST() {
+    for (const auto& kind : Dictionary::kinds()) {
+        srand(3);
+        std::unique_ptr<Dictionary> dict = Dictionary::create(kind);
+        TST tst;
+        std::set<std::string> expected;
+
+        for (int step = 0; step < 20000; step++) {
+            std::string word = randomWord();
+            if (rand() % 3 == 0) {
+                bool erased = expected.erase(word) == 1;
+                assert(dict->erase(word) == erased);
+                tst.erase(word);
+            } else {
+                dict->insert(word);
+                tst.insert(word);
+                expected.insert(word);
+            }
+            assert(dict->wordCount() == expected.size());
+        }
+
+        for (int pass = 0; pass < 2; pass++) {
+            for (const auto& word : expected) assert(dict->search(word));
+            std::vector<std::string> all;
+            dict->getAllWords(all);
+            assert(std::set<std::string>(all.begin(), all.end()) == expected && all.size() == expected.size());
+
+            // Same words, same order as TST for every prefix length
+            for (int i = 0; i < 2000; i++) {
+                std::string word = randomWord();
+                std::string prefix = word.substr(0, 1 + rand() % word.size());
+                int k = 1 + rand() % 20;
+                assert(dict->prefixSearch(prefix, k) == tst.prefixSearch(prefix, k));
+            }
+            dict->compactIfFragmented();
+        }
+
+        // With weights set, a backend that ranks returns the k heaviest of
+        // the prefix (ties in byte order); the others keep byte order
+        auto weight = [](const std::string& word) { return (int)(word.size() * 7 % 13); };
+        dict->setWeights(weight);
+        bool ranks = kind == "sorted";
+        for (int i = 0; i < 2000; i++) {
+            std::string word = randomWord();
+            std::string prefix = word.substr(0, 1 + rand() % word.size());
+            size_t k = 1 + rand() % 20;
+            if (!ranks) {
+                assert(dict->prefixSearch(prefix, (int)k) == tst.prefixSearch(prefix, (int)k));
+                continue;
+            }
+            std::vector<std::string> matches;
+            for (const auto& w : expected) {
+                if (w.compare(0, prefix.size(), prefix) == 0) matches.push_back(w);
+            }
+            std::stable_sort(matches.begin(), matches.end(), [&](const std::string& a, const std::string& b) {
+                return weight(a) > weight(b);
+            });
+            if (matches.size() > k) matches.resize(k);
+            assert(dict->prefixSearch(prefix, (int)k) == matches);
+        }
+
+        std::cout << "Dictionary '" << kind << "' randomized comparison tests passed" << std::endl;
+    }
+}
+
+void testMemoryUsage() {
+    for (const auto& kind : Dictionary::kinds()) {
+        std::unique_ptr<Dictionary> dict = Dictionary::create(kind);
+        assert(dict->memoryUsage().items == 0);
+
+        for (int i = 0; i < 100; i++) dict->insert("std::chrono::duration_" + std::to_string(i));
+        dict->insert("a_word_too_long_for_the_inline_string_buffer");
+        MemoryUsage usage = dict->memoryUsage();
+        assert(usage.items == 101);
+        assert(usage.total() > usage.strings);
+
+        assert(dict->erase("std::chrono::duration_7"));
+        assert(dict->memoryUsage().items == 100);
+    }
+
+    std::cout << "Dictionary memory usage tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Dictionary Tests...\n" << std::endl;
+
+    testDictionaryKinds();
+    testMatchesTST();
+    testMemoryUsage();
+
+    std::cout << "\n All Dictionary tests passed!\n" << std::endl;
+
+    return 0;
+}
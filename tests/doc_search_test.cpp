@@ -0,0 +1,156 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../include/doc_search.h"
+
+// Every occurrence of pattern in text, the slow way
+static std::vector<size_t> naiveFind(const std::string& text, const std::string& pattern) {
+    std::vector<size_t> out;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        out.push_back(pos);
+    }
+    return out;
+}
+
+static std::vector<size_t> indexed(const DocumentSearch& search) {
+    std::vector<size_t> out;
+    for (size_t i = 0; i < search.count(); i++) {
+        out.push_back(search.at(i));
+    }
+    return out;
+}
+
+void testScan() {
+    TextBuffer buffer;
+    buffer.load("int x = 0;\nint y = x;\nreturn x + y;\n");
+
+    DocumentSearch search;
+    search.setPattern("x", buffer);
+    assert(search.count() == 3);
+
+    // Matches across lines and overlapping matches are all indexed
+    search.setPattern(";\nint", buffer);
+    assert(search.count() == 1 && search.at(0) == 9);
+
+    buffer.load("aaaa");
+    search.setPattern("aa", buffer);
+    assert(indexed(search) == std::vector<size_t>({0, 1, 2}));
+
+    // The rarest byte of "int_q" in source code is 'q'
+    assert(DocumentSearch::rarestByte("int_q") == 4);
+
+    std::cout << "Search scan tests passed" << std::endl;
+}
+
+void testAcrossPieces() {
+    // Splitting the document into many pieces must not lose boundary matches
+    TextBuffer buffer;
+    std::string model = "foo bar foo\nbaz foo";
+    buffer.load(model);
+    buffer.insert(5, "fo");
+    model.insert(5, "fo");
+    buffer.insert(6, "o");
+    model.insert(6, "o");
+    buffer.insert(0, "f");
+    model.insert(0, "f");
+    buffer.insert(1, "oo");
+    model.insert(1, "oo");
+    assert(buffer.pieceCount() > 3);
+
+    DocumentSearch search;
+    search.setPattern("foo", buffer);
+    assert(indexed(search) == naiveFind(model, "foo"));
+
+    std::cout << "Search piece boundary tests passed" << std::endl;
+}
+
+void testIncrementalEdits() {
+    TextBuffer buffer;
+    std::string model = "abab\nbaba\nab";
+    buffer.load(model);
+
+    DocumentSearch search;
+    search.setPattern("ab\nba", buffer);
+
+    srand(7);
+    for (int step = 0; step < 5000; step++) {
+        size_t pos = model.empty() ? 0 : rand() % (model.size() + 1);
+        if (rand() % 3 != 0) {
+            const char* alphabet = "ab\n";
+            std::string text(1 + rand() % 3, ' ');
+            for (char& c : text) c = alphabet[rand() % 3];
+            buffer.insert(pos, text);
+            model.insert(pos, text);
+            search.edited(pos, 0, text.size(), buffer);
+        } else if (!model.empty()) {
+            if (pos >= model.size()) pos = model.size() - 1;
+            size_t count = std::min<size_t>(1 + rand() % 4, model.size() - pos);
+            buffer.erase(pos, count);
+            model.erase(pos, count);
+            search.edited(pos, count, 0, buffer);
+        }
+        if (step % 250 == 0) {
+            assert(indexed(search) == naiveFind(model, "ab\nba"));
+        }
+    }
+    assert(indexed(search) == naiveFind(model, "ab\nba"));
+
+    std::cout << "Search incremental update tests passed" << std::endl;
+}
+
+void testNavigation() {
+    TextBuffer buffer;
+    buffer.load("x..x..x");
+
+    DocumentSearch search;
+    search.setPattern("x", buffer);
+
+    assert(search.next(0) == 1);
+    assert(search.next(3) == 2);
+    assert(search.next(6) == 0);      // wraps
+    assert(search.prev(0) == 2);      // wraps back
+    assert(search.prev(6) == 1);
+    assert(search.prev(4) == 1);      // from between matches
+
+    search.setPattern("y", buffer);
+    assert(search.next(0) == DocumentSearch::npos);
+
+    std::cout << "Search navigation tests passed" << std::endl;
+}
+
+void testReplaceAll() {
+    TextBuffer buffer;
+    buffer.load("head aaa mid aa tail");
+
+    DocumentSearch search;
+    search.setPattern("aa", buffer);
+    DocumentSearch::Replacement r = search.replaceAll(buffer, "b");
+
+    // "aaa" has overlapping matches; only the leftmost is replaced
+    assert(r.replaced == 2);
+    assert(r.from == 5);
+    buffer.erase(r.from, r.length);
+    buffer.insert(r.from, r.text);
+    assert(buffer.text() == "head ba mid b tail");
+
+    search.setPattern("zz", buffer);
+    assert(search.replaceAll(buffer, "q").replaced == 0);
+
+    std::cout << "Search replace-all tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Document Search Tests...\n" << std::endl;
+
+    testScan();
+    testAcrossPieces();
+    testIncrementalEdits();
+    testNavigation();
+    testReplaceAll();
+
+    std::cout << "\n All Document Search tests passed!\n" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../include/edit_journal.h"
+
+static std::string tempPath() {
+    char path[] = "/tmp/edit_journal_test_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    return path;
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+static std::string applyOps(std::string text, const std::vector<JournalOp>& ops) {
+    for (const auto& op : ops) {
+        if (op.kind == JournalOp::INSERT) {
+            text.insert(op.offset, op.text);
+        } else {
+            text.erase(op.offset, op.count);
+        }
+    }
+    return text;
+}
+
+// Random edits on text, each recorded in the journal; returns the result
+static std::string recordEdits(EditJournal& journal, std::string text, int edits) {
+    for (int i = 0; i < edits; i++) {
+        size_t offset = rand() % (text.size() + 1);
+        if (rand() % 3 == 0 && offset < text.size()) {
+            size_t count = 1 + rand() % std::min<size_t>(5, text.size() - offset);
+            text.erase(offset, count);
+            journal.erase(offset, count);
+        } else {
+            std::string insert = rand() % 4 == 0 ? "\n" : std::string(1 + rand() % 3, (char)('a' + rand() % 26));
+            text.insert(offset, insert);
+            journal.insert(offset, insert);
+        }
+    }
+    return text;
+}
+
+void testRecordAndReplay() {
+    srand(11);
+    std::string path = tempPath();
+    JournalHeader header;
+    header.document = "src/main.cpp";
+    header.baseSize = 42;
+    header.baseMtimeNs = 123456789;
+
+    EditJournal journal;
+    std::string error;
+    assert(journal.open(path, header, false, error));
+    std::string base = "int main() {\n    return 0;\n}\n";
+    std::string edited = recordEdits(journal, base, 500);
+    journal.sync();
+
+    // Readable while still open: everything recorded before sync() is on disk
+    JournalHeader read;
+    std::vector<JournalOp> ops;
+    assert(EditJournal::replay(path, read, ops));
+    assert(read.document == header.document && read.baseSize == 42 && read.baseMtimeNs == 123456789);
+    assert(applyOps(base, ops) == edited);
+
+    // Closing flushes the last batch; discarding removes the file
+    journal.insert(0, "// tail\n");
+    journal.close(false);
+    assert(EditJournal::replay(path, read, ops));
+    assert(applyOps(base, ops) == "// tail\n" + edited);
+
+    assert(journal.open(path, header, false, error));
+    journal.close(true);
+    assert(!EditJournal::replay(path, read, ops));
+
+    std::cout << "EditJournal record and replay tests passed" << std::endl;
+}
+
+void testTornAndCorruptTail() {
+    std::string path = tempPath();
+    JournalHeader header;
+    header.document = "notes.txt";
+
+    EditJournal journal;
+    std::string error;
+    assert(journal.open(path, header, false, error));
+    journal.insert(0, "hello");
+    journal.insert(5, " world");
+    journal.erase(0, 1);
+    journal.close(false);
+
+    JournalHeader read;
+    std::vector<JournalOp> ops;
+    std::string full = readFile(path);
+
+    // A crash mid-write leaves part of the last record: it is dropped
+    writeFile(path, full.substr(0, full.size() - 3));
+    assert(EditJournal::replay(path, read, ops));
+    assert(ops.size() == 2 && applyOps("", ops) == "hello world");
+
+    // A flipped byte inside the second record ends the journal there
+    std::string corrupt = full;
+    corrupt[full.find(" world") + 2] ^= 0x20;
+    writeFile(path, corrupt);
+    assert(EditJournal::replay(path, read, ops));
+    assert(ops.size() == 1 && applyOps("", ops) == "hello");
+
+    // Reopening with keep continues after the intact records
+    writeFile(path, full.substr(0, full.size() - 3));
+    assert(journal.open(path, header, true, error));
+    journal.insert(11, "!");
+    journal.close(false);
+    assert(EditJournal::replay(path, read, ops));
+    assert(ops.size() == 3 && applyOps("", ops) == "hello world!");
+
+    // ...but not for another version of the file
+    JournalHeader changed = header;
+    changed.baseSize = 99;
+    assert(journal.open(path, changed, true, error));
+    journal.close(false);
+    assert(EditJournal::replay(path, read, ops));
+    assert(ops.empty() && read.baseSize == 99);
+
+    // Garbage is not a journal
+    writeFile(path, "not a journal");
+    assert(!EditJournal::replay(path, read, ops));
+
+    // ...and is never truncated to start one, e.g. another editor's swap file
+    assert(!journal.open(path, header, false, error) && !error.empty());
+    assert(readFile(path) == "not a journal");
+
+    unlink(path.c_str());
+    std::cout << "EditJournal torn tail tests passed" << std::endl;
+}
+
+// A second editor of the same file is kept out while the first journals it
+void testLocking() {
+    std::string path = tempPath();
+    JournalHeader header = EditJournal::describe("doc.cpp");
+    std::string error;
+
+    EditJournal first;
+    assert(!EditJournal::inUse(path));
+    assert(first.open(path, header, false, error));
+    first.insert(0, "hello");
+    first.sync();
+    std::string written = readFile(path);
+    assert(EditJournal::inUse(path));
+
+    // Neither a fresh start nor an append touches the locked journal
+    EditJournal second;
+    assert(!second.open(path, header, false, error) && error.find("in use") != std::string::npos);
+    assert(!second.open(path, header, true, error) && !second.isOpen());
+    assert(readFile(path) == written);
+
+    // A clean close removes the journal and lets the next editor in
+    first.close(true);
+    assert(!EditJournal::inUse(path) && access(path.c_str(), F_OK) != 0);
+    assert(second.open(path, header, false, error));
+    second.close(true);
+
+    std::cout << "EditJournal locking tests passed" << std::endl;
+}
+
+void testHelpers() {
+    assert(EditJournal::pathFor("dir/sub/file.cpp") == "dir/sub/.file.cpp.scaj");
+    assert(EditJournal::pathFor("file.cpp") == ".file.cpp.scaj");
+
+    std::string path = tempPath();
+    writeFile(path, "12345");
+    JournalHeader header = EditJournal::describe(path);
+    assert(header.document == path && header.baseSize == 5 && header.baseMtimeNs != 0);
+    unlink(path.c_str());
+    assert(EditJournal::describe(path).baseSize == 0);
+
+    std::cout << "EditJournal helper tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Edit Journal Tests...\n" << std::endl;
+
+    testRecordAndReplay();
+    testTornAndCorruptTail();
+    testLocking();
+    testHelpers();
+
+    std::cout << "\n All Edit Journal tests passed!\n" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "../include/fuzzy.h"
+
+// Smallest edit distance between query and any substring of text, by dynamic programming
+static int naiveDistance(const std::string& query, const std::string& text) {
+    size_t m = query.size();
+    std::vector<int> column(m + 1);
+    for (size_t i = 0; i <= m; i++) column[i] = i;
+    int best = m;
+    for (char c : text) {
+        int diagonal = column[0];
+        column[0] = 0;      // a match may start anywhere
+        for (size_t i = 1; i <= m; i++) {
+            int up = column[i];
+            bool same = std::tolower((unsigned char)query[i - 1]) == std::tolower((unsigned char)c);
+            column[i] = std::min({up + 1, column[i - 1] + 1, diagonal + (same ? 0 : 1)});
+            diagonal = up;
+        }
+        best = std::min(best, column[m]);
+    }
+    return best;
+}
+
+void testDistance() {
+    assert(FuzzyIndex::substringDistance("vector", "std_vector_push") == 0);
+    assert(FuzzyIndex::substringDistance("vectr", "vector") == 1);
+    assert(FuzzyIndex::substringDistance("Vector", "myvector") == 0);     // ASCII case is ignored
+    assert(FuzzyIndex::substringDistance("abc", "") == 3);
+
+    srand(3);
+    for (int round = 0; round < 3000; round++) {
+        std::string query(1 + rand() % 64, ' ');
+        for (char& c : query) c = "abcAB"[rand() % 5];
+        std::string text(rand() % 100, ' ');
+        for (char& c : text) c = "abcd"[rand() % 4];
+        assert(FuzzyIndex::substringDistance(query, text) == naiveDistance(query, text));
+    }
+
+    std::cout << "Fuzzy distance tests passed" << std::endl;
+}
+
+void testSearch() {
+    std::vector<std::string> vocabulary = {
+        "printf", "sprintf", "println", "print", "pritnf", "vector", "std::vector<int>",
+        "a_very_long_identifier_that_does_not_fit_in_a_sixty_four_byte_bucket_printf"
+    };
+    FuzzyIndex index;
+    index.build(vocabulary);
+    assert(index.size() == vocabulary.size());
+
+    auto matches = index.search("printf", 1, 10);
+    // Exact containers first, shortest first; then one-edit matches
+    assert(matches.size() == 5);
+    assert(matches[0].word == "printf" && matches[0].distance == 0 && matches[0].id == 0);
+    assert(matches[1].word == "sprintf" && matches[1].distance == 0);
+    assert(matches[2].distance == 0 && matches[2].id == 7);
+    assert(matches[3].word == "print" && matches[3].distance == 1);
+    assert(matches[4].word == "println" && matches[4].distance == 1);
+
+    // A transposition costs two edits
+    matches = index.search("printf", 2, 10);
+    assert(matches.size() == 6 && matches[5].word == "pritnf" && matches[5].distance == 2);
+
+    assert(index.search("printf", 1, 2).size() == 2);
+    assert(index.search("", 1, 10).empty());
+    assert(index.search(std::string(65, 'a'), 1, 10).empty());
+
+    std::cout << "Fuzzy search tests passed" << std::endl;
+}
+
+void testThreadsAgree() {
+    std::vector<std::string> vocabulary;
+    srand(5);
+    for (int i = 0; i < 20000; i++) {
+        std::string word(3 + rand() % 12, ' ');
+        for (char& c : word) c = 'a' + rand() % 6;
+        vocabulary.push_back(word);
+    }
+    FuzzyIndex index;
+    index.build(vocabulary);
+
+    auto single = index.search("abcdef", 2, 50, 1);
+    auto parallel = index.search("abcdef", 2, 50, 4);
+    assert(!single.empty() && single.size() == parallel.size());
+    for (size_t i = 0; i < single.size(); i++) {
+        assert(single[i].id == parallel[i].id && single[i].distance == parallel[i].distance);
+        assert(naiveDistance("abcdef", single[i].word) == single[i].distance);
+    }
+
+    std::cout << "Fuzzy thread partition tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Fuzzy Tests...\n" << std::endl;
+
+    testDistance();
+    testSearch();
+    testThreadsAgree();
+
+    std::cout << "\n All Fuzzy tests passed!\n" << std::endl;
+
+    return 0;
+}
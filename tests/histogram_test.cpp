@@ -0,0 +1,64 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include "../include/histogram.h"
+
+void testBucketLayout() {
+    // Small values are exact
+    for (uint64_t v = 0; v < LatencyHistogram::SUB_BUCKETS; v++) {
+        size_t i = LatencyHistogram::bucketIndex(v);
+        assert(LatencyHistogram::bucketLow(i) == v && LatencyHistogram::bucketHigh(i) == v);
+    }
+
+    // Every value falls inside its bucket, and buckets stay within ~3%
+    for (uint64_t v = 1; v < (1ULL << 62); v = v * 3 + 1) {
+        size_t i = LatencyHistogram::bucketIndex(v);
+        uint64_t low = LatencyHistogram::bucketLow(i);
+        uint64_t high = LatencyHistogram::bucketHigh(i);
+        assert(low <= v && v <= high);
+        assert((double)(high - low) <= 0.032 * low + 1);
+    }
+    assert(LatencyHistogram::bucketIndex(UINT64_MAX) == LatencyHistogram::BUCKETS - 1);
+
+    std::cout << "Histogram bucket layout tests passed" << std::endl;
+}
+
+void testPercentiles() {
+    LatencyHistogram h;
+    assert(h.percentile(50) == 0);
+
+    for (uint64_t v = 1; v <= 10000; v++) {
+        h.record(v);
+    }
+    assert(h.count() == 10000);
+    assert(h.min() == 1 && h.max() == 10000);
+    assert(h.mean() == 5000.5);
+
+    uint64_t p50 = h.percentile(50);
+    uint64_t p99 = h.percentile(99);
+    assert(p50 >= 5000 && p50 <= 5000 * 1.032);
+    assert(p99 >= 9900 && p99 <= 9900 * 1.032);
+    assert(h.percentile(100) == 10000);
+    assert(h.percentile(0) == 1);
+
+    LatencyHistogram other;
+    other.record(1000000);
+    h.merge(other);
+    assert(h.count() == 10001 && h.max() == 1000000);
+
+    h.clear();
+    assert(h.count() == 0 && h.max() == 0);
+
+    std::cout << "Histogram percentile tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Histogram Tests...\n" << std::endl;
+
+    testBucketLayout();
+    testPercentiles();
+
+    std::cout << "\n All Histogram tests passed!\n" << std::endl;
+
+    return 0;
+}
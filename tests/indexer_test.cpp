@@ -0,0 +1,185 @@
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <unistd.h>
+#include "../include/incremental_indexer.h"
+
+namespace fs = std::filesystem;
+
+void writeFile(const fs::path& path, const std::string& text) {
+    std::ofstream out(path);
+    out << text;
+}
+
+// inotify delivers asynchronously; poll until the change shows up
+UpdateStats waitForUpdate(IncrementalIndexer& indexer) {
+    UpdateStats total;
+    for (int attempt = 0; attempt < 100; attempt++) {
+        UpdateStats stats = indexer.update();
+        total.filesRescanned += stats.filesRescanned;
+        total.filesRemoved += stats.filesRemoved;
+        total.tokensAdded += stats.tokensAdded;
+        total.tokensRemoved += stats.tokensRemoved;
+        if (total.filesRescanned + total.filesRemoved > 0) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return total;
+}
+
+void testTokenize() {
+    TokenCounts counts;
+    std::string code =
+        "// commentWord\n"
+        "int counter = 0; /* blockWord */\n"
+        "std::string label = \"stringWord\";\n"
+        "auto raw = R\"x(rawWord)x\";\n"
+        "counter++;\n";
+    ProjectIndexer::tokenize(code.data(), code.size(), counts);
+
+    auto tokens = counts.tokenMap();
+    assert(tokens["counter"] == 2);
+    assert(tokens["int"] == 1);
+    assert(tokens["label"] == 1);
+    assert(tokens.count("commentWord") == 0);
+    assert(tokens.count("blockWord") == 0);
+    assert(tokens.count("stringWord") == 0);
+    assert(tokens.count("rawWord") == 0);
+
+    std::cout << "Tokenizer tests passed" << std::endl;
+}
+
+// Project counts rank suggestions but never reach the frequency file,
+// so indexing the same tree in a later session does not double them
+void testIndexTreeNotSaved(const fs::path& dir) {
+    fs::path src = dir / "saved";
+    fs::create_directories(src);
+    writeFile(src / "a.cpp", "int epsilonValue = 1; epsilonValue++;\n");
+    std::string freqPath = (dir / "saved_freq.txt").string();
+
+    for (int session = 0; session < 2; session++) {
+        DictionaryOf<TST> tst("tst");
+        FreqStore freqStore(freqPath);
+        CooccurrenceGraph graph;
+        freqStore.bump("epsilonValue");
+        ProjectIndexer().indexTree(src.string(), tst, freqStore, graph);
+        assert(freqStore.get("epsilonValue") == 2 + session + 1);
+    }
+
+    FreqStore reloaded(freqPath);
+    assert(reloaded.get("epsilonValue") == 2);
+    assert(reloaded.get("int") == 0);
+
+    std::cout << "Index persistence tests passed" << std::endl;
+}
+
+void testIncrementalUpdates(const fs::path& dir) {
+    DictionaryOf<TST> tst("tst");
+    tst.insert("seedOnly");
+    FreqStore freqStore((dir / "freq.txt").string());
+    CooccurrenceGraph graph;
+    IncrementalIndexer indexer(tst, freqStore, graph);
+
+    fs::path src = dir / "src";
+    fs::create_directories(src);
+    writeFile(src / "a.cpp", "int alphaValue = 1; alphaValue++;\nseedOnly();\n");
+    writeFile(src / "b.cpp", "int betaValue = 2;\n");
+
+    IndexStats stats = indexer.start(src.string());
+    assert(stats.files == 2);
+    assert(tst.search("alphaValue"));
+    assert(tst.search("betaValue"));
+    assert(freqStore.get("alphaValue") == 2);
+    assert(freqStore.get("int") == 2);
+    assert(graph.getEdgeWeight("int", "alphaValue") == 1);
+
+    // Rewrite a.cpp: alphaValue disappears, gammaValue appears
+    writeFile(src / "a.cpp", "int gammaValue = 3;\n");
+    UpdateStats update = waitForUpdate(indexer);
+    assert(update.filesRescanned == 1);
+    assert(!tst.search("alphaValue"));
+    assert(tst.search("gammaValue"));
+    assert(freqStore.get("alphaValue") == 0);
+    assert(freqStore.get("int") == 2);
+    assert(graph.getEdgeWeight("int", "alphaValue") == 0);
+    assert(graph.getEdgeWeight("int", "gammaValue") == 1);
+
+    // A token that was in the TST before indexing survives its file going away
+    assert(tst.search("seedOnly"));
+
+    // Files in a new directory are picked up
+    fs::create_directories(src / "sub");
+    writeFile(src / "sub" / "c.cpp", "int deltaValue;\n");
+    waitForUpdate(indexer);
+    assert(tst.search("deltaValue"));
+
+    // Deleting a file subtracts everything it contributed
+    fs::remove(src / "b.cpp");
+    update = waitForUpdate(indexer);
+    assert(update.filesRemoved == 1);
+    assert(!tst.search("betaValue"));
+    assert(freqStore.get("int") == 2);
+
+    // None of it reached the frequency file
+    assert(FreqStore((dir / "freq.txt").string()).get("int") == 0);
+
+    // Stopping unloads the project entirely
+    indexer.stop();
+    assert(!tst.search("gammaValue"));
+    assert(!tst.search("deltaValue"));
+    assert(tst.search("seedOnly"));
+    assert(freqStore.get("int") == 0);
+    assert(graph.getEdgeWeight("int", "gammaValue") == 0);
+
+    std::cout << "Incremental indexer tests passed" << std::endl;
+}
+
+// More events than the kernel queues: the watcher reports the overflow and
+// update() indexes the whole tree again instead of missing changes
+void testQueueOverflow(const fs::path& dir) {
+    std::ifstream limitFile("/proc/sys/fs/inotify/max_queued_events");
+    int limit = 0;
+    if (!(limitFile >> limit) || limit > 100000) return;
+
+    DictionaryOf<TST> tst("tst");
+    FreqStore freqStore((dir / "overflow_freq.txt").string());
+    CooccurrenceGraph graph;
+    IncrementalIndexer indexer(tst, freqStore, graph);
+
+    fs::path src = dir / "overflow";
+    fs::create_directories(src);
+    writeFile(src / "a.cpp", "int etaValue;\n");
+    writeFile(src / "b.cpp", "int thetaValue;\n");
+    indexer.start(src.string());
+
+    // Alternate files so the kernel cannot merge repeated events
+    for (int i = 0; i <= limit; i++) {
+        writeFile(src / (i % 2 ? "a.cpp" : "b.cpp"), i % 2 ? "int iotaValue;\n" : "int kappaValue;\n");
+    }
+
+    UpdateStats update = indexer.update();
+    assert(update.fullRescan);
+    assert(update.filesRescanned == 2);
+    assert(!tst.search("etaValue") && !tst.search("thetaValue"));
+    assert(tst.search("iotaValue") && tst.search("kappaValue"));
+    assert(freqStore.get("int") == 2);
+    assert(indexer.watching());
+
+    std::cout << "Watcher overflow tests passed" << std::endl;
+}
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / ("indexer_test_" + std::to_string(getpid()));
+    fs::create_directories(dir);
+
+    testTokenize();
+    testIndexTreeNotSaved(dir);
+    testIncrementalUpdates(dir);
+    testQueueOverflow(dir);
+
+    fs::remove_all(dir);
+    std::cout << "All indexer tests passed!" << std::endl;
+    return 0;
+}
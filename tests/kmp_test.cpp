@@ -0,0 +1,64 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../include/kmp.h"
+
+const CompiledPattern::Kernel KERNELS[] = {
+    CompiledPattern::SCALAR, CompiledPattern::SSE2, CompiledPattern::AVX2
+};
+
+void testBasics() {
+    for (auto kernel : KERNELS) {
+        CompiledPattern pattern("vec", kernel);
+        assert(pattern.contains("std::vector"));
+        assert(!pattern.contains("ve"));
+        assert(!pattern.contains(""));
+        assert(pattern.kernel() <= CompiledPattern::bestKernel());
+
+        assert(CompiledPattern("", kernel).contains("anything"));
+        assert(CompiledPattern("x", kernel).findAll("x.x..x") == std::vector<int>({0, 2, 5}));
+
+        // Every overlapping match of a periodic pattern
+        std::vector<int> run = CompiledPattern("aaaa", kernel).findAll(std::string(1000, 'a'));
+        assert(run.size() == 997 && run.front() == 0 && run.back() == 996);
+    }
+
+    std::cout << "CompiledPattern basic tests passed" << std::endl;
+}
+
+void testMatchesKMP() {
+    // Small alphabets give many first/last-byte candidates and overlapping matches
+    srand(11);
+    for (int round = 0; round < 2000; round++) {
+        std::string text(rand() % 200, ' ');
+        for (char& c : text) c = "ab\n"[rand() % 3];
+        std::string pat(1 + rand() % 40, ' ');
+        for (char& c : pat) c = "ab\n"[rand() % 3];
+        if (rand() % 4 == 0 && text.size() > pat.size()) {
+            text.replace(text.size() - pat.size(), pat.size(), pat);   // a match in the tail
+        }
+
+        std::vector<int> expected = KMP::findAll(text, pat);
+        for (auto kernel : KERNELS) {
+            CompiledPattern pattern(pat, kernel);
+            assert(pattern.findAll(text) == expected);
+            assert(pattern.contains(text) == KMP::contains(text, pat));
+        }
+    }
+
+    std::cout << "CompiledPattern matches KMP on " << CompiledPattern::kernelName(CompiledPattern::bestKernel())
+              << " and fallbacks" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning KMP Tests...\n" << std::endl;
+
+    testBasics();
+    testMatchesKMP();
+
+    std::cout << "\n All KMP tests passed!\n" << std::endl;
+
+    return 0;
+}
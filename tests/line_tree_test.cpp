@@ -0,0 +1,76 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../include/line_tree.h"
+
+void testInsertErase() {
+    LineTree<int> tree;
+    assert(tree.size() == 0);
+
+    tree.grow(3);
+    for (int i = 0; i < 3; i++) tree[i] = i;
+
+    // Two new lines before line 1 push lines 1 and 2 down
+    tree.insert(1, 2);
+    assert(tree.size() == 5);
+    assert(tree[0] == 0 && tree[1] == 0 && tree[2] == 0 && tree[3] == 1 && tree[4] == 2);
+
+    std::vector<int> erased;
+    tree[1] = 7;
+    tree.erase(1, 3, [&](int& value) { erased.push_back(value); });
+    assert((erased == std::vector<int>{7, 0, 1}));
+    assert(tree.size() == 2 && tree[0] == 0 && tree[1] == 2);
+
+    // grow never shrinks
+    tree.grow(1);
+    assert(tree.size() == 2);
+    tree.clear();
+    assert(tree.size() == 0);
+
+    std::cout << "LineTree insert / erase tests passed" << std::endl;
+}
+
+void testRandomEditsMatchVector() {
+    srand(17);
+    LineTree<std::string> tree;
+    std::vector<std::string> model;
+
+    for (int step = 0; step < 20000; step++) {
+        int op = rand() % 3;
+        size_t at = rand() % (model.size() + 1);
+        size_t count = rand() % 40;
+        if (op == 0) {
+            tree.insert(at, count);
+            model.insert(model.begin() + at, count, std::string());
+        } else if (op == 1) {
+            count = std::min(count, model.size() - at);
+            std::vector<std::string> erased;
+            tree.erase(at, count, [&](std::string& value) { erased.push_back(value); });
+            assert(erased == std::vector<std::string>(model.begin() + at, model.begin() + at + count));
+            model.erase(model.begin() + at, model.begin() + at + count);
+        } else if (!model.empty()) {
+            size_t line = rand() % model.size();
+            tree[line] = model[line] = std::to_string(step);
+        }
+        assert(tree.size() == model.size());
+    }
+
+    for (size_t i = 0; i < model.size(); i++) {
+        assert(tree[i] == model[i]);
+    }
+
+    std::cout << "LineTree randomized comparison tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Line Tree Tests...\n" << std::endl;
+
+    testInsertErase();
+    testRandomEditsMatchVector();
+
+    std::cout << "\n All Line Tree tests passed!\n" << std::endl;
+
+    return 0;
+}
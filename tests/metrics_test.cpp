@@ -0,0 +1,77 @@
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+#include "../include/metrics.h"
+
+void testSampling() {
+    metrics::Snapshot before = metrics::collect();
+
+    size_t sampled = 0;
+    for (uint32_t i = 0; i < metrics::SAMPLE_INTERVAL * 10; i++) {
+        metrics::StageTimer timer(metrics::sample(metrics::SUGGEST));
+        timer.lap(metrics::CACHE_LOOKUP);
+        timer.total(metrics::SUGGEST);
+        sampled += timer.isTiming();
+    }
+    assert(sampled == 10);
+
+    metrics::Snapshot after = metrics::collect();
+    const metrics::StageStats& suggest = after.stages[metrics::SUGGEST];
+    assert(suggest.calls - before.stages[metrics::SUGGEST].calls == metrics::SAMPLE_INTERVAL * 10);
+    assert(suggest.timed - before.stages[metrics::SUGGEST].timed == 10);
+    assert(suggest.percentile(50) <= suggest.maxNs);
+
+    std::cout << "Metrics sampling tests passed" << std::endl;
+}
+
+void testThreads() {
+    metrics::Snapshot before = metrics::collect();
+
+    // Exited threads keep their counts
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([] {
+            for (int i = 0; i < 1000; i++) {
+                metrics::count(metrics::CACHE_HITS);
+            }
+            metrics::ScopedTimer timer(metrics::FREQ_SAVE);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    metrics::Snapshot after = metrics::collect();
+    assert(after.counters[metrics::CACHE_HITS] - before.counters[metrics::CACHE_HITS] == 4000);
+    assert(after.stages[metrics::FREQ_SAVE].timed - before.stages[metrics::FREQ_SAVE].timed == 4);
+    assert(after.threads >= 5);
+
+    std::string json = metrics::toJson(after);
+    assert(json.find("\"cache_hits\":") != std::string::npos);
+    assert(json.find("\"freq_save\":{\"calls\":") != std::string::npos);
+
+    std::cout << "Metrics thread tests passed" << std::endl;
+}
+
+void testBuckets() {
+    for (uint64_t v = 1; v < (1ULL << 60); v = v * 5 + 3) {
+        size_t i = metrics::bucketIndex(v);
+        assert(v <= metrics::bucketHigh(i));
+        assert(metrics::bucketHigh(i) <= v + v / 4 + 1);
+    }
+
+    std::cout << "Metrics bucket tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Metrics Tests...\n" << std::endl;
+
+    testSampling();
+    testThreads();
+    testBuckets();
+
+    std::cout << "\n All Metrics tests passed!\n" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include "../include/radix_tst.h"
+#include "../include/tst.h"
+
+void testInsertSplitsLabels() {
+    RadixTST tree;
+    tree.insert("unordered_map");
+    assert(tree.nodeCount() == 1);
+    assert(tree.search("unordered_map"));
+    assert(!tree.search("unordered"));
+    assert(!tree.search("unordered_map_"));
+
+    // Diverging midway splits the label: "unordered_" -> {"map", "set"}
+    tree.insert("unordered_set");
+    assert(tree.nodeCount() == 3);
+
+    // Ending inside a label splits it too, marking the head as a word
+    tree.insert("unordered");
+    assert(tree.nodeCount() == 4);
+    assert(tree.search("unordered") && tree.search("unordered_map") && tree.search("unordered_set"));
+    assert(!tree.search("unordered_"));
+
+    // Already present: nothing changes
+    tree.insert("unordered_set");
+    assert(tree.wordCount() == 3 && tree.nodeCount() == 4);
+
+    // A character-per-node TST needs a node for each of these characters
+    TST tst;
+    for (const char* word : {"unordered_map", "unordered_set", "unordered"}) tst.insert(word);
+    assert(tst.nodeCount() == 16);
+
+    std::cout << "RadixTST split tests passed" << std::endl;
+}
+
+void testPrefixSearch() {
+    RadixTST tree;
+    for (const char* word : {"print", "printf", "println", "private", "protected", "pr"}) {
+        tree.insert(word);
+    }
+
+    auto results = tree.prefixSearch("pri", 10);
+    assert((results == std::vector<std::string>{"print", "printf", "println", "private"}));
+
+    // The prefix ends inside a label, on a word, and past every word
+    assert((tree.prefixSearch("printl", 10) == std::vector<std::string>{"println"}));
+    assert((tree.prefixSearch("pr", 2) == std::vector<std::string>{"pr", "print"}));
+    assert(tree.prefixSearch("prx", 10).empty());
+    assert(tree.prefixSearch("printfx", 10).empty());
+    assert(tree.prefixSearch("pri", 0).empty());
+    assert(tree.prefixSearch("", 3).size() == 3);
+
+    RadixTST empty;
+    assert(empty.prefixSearch("a", 5).empty());
+    assert(!empty.search(""));
+
+    std::cout << "RadixTST prefix search tests passed" << std::endl;
+}
+
+void testLongLabels() {
+    // Labels past the inline capacity live in the arena and split there
+    RadixTST tree;
+    std::string a = "std::__detail::_Hashtable_traits_cache_hash_code";
+    std::string b = "std::__detail::_Hashtable_traits_unique_keys";
+    std::string c = "std::__detail::_Hash";
+    tree.insert(a);
+    assert(tree.labelBytes() == a.size());
+    tree.insert(b);
+    tree.insert(c);
+    assert(tree.search(a) && tree.search(b) && tree.search(c));
+    assert(!tree.search("std::__detail::_Hashtable_traits_"));
+    assert((tree.prefixSearch("std::__detail::_Hashtable_traits_", 10) == std::vector<std::string>{a, b}));
+
+    // Erasing c merges its node back with the lone continuation
+    size_t nodes = tree.nodeCount();
+    assert(tree.erase(c));
+    assert(tree.nodeCount() == nodes - 1);
+    assert(tree.search(a) && tree.search(b) && !tree.search(c));
+
+    assert(tree.erase(b));
+    assert(tree.nodeCount() == 1);
+    assert((tree.prefixSearch("std", 10) == std::vector<std::string>{a}));
+
+    std::cout << "RadixTST long label tests passed" << std::endl;
+}
+
+void testErase() {
+    RadixTST tree;
+    tree.insert("hell");
+    tree.insert("hello");
+    tree.insert("help");
+    assert(tree.nodeCount() == 4);   // "hel" -> {"l" -> "o", "p"}
+
+    assert(tree.erase("hello"));
+    assert(!tree.search("hello") && tree.search("hell"));
+    assert(tree.nodeCount() == 3);
+
+    // "hel" is left with one continuation, "p", and absorbs it
+    assert(tree.erase("hell"));
+    assert(tree.search("help"));
+    assert(tree.nodeCount() == 1);
+
+    assert(!tree.erase("hell"));
+    assert(!tree.erase("he"));
+    assert(!tree.erase(""));
+
+    assert(tree.erase("help"));
+    assert(tree.wordCount() == 0 && tree.nodeCount() == 0);
+    assert(tree.prefixSearch("he", 5).empty());
+
+    // Removing a sibling with both links in use promotes its successor
+    for (const char* word : {"m", "d", "t", "b", "f", "r", "w", "e"}) tree.insert(word);
+    assert(tree.erase("d"));
+    assert(tree.erase("m"));
+    assert((tree.prefixSearch("", 10) == std::vector<std::string>{"b", "e", "f", "r", "t", "w"}));
+    assert(tree.nodeCount() == 6);
+
+    std::cout << "RadixTST erase tests passed" << std::endl;
+}
+
+void testCompact() {
+    RadixTST tree;
+    TST tst;
+    std::vector<std::string> words;
+    for (const char* stem : {"get", "set", "std::vector", "std::", "node_", "getBuffer"}) {
+        for (int i = 0; i < 50; i++) words.push_back(stem + std::to_string(i * 13));
+    }
+    for (const auto& word : words) {
+        tree.insert(word);
+        tst.insert(word);
+    }
+    // One node per shared label instead of one per character
+    assert(tree.nodeCount() < tst.nodeCount());
+
+    // Erasing leaves orphaned label bytes; a rebuild keeps every word and
+    // drops them
+    for (size_t i = 0; i < words.size(); i += 3) assert(tree.erase(words[i]));
+    size_t nodes = tree.nodeCount();
+    size_t wordsLeft = tree.wordCount();
+    tree.compact();
+    assert(tree.nodeCount() == nodes && tree.wordCount() == wordsLeft);
+    for (size_t i = 0; i < words.size(); i++) assert(tree.search(words[i]) == (i % 3 != 0));
+
+    std::cout << "RadixTST compact tests passed" << std::endl;
+}
+
+void testMemoryUsage() {
+    RadixTST tree;
+    tree.insert("print");
+    tree.insert("printf");
+    tree.insert("a_label_longer_than_inline");
+    MemoryUsage usage = tree.memoryUsage();
+    assert(usage.nodes == sizeof(RadixNode) * tree.nodeCount());
+    assert(usage.strings == tree.labelBytes());
+    assert(usage.total() >= usage.nodes + usage.strings);
+
+    std::cout << "RadixTST memory usage tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Radix TST Tests...\n" << std::endl;
+
+    testInsertSplitsLabels();
+    testPrefixSearch();
+    testLongLabels();
+    testErase();
+    testCompact();
+    testMemoryUsage();
+
+    std::cout << "\n All Radix TST tests passed!\n" << std::endl;
+
+    return 0;
+}
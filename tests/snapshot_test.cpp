@@ -0,0 +1,153 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include "../include/snapshot_dict.h"
+#include "../include/ranker.h"
+
+void testSnapshotIsolation() {
+    SnapshotDictionary dict;
+    auto reader = dict.registerReader();
+
+    dict.insert("print");
+    dict.bump("print", 3);
+    dict.publish();
+
+    {
+        auto before = reader.read();
+
+        // Staged and even published changes do not reach a pinned snapshot
+        dict.insert("printf");
+        dict.bump("print", 4);
+        dict.addEdge("std", "print");
+        dict.publish();
+
+        assert(before->version == 1);
+        assert(before->words.search("print"));
+        assert(!before->words.search("printf"));
+        assert(before->frequency("print") == 3);
+        assert(before->edgeWeight("std", "print") == 0);
+        assert(dict.retiredCount() >= 1);
+    }
+
+    auto after = reader.read();
+    assert(after->version == 2);
+    assert(after->words.search("printf"));
+    assert(after->frequency("print") == 7);
+    assert(after->edgeWeight("std", "print") == 1);
+
+    auto ranked = after->complete("pri", 5, "std");
+    assert(ranked.size() == 2);
+    assert(ranked[0].first == "print");
+    // Scored exactly as the Ranker scores
+    assert(ranked[0].second == Ranker::score(7, 1));
+    assert(after->score("printf", "std") == Ranker::score(0, 0));
+
+    std::cout << "Snapshot isolation tests passed" << std::endl;
+}
+
+void testReclamation() {
+    SnapshotDictionary dict;
+    auto reader = dict.registerReader();
+
+    {
+        auto pinned = reader.read();
+        for (int i = 0; i < 10; i++) {
+            dict.insert("word" + std::to_string(i));
+            dict.publish();
+        }
+        // The pinned snapshot and everything after it must be kept
+        assert(dict.retiredCount() == 10);
+        assert(pinned->version == 0);
+        assert(pinned->words.wordCount() == 0);
+    }
+
+    dict.reclaim();
+    assert(dict.retiredCount() == 0);
+
+    std::cout << "Reclamation tests passed" << std::endl;
+}
+
+// N readers check per-snapshot invariants while a writer publishes batches.
+// Batch b inserts BATCH words "b<b>_<i>", bumps "total" by BATCH and links
+// consecutive words, so inside any one snapshot the word count, the total
+// and the version must all agree.
+void testConcurrentReadersAndWriter() {
+    const int READERS = 4;
+    const int BATCHES = 300;
+    const int BATCH = 10;
+
+    SnapshotDictionary dict;
+    std::atomic<bool> done(false);
+    std::atomic<long> reads(0);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; r++) {
+        readers.emplace_back([&]() {
+            auto reader = dict.registerReader();
+            uint64_t lastVersion = 0;
+
+            while (!done.load()) {
+                auto snap = reader.read();
+                uint64_t v = snap->version;
+                assert(v >= lastVersion);
+                lastVersion = v;
+
+                assert(snap->frequency("total") == (int)v * BATCH);
+                assert(snap->words.wordCount() == v * BATCH);
+
+                if (v > 0) {
+                    std::string last = "b" + std::to_string(v - 1) + "_";
+                    assert(snap->words.search(last + std::to_string(BATCH - 1)));
+                    assert(snap->edgeWeight(last + "0", last + "1") == 1);
+                    assert(snap->frequency(last + "0") == 1);
+                }
+                // Nothing from a later batch may leak in
+                assert(!snap->words.search("b" + std::to_string(v) + "_0"));
+
+                auto completions = snap->complete("b", 5);
+                assert(completions.size() == std::min<size_t>(5, v * BATCH));
+                reads++;
+            }
+        });
+    }
+
+    for (int b = 0; b < BATCHES; b++) {
+        std::string prefix = "b" + std::to_string(b) + "_";
+        for (int i = 0; i < BATCH; i++) {
+            dict.insert(prefix + std::to_string(i));
+            dict.bump(prefix + std::to_string(i));
+            if (i > 0) {
+                dict.addEdge(prefix + std::to_string(i - 1), prefix + std::to_string(i));
+            }
+        }
+        dict.bump("total", BATCH);
+        dict.publish();
+        if (b % 16 == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    done = true;
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    assert(dict.currentVersion() == (uint64_t)BATCHES);
+    dict.reclaim();
+    assert(dict.retiredCount() == 0);
+
+    std::cout << "Concurrent readers/writer tests passed (" << reads.load()
+              << " snapshot reads)" << std::endl;
+}
+
+int main() {
+    testSnapshotIsolation();
+    testReclamation();
+    testConcurrentReadersAndWriter();
+
+    std::cout << "All snapshot tests passed!" << std::endl;
+    return 0;
+}
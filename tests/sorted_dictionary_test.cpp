@@ -0,0 +1,177 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "../include/sorted_dictionary.h"
+
+void testBlocksAndSearch() {
+    SortedDictionary dict;
+    std::vector<std::string> words;
+    for (int i = 0; i < 40; i++) words.push_back("word_" + std::to_string(100 + i));
+    for (const auto& word : words) dict.insert(word);
+    dict.insert("word_100");
+    assert(dict.wordCount() == 40 && dict.pendingCount() == 40);
+
+    // 40 words make two full blocks of 16 and one of 8
+    dict.compact();
+    assert(dict.pendingCount() == 0 && dict.blockCount() == 3);
+    for (const auto& word : words) assert(dict.search(word));
+    assert(!dict.search("word_"));
+    assert(!dict.search("word_1000"));
+    assert(!dict.search("a") && !dict.search("z") && !dict.search(""));
+
+    std::vector<std::string> all;
+    dict.getAllWords(all);
+    assert(all == words);
+
+    std::cout << "SortedDictionary block search tests passed" << std::endl;
+}
+
+void testPrefixRange() {
+    SortedDictionary dict;
+    for (const char* word : {"print", "printf", "println", "private", "protected", "pr", "std::__detail"}) {
+        dict.insert(word);
+    }
+    dict.compact();
+
+    assert((dict.prefixSearch("pri", 10) == std::vector<std::string>{"print", "printf", "println", "private"}));
+    assert((dict.prefixSearch("pr", 2) == std::vector<std::string>{"pr", "print"}));
+    assert((dict.prefixSearch("printl", 10) == std::vector<std::string>{"println"}));
+    assert(dict.prefixSearch("prx", 10).empty());
+    assert(dict.prefixSearch("printfx", 10).empty());
+    assert(dict.prefixSearch("pri", 0).empty());
+    assert(dict.prefixSearch("", 3).size() == 3);
+    assert((dict.prefixSearch("std::__", 5) == std::vector<std::string>{"std::__detail"}));
+
+    // A prefix ending in 0xff runs to the next byte below it, or to the end
+    dict.insert("a\xff\xff" "b");
+    dict.insert("a\xff" "c");
+    dict.insert("b");
+    dict.compact();
+    assert((dict.prefixSearch("a\xff", 5) == std::vector<std::string>{"a\xff" "c", "a\xff\xff" "b"}));
+    assert((dict.prefixSearch("a\xff\xff", 5) == std::vector<std::string>{"a\xff\xff" "b"}));
+
+    SortedDictionary empty;
+    assert(empty.prefixSearch("a", 5).empty());
+    assert(!empty.search("a") && !empty.erase("a"));
+
+    std::cout << "SortedDictionary prefix range tests passed" << std::endl;
+}
+
+void testPendingChanges() {
+    SortedDictionary dict;
+    for (const char* word : {"alpha", "beta", "gamma"}) dict.insert(word);
+    dict.compact();
+
+    // Changes wait in the side sets and queries see them straight away
+    dict.insert("delta");
+    assert(dict.erase("beta"));
+    assert(!dict.erase("beta") && !dict.erase("omega"));
+    assert(dict.pendingCount() == 2 && dict.wordCount() == 3);
+    assert(dict.search("delta") && !dict.search("beta"));
+    assert((dict.prefixSearch("", 10) == std::vector<std::string>{"alpha", "delta", "gamma"}));
+
+    // Re-inserting an erased word just cancels the erase
+    dict.insert("beta");
+    assert(dict.pendingCount() == 1 && dict.search("beta"));
+    assert(dict.erase("delta") && dict.pendingCount() == 0);
+
+    assert(!dict.compactIfFragmented());
+    dict.insert("epsilon");
+    assert(dict.compactIfFragmented(0.25));
+    assert(dict.pendingCount() == 0 && dict.wordCount() == 4);
+
+    // Enough pending changes fold into a new array by themselves
+    SortedDictionary grown;
+    for (size_t i = 0; i < SortedDictionary::MIN_REBUILD; i++) {
+        grown.insert("id" + std::to_string(i));
+    }
+    assert(grown.pendingCount() == 0 && grown.wordCount() == SortedDictionary::MIN_REBUILD);
+
+    std::cout << "SortedDictionary pending change tests passed" << std::endl;
+}
+
+void testWeightedTopK() {
+    std::map<std::string, int> freq = {
+        {"print", 5}, {"printf", 40}, {"println", 40}, {"private", 1}, {"protected", 99}, {"push", 70},
+    };
+    SortedDictionary dict;
+    dict.setWeights([&](const std::string& word) { return freq.count(word) ? freq[word] : 0; });
+    for (const auto& entry : freq) dict.insert(entry.first);
+    dict.compact();
+
+    // Heaviest first, ties in byte order
+    assert((dict.prefixSearch("pr", 3) == std::vector<std::string>{"protected", "printf", "println"}));
+    assert((dict.prefixSearch("pri", 10) == std::vector<std::string>{"printf", "println", "print", "private"}));
+    assert((dict.prefixSearch("p", 1) == std::vector<std::string>{"protected"}));
+
+    // Pending words take their weight when inserted; erased ones drop out
+    freq["printk"] = 60;
+    dict.insert("printk");
+    assert(dict.erase("printf"));
+    assert((dict.prefixSearch("pri", 3) == std::vector<std::string>{"printk", "println", "print"}));
+    freq["printk"] = 2;
+    assert(dict.prefixSearch("pri", 1)[0] == "printk");
+    freq["printk"] = 60;
+
+    // Weights are sampled at rebuild; setWeights resamples now
+    freq["private"] = 100;
+    assert(dict.prefixSearch("pri", 1)[0] == "printk");
+    dict.setWeights([&](const std::string& word) { return freq.count(word) ? freq[word] : 0; });
+    assert(dict.prefixSearch("pri", 1)[0] == "private");
+
+    // No weights: back to the first k in order
+    dict.setWeights(nullptr);
+    assert((dict.prefixSearch("pri", 2) == std::vector<std::string>{"print", "printk"}));
+
+    // Only pending words (nothing in the array yet) are still ranked: the
+    // weight-order walk stops at k, the byte-order walk at the end of a
+    // short run, and both agree with a full sort
+    SortedDictionary fresh;
+    fresh.setWeights([](const std::string& word) { return (int)(word.size() * 31 % 17); });
+    std::vector<std::string> ids;
+    for (int i = 0; i < 200; i++) {
+        ids.push_back("id" + std::to_string(i * 7));
+        fresh.insert(ids.back());
+    }
+    assert(fresh.pendingCount() == 200);
+    std::stable_sort(ids.begin(), ids.end(), [](const std::string& a, const std::string& b) {
+        int wa = (int)(a.size() * 31 % 17), wb = (int)(b.size() * 31 % 17);
+        return wa != wb ? wa > wb : a < b;
+    });
+    assert((fresh.prefixSearch("id", 5) == std::vector<std::string>(ids.begin(), ids.begin() + 5)));
+    assert((fresh.prefixSearch("id7", 3) == std::vector<std::string>{"id7", "id70", "id77"}));
+
+    std::cout << "SortedDictionary weighted top-k tests passed" << std::endl;
+}
+
+void testMemoryUsage() {
+    SortedDictionary dict;
+    for (int i = 0; i < 100; i++) dict.insert("std::chrono::duration_" + std::to_string(i));
+    dict.compact();
+    MemoryUsage usage = dict.memoryUsage();
+    // Front coding stores the shared 23-byte stem once per block of 16
+    assert(usage.strings < 100 * 10);
+    assert(usage.total() > usage.strings);
+
+    dict.insert("pending_word_longer_than_inline");
+    assert(dict.memoryUsage().nodes > 0);
+
+    std::cout << "SortedDictionary memory usage tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Sorted Dictionary Tests...\n" << std::endl;
+
+    testBlocksAndSearch();
+    testPrefixRange();
+    testPendingChanges();
+    testWeightedTopK();
+    testMemoryUsage();
+
+    std::cout << "\n All Sorted Dictionary tests passed!\n" << std::endl;
+
+    return 0;
+}
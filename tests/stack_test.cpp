@@ -0,0 +1,109 @@
+#include <iostream>
+#include <cassert>
+#include "../include/stack.h"
+
+void testCoalesceTyping() {
+    UndoRedoStack history;
+
+    history.record(0, 0, "", "f");
+    history.record(0, 1, "", "o");
+    history.record(0, 2, "", "r");
+    assert(history.undoDepth() == 1);
+
+    // A space after a word starts a new step
+    history.record(0, 3, "", " ");
+    assert(history.undoDepth() == 2);
+
+    history.undo();
+    EditDelta word = history.undo();
+    assert(word.line == 0 && word.col == 0);
+    assert(word.inserted == "for");
+    assert(!history.canUndo());
+
+    std::cout << "Undo coalescing tests passed" << std::endl;
+}
+
+void testCoalesceBackspace() {
+    UndoRedoStack history;
+
+    history.record(2, 5, "o", "");
+    history.record(2, 4, "l", "");
+    history.record(2, 3, "l", "");
+    assert(history.undoDepth() == 1);
+
+    EditDelta deleted = history.undo();
+    assert(deleted.col == 3);
+    assert(deleted.removed == "llo");
+
+    // Multi-byte deletes keep their order, whether the run is sealed, undone
+    // or followed by another edit
+    history.record(0, 6, "gh", "");
+    history.record(0, 4, "ef", "");
+    history.record(0, 1, "bcd", "");
+    history.seal();
+    history.record(0, 0, "a", "");
+    history.record(1, 0, "", "x");
+    assert(history.undoDepth() == 3);
+    history.undo();
+    assert(history.undo().removed == "a");
+    assert(history.undo().removed == "bcdefgh");
+    assert(history.redo().removed == "bcdefgh");
+
+    std::cout << "Backspace coalescing tests passed" << std::endl;
+}
+
+void testSealAndRedo() {
+    UndoRedoStack history;
+
+    history.record(0, 0, "", "a");
+    history.seal();
+    history.record(0, 1, "", "b");
+    assert(history.undoDepth() == 2);
+
+    EditDelta undone = history.undo();
+    assert(undone.inserted == "b");
+    assert(history.canRedo());
+
+    EditDelta redone = history.redo();
+    assert(redone.inserted == "b");
+    assert(!history.canRedo());
+
+    // A new edit clears the redo stack
+    history.undo();
+    history.record(0, 1, "", "c");
+    assert(!history.canRedo());
+
+    std::cout << "Undo seal and redo tests passed" << std::endl;
+}
+
+void testByteBudget() {
+    UndoRedoStack history(1024);
+
+    for (int i = 0; i < 100; i++) {
+        history.record(i, 0, "", std::string(64, 'x'));
+        history.seal();
+    }
+
+    assert(history.bytesUsed() <= 1024);
+    assert(history.undoDepth() < 100);
+    assert(history.canUndo());
+
+    // The newest entry survives eviction
+    EditDelta newest = history.undo();
+    assert(newest.line == 99);
+
+    std::cout << "Undo byte budget tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Undo/Redo Stack Tests...\n" << std::endl;
+
+    testCoalesceTyping();
+    testCoalesceBackspace();
+    testSealAndRedo();
+    testByteBudget();
+
+    std::cout << "\n All Undo/Redo Stack tests passed!\n" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../include/substring_session.h"
+
+static std::vector<SubstringCandidate> naiveMatches(const std::vector<std::string>& words,
+                                                   const std::string& query) {
+    std::vector<SubstringCandidate> out;
+    for (size_t id = 0; id < words.size(); id++) {
+        size_t offset = words[id].find(query);
+        if (offset != std::string::npos) {
+            out.push_back(SubstringCandidate{(uint32_t)id, (uint32_t)offset});
+        }
+    }
+    return out;
+}
+
+static bool sameMatches(const std::vector<SubstringCandidate>& a, const std::vector<SubstringCandidate>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].id != b[i].id || a[i].offset != b[i].offset) return false;
+    }
+    return true;
+}
+
+void testNarrowing() {
+    std::vector<std::string> words = {"vector", "push_back", "std_vector_push", "reverse", "ve_ctor", "invert"};
+    SubstringSession session(&words);
+
+    assert(session.update("ve").size() == 5);
+    assert(session.lastScanned() == words.size());
+
+    // Appending only re-checks the previous matches
+    auto matches = session.update("vec");
+    assert(session.lastScanned() == 5);
+    assert(matches.size() == 2 && session.word(matches[1]) == "std_vector_push" && matches[1].offset == 4);
+
+    // "ver" first occurs later in "reverse" than "ve" did
+    session.update("ve");
+    matches = session.update("ver");
+    assert(matches.size() == 2 && session.word(matches[0]) == "reverse" && matches[0].offset == 2);
+
+    // Backspace pops back without scanning
+    session.update("vers");
+    assert(session.update("ve").size() == 5);
+    assert(session.lastScanned() == 0);
+
+    // A query unrelated to the last ones scans everything again
+    assert(session.update("push").size() == 2);
+    assert(session.lastScanned() == words.size());
+    assert(session.update("").empty());
+
+    std::cout << "Substring narrowing tests passed" << std::endl;
+}
+
+void testRandomSessions() {
+    std::vector<std::string> words;
+    srand(9);
+    for (int i = 0; i < 3000; i++) {
+        std::string word(1 + rand() % 12, ' ');
+        for (char& c : word) c = 'a' + rand() % 4;
+        words.push_back(word);
+    }
+
+    SubstringSession session(&words);
+    std::string query;
+    for (int step = 0; step < 3000; step++) {
+        int action = rand() % 10;
+        if (action < 6 && query.size() < 2 * SubstringSession::MAX_LEVELS) {
+            query += (char)('a' + rand() % 4);
+        } else if (action < 9 && !query.empty()) {
+            query.pop_back();
+        } else {
+            query = std::string(1, 'a' + rand() % 4);
+        }
+        if (query.empty()) {
+            assert(session.update(query).empty());
+            continue;
+        }
+        assert(sameMatches(session.update(query), naiveMatches(words, query)));
+        assert(session.depth() <= SubstringSession::MAX_LEVELS);
+    }
+
+    std::cout << "Substring random session tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Substring Session Tests...\n" << std::endl;
+
+    testNarrowing();
+    testRandomSessions();
+
+    std::cout << "\n All Substring Session tests passed!\n" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <map>
+#include "../include/symbol_index.h"
+
+static std::vector<std::string> words(const std::vector<LocalSymbol>& symbols) {
+    std::vector<std::string> out;
+    for (const auto& symbol : symbols) out.push_back(symbol.word);
+    return out;
+}
+
+void testTokenize() {
+    std::vector<std::string> out;
+    SymbolIndex::tokenize("for (int i = 0; i < count_; ++i) total += 0x1f * value2;", out);
+    assert((out == std::vector<std::string>{"for", "int", "count_", "total", "value2"}));
+
+    SymbolIndex::tokenize("", out);
+    assert(out.empty());
+
+    std::cout << "SymbolIndex tokenize tests passed" << std::endl;
+}
+
+void testUpdatesAreDiffed() {
+    SymbolIndex index;
+    index.updateLine(0, "int counter = 0;");
+    index.updateLine(1, "counter++;");
+    assert(index.occurrences("counter") == 2);
+    assert(index.occurrences("int") == 1);
+
+    // Rewriting a line replaces only what it contributed
+    index.updateLine(1, "countdown--;");
+    assert(index.occurrences("counter") == 1);
+    assert(index.occurrences("countdown") == 1);
+    assert((words(index.complete("coun", 0, 10)) == std::vector<std::string>{"counter", "countdown"}));
+
+    // The last occurrence takes the name out of the trie
+    index.updateLine(0, "");
+    assert(index.occurrences("counter") == 0);
+    assert((words(index.complete("coun", 0, 10)) == std::vector<std::string>{"countdown"}));
+    assert(index.symbolCount() == 1);
+
+    // The word being typed is not offered back
+    assert(index.complete("countdown", 0, 10).empty());
+
+    std::cout << "SymbolIndex diff tests passed" << std::endl;
+}
+
+void testLineShifts() {
+    SymbolIndex index;
+    index.updateLine(0, "alpha");
+    index.updateLine(1, "beta");
+    index.updateLine(2, "gamma");
+
+    // A line break typed at the end of line 0: line 1 is new and empty
+    index.linesInserted(1, 1);
+    index.updateLine(0, "alpha");
+    index.updateLine(1, "alphabet");
+    assert(index.occurrences("beta") == 1 && index.occurrences("alphabet") == 1);
+
+    // Joining lines 1 and 2 ("alphabet" + "beta"): line 2 goes away
+    index.linesErased(2, 1);
+    index.updateLine(1, "alphabetbeta");
+    assert(index.occurrences("beta") == 0);
+    assert(index.occurrences("alphabetbeta") == 1);
+    assert(index.occurrences("gamma") == 1);
+
+    // Erasing past the end is ignored
+    index.linesErased(10, 5);
+    index.linesErased(2, 5);
+    assert(index.occurrences("gamma") == 0);
+
+    std::cout << "SymbolIndex line shift tests passed" << std::endl;
+}
+
+void testProximityBoost() {
+    SymbolIndex index;
+    // "valueFar" is used twice near the top, "valueNear" once next to the cursor
+    index.updateLine(0, "valueFar = valueFar + 1;");
+    for (size_t line = 1; line < 1000; line++) {
+        index.updateLine(line, "x++;");
+    }
+    index.updateLine(990, "valueNear = 2;");
+
+    auto atBottom = index.complete("value", 995, 10);
+    assert(atBottom.size() == 2 && atBottom[0].word == "valueNear");
+    assert(atBottom[0].distance == 5 && atBottom[1].distance == SymbolIndex::RADIUS);
+
+    // From the top the more frequent, nearby name wins
+    auto atTop = index.complete("value", 1, 10);
+    assert(atTop[0].word == "valueFar" && atTop[0].count == 2 && atTop[0].distance == 1);
+
+    assert(index.complete("value", 995, 1).size() == 1);
+
+    // Every match is ranked, not just the first few in byte order: the last
+    // of 100 names wins when it is the one beside the cursor
+    for (int i = 0; i < 100; i++) {
+        index.updateLine(500 + i, "value_" + std::to_string(100 + i) + "++;");
+    }
+    index.updateLine(20, "value_zz = 0;");
+    auto crowded = index.complete("value_", 21, 3);
+    assert(crowded.size() == 3 && crowded[0].word == "value_zz" && crowded[0].distance == 1);
+
+    std::cout << "SymbolIndex proximity tests passed" << std::endl;
+}
+
+void testRandomEditsMatchRebuild() {
+    srand(5);
+    const char* names[] = {"alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta"};
+    std::vector<std::string> document(50);
+
+    SymbolIndex index;
+    auto randomLine = [&] {
+        std::string line;
+        int n = rand() % 4;
+        for (int i = 0; i < n; i++) line += std::string(names[rand() % 8]) + " ";
+        return line;
+    };
+
+    for (int step = 0; step < 3000; step++) {
+        int op = rand() % 3;
+        size_t at = rand() % (document.size() + 1);
+        if (op == 0 || document.size() < 2) {
+            size_t count = 1 + rand() % 3;
+            document.insert(document.begin() + at, count, "");
+            index.linesInserted(at, count);
+        } else if (op == 1 && at < document.size()) {
+            size_t count = std::min<size_t>(1 + rand() % 3, document.size() - at);
+            document.erase(document.begin() + at, document.begin() + at + count);
+            index.linesErased(at, count);
+        }
+        size_t line = rand() % document.size();
+        document[line] = randomLine();
+        index.updateLine(line, document[line]);
+    }
+
+    // Lines still empty in the index were never updated, as in the model
+    std::map<std::string, uint32_t> expected;
+    std::vector<std::string> tokens;
+    for (const auto& line : document) {
+        SymbolIndex::tokenize(line, tokens);
+        for (const auto& token : tokens) expected[token]++;
+    }
+    for (const char* name : names) {
+        assert(index.occurrences(name) == expected[name]);
+    }
+    assert(index.symbolCount() == expected.size());
+
+    std::cout << "SymbolIndex random edit tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Symbol Index Tests...\n" << std::endl;
+
+    testTokenize();
+    testUpdatesAreDiffed();
+    testLineShifts();
+    testProximityBoost();
+    testRandomEditsMatchRebuild();
+
+    std::cout << "\n All Symbol Index tests passed!\n" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../include/syntax.h"
+
+// Tokens of every line lexed from the top, the reference for the cache
+static std::vector<std::vector<SyntaxToken>> lexAll(const std::vector<std::string>& document) {
+    std::vector<std::vector<SyntaxToken>> out(document.size());
+    LexState state;
+    for (size_t i = 0; i < document.size(); i++) {
+        state = SyntaxHighlighter::lexLine(document[i], state, out[i]);
+    }
+    return out;
+}
+
+static bool sameTokens(const std::vector<SyntaxToken>& a, const std::vector<SyntaxToken>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].start != b[i].start || a[i].length != b[i].length || a[i].kind != b[i].kind) return false;
+    }
+    return true;
+}
+
+void testKeywordsAndLexStates() {
+    assert(SyntaxHighlighter::isKeyword("while", 5) && SyntaxHighlighter::isKeyword("nullptr", 7));
+    assert(!SyntaxHighlighter::isKeyword("whil", 4) && !SyntaxHighlighter::isKeyword("whilex", 6));
+
+    std::vector<SyntaxToken> tokens;
+    LexState state = SyntaxHighlighter::lexLine("int x; /* open", LexState(), tokens);
+    assert(state.mode == LexState::BLOCK_COMMENT);
+    tokens.clear();
+    state = SyntaxHighlighter::lexLine("still */ return", state, tokens);
+    assert(state.mode == LexState::NORMAL && tokens[0].kind == TOKEN_COMMENT && tokens.back().kind == TOKEN_KEYWORD);
+
+    tokens.clear();
+    state = SyntaxHighlighter::lexLine("auto s = R\"xy(raw", LexState(), tokens);
+    assert(state.mode == LexState::RAW_STRING && state.rawDelimiter == "xy");
+
+    std::cout << "SyntaxHighlighter lexer tests passed" << std::endl;
+}
+
+void testCheckpointsAndWindow() {
+    // Far more lines than the window, with a comment opened near the top
+    std::vector<std::string> document(20 * SyntaxHighlighter::WINDOW, "int x = 1; // note");
+    document[10] = "/* open";
+    document[3000] = "close */ int y;";
+    auto expected = lexAll(document);
+
+    SyntaxHighlighter syntax;
+    size_t fetched = 0;
+    auto getLine = [&](size_t line) { fetched++; return document[line]; };
+
+    // The first request far down lexes everything above it once ...
+    size_t far = document.size() - 10;
+    assert(sameTokens(syntax.lineTokens(far, getLine).tokens, expected[far]));
+    assert(fetched == far + 1);
+
+    // ... after which any line above is at most a checkpoint interval away
+    for (size_t line : {(size_t)5, (size_t)2999, (size_t)3000, (size_t)7000, (size_t)129}) {
+        fetched = 0;
+        assert(sameTokens(syntax.lineTokens(line, getLine).tokens, expected[line]));
+        assert(fetched <= SyntaxHighlighter::CHECKPOINT);
+    }
+
+    // Lines inside the window are cached and keep their version
+    const LineTokens& cached = syntax.lineTokens(130, getLine);
+    uint64_t version = cached.version;
+    fetched = 0;
+    assert(syntax.lineTokens(130, getLine).version == version && fetched == 0);
+
+    // Closing the comment early re-lexes the lines whose state changed
+    document[11] = "*/";
+    expected = lexAll(document);
+    syntax.invalidate(11);
+    assert(sameTokens(syntax.lineTokens(130, getLine).tokens, expected[130]));
+    assert(syntax.lineTokens(130, getLine).version != version);
+
+    std::cout << "SyntaxHighlighter checkpoint and window tests passed" << std::endl;
+}
+
+void testRandomEditsMatchFullLex() {
+    srand(29);
+    const char* pool[] = {"int a = 0;", "/* open", "close */", "// line", "auto s = R\"d(raw",
+                          "end)d\";", "return \"str\";", "", "#include <x>", "x /* y */ z"};
+    std::vector<std::string> document(3000);
+    for (auto& line : document) line = pool[rand() % 10];
+
+    SyntaxHighlighter syntax;
+    auto getLine = [&](size_t line) { return document[line]; };
+
+    size_t scrollY = 0;
+    for (int step = 0; step < 400; step++) {
+        int op = rand() % 4;
+        size_t at = rand() % document.size();
+        size_t count = 1 + rand() % 700;
+        if (op == 0) {
+            document[at] = pool[rand() % 10];
+            syntax.invalidate(at);
+        } else if (op == 1) {
+            std::vector<std::string> added(count);
+            for (auto& line : added) line = pool[rand() % 10];
+            document.insert(document.begin() + at, added.begin(), added.end());
+            syntax.linesInserted(at, count);
+        } else if (op == 2 && document.size() > count + 1) {
+            count = std::min(count, document.size() - at);
+            document.erase(document.begin() + at, document.begin() + at + count);
+            syntax.linesErased(at, count);
+        }
+
+        // Draw a screen, mostly near the last one, sometimes far away
+        if (rand() % 4 == 0) {
+            scrollY = rand() % document.size();
+        } else {
+            scrollY = std::min(scrollY + rand() % 40, document.size() - 1);
+        }
+        auto expected = lexAll(document);
+        for (size_t row = 0; row < 60 && scrollY + row < document.size(); row++) {
+            const LineTokens& tokens = syntax.lineTokens(scrollY + row, getLine);
+            assert(sameTokens(tokens.tokens, expected[scrollY + row]));
+        }
+    }
+
+    std::cout << "SyntaxHighlighter random edit tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning Syntax Highlighter Tests...\n" << std::endl;
+
+    testKeywordsAndLexStates();
+    testCheckpointsAndWindow();
+    testRandomEditsMatchFullLex();
+
+    std::cout << "\n All Syntax Highlighter tests passed!\n" << std::endl;
+
+    return 0;
+}
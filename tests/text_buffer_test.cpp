@@ -0,0 +1,243 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../include/text_buffer.h"
+#include "../include/line_index.h"
+
+void testLoadAndLines() {
+    TextBuffer buffer;
+    assert(buffer.lineCount() == 1);
+    assert(buffer.line(0) == "");
+
+    buffer.load("int main() {\n    return 0;\n}");
+    assert(buffer.lineCount() == 3);
+    assert(buffer.line(0) == "int main() {");
+    assert(buffer.line(1) == "    return 0;");
+    assert(buffer.line(2) == "}");
+    assert(buffer.lineLength(1) == 13);
+    assert(buffer.offsetOf(2, 0) == 27);
+
+    std::cout << "TextBuffer load and line tests passed" << std::endl;
+}
+
+void testInsertAndErase() {
+    TextBuffer buffer;
+    buffer.load("hello world");
+
+    buffer.insert(5, ",");
+    assert(buffer.text() == "hello, world");
+
+    // Split the line in the middle of a piece
+    buffer.insert(6, "\n");
+    assert(buffer.lineCount() == 2);
+    assert(buffer.line(0) == "hello,");
+    assert(buffer.line(1) == " world");
+
+    // Join it back by erasing across the line break
+    buffer.erase(6, 2);
+    assert(buffer.lineCount() == 1);
+    assert(buffer.text() == "hello,world");
+
+    std::cout << "TextBuffer insert and erase tests passed" << std::endl;
+}
+
+void testTypingCoalescesPieces() {
+    TextBuffer buffer;
+    buffer.load("ab");
+
+    size_t before = buffer.pieceCount();
+    std::string typed = "xyz123";
+    for (size_t i = 0; i < typed.size(); i++) {
+        buffer.insert(1 + i, std::string(1, typed[i]));
+    }
+    assert(buffer.text() == "axyz123b");
+    assert(buffer.pieceCount() == before + 2);
+
+    std::cout << "TextBuffer typing tests passed" << std::endl;
+}
+
+void testRandomEditsMatchString() {
+    TextBuffer buffer;
+    std::string model = "first\nsecond\nthird";
+    buffer.load(model);
+
+    srand(42);
+    for (int step = 0; step < 5000; step++) {
+        size_t pos = model.empty() ? 0 : rand() % (model.size() + 1);
+        if (rand() % 3 != 0) {
+            std::string text = (rand() % 4 == 0) ? "\n" : std::string(1 + rand() % 3, 'a' + rand() % 26);
+            buffer.insert(pos, text);
+            model.insert(pos, text);
+        } else if (!model.empty()) {
+            size_t count = 1 + rand() % 4;
+            if (pos >= model.size()) pos = model.size() - 1;
+            count = std::min(count, model.size() - pos);
+            buffer.erase(pos, count);
+            model.erase(pos, count);
+        }
+    }
+
+    assert(buffer.text() == model);
+    assert(buffer.length() == model.size());
+
+    size_t line = 0;
+    size_t start = 0;
+    for (size_t i = 0; i <= model.size(); i++) {
+        if (i == model.size() || model[i] == '\n') {
+            assert(buffer.lineStart(line) == start);
+            assert(buffer.line(line) == model.substr(start, i - start));
+            line++;
+            start = i + 1;
+        }
+    }
+    assert(buffer.lineCount() == line);
+
+    size_t lineOfOffset = 0;
+    for (size_t i = 0; i <= model.size(); i++) {
+        assert(buffer.lineAt(i) == lineOfOffset);
+        if (i < model.size() && model[i] == '\n') lineOfOffset++;
+    }
+
+    std::cout << "TextBuffer random edit tests passed" << std::endl;
+}
+
+void testLineIndex() {
+    srand(7);
+    std::string text;
+    for (int i = 0; i < 40000; i++) {
+        text += rand() % 9 == 0 ? '\n' : (char)('a' + rand() % 26);
+    }
+
+    // The vector kernels against a plain count, at every alignment and tail length
+    for (size_t from = 0; from < 64; from++) {
+        for (size_t length = 0; length < 300; length += 7) {
+            size_t expected = 0;
+            for (size_t i = from; i < from + length; i++) expected += text[i] == '\n';
+            assert(LineIndex::countNewlines(text.data() + from, length) == expected);
+        }
+    }
+
+    std::vector<size_t> positions;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\n') positions.push_back(i);
+    }
+
+    // Background or not, queries give the same answers
+    for (bool background : {false, true}) {
+        LineIndex index;
+        index.build(text.data(), text.size(), background, 0);
+
+        for (size_t k = 0; k < positions.size(); k += 3) {
+            assert(index.findBreak(k) == positions[k]);
+        }
+        assert(index.findBreak(positions.size()) == LineIndex::npos);
+
+        size_t breaks = 0;
+        for (size_t i = 0; i <= text.size(); i += 13) {
+            while (breaks < positions.size() && positions[breaks] < i) breaks++;
+            assert(index.breaksBefore(i) == breaks);
+        }
+
+        index.wait();
+        assert(index.ready());
+        assert(index.knownBreaks() == positions.size());
+    }
+
+    std::cout << "LineIndex tests passed" << std::endl;
+}
+
+void testOpenMapsFile() {
+    std::string model;
+    for (int i = 0; i < 50000; i++) {
+        model += "line " + std::to_string(i) + std::string(i % 17, 'x') + "\n";
+    }
+    model += "last line without newline";
+
+    char path[] = "/tmp/text_buffer_test_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(write(fd, model.data(), model.size()) == (ssize_t)model.size());
+    close(fd);
+
+    TextBuffer buffer;
+    std::string error;
+    assert(!buffer.open("/nonexistent/file.txt", error));
+    assert(!error.empty());
+    assert(buffer.open(path, error));
+    assert(buffer.length() == model.size());
+
+    // The first screen is there whether or not indexing has finished
+    assert(buffer.lineCount() > 24);
+    for (size_t i = 0; i < 24; i++) {
+        assert(buffer.line(i) == "line " + std::to_string(i) + std::string(i % 17, 'x'));
+    }
+
+    buffer.finishLoading();
+    assert(!buffer.loading());
+    assert(buffer.lineCount() == 50001);
+    assert(buffer.line(50000) == "last line without newline");
+    assert(buffer.lineAt(model.size()) == 50000);
+    assert(buffer.text() == model);
+
+    // The mapping is read-only; edits go to the add buffer
+    buffer.insert(0, "first\n");
+    buffer.erase(buffer.lineStart(100), buffer.lineLength(100) + 1);
+    model.insert(0, "first\n");
+    size_t start = 0;
+    for (int i = 0; i < 100; i++) start = model.find('\n', start) + 1;
+    model.erase(start, model.find('\n', start) + 1 - start);
+    assert(buffer.text() == model);
+    assert(buffer.lineCount() == 50001);
+
+    // Saving over the mapped file replaces it; the mapping keeps the old one.
+    // The mode carries over, and an unrelated path.tmp is left alone.
+    chmod(path, 0640);
+    std::string bystander = std::string(path) + ".tmp";
+    std::FILE* other = std::fopen(bystander.c_str(), "w");
+    std::fputs("not ours", other);
+    std::fclose(other);
+    assert(buffer.save(path, error));
+    std::FILE* saved = std::fopen(path, "rb");
+    std::string written(model.size() + 1, '\0');
+    written.resize(std::fread(&written[0], 1, written.size(), saved));
+    std::fclose(saved);
+    assert(written == model);
+    assert(buffer.text() == model);
+    struct stat info;
+    assert(stat(path, &info) == 0 && (info.st_mode & 07777) == 0640);
+    other = std::fopen(bystander.c_str(), "r");
+    char kept[16] = {};
+    assert(std::fread(kept, 1, sizeof(kept) - 1, other) == 8 && std::string(kept) == "not ours");
+    std::fclose(other);
+    unlink(bystander.c_str());
+    assert(!buffer.save("/nonexistent/dir/file.txt", error));
+
+    // An empty file is an empty document
+    std::FILE* empty = std::fopen(path, "w");
+    std::fclose(empty);
+    assert(buffer.open(path, error));
+    assert(buffer.length() == 0 && buffer.lineCount() == 1 && !buffer.loading());
+
+    unlink(path);
+    std::cout << "TextBuffer open tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "\nRunning TextBuffer Tests...\n" << std::endl;
+
+    testLoadAndLines();
+    testInsertAndErase();
+    testTypingCoalescesPieces();
+    testRandomEditsMatchString();
+    testLineIndex();
+    testOpenMapsFile();
+
+    std::cout << "\n All TextBuffer tests passed!\n" << std::endl;
+
+    return 0;
+}
@@ -1,5 +1,9 @@
 #include <iostream>
 #include <cassert>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdlib>
 #include "../include/tst.h"
 
 void testTSTInsertAndSearch() {
@@ -67,12 +71,137 @@ void testTSTEmptyCases(){
     std::cout << "✓ TST Empty Cases tests passed" << std::endl;
 }
 
+void testTSTErase(){
+    TST tst;
+    
+    tst.insert("hell");
+    tst.insert("hello");
+    tst.insert("help");
+    assert(tst.wordCount() == 3);
+    assert(tst.nodeCount() == 6);
+    
+    assert(tst.erase("hello") == true);
+    assert(tst.search("hello") == false);
+    assert(tst.search("hell") == true);
+    assert(tst.nodeCount() == 5);
+    
+    // Erasing a prefix of another word keeps the shared nodes
+    assert(tst.erase("hell") == true);
+    assert(tst.search("help") == true);
+    assert(tst.nodeCount() == 4);
+    
+    assert(tst.erase("hell") == false);
+    assert(tst.erase("he") == false);
+    assert(tst.erase("") == false);
+    
+    assert(tst.erase("help") == true);
+    assert(tst.wordCount() == 0);
+    assert(tst.nodeCount() == 0);
+    assert(tst.prefixSearch("he", 5).empty());
+    
+    std::cout << "✓ TST Erase tests passed" << std::endl;
+}
+
+void testTSTCompact(){
+    TST tst;
+    std::set<std::string> expected;
+    
+    srand(7);
+    std::vector<std::string> all;
+    for (char a = 'a'; a <= 'z'; a++) {
+        for (char b = 'a'; b <= 'z'; b++) {
+            all.push_back(std::string(1, a) + b + "x");
+        }
+    }
+    for (size_t i = all.size() - 1; i > 0; i--) {
+        std::swap(all[i], all[rand() % (i + 1)]);
+    }
+    for (const auto& word : all) {
+        tst.insert(word);
+        expected.insert(word);
+    }
+    
+    // Erasing words whose node has two siblings leaves dead junctions
+    for (int i = 0; i < 400; i++) {
+        std::string word = std::string(1, 'a' + rand() % 26) + (char)('a' + rand() % 26) + "x";
+        assert(tst.erase(word) == (expected.erase(word) == 1));
+    }
+    assert(tst.wordCount() == expected.size());
+    
+    size_t before = tst.nodeCount();
+    size_t dead = tst.deadNodeCount();
+    assert(dead > 0);
+    tst.compact();
+    assert(tst.deadNodeCount() == 0);
+    assert(tst.nodeCount() == before - dead);
+    assert(tst.wordCount() == expected.size());
+    
+    std::vector<std::string> words;
+    tst.getAllWords(words);
+    assert(std::set<std::string>(words.begin(), words.end()) == expected);
+    for (const auto& word : expected) {
+        assert(tst.search(word));
+    }
+    
+    // Tree still accepts inserts and erases after a rebuild
+    tst.insert("zzz");
+    assert(tst.search("zzz"));
+    assert(tst.erase("zzz"));
+    
+    std::cout << "✓ TST Compact tests passed" << std::endl;
+}
+
+void testTSTFragmentationThreshold(){
+    TST tst;
+    tst.insert("b");
+    tst.insert("a");
+    tst.insert("c");
+    
+    // "b" roots the sibling BST with both links in use: it goes dead, not away
+    assert(tst.erase("b"));
+    assert(tst.deadNodeCount() == 1);
+    assert(tst.nodeCount() == 3);
+    
+    assert(tst.compactIfFragmented(0.5) == false);
+    assert(tst.compactIfFragmented(0.25) == true);
+    assert(tst.nodeCount() == 2);
+    assert(tst.deadNodeCount() == 0);
+    
+    // Reusing a dead node revives it
+    tst.insert("b");
+    tst.erase("b");
+    tst.insert("b");
+    assert(tst.deadNodeCount() == 0);
+    assert(tst.search("a") && tst.search("b") && tst.search("c"));
+    
+    std::cout << "✓ TST Fragmentation threshold tests passed" << std::endl;
+}
+
+void testTSTMemoryUsage() {
+    TST tst;
+    assert(tst.memoryUsage().items == 0);
+    
+    tst.insert("print");
+    tst.insert("printf");
+    tst.insert("println");
+    MemoryUsage usage = tst.memoryUsage();
+    assert(usage.items == 3);
+    assert(usage.nodes > 0 && usage.total() >= usage.nodes);
+    assert(usage.nodes == sizeof(TSTNode) * tst.nodeCount());
+    
+    std::cout << "✓ TST Memory usage tests passed" << std::endl;
+}
+
 int main() {
     std::cout << "\nRunning TST Tests...\n" << std::endl;
     
     testTSTInsertAndSearch();
     testTSTPrefixSearch();
     testTSTEmptyCases();
+    testTSTErase();
+    testTSTCompact();
+    testTSTFragmentationThreshold();
+    testTSTMemoryUsage();
     
     std::cout << "\n All TST tests passed!\n" << std::endl;
     